@@ -0,0 +1,68 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_CPP__BULK_ENTITIES_HPP_
+#define RMW_FASTRTPS_CPP__BULK_ENTITIES_HPP_
+
+#include <cstddef>
+
+#include "rmw/rmw.h"
+#include "rmw/subscription_options.h"
+
+namespace rmw_fastrtps_cpp
+{
+
+/// One publisher to create in a bulk batch; `publisher` receives the result.
+struct PublisherRequest
+{
+  const rosidl_message_type_support_t * type_supports;
+  const char * topic_name;
+  const rmw_qos_profile_t * qos_policies;
+  const rmw_publisher_options_t * publisher_options;
+  rmw_publisher_t * publisher;
+};
+
+/// One subscription to create in a bulk batch; `subscription` receives the
+/// result.
+struct SubscriptionRequest
+{
+  const rosidl_message_type_support_t * type_supports;
+  const char * topic_name;
+  const rmw_qos_profile_t * qos_policies;
+  const rmw_subscription_options_t * subscription_options;
+  rmw_subscription_t * subscription;
+};
+
+/// Create a batch of publishers and subscriptions with one graph update.
+/**
+ * Equivalent to calling rmw_create_publisher / rmw_create_subscription for
+ * each request, except that the graph cache is updated and the participant
+ * entities announcement published once for the whole batch instead of once
+ * per entity, so remote participants process a single discovery update.
+ * Types shared between requests are registered with the participant once.
+ *
+ * On failure every entity already created by the batch is destroyed and all
+ * result fields are null; the batch either fully succeeds or has no effect.
+ */
+rmw_ret_t
+create_entities_bulk(
+  const rmw_node_t * node,
+  PublisherRequest * publisher_requests,
+  size_t publisher_request_count,
+  SubscriptionRequest * subscription_requests,
+  size_t subscription_request_count);
+
+}  // namespace rmw_fastrtps_cpp
+
+#endif  // RMW_FASTRTPS_CPP__BULK_ENTITIES_HPP_
@@ -0,0 +1,159 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <mutex>
+
+#include "rmw/error_handling.h"
+#include "rmw/rmw.h"
+
+#include "rmw_dds_common/context.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+#include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
+
+#include "rmw_fastrtps_cpp/bulk_entities.hpp"
+#include "rmw_fastrtps_cpp/identifier.hpp"
+#include "rmw_fastrtps_cpp/publisher.hpp"
+#include "rmw_fastrtps_cpp/subscription.hpp"
+
+namespace rmw_fastrtps_cpp
+{
+
+static void
+_destroy_batch(
+  const rmw_node_t * node,
+  PublisherRequest * publisher_requests,
+  size_t publisher_request_count,
+  SubscriptionRequest * subscription_requests,
+  size_t subscription_request_count)
+{
+  for (size_t i = 0; i < publisher_request_count; ++i) {
+    if (publisher_requests[i].publisher) {
+      rmw_fastrtps_shared_cpp::__rmw_destroy_publisher(
+        eprosima_fastrtps_identifier, node, publisher_requests[i].publisher);
+      publisher_requests[i].publisher = nullptr;
+    }
+  }
+  for (size_t i = 0; i < subscription_request_count; ++i) {
+    if (subscription_requests[i].subscription) {
+      rmw_fastrtps_shared_cpp::__rmw_destroy_subscription(
+        eprosima_fastrtps_identifier, node, subscription_requests[i].subscription);
+      subscription_requests[i].subscription = nullptr;
+    }
+  }
+}
+
+rmw_ret_t
+create_entities_bulk(
+  const rmw_node_t * node,
+  PublisherRequest * publisher_requests,
+  size_t publisher_request_count,
+  SubscriptionRequest * subscription_requests,
+  size_t subscription_request_count)
+{
+  if (!node) {
+    RMW_SET_ERROR_MSG("node handle is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (node->implementation_identifier != eprosima_fastrtps_identifier) {
+    RMW_SET_ERROR_MSG("node handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+  if ((publisher_request_count && !publisher_requests) ||
+    (subscription_request_count && !subscription_requests))
+  {
+    RMW_SET_ERROR_MSG("request array is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  if (0 == publisher_request_count && 0 == subscription_request_count) {
+    return RMW_RET_OK;
+  }
+
+  auto participant_info =
+    static_cast<CustomParticipantInfo *>(node->context->impl->participant_info);
+  auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
+
+  for (size_t i = 0; i < publisher_request_count; ++i) {
+    publisher_requests[i].publisher = nullptr;
+  }
+  for (size_t i = 0; i < subscription_request_count; ++i) {
+    subscription_requests[i].subscription = nullptr;
+  }
+
+  // Endpoint creation itself stays sequential: Domain::createPublisher /
+  // createSubscriber serialize on the participant internally, so threads
+  // would only contend. The win is below — one graph update and one
+  // discovery announcement for the whole batch. Types shared between
+  // requests are registered on the first use and found by lookup afterwards.
+  for (size_t i = 0; i < publisher_request_count; ++i) {
+    PublisherRequest & req = publisher_requests[i];
+    req.publisher = create_publisher(
+      participant_info, req.type_supports, req.topic_name,
+      req.qos_policies, req.publisher_options, false, true);
+    if (!req.publisher) {
+      _destroy_batch(
+        node, publisher_requests, publisher_request_count,
+        subscription_requests, subscription_request_count);
+      return RMW_RET_ERROR;
+    }
+  }
+  for (size_t i = 0; i < subscription_request_count; ++i) {
+    SubscriptionRequest & req = subscription_requests[i];
+    req.subscription = create_subscription(
+      participant_info, req.type_supports, req.topic_name,
+      req.qos_policies, req.subscription_options, false, true);
+    if (!req.subscription) {
+      _destroy_batch(
+        node, publisher_requests, publisher_request_count,
+        subscription_requests, subscription_request_count);
+      return RMW_RET_ERROR;
+    }
+  }
+
+  {
+    // Associate every endpoint under one lock; only the final cumulative
+    // state is announced, so remote participants process the batch as a
+    // single discovery update instead of one per entity.
+    std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
+    rmw_dds_common::msg::ParticipantEntitiesInfo msg;
+    for (size_t i = 0; i < publisher_request_count; ++i) {
+      auto info = static_cast<const CustomPublisherInfo *>(publisher_requests[i].publisher->data);
+      msg = common_context->graph_cache.associate_writer(
+        info->publisher_gid, common_context->gid, node->name, node->namespace_);
+    }
+    for (size_t i = 0; i < subscription_request_count; ++i) {
+      auto info =
+        static_cast<const CustomSubscriberInfo *>(subscription_requests[i].subscription->data);
+      msg = common_context->graph_cache.associate_reader(
+        info->subscription_gid_, common_context->gid, node->name, node->namespace_);
+    }
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      eprosima_fastrtps_identifier, common_context, &msg);
+    if (RMW_RET_OK != rmw_ret) {
+      _destroy_batch(
+        node, publisher_requests, publisher_request_count,
+        subscription_requests, subscription_request_count);
+      return rmw_ret;
+    }
+  }
+
+  return RMW_RET_OK;
+}
+
+}  // namespace rmw_fastrtps_cpp
@@ -29,8 +29,12 @@
 #include "rmw_fastrtps_cpp/subscription.hpp"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_snapshot.hpp"
 #include "rmw_fastrtps_shared_cpp/participant.hpp"
 #include "rmw_fastrtps_shared_cpp/publisher.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/subscription.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -56,6 +60,29 @@ init_context_impl(rmw_context_t * context)
     return RMW_RET_BAD_ALLOC;
   }
 
+  // The guard condition is the only step with no dependency on the
+  // participant; creating it first keeps the expensive participant setup
+  // last in the failure ordering. Everything after the participant exists
+  // (graph publisher, subscriber, listener thread) consumes its handle and
+  // cannot be overlapped with its creation.
+  std::unique_ptr<rmw_guard_condition_t, std::function<void(rmw_guard_condition_t *)>>
+  graph_guard_condition(
+    rmw_fastrtps_shared_cpp::__rmw_create_guard_condition(eprosima_fastrtps_identifier),
+    [&](rmw_guard_condition_t * p) {
+      rmw_ret_t ret = rmw_fastrtps_shared_cpp::__rmw_destroy_guard_condition(p);
+      if (ret != RMW_RET_OK) {
+        RMW_SAFE_FWRITE_TO_STDERR(
+          "Failed to destroy guard condition after function: '"
+          RCUTILS_STRINGIFY(__function__) "' failed.\n");
+      }
+    });
+  if (!graph_guard_condition) {
+    return RMW_RET_BAD_ALLOC;
+  }
+  // Optional trigger coalescing for discovery storms; no-op when the
+  // quiet-window variable is unset.
+  rmw_fastrtps_shared_cpp::apply_graph_guard_coalescing(graph_guard_condition.get());
+
   std::unique_ptr<CustomParticipantInfo, std::function<void(CustomParticipantInfo *)>>
   participant_info(
     rmw_fastrtps_shared_cpp::create_participant(
@@ -66,7 +93,9 @@ init_context_impl(rmw_context_t * context)
       context->options.enclave,
       common_context.get()),
     [&](CustomParticipantInfo * participant_info) {
-      if (RMW_RET_OK != rmw_fastrtps_shared_cpp::destroy_participant(participant_info)) {
+      if (RMW_RET_OK !=
+      rmw_fastrtps_shared_cpp::destroy_participant(participant_info, common_context.get()))
+      {
         RCUTILS_SAFE_FWRITE_TO_STDERR(
           "Failed to destroy participant after function: '"
           RCUTILS_STRINGIFY(__function__) "' failed.\n");
@@ -83,6 +112,12 @@ init_context_impl(rmw_context_t * context)
   qos.depth = 1;
   qos.durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
   qos.reliability = RMW_QOS_POLICY_RELIABILITY_RELIABLE;
+  if (rmw_fastrtps_shared_cpp::graph_announce_reduced_qos()) {
+    // WAN deployments trade reliable graph gossip for bandwidth; see
+    // graph_announce.hpp. Applied to both endpoints so a reliable reader
+    // does not refuse the best-effort writer.
+    qos.reliability = RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT;
+  }
 
   std::unique_ptr<rmw_publisher_t, std::function<void(rmw_publisher_t *)>>
   publisher(
@@ -136,23 +171,9 @@ init_context_impl(rmw_context_t * context)
     return RMW_RET_BAD_ALLOC;
   }
 
-  std::unique_ptr<rmw_guard_condition_t, std::function<void(rmw_guard_condition_t *)>>
-  graph_guard_condition(
-    rmw_fastrtps_shared_cpp::__rmw_create_guard_condition(eprosima_fastrtps_identifier),
-    [&](rmw_guard_condition_t * p) {
-      rmw_ret_t ret = rmw_fastrtps_shared_cpp::__rmw_destroy_guard_condition(p);
-      if (ret != RMW_RET_OK) {
-        RMW_SAFE_FWRITE_TO_STDERR(
-          "Failed to destroy guard condition after function: '"
-          RCUTILS_STRINGIFY(__function__) "' failed.\n");
-      }
-    });
-  if (!graph_guard_condition) {
-    return RMW_RET_BAD_ALLOC;
-  }
-
   common_context->graph_cache.set_on_change_callback(
-    [guard_condition = graph_guard_condition.get()]() {
+    [guard_condition = graph_guard_condition.get(), graph_key = common_context.get()]() {
+      rmw_fastrtps_shared_cpp::graph_query_cache_on_change(graph_key);
       rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
         eprosima_fastrtps_identifier,
         guard_condition);
@@ -175,6 +196,11 @@ init_context_impl(rmw_context_t * context)
     common_context->gid,
     context->options.enclave);
 
+  // Warm-start the graph from the previous incarnation's snapshot, if one
+  // is configured and fresh; discovery then confirms or corrects it.
+  rmw_fastrtps_shared_cpp::graph_snapshot_preload(
+    eprosima_fastrtps_identifier, common_context.get());
+
   graph_guard_condition.release();
   publisher.release();
   subscription.release();
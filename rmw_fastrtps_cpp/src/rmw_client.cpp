@@ -19,8 +19,11 @@
 #include "rmw/allocators.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/client_endpoint_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
@@ -77,15 +80,11 @@ rmw_create_client(
     return nullptr;
   }
 
-  const rosidl_service_type_support_t * type_support = get_service_typesupport_handle(
-    type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  const rosidl_service_type_support_t * type_support =
+    _resolve_service_typesupport(type_supports);
   if (!type_support) {
-    type_support = get_service_typesupport_handle(
-      type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
-    if (!type_support) {
-      RMW_SET_ERROR_MSG("type support not from this implementation");
-      return nullptr;
-    }
+    RMW_SET_ERROR_MSG("type support not from this implementation");
+    return nullptr;
   }
 
   CustomClientInfo * info = nullptr;
@@ -93,12 +92,6 @@ rmw_create_client(
   eprosima::fastrtps::PublisherAttributes publisherParam;
   rmw_client_t * rmw_client = nullptr;
 
-  info = new CustomClientInfo();
-  info->participant_ = participant;
-  info->typesupport_identifier_ = type_support->typesupport_identifier;
-  info->request_publisher_matched_count_ = 0;
-  info->response_subscriber_matched_count_ = 0;
-
   const service_type_support_callbacks_t * service_members;
   const message_type_support_callbacks_t * request_members;
   const message_type_support_callbacks_t * response_members;
@@ -109,91 +102,121 @@ rmw_create_client(
   response_members = static_cast<const message_type_support_callbacks_t *>(
     service_members->response_members_->data);
 
-  info->request_type_support_impl_ = request_members;
-  info->response_type_support_impl_ = response_members;
-
   std::string request_type_name = _create_type_name(request_members);
   std::string response_type_name = _create_type_name(response_members);
 
-  if (
-    !Domain::getRegisteredType(
-      participant, request_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
-  {
-    info->request_type_support_ = new RequestTypeSupport_cpp(service_members);
-    _register_type(participant, info->request_type_support_);
-  }
+  // A pair parked by a previous client of this service is still registered,
+  // created and matched; reviving it skips all of the work below.
+  info = rmw_fastrtps_shared_cpp::client_endpoint_pool_take(
+    common_context, service_name, request_type_name, response_type_name, *qos_policies);
+  if (nullptr == info) {
+    info = new CustomClientInfo();
+    info->participant_ = participant;
+    info->typesupport_identifier_ = type_support->typesupport_identifier;
+    info->request_publisher_matched_count_ = 0;
+    info->response_subscriber_matched_count_ = 0;
+    info->request_type_support_impl_ = request_members;
+    info->response_type_support_impl_ = response_members;
+    info->request_data_template_.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
+    info->request_data_template_.impl = request_members;
+    info->qos_profile_ = *qos_policies;
+    // Statically generated type supports outlive the client, so its
+    // endpoints may be parked for reuse on destroy.
+    info->poolable_ = true;
+
+    info->request_type_support_ =
+      participant_info->find_registered_type(participant, request_type_name);
+    if (!info->request_type_support_) {
+      if (
+        !Domain::getRegisteredType(
+          participant, request_type_name.c_str(),
+          reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
+      {
+        info->request_type_support_ = new RequestTypeSupport_cpp(service_members);
+        _register_type(participant, info->request_type_support_);
+      }
+      participant_info->record_registered_type(
+        participant, request_type_name, info->request_type_support_);
+    }
 
-  if (
-    !Domain::getRegisteredType(
-      participant, response_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
-  {
-    info->response_type_support_ = new ResponseTypeSupport_cpp(service_members);
-    _register_type(participant, info->response_type_support_);
-  }
+    info->response_type_support_ =
+      participant_info->find_registered_type(participant, response_type_name);
+    if (!info->response_type_support_) {
+      if (
+        !Domain::getRegisteredType(
+          participant, response_type_name.c_str(),
+          reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
+      {
+        info->response_type_support_ = new ResponseTypeSupport_cpp(service_members);
+        _register_type(participant, info->response_type_support_);
+      }
+      participant_info->record_registered_type(
+        participant, response_type_name, info->response_type_support_);
+    }
 
-  if (!participant_info->leave_middleware_default_qos) {
-    subscriberParam.historyMemoryPolicy =
-      eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
-  }
+    if (!participant_info->leave_middleware_default_qos) {
+      subscriberParam.historyMemoryPolicy =
+        eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
+    }
 
-  subscriberParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
-  subscriberParam.topic.topicDataType = response_type_name;
-  subscriberParam.topic.topicName = _create_topic_name(
-    qos_policies, ros_service_response_prefix, service_name, "Reply");
+    subscriberParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
+    subscriberParam.topic.topicDataType = response_type_name;
+    subscriberParam.topic.topicName = _create_topic_name(
+      qos_policies, ros_service_response_prefix, service_name, "Reply");
 
-  if (!participant_info->leave_middleware_default_qos) {
-    publisherParam.qos.m_publishMode.kind = eprosima::fastrtps::ASYNCHRONOUS_PUBLISH_MODE;
-    publisherParam.historyMemoryPolicy =
-      eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
-  }
+    if (!participant_info->leave_middleware_default_qos) {
+      publisherParam.qos.m_publishMode.kind = eprosima::fastrtps::ASYNCHRONOUS_PUBLISH_MODE;
+      publisherParam.historyMemoryPolicy =
+        eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
+    }
 
-  publisherParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
-  publisherParam.topic.topicDataType = request_type_name;
-  publisherParam.topic.topicName = _create_topic_name(
-    qos_policies, ros_service_requester_prefix, service_name, "Request");
-
-  RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_fastrtps_cpp",
-    "************ Client Details *********");
-  RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_fastrtps_cpp",
-    "Sub Topic %s", subscriberParam.topic.topicName.c_str());
-  RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_fastrtps_cpp",
-    "Pub Topic %s", publisherParam.topic.topicName.c_str());
-  RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_cpp", "***********");
-
-  // Create Client Subscriber and set QoS
-  if (!get_datareader_qos(*qos_policies, subscriberParam)) {
-    RMW_SET_ERROR_MSG("failed to get datareader qos");
-    goto fail;
-  }
-  info->listener_ = new ClientListener(info);
-  info->response_subscriber_ =
-    Domain::createSubscriber(participant, subscriberParam, info->listener_);
-  if (!info->response_subscriber_) {
-    RMW_SET_ERROR_MSG("create_client() could not create subscriber");
-    goto fail;
-  }
+    publisherParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
+    publisherParam.topic.topicDataType = request_type_name;
+    publisherParam.topic.topicName = _create_topic_name(
+      qos_policies, ros_service_requester_prefix, service_name, "Request");
+
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_cpp",
+      "************ Client Details *********");
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_cpp",
+      "Sub Topic %s", subscriberParam.topic.topicName.c_str());
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_cpp",
+      "Pub Topic %s", publisherParam.topic.topicName.c_str());
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_cpp", "***********");
+
+    // Create Client Subscriber and set QoS
+    if (!get_datareader_qos(*qos_policies, subscriberParam)) {
+      RMW_SET_ERROR_MSG("failed to get datareader qos");
+      goto fail;
+    }
+    info->listener_ = new ClientListener(info);
+    info->response_subscriber_ =
+      Domain::createSubscriber(participant, subscriberParam, info->listener_);
+    if (!info->response_subscriber_) {
+      RMW_SET_ERROR_MSG("create_client() could not create subscriber");
+      goto fail;
+    }
 
-  // Create Client Publisher and set QoS
-  if (!get_datawriter_qos(*qos_policies, publisherParam)) {
-    RMW_SET_ERROR_MSG("failed to get datawriter qos");
-    goto fail;
-  }
-  info->pub_listener_ = new ClientPubListener(info);
-  info->request_publisher_ =
-    Domain::createPublisher(participant, publisherParam, info->pub_listener_);
-  if (!info->request_publisher_) {
-    RMW_SET_ERROR_MSG("create_client() could not create publisher");
-    goto fail;
-  }
+    // Create Client Publisher and set QoS
+    if (!get_datawriter_qos(*qos_policies, publisherParam)) {
+      RMW_SET_ERROR_MSG("failed to get datawriter qos");
+      goto fail;
+    }
+    info->pub_listener_ = new ClientPubListener(info);
+    info->request_publisher_ =
+      Domain::createPublisher(participant, publisherParam, info->pub_listener_);
+    if (!info->request_publisher_) {
+      RMW_SET_ERROR_MSG("create_client() could not create publisher");
+      goto fail;
+    }
 
-  info->writer_guid_ = info->request_publisher_->getGuid();
+    info->writer_guid_ = info->request_publisher_->getGuid();
+  }
 
-  rmw_client = rmw_client_allocate();
+  rmw_client = static_cast<rmw_client_t *>(
+    rmw_fastrtps_shared_cpp::handle_pool_allocate(sizeof(rmw_client_t)));
   if (!rmw_client) {
     RMW_SET_ERROR_MSG("failed to allocate memory for client");
     goto fail;
@@ -201,13 +224,11 @@ rmw_create_client(
 
   rmw_client->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_client->data = info;
-  rmw_client->service_name = reinterpret_cast<const char *>(
-    rmw_allocate(strlen(service_name) + 1));
+  rmw_client->service_name = rmw_fastrtps_shared_cpp::handle_pool_copy_string(service_name);
   if (!rmw_client->service_name) {
     RMW_SET_ERROR_MSG("failed to allocate memory for client name");
     goto fail;
   }
-  memcpy(const_cast<char *>(rmw_client->service_name), service_name, strlen(service_name) + 1);
 
   {
     // Update graph
@@ -224,11 +245,8 @@ rmw_create_client(
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.associate_reader(
       gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      eprosima_fastrtps_identifier,
-      common_context->pub,
-      static_cast<void *>(&msg),
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      eprosima_fastrtps_identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       goto fail;
     }
@@ -288,10 +306,10 @@ fail:
 
   if (nullptr != rmw_client) {
     if (rmw_client->service_name != nullptr) {
-      rmw_free(const_cast<char *>(rmw_client->service_name));
+      rmw_fastrtps_shared_cpp::handle_pool_release(const_cast<char *>(rmw_client->service_name));
       rmw_client->service_name = nullptr;
     }
-    rmw_client_free(rmw_client);
+    rmw_fastrtps_shared_cpp::handle_pool_release(rmw_client);
   }
 
   return nullptr;
@@ -12,7 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 #include "fastcdr/FastBuffer.h"
+#include "fastcdr/exceptions/NotEnoughMemoryException.h"
 
 #include "rmw/error_handling.h"
 #include "rmw/serialized_message.h"
@@ -20,6 +26,30 @@
 
 #include "./type_support_common.hpp"
 
+namespace
+{
+
+// Constructed type supports cached per callbacks instance, in the spirit of
+// the registry rmw_fastrtps_dynamic_cpp uses. The callbacks live for the
+// lifetime of the process, so entries are never evicted, and the cached
+// objects hold no per-call state, so they can be shared between threads.
+MessageTypeSupport_cpp *
+_get_cached_type_support(const message_type_support_callbacks_t * callbacks)
+{
+  static std::mutex cache_mutex;
+  static std::unordered_map<const message_type_support_callbacks_t *,
+    std::unique_ptr<MessageTypeSupport_cpp>> cache;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto & entry = cache[callbacks];
+  if (!entry) {
+    entry.reset(new MessageTypeSupport_cpp(callbacks));
+  }
+  return entry.get();
+}
+
+}  // namespace
+
 extern "C"
 {
 rmw_ret_t
@@ -28,19 +58,38 @@ rmw_serialize(
   const rosidl_message_type_support_t * type_support,
   rmw_serialized_message_t * serialized_message)
 {
-  const rosidl_message_type_support_t * ts = get_message_typesupport_handle(
-    type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  const rosidl_message_type_support_t * ts = _resolve_message_typesupport(type_support);
   if (!ts) {
-    ts = get_message_typesupport_handle(
-      type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
-    if (!ts) {
-      RMW_SET_ERROR_MSG("type support not from this implementation");
-      return RMW_RET_ERROR;
-    }
+    RMW_SET_ERROR_MSG("type support not from this implementation");
+    return RMW_RET_ERROR;
   }
 
   auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
-  auto tss = new MessageTypeSupport_cpp(callbacks);
+  auto tss = _get_cached_type_support(callbacks);
+
+  // One pass when the message fits: serialize straight into the existing
+  // capacity and only fall back to the sizing walk below when the buffer
+  // overflows. A reused serialized message keeps its capacity across calls,
+  // so a steady stream of messages pays the estimate traversal at most once
+  // per size step instead of once per message.
+  if (serialized_message->buffer_capacity > 0) {
+    eprosima::fastcdr::FastBuffer buffer(
+      reinterpret_cast<char *>(serialized_message->buffer),
+      serialized_message->buffer_capacity);
+    eprosima::fastcdr::Cdr ser(
+      buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    try {
+      if (!tss->serializeROSmessage(ros_message, ser, callbacks)) {
+        return RMW_RET_ERROR;
+      }
+      serialized_message->buffer_length = ser.getSerializedDataLength();
+      return RMW_RET_OK;
+    } catch (const eprosima::fastcdr::exception::NotEnoughMemoryException &) {
+      // Did not fit; size it exactly and serialize again.
+    }
+  }
+
   auto data_length = tss->getEstimatedSerializedSize(ros_message, callbacks);
   if (serialized_message->buffer_capacity < data_length) {
     if (rmw_serialized_message_resize(serialized_message, data_length) != RMW_RET_OK) {
@@ -52,12 +101,12 @@ rmw_serialize(
   eprosima::fastcdr::FastBuffer buffer(
     reinterpret_cast<char *>(serialized_message->buffer), data_length);
   eprosima::fastcdr::Cdr ser(
-    buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN, eprosima::fastcdr::Cdr::DDS_CDR);
+    buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+    eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->serializeROSmessage(ros_message, ser, callbacks);
   serialized_message->buffer_length = data_length;
   serialized_message->buffer_capacity = data_length;
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
@@ -67,26 +116,20 @@ rmw_deserialize(
   const rosidl_message_type_support_t * type_support,
   void * ros_message)
 {
-  const rosidl_message_type_support_t * ts = get_message_typesupport_handle(
-    type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  const rosidl_message_type_support_t * ts = _resolve_message_typesupport(type_support);
   if (!ts) {
-    ts = get_message_typesupport_handle(
-      type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
-    if (!ts) {
-      RMW_SET_ERROR_MSG("type support not from this implementation");
-      return RMW_RET_ERROR;
-    }
+    RMW_SET_ERROR_MSG("type support not from this implementation");
+    return RMW_RET_ERROR;
   }
 
   auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
-  auto tss = new MessageTypeSupport_cpp(callbacks);
+  auto tss = _get_cached_type_support(callbacks);
   eprosima::fastcdr::FastBuffer buffer(
     reinterpret_cast<char *>(serialized_message->buffer), serialized_message->buffer_length);
   eprosima::fastcdr::Cdr deser(buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
     eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->deserializeROSmessage(deser, ros_message, callbacks);
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
@@ -30,8 +30,10 @@
 #include "rmw/allocators.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
@@ -89,15 +91,11 @@ rmw_create_service(
     return nullptr;
   }
 
-  const rosidl_service_type_support_t * type_support = get_service_typesupport_handle(
-    type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  const rosidl_service_type_support_t * type_support =
+    _resolve_service_typesupport(type_supports);
   if (!type_support) {
-    type_support = get_service_typesupport_handle(
-      type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
-    if (!type_support) {
-      RMW_SET_ERROR_MSG("type support not from this implementation");
-      return nullptr;
-    }
+    RMW_SET_ERROR_MSG("type support not from this implementation");
+    return nullptr;
   }
 
   CustomServiceInfo * info = nullptr;
@@ -125,22 +123,30 @@ rmw_create_service(
   std::string request_type_name = _create_type_name(request_members);
   std::string response_type_name = _create_type_name(response_members);
 
-  if (
-    !Domain::getRegisteredType(
-      participant, request_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
-  {
-    info->request_type_support_ = new RequestTypeSupport_cpp(service_members);
-    _register_type(participant, info->request_type_support_);
+  info->request_type_support_ = impl->find_registered_type(participant, request_type_name);
+  if (!info->request_type_support_) {
+    if (
+      !Domain::getRegisteredType(
+        participant, request_type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
+    {
+      info->request_type_support_ = new RequestTypeSupport_cpp(service_members);
+      _register_type(participant, info->request_type_support_);
+    }
+    impl->record_registered_type(participant, request_type_name, info->request_type_support_);
   }
 
-  if (
-    !Domain::getRegisteredType(
-      participant, response_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
-  {
-    info->response_type_support_ = new ResponseTypeSupport_cpp(service_members);
-    _register_type(participant, info->response_type_support_);
+  info->response_type_support_ = impl->find_registered_type(participant, response_type_name);
+  if (!info->response_type_support_) {
+    if (
+      !Domain::getRegisteredType(
+        participant, response_type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
+    {
+      info->response_type_support_ = new ResponseTypeSupport_cpp(service_members);
+      _register_type(participant, info->response_type_support_);
+    }
+    impl->record_registered_type(participant, response_type_name, info->response_type_support_);
   }
 
   if (!impl->leave_middleware_default_qos) {
@@ -199,20 +205,19 @@ rmw_create_service(
     goto fail;
   }
 
-  rmw_service = rmw_service_allocate();
+  rmw_service = static_cast<rmw_service_t *>(
+    rmw_fastrtps_shared_cpp::handle_pool_allocate(sizeof(rmw_service_t)));
   if (!rmw_service) {
     RMW_SET_ERROR_MSG("failed to allocate memory for service");
     goto fail;
   }
   rmw_service->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_service->data = info;
-  rmw_service->service_name = reinterpret_cast<const char *>(
-    rmw_allocate(strlen(service_name) + 1));
+  rmw_service->service_name = rmw_fastrtps_shared_cpp::handle_pool_copy_string(service_name);
   if (!rmw_service->service_name) {
     RMW_SET_ERROR_MSG("failed to allocate memory for service name");
     goto fail;
   }
-  memcpy(const_cast<char *>(rmw_service->service_name), service_name, strlen(service_name) + 1);
 
   {
     // Update graph
@@ -229,11 +234,8 @@ rmw_create_service(
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.associate_writer(
       gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      eprosima_fastrtps_identifier,
-      common_context->pub,
-      static_cast<void *>(&msg),
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      eprosima_fastrtps_identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       goto fail;
     }
@@ -282,10 +284,10 @@ fail:
   }
 
   if (rmw_service && rmw_service->service_name) {
-    rmw_free(const_cast<char *>(rmw_service->service_name));
+    rmw_fastrtps_shared_cpp::handle_pool_release(const_cast<char *>(rmw_service->service_name));
     rmw_service->service_name = nullptr;
   }
-  rmw_service_free(rmw_service);
+  rmw_fastrtps_shared_cpp::handle_pool_release(rmw_service);
 
   return nullptr;
 }
@@ -22,12 +22,15 @@
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/endpoint_options.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/topic_mux.hpp"
 
 #include "fastrtps/participant/Participant.h"
 #include "fastrtps/subscriber/Subscriber.h"
@@ -71,20 +74,24 @@ create_subscription(
     RMW_SET_ERROR_MSG("participant_info is null");
     return nullptr;
   }
-  Participant * participant = participant_info->participant;
+  // A multiplexed subscription keeps its own reader, but places it on the
+  // shared channel topic (see EndpointOptions::mux_channel and
+  // topic_mux.hpp); its content filter narrows the channel down to the
+  // logical stream.
+  const char * mux_channel = rmw_fastrtps_shared_cpp::endpoint_mux_channel(
+    subscription_options->rmw_specific_subscription_payload);
+  std::string dds_topic_name = _create_topic_name(
+    qos_policies, ros_topic_prefix, nullptr != mux_channel ? mux_channel : topic_name);
+  Participant * participant = participant_info->participant_for_topic(dds_topic_name);
   if (!participant) {
     RMW_SET_ERROR_MSG("participant handle is null");
     return nullptr;
   }
-  const rosidl_message_type_support_t * type_support = get_message_typesupport_handle(
-    type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  const rosidl_message_type_support_t * type_support =
+    _resolve_message_typesupport(type_supports);
   if (!type_support) {
-    type_support = get_message_typesupport_handle(
-      type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
-    if (!type_support) {
-      RMW_SET_ERROR_MSG("type support not from this implementation");
-      return nullptr;
-    }
+    RMW_SET_ERROR_MSG("type support not from this implementation");
+    return nullptr;
   }
   if (!is_valid_qos(*qos_policies)) {
     return nullptr;
@@ -102,35 +109,56 @@ create_subscription(
   }
   info->typesupport_identifier_ = type_support->typesupport_identifier;
   info->type_support_impl_ = type_support->data;
+  info->participant_ = participant;
 
   auto callbacks = static_cast<const message_type_support_callbacks_t *>(type_support->data);
   std::string type_name = _create_type_name(callbacks);
-  if (
-    !Domain::getRegisteredType(
-      participant, type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->type_support_)))
-  {
-    info->type_support_ = new (std::nothrow) MessageTypeSupport_cpp(callbacks);
-    if (!info->type_support_) {
-      RMW_SET_ERROR_MSG("failed to allocate MessageTypeSupport_cpp");
-      goto fail;
+  info->type_support_ = participant_info->find_registered_type(participant, type_name);
+  if (!info->type_support_) {
+    if (
+      !Domain::getRegisteredType(
+        participant, type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->type_support_)))
+    {
+      info->type_support_ = new (std::nothrow) MessageTypeSupport_cpp(callbacks);
+      if (!info->type_support_) {
+        RMW_SET_ERROR_MSG("failed to allocate MessageTypeSupport_cpp");
+        goto fail;
+      }
+      _register_type(participant, info->type_support_);
     }
-    _register_type(participant, info->type_support_);
+    participant_info->record_registered_type(participant, type_name, info->type_support_);
   }
   if (!participant_info->leave_middleware_default_qos) {
     subscriberParam.historyMemoryPolicy =
       eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
   }
 
+  // Explicit per-endpoint memory options override both of the above.
+  rmw_fastrtps_shared_cpp::apply_endpoint_memory_options(
+    subscription_options->rmw_specific_subscription_payload,
+    subscriberParam.historyMemoryPolicy,
+    info->type_support_);
+
   subscriberParam.topic.topicKind =
     keyed ? eprosima::fastrtps::rtps::WITH_KEY : eprosima::fastrtps::rtps::NO_KEY;
+  rmw_fastrtps_shared_cpp::apply_endpoint_key_options(
+    subscription_options->rmw_specific_subscription_payload,
+    subscriberParam.topic.topicKind,
+    info->type_support_);
   subscriberParam.topic.topicDataType = type_name;
-  subscriberParam.topic.topicName = _create_topic_name(qos_policies, ros_topic_prefix, topic_name);
+  subscriberParam.topic.topicName = dds_topic_name;
 
   if (!get_datareader_qos(*qos_policies, subscriberParam)) {
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
+  rmw_fastrtps_shared_cpp::apply_subscription_reliability_timing_options(
+    subscription_options->rmw_specific_subscription_payload,
+    subscriberParam);
+  rmw_fastrtps_shared_cpp::apply_endpoint_partition_options(
+    subscription_options->rmw_specific_subscription_payload,
+    subscriberParam.qos.m_partition);
   info->listener_ = nullptr;
   if (create_subscription_listener) {
     info->listener_ = new (std::nothrow) SubListener(info);
@@ -146,20 +174,28 @@ create_subscription(
   }
   info->subscription_gid_ = rmw_fastrtps_shared_cpp::create_rmw_gid(
     eprosima_fastrtps_identifier, info->subscriber_->getGuid());
-  rmw_subscription = rmw_subscription_allocate();
+  rmw_subscription = static_cast<rmw_subscription_t *>(
+    rmw_fastrtps_shared_cpp::handle_pool_allocate(sizeof(rmw_subscription_t)));
   if (!rmw_subscription) {
     RMW_SET_ERROR_MSG("failed to allocate subscription");
     goto fail;
   }
   rmw_subscription->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_subscription->data = info;
-  rmw_subscription->topic_name = rcutils_strdup(topic_name, rcutils_get_default_allocator());
+  rmw_subscription->topic_name = rmw_fastrtps_shared_cpp::handle_pool_copy_string(topic_name);
   if (!rmw_subscription->topic_name) {
     RMW_SET_ERROR_MSG("failed to allocate memory for subscription topic name");
     goto fail;
   }
 
   rmw_subscription->options = *subscription_options;
+  rmw_subscription->can_loan_messages = false;
+
+  if (nullptr != mux_channel) {
+    // Keep the logical topic visible to local graph queries, which only
+    // discover the channel.
+    rmw_fastrtps_shared_cpp::mux_register_logical_topic(rmw_subscription, topic_name, type_name);
+  }
   return rmw_subscription;
 
 fail:
@@ -168,7 +204,7 @@ fail:
     delete info->listener_;
     delete info;
   }
-  rmw_subscription_free(rmw_subscription);
+  rmw_fastrtps_shared_cpp::handle_pool_release(rmw_subscription);
   return nullptr;
 }
 }  // namespace rmw_fastrtps_cpp
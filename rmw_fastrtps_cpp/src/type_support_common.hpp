@@ -15,8 +15,10 @@
 #ifndef TYPE_SUPPORT_COMMON_HPP_
 #define TYPE_SUPPORT_COMMON_HPP_
 
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include "fastrtps/Domain.h"
 #include "fastrtps/participant/Participant.h"
@@ -24,6 +26,7 @@
 #include "rmw/error_handling.h"
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/type_name_compaction.hpp"
 
 #include "rmw_fastrtps_cpp/MessageTypeSupport.hpp"
 #include "rmw_fastrtps_cpp/ServiceTypeSupport.hpp"
@@ -51,14 +54,90 @@ _create_type_name(
     return "";
   }
 
-  std::ostringstream ss;
-  std::string message_namespace(members->message_namespace_);
-  std::string message_name(members->message_name_);
-  if (!message_namespace.empty()) {
-    ss << message_namespace << "::";
+  // Entity creation asks for the same few names over and over (clients and
+  // services twice each), so intern the result per callbacks struct instead
+  // of rebuilding it through an ostringstream every time.
+  static std::mutex cache_mutex;
+  static std::unordered_map<const message_type_support_callbacks_t *, std::string> cache;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  std::string & name = cache[members];
+  if (name.empty()) {
+    std::ostringstream ss;
+    std::string message_namespace(members->message_namespace_);
+    std::string message_name(members->message_name_);
+    if (!message_namespace.empty()) {
+      ss << message_namespace << "::";
+    }
+    ss << "dds_::" << message_name << "_";
+    // Compact mode announces a hash of the mangled name; see
+    // type_name_compaction.hpp. A no-op unless opted in.
+    name = rmw_fastrtps_shared_cpp::compact_type_name(ss.str());
+  }
+  return name;
+}
+
+/// Resolve the fastrtps message type support behind an rmw handle, cached.
+/**
+ * Resolution probes the C identifier and then the C++ one, a pair of
+ * identifier string comparisons per call. The handles are static
+ * process-lifetime objects and resolution is deterministic per handle, so
+ * the result is interned per input pointer the same way _create_type_name
+ * interns its names; serialize-heavy callers then pay one map lookup
+ * instead of the double probe. Failed resolutions are not cached - they
+ * set an error and never recur on a hot path.
+ */
+inline const rosidl_message_type_support_t *
+_resolve_message_typesupport(const rosidl_message_type_support_t * type_supports)
+{
+  static std::mutex cache_mutex;
+  static std::unordered_map<const rosidl_message_type_support_t *,
+    const rosidl_message_type_support_t *> cache;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(type_supports);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+  const rosidl_message_type_support_t * resolved = get_message_typesupport_handle(
+    type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  if (!resolved) {
+    resolved = get_message_typesupport_handle(
+      type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
+  }
+  if (resolved) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.emplace(type_supports, resolved);
+  }
+  return resolved;
+}
+
+/// The service counterpart of _resolve_message_typesupport.
+inline const rosidl_service_type_support_t *
+_resolve_service_typesupport(const rosidl_service_type_support_t * type_supports)
+{
+  static std::mutex cache_mutex;
+  static std::unordered_map<const rosidl_service_type_support_t *,
+    const rosidl_service_type_support_t *> cache;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(type_supports);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+  const rosidl_service_type_support_t * resolved = get_service_typesupport_handle(
+    type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  if (!resolved) {
+    resolved = get_service_typesupport_handle(
+      type_supports, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
+  }
+  if (resolved) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.emplace(type_supports, resolved);
   }
-  ss << "dds_::" << message_name << "_";
-  return ss.str();
+  return resolved;
 }
 
 inline void
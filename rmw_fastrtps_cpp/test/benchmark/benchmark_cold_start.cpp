@@ -0,0 +1,192 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "rcutils/allocator.h"
+#include "rcutils/strdup.h"
+
+#include "rmw/rmw.h"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+// Cold-start benchmark: the full path from rmw_init to the first message
+// delivered across two fresh contexts, broken down per phase. Each phase
+// lands in its own counter - context init (participant creation included),
+// node creation, endpoint creation, discovery match, and first publish to
+// first successful take - so a regression in time-to-operational can be
+// attributed to the phase that grew instead of being one opaque number.
+// Two contexts mean two participants, so the match phase goes through real
+// PDP/EDP traffic, the same as a process pair after a power cycle.
+
+namespace
+{
+
+constexpr const char * const kTopic = "benchmark_cold_start_topic";
+
+const rosidl_message_type_support_t *
+message_type_support()
+{
+  return rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::BasicTypes>();
+}
+
+struct Side
+{
+  rmw_init_options_t init_options;
+  rmw_context_t context;
+  rmw_node_t * node{nullptr};
+};
+
+void
+init_side(Side & side, const char * node_name)
+{
+  side.init_options = rmw_get_zero_initialized_init_options();
+  if (RMW_RET_OK != rmw_init_options_init(&side.init_options, rcutils_get_default_allocator())) {
+    throw std::runtime_error("failed to init options");
+  }
+  side.init_options.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+  side.context = rmw_get_zero_initialized_context();
+  if (RMW_RET_OK != rmw_init(&side.init_options, &side.context)) {
+    throw std::runtime_error("failed to init context");
+  }
+  side.node = rmw_create_node(&side.context, node_name, "/", 0, false);
+  if (!side.node) {
+    throw std::runtime_error("failed to create node");
+  }
+}
+
+void
+fini_side(Side & side)
+{
+  rmw_destroy_node(side.node);
+  rmw_shutdown(&side.context);
+  rmw_context_fini(&side.context);
+  rmw_init_options_fini(&side.init_options);
+}
+
+double
+ms_since(std::chrono::steady_clock::time_point & mark)
+{
+  const auto now = std::chrono::steady_clock::now();
+  const double ms = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
+    now - mark).count();
+  mark = now;
+  return ms;
+}
+
+// One iteration is one complete cold start. Manual time covers rmw_init
+// through the first delivered message; teardown runs outside the measured
+// span, since a power-cycled process does not pay the previous shutdown.
+void cold_start_to_first_message(benchmark::State & st)
+{
+  double init_ms = 0.0;
+  double entities_ms = 0.0;
+  double match_ms = 0.0;
+  double first_message_ms = 0.0;
+
+  for (auto _ : st) {
+    (void)_;
+    Side pub_side;
+    Side sub_side;
+    auto mark = std::chrono::steady_clock::now();
+    const auto start = mark;
+
+    // rmw_init + context impl init + create_participant + node, both ends.
+    init_side(pub_side, "benchmark_cold_start_pub");
+    init_side(sub_side, "benchmark_cold_start_sub");
+    init_ms += ms_since(mark);
+
+    rmw_publisher_options_t publisher_options = rmw_get_default_publisher_options();
+    rmw_publisher_t * publisher = rmw_create_publisher(
+      pub_side.node, message_type_support(), kTopic, &rmw_qos_profile_default,
+      &publisher_options);
+    rmw_subscription_options_t subscription_options = rmw_get_default_subscription_options();
+    rmw_subscription_t * subscription = rmw_create_subscription(
+      sub_side.node, message_type_support(), kTopic, &rmw_qos_profile_default,
+      &subscription_options);
+    if (!publisher || !subscription) {
+      st.SkipWithError("failed to create endpoints");
+      return;
+    }
+    entities_ms += ms_since(mark);
+
+    // Discovery: the writer learning about the reader is what gates the
+    // first reliable delivery.
+    const auto match_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    size_t matched = 0;
+    while (matched == 0) {
+      if (RMW_RET_OK != rmw_publisher_count_matched_subscriptions(publisher, &matched)) {
+        st.SkipWithError("failed to count matched subscriptions");
+        return;
+      }
+      if (std::chrono::steady_clock::now() > match_deadline) {
+        st.SkipWithError("endpoints did not match");
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    match_ms += ms_since(mark);
+
+    // First delivery. One publish after the match suffices with reliable
+    // QoS; the poll sees exactly the transport and take-path latency.
+    test_msgs::msg::BasicTypes message;
+    test_msgs::msg::BasicTypes taken_message;
+    if (RMW_RET_OK != rmw_publish(publisher, &message, nullptr)) {
+      st.SkipWithError("failed to publish");
+      return;
+    }
+    const auto take_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    bool taken = false;
+    while (!taken) {
+      if (RMW_RET_OK != rmw_take(subscription, &taken_message, &taken, nullptr)) {
+        st.SkipWithError("failed to take");
+        return;
+      }
+      if (std::chrono::steady_clock::now() > take_deadline) {
+        st.SkipWithError("message was not delivered");
+        return;
+      }
+    }
+    first_message_ms += ms_since(mark);
+
+    st.SetIterationTime(
+      std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now() - start).count());
+
+    rmw_destroy_subscription(sub_side.node, subscription);
+    rmw_destroy_publisher(pub_side.node, publisher);
+    fini_side(sub_side);
+    fini_side(pub_side);
+  }
+
+  st.counters["init_ms"] = benchmark::Counter(init_ms, benchmark::Counter::kAvgIterations);
+  st.counters["entities_ms"] = benchmark::Counter(entities_ms, benchmark::Counter::kAvgIterations);
+  st.counters["match_ms"] = benchmark::Counter(match_ms, benchmark::Counter::kAvgIterations);
+  st.counters["first_message_ms"] =
+    benchmark::Counter(first_message_ms, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(cold_start_to_first_message)
+->Unit(benchmark::kMillisecond)
+->UseManualTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,211 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcutils/allocator.h"
+#include "rcutils/strdup.h"
+
+#include "rmw/rmw.h"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+// Discovery scaling benchmarks: N participants each announcing M endpoints,
+// observed from a separate participant. Every context creates its own
+// participant, so the observer converges through real PDP/EDP traffic, the
+// ParticipantListener callbacks and the graph cache - the same path a robot
+// fleet exercises on startup. Convergence regressions that today only show
+// up on large sites surface here as a time-per-iteration jump.
+
+namespace
+{
+
+constexpr const char * const kTopic = "benchmark_discovery_topic";
+
+const rosidl_message_type_support_t *
+message_type_support()
+{
+  return rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::BasicTypes>();
+}
+
+// One context with its own participant, one node and M publishers.
+class Peer
+{
+public:
+  Peer(int64_t index, int64_t endpoint_count)
+  {
+    init_options_ = rmw_get_zero_initialized_init_options();
+    if (RMW_RET_OK != rmw_init_options_init(&init_options_, rcutils_get_default_allocator())) {
+      throw std::runtime_error("failed to init options");
+    }
+    init_options_.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+    context_ = rmw_get_zero_initialized_context();
+    if (RMW_RET_OK != rmw_init(&init_options_, &context_)) {
+      throw std::runtime_error("failed to init context");
+    }
+    std::string node_name = "benchmark_discovery_peer_" + std::to_string(index);
+    node_ = rmw_create_node(&context_, node_name.c_str(), "/", 0, false);
+    if (!node_) {
+      throw std::runtime_error("failed to create node");
+    }
+    rmw_publisher_options_t options = rmw_get_default_publisher_options();
+    for (int64_t i = 0; i < endpoint_count; ++i) {
+      rmw_publisher_t * publisher = rmw_create_publisher(
+        node_, message_type_support(), kTopic, &rmw_qos_profile_default, &options);
+      if (!publisher) {
+        throw std::runtime_error("failed to create publisher");
+      }
+      publishers_.push_back(publisher);
+    }
+  }
+
+  ~Peer()
+  {
+    for (rmw_publisher_t * publisher : publishers_) {
+      rmw_destroy_publisher(node_, publisher);
+    }
+    rmw_destroy_node(node_);
+    rmw_shutdown(&context_);
+    rmw_context_fini(&context_);
+    rmw_init_options_fini(&init_options_);
+  }
+
+private:
+  rmw_init_options_t init_options_;
+  rmw_context_t context_;
+  rmw_node_t * node_{nullptr};
+  std::vector<rmw_publisher_t *> publishers_;
+};
+
+class DiscoveryBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const benchmark::State &) override
+  {
+    init_options_ = rmw_get_zero_initialized_init_options();
+    if (RMW_RET_OK != rmw_init_options_init(&init_options_, rcutils_get_default_allocator())) {
+      throw std::runtime_error("failed to init options");
+    }
+    init_options_.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+    context_ = rmw_get_zero_initialized_context();
+    if (RMW_RET_OK != rmw_init(&init_options_, &context_)) {
+      throw std::runtime_error("failed to init context");
+    }
+    node_ = rmw_create_node(&context_, "benchmark_discovery_observer", "/", 0, false);
+    if (!node_) {
+      throw std::runtime_error("failed to create node");
+    }
+  }
+
+  void TearDown(const benchmark::State &) override
+  {
+    rmw_destroy_node(node_);
+    rmw_shutdown(&context_);
+    rmw_context_fini(&context_);
+    rmw_init_options_fini(&init_options_);
+  }
+
+protected:
+  // Poll the observer's graph cache until it reports the expected number of
+  // publishers on the benchmark topic, i.e. until EDP converged.
+  void wait_for_publisher_count(size_t expected, benchmark::State & st)
+  {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    size_t count = 0;
+    while (count != expected) {
+      if (RMW_RET_OK != rmw_count_publishers(node_, kTopic, &count)) {
+        st.SkipWithError("failed to count publishers");
+        return;
+      }
+      if (std::chrono::steady_clock::now() > deadline) {
+        st.SkipWithError("graph did not converge");
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  rmw_init_options_t init_options_;
+  rmw_context_t context_;
+  rmw_node_t * node_{nullptr};
+};
+
+// Time to a converged graph: spin up N participants with M publishers each
+// and wait until the observer's graph cache accounts for all of them. The
+// teardown (and the observer seeing it) is timed too, matching what a site
+// restart pays; per-iteration time is dominated by the discovery exchange,
+// not the local allocations.
+BENCHMARK_DEFINE_F(DiscoveryBenchmark, time_to_converged_graph)(benchmark::State & st)
+{
+  const int64_t participants = st.range(0);
+  const int64_t endpoints = st.range(1);
+  for (auto _ : st) {
+    (void)_;
+    {
+      std::vector<std::unique_ptr<Peer>> peers;
+      for (int64_t i = 0; i < participants; ++i) {
+        peers.emplace_back(new Peer(i, endpoints));
+      }
+      wait_for_publisher_count(static_cast<size_t>(participants * endpoints), st);
+    }
+    wait_for_publisher_count(0u, st);
+  }
+}
+
+// Graph query cost on a converged graph of N x M remote endpoints; isolates
+// the graph cache read path the tools and executors hit, with discovery
+// traffic quiesced.
+BENCHMARK_DEFINE_F(DiscoveryBenchmark, converged_graph_query)(benchmark::State & st)
+{
+  const int64_t participants = st.range(0);
+  const int64_t endpoints = st.range(1);
+  std::vector<std::unique_ptr<Peer>> peers;
+  for (int64_t i = 0; i < participants; ++i) {
+    peers.emplace_back(new Peer(i, endpoints));
+  }
+  wait_for_publisher_count(static_cast<size_t>(participants * endpoints), st);
+
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  for (auto _ : st) {
+    (void)_;
+    rmw_names_and_types_t names_and_types = rmw_get_zero_initialized_names_and_types();
+    if (RMW_RET_OK != rmw_get_topic_names_and_types(
+        node_, &allocator, false, &names_and_types))
+    {
+      st.SkipWithError("failed to query topic names and types");
+      break;
+    }
+    benchmark::DoNotOptimize(names_and_types.names.size);
+    rmw_names_and_types_fini(&names_and_types);
+  }
+}
+
+BENCHMARK_REGISTER_F(DiscoveryBenchmark, time_to_converged_graph)
+->Unit(benchmark::kMillisecond)
+->Args({1, 1})->Args({2, 8})->Args({4, 16});
+BENCHMARK_REGISTER_F(DiscoveryBenchmark, converged_graph_query)
+->Args({1, 1})->Args({2, 8})->Args({4, 16});
+
+}  // namespace
+
+BENCHMARK_MAIN();
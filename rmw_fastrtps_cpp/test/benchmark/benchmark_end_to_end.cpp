@@ -0,0 +1,251 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "rcutils/allocator.h"
+#include "rcutils/strdup.h"
+
+#include "rmw/rmw.h"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+#include "rosidl_typesupport_cpp/service_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/srv/basic_types.hpp"
+
+// End-to-end benchmarks through the public rmw API with a loopback
+// participant: message serialization, publish, publish + take, and a full
+// service round trip. Run with --benchmark_format=json (or the JSON result
+// file recorded by the CTest integration) to diff numbers across releases.
+
+namespace
+{
+
+class EndToEndBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const benchmark::State &) override
+  {
+    init_options_ = rmw_get_zero_initialized_init_options();
+    if (RMW_RET_OK != rmw_init_options_init(&init_options_, rcutils_get_default_allocator())) {
+      throw std::runtime_error("failed to init options");
+    }
+    init_options_.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+    context_ = rmw_get_zero_initialized_context();
+    if (RMW_RET_OK != rmw_init(&init_options_, &context_)) {
+      throw std::runtime_error("failed to init context");
+    }
+    node_ = rmw_create_node(&context_, "benchmark_node", "/", 0, false);
+    if (!node_) {
+      throw std::runtime_error("failed to create node");
+    }
+  }
+
+  void TearDown(const benchmark::State &) override
+  {
+    rmw_destroy_node(node_);
+    rmw_shutdown(&context_);
+    rmw_context_fini(&context_);
+    rmw_init_options_fini(&init_options_);
+  }
+
+protected:
+  static const rosidl_message_type_support_t * message_type_support()
+  {
+    return rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::BasicTypes>();
+  }
+
+  rmw_publisher_t * create_publisher(const char * topic)
+  {
+    rmw_publisher_options_t options = rmw_get_default_publisher_options();
+    rmw_publisher_t * publisher = rmw_create_publisher(
+      node_, message_type_support(), topic, &rmw_qos_profile_default, &options);
+    if (!publisher) {
+      throw std::runtime_error("failed to create publisher");
+    }
+    return publisher;
+  }
+
+  rmw_subscription_t * create_subscription(const char * topic)
+  {
+    rmw_subscription_options_t options = rmw_get_default_subscription_options();
+    rmw_subscription_t * subscription = rmw_create_subscription(
+      node_, message_type_support(), topic, &rmw_qos_profile_default, &options);
+    if (!subscription) {
+      throw std::runtime_error("failed to create subscription");
+    }
+    return subscription;
+  }
+
+  void wait_for_match(rmw_publisher_t * publisher)
+  {
+    size_t count = 0;
+    while (count == 0) {
+      if (RMW_RET_OK != rmw_publisher_count_matched_subscriptions(publisher, &count)) {
+        throw std::runtime_error("failed to count matched subscriptions");
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  rmw_init_options_t init_options_;
+  rmw_context_t context_;
+  rmw_node_t * node_{nullptr};
+};
+
+// Serialization alone: the cost __rmw_publish pays before handing the
+// payload to the transport.
+BENCHMARK_DEFINE_F(EndToEndBenchmark, serialize_basic_types)(benchmark::State & st)
+{
+  test_msgs::msg::BasicTypes message;
+  message.int64_value = 42;
+  rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+  if (RMW_RET_OK != rmw_serialized_message_init(
+      &serialized, 0u, &rcutils_get_default_allocator()))
+  {
+    st.SkipWithError("failed to init serialized message");
+    return;
+  }
+  for (auto _ : st) {
+    (void)_;
+    if (RMW_RET_OK != rmw_serialize(&message, message_type_support(), &serialized)) {
+      st.SkipWithError("rmw_serialize failed");
+      break;
+    }
+  }
+  rmw_serialized_message_fini(&serialized);
+}
+
+// Publish with a matched local subscription that never takes: the writer-side
+// hot path including serialization and the history update.
+BENCHMARK_DEFINE_F(EndToEndBenchmark, publish_basic_types)(benchmark::State & st)
+{
+  rmw_publisher_t * publisher = create_publisher("/benchmark_publish");
+  rmw_subscription_t * subscription = create_subscription("/benchmark_publish");
+  wait_for_match(publisher);
+
+  test_msgs::msg::BasicTypes message;
+  for (auto _ : st) {
+    (void)_;
+    if (RMW_RET_OK != rmw_publish(publisher, &message, nullptr)) {
+      st.SkipWithError("rmw_publish failed");
+      break;
+    }
+  }
+
+  rmw_destroy_subscription(node_, subscription);
+  rmw_destroy_publisher(node_, publisher);
+}
+
+// Publish then take over loopback; covers listener dispatch and the
+// reader-side deserialization in addition to the publish path.
+BENCHMARK_DEFINE_F(EndToEndBenchmark, publish_take_basic_types)(benchmark::State & st)
+{
+  rmw_publisher_t * publisher = create_publisher("/benchmark_take");
+  rmw_subscription_t * subscription = create_subscription("/benchmark_take");
+  wait_for_match(publisher);
+
+  test_msgs::msg::BasicTypes message;
+  test_msgs::msg::BasicTypes taken_message;
+  for (auto _ : st) {
+    (void)_;
+    if (RMW_RET_OK != rmw_publish(publisher, &message, nullptr)) {
+      st.SkipWithError("rmw_publish failed");
+      break;
+    }
+    bool taken = false;
+    while (!taken) {
+      if (RMW_RET_OK != rmw_take(subscription, &taken_message, &taken, nullptr)) {
+        st.SkipWithError("rmw_take failed");
+        return;
+      }
+    }
+  }
+
+  rmw_destroy_subscription(node_, subscription);
+  rmw_destroy_publisher(node_, publisher);
+}
+
+// Full service round trip: send request, take request, send response,
+// take response, all over loopback.
+BENCHMARK_DEFINE_F(EndToEndBenchmark, service_round_trip)(benchmark::State & st)
+{
+  const rosidl_service_type_support_t * type_support =
+    rosidl_typesupport_cpp::get_service_type_support_handle<test_msgs::srv::BasicTypes>();
+  rmw_service_t * service = rmw_create_service(
+    node_, type_support, "benchmark_service", &rmw_qos_profile_services_default);
+  rmw_client_t * client = rmw_create_client(
+    node_, type_support, "benchmark_service", &rmw_qos_profile_services_default);
+  if (!service || !client) {
+    st.SkipWithError("failed to create service or client");
+    return;
+  }
+  bool available = false;
+  while (!available) {
+    if (RMW_RET_OK != rmw_service_server_is_available(node_, client, &available)) {
+      st.SkipWithError("availability check failed");
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  test_msgs::srv::BasicTypes::Request request;
+  test_msgs::srv::BasicTypes::Request taken_request;
+  test_msgs::srv::BasicTypes::Response response;
+  test_msgs::srv::BasicTypes::Response taken_response;
+  for (auto _ : st) {
+    (void)_;
+    int64_t sequence_id = 0;
+    if (RMW_RET_OK != rmw_send_request(client, &request, &sequence_id)) {
+      st.SkipWithError("rmw_send_request failed");
+      break;
+    }
+    rmw_service_info_t request_header;
+    bool taken = false;
+    while (!taken) {
+      if (RMW_RET_OK != rmw_take_request(service, &request_header, &taken_request, &taken)) {
+        st.SkipWithError("rmw_take_request failed");
+        return;
+      }
+    }
+    if (RMW_RET_OK != rmw_send_response(service, &request_header.request_id, &response)) {
+      st.SkipWithError("rmw_send_response failed");
+      break;
+    }
+    taken = false;
+    while (!taken) {
+      if (RMW_RET_OK != rmw_take_response(client, &request_header, &taken_response, &taken)) {
+        st.SkipWithError("rmw_take_response failed");
+        return;
+      }
+    }
+  }
+
+  rmw_destroy_client(node_, client);
+  rmw_destroy_service(node_, service);
+}
+
+BENCHMARK_REGISTER_F(EndToEndBenchmark, serialize_basic_types);
+BENCHMARK_REGISTER_F(EndToEndBenchmark, publish_basic_types);
+BENCHMARK_REGISTER_F(EndToEndBenchmark, publish_take_basic_types);
+BENCHMARK_REGISTER_F(EndToEndBenchmark, service_round_trip);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,220 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <malloc.h>
+#endif
+
+#include "rcutils/allocator.h"
+#include "rcutils/strdup.h"
+
+#include "rmw/rmw.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+// Memory footprint benchmarks: K nodes x N endpoints through the public rmw
+// API, reporting RSS and heap growth per entity so per-entity middleware
+// overhead is a tracked number instead of a by-hand measurement when sizing
+// compute boards. Time per iteration doubles as the create/destroy cost of
+// the same fleet.
+
+namespace
+{
+
+const rosidl_message_type_support_t *
+message_type_support()
+{
+  return rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::BasicTypes>();
+}
+
+// Resident set size in kilobytes; zero where /proc is unavailable.
+size_t
+read_rss_kb()
+{
+#if defined(__linux__)
+  FILE * status = fopen("/proc/self/status", "r");
+  if (!status) {
+    return 0u;
+  }
+  size_t rss_kb = 0u;
+  char line[256];
+  while (fgets(line, sizeof(line), status)) {
+    if (0 == strncmp(line, "VmRSS:", 6)) {
+      rss_kb = strtoul(line + 6, nullptr, 10);  // NOLINT(runtime/int)
+      break;
+    }
+  }
+  fclose(status);
+  return rss_kb;
+#else
+  return 0u;
+#endif
+}
+
+// Bytes currently handed out by the allocator; zero where unavailable. RSS
+// alone over-counts (it moves in page granularity and never shrinks under
+// most allocators), so the heap view is what per-entity deltas come from.
+size_t
+heap_bytes()
+{
+#if defined(__linux__) && defined(__GLIBC__) && \
+  (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks;
+#else
+  return 0u;
+#endif
+}
+
+class MemoryFootprintBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const benchmark::State &) override
+  {
+    init_options_ = rmw_get_zero_initialized_init_options();
+    if (RMW_RET_OK != rmw_init_options_init(&init_options_, rcutils_get_default_allocator())) {
+      throw std::runtime_error("failed to init options");
+    }
+    init_options_.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+    context_ = rmw_get_zero_initialized_context();
+    if (RMW_RET_OK != rmw_init(&init_options_, &context_)) {
+      throw std::runtime_error("failed to init context");
+    }
+  }
+
+  void TearDown(const benchmark::State &) override
+  {
+    rmw_shutdown(&context_);
+    rmw_context_fini(&context_);
+    rmw_init_options_fini(&init_options_);
+  }
+
+protected:
+  rmw_init_options_t init_options_;
+  rmw_context_t context_;
+};
+
+// RSS and heap growth of K nodes x N publishers + N subscriptions. The
+// per-entity counters divide the measured growth across all endpoints, so
+// they include each entity's share of history, listener and graph cache
+// allocations, not only the info structs; the sizeof counters report the
+// fixed part for reference. Deltas are captured on the first iteration,
+// before allocator reuse across iterations flattens them.
+BENCHMARK_DEFINE_F(MemoryFootprintBenchmark, entity_footprint)(benchmark::State & st)
+{
+  const int64_t node_count = st.range(0);
+  const int64_t endpoints_per_node = st.range(1);
+  const size_t entity_count = static_cast<size_t>(node_count * endpoints_per_node * 2);
+  bool captured = false;
+
+  for (auto _ : st) {
+    (void)_;
+    const size_t rss_before = read_rss_kb();
+    const size_t heap_before = heap_bytes();
+
+    std::vector<rmw_node_t *> nodes;
+    std::vector<rmw_publisher_t *> publishers;
+    std::vector<rmw_subscription_t *> subscriptions;
+    rmw_publisher_options_t publisher_options = rmw_get_default_publisher_options();
+    rmw_subscription_options_t subscription_options = rmw_get_default_subscription_options();
+    for (int64_t i = 0; i < node_count; ++i) {
+      std::string node_name = "benchmark_footprint_node_" + std::to_string(i);
+      rmw_node_t * node = rmw_create_node(&context_, node_name.c_str(), "/", 0, false);
+      if (!node) {
+        st.SkipWithError("failed to create node");
+        return;
+      }
+      nodes.push_back(node);
+      for (int64_t j = 0; j < endpoints_per_node; ++j) {
+        // One topic per endpoint pair, like a per-asset status fleet.
+        std::string topic =
+          "benchmark_footprint_" + std::to_string(i) + "_" + std::to_string(j);
+        rmw_publisher_t * publisher = rmw_create_publisher(
+          node, message_type_support(), topic.c_str(), &rmw_qos_profile_default,
+          &publisher_options);
+        if (!publisher) {
+          st.SkipWithError("failed to create publisher");
+          return;
+        }
+        publishers.push_back(publisher);
+        rmw_subscription_t * subscription = rmw_create_subscription(
+          node, message_type_support(), topic.c_str(), &rmw_qos_profile_default,
+          &subscription_options);
+        if (!subscription) {
+          st.SkipWithError("failed to create subscription");
+          return;
+        }
+        subscriptions.push_back(subscription);
+      }
+    }
+
+    if (!captured) {
+      captured = true;
+      const size_t rss_after = read_rss_kb();
+      const size_t heap_after = heap_bytes();
+      st.counters["rss_total_kb"] = static_cast<double>(rss_after);
+      st.counters["rss_delta_kb"] = static_cast<double>(rss_after - rss_before);
+      st.counters["heap_delta_bytes"] = static_cast<double>(heap_after - heap_before);
+      st.counters["heap_bytes_per_entity"] =
+        static_cast<double>(heap_after - heap_before) / entity_count;
+      st.counters["sizeof_publisher_info"] =
+        static_cast<double>(sizeof(CustomPublisherInfo) + sizeof(PubListener));
+      st.counters["sizeof_subscriber_info"] =
+        static_cast<double>(sizeof(CustomSubscriberInfo) + sizeof(SubListener));
+
+      // Graph cache share: what one full topic query allocates once the
+      // graph holds every local entity, a tracked proxy for cache size.
+      rcutils_allocator_t allocator = rcutils_get_default_allocator();
+      rmw_names_and_types_t names_and_types = rmw_get_zero_initialized_names_and_types();
+      const size_t heap_before_query = heap_bytes();
+      if (RMW_RET_OK == rmw_get_topic_names_and_types(
+          nodes.front(), &allocator, false, &names_and_types))
+      {
+        st.counters["graph_topics"] = static_cast<double>(names_and_types.names.size);
+        st.counters["graph_query_bytes"] =
+          static_cast<double>(heap_bytes() - heap_before_query);
+        rmw_names_and_types_fini(&names_and_types);
+      }
+    }
+
+    for (size_t i = 0; i < publishers.size(); ++i) {
+      rmw_destroy_publisher(nodes[i / endpoints_per_node], publishers[i]);
+      rmw_destroy_subscription(nodes[i / endpoints_per_node], subscriptions[i]);
+    }
+    for (rmw_node_t * node : nodes) {
+      rmw_destroy_node(node);
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(MemoryFootprintBenchmark, entity_footprint)
+->Unit(benchmark::kMillisecond)
+->Args({1, 1})->Args({2, 8})->Args({4, 32});
+
+}  // namespace
+
+BENCHMARK_MAIN();
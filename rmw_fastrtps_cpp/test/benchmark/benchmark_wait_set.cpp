@@ -0,0 +1,247 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcutils/allocator.h"
+#include "rcutils/strdup.h"
+
+#include "rmw/rmw.h"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+// Wait-set scalability benchmarks: rmw_wait cost and wakeup latency versus
+// the number of attached subscriptions and guard conditions. This is the
+// reference measurement for the wait-set internals (attachment caches,
+// readiness scan, scrub loops) and for listener locking regressions as
+// Fast-RTPS versions move underneath.
+
+namespace
+{
+
+const rosidl_message_type_support_t *
+message_type_support()
+{
+  return rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::BasicTypes>();
+}
+
+// One node with N subscriptions and N guard conditions, plus the pristine
+// attachment arrays a wait consumes. rmw_wait scrubs non-ready entries to
+// null, so each wait gets a fresh copy of the arrays.
+class WaitSetFixture : public benchmark::Fixture
+{
+public:
+  void SetUp(const benchmark::State &) override
+  {
+    init_options_ = rmw_get_zero_initialized_init_options();
+    if (RMW_RET_OK != rmw_init_options_init(&init_options_, rcutils_get_default_allocator())) {
+      throw std::runtime_error("failed to init options");
+    }
+    init_options_.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+    context_ = rmw_get_zero_initialized_context();
+    if (RMW_RET_OK != rmw_init(&init_options_, &context_)) {
+      throw std::runtime_error("failed to init context");
+    }
+    node_ = rmw_create_node(&context_, "benchmark_wait_set_node", "/", 0, false);
+    if (!node_) {
+      throw std::runtime_error("failed to create node");
+    }
+    wait_set_ = rmw_create_wait_set(&context_, 0);
+    if (!wait_set_) {
+      throw std::runtime_error("failed to create wait set");
+    }
+  }
+
+  void TearDown(const benchmark::State &) override
+  {
+    destroy_entities();
+    rmw_destroy_wait_set(wait_set_);
+    rmw_destroy_node(node_);
+    rmw_shutdown(&context_);
+    rmw_context_fini(&context_);
+    rmw_init_options_fini(&init_options_);
+  }
+
+protected:
+  void create_entities(int64_t count)
+  {
+    rmw_subscription_options_t options = rmw_get_default_subscription_options();
+    for (int64_t i = 0; i < count; ++i) {
+      std::string topic = "benchmark_wait_set_" + std::to_string(i);
+      rmw_subscription_t * subscription = rmw_create_subscription(
+        node_, message_type_support(), topic.c_str(), &rmw_qos_profile_default, &options);
+      if (!subscription) {
+        throw std::runtime_error("failed to create subscription");
+      }
+      subscriptions_.push_back(subscription);
+      rmw_guard_condition_t * guard_condition = rmw_create_guard_condition(&context_);
+      if (!guard_condition) {
+        throw std::runtime_error("failed to create guard condition");
+      }
+      guard_conditions_.push_back(guard_condition);
+    }
+    subscription_data_.clear();
+    guard_condition_data_.clear();
+    for (rmw_subscription_t * subscription : subscriptions_) {
+      subscription_data_.push_back(subscription->data);
+    }
+    for (rmw_guard_condition_t * guard_condition : guard_conditions_) {
+      guard_condition_data_.push_back(guard_condition->data);
+    }
+    scratch_subscription_data_.resize(subscription_data_.size());
+    scratch_guard_condition_data_.resize(guard_condition_data_.size());
+  }
+
+  void destroy_entities()
+  {
+    for (rmw_subscription_t * subscription : subscriptions_) {
+      rmw_destroy_subscription(node_, subscription);
+    }
+    subscriptions_.clear();
+    for (rmw_guard_condition_t * guard_condition : guard_conditions_) {
+      rmw_destroy_guard_condition(guard_condition);
+    }
+    guard_conditions_.clear();
+  }
+
+  // Attach everything and wait once. The scratch arrays are refilled from
+  // the pristine copies because the wait nulls what was not ready.
+  rmw_ret_t wait_once(const rmw_time_t * timeout)
+  {
+    scratch_subscription_data_ = subscription_data_;
+    scratch_guard_condition_data_ = guard_condition_data_;
+    rmw_subscriptions_t subscriptions;
+    subscriptions.subscriber_count = scratch_subscription_data_.size();
+    subscriptions.subscribers = scratch_subscription_data_.data();
+    rmw_guard_conditions_t guard_conditions;
+    guard_conditions.guard_condition_count = scratch_guard_condition_data_.size();
+    guard_conditions.guard_conditions = scratch_guard_condition_data_.data();
+    return rmw_wait(
+      &subscriptions, &guard_conditions, nullptr, nullptr, nullptr, wait_set_, timeout);
+  }
+
+  rmw_init_options_t init_options_;
+  rmw_context_t context_;
+  rmw_node_t * node_{nullptr};
+  rmw_wait_set_t * wait_set_{nullptr};
+  std::vector<rmw_subscription_t *> subscriptions_;
+  std::vector<rmw_guard_condition_t *> guard_conditions_;
+  std::vector<void *> subscription_data_;
+  std::vector<void *> guard_condition_data_;
+  std::vector<void *> scratch_subscription_data_;
+  std::vector<void *> scratch_guard_condition_data_;
+};
+
+// Pure scan cost: a zero-timeout wait with nothing ready pays the attach
+// loops, the readiness check and the detach/scrub loops for 2N entities and
+// returns RMW_RET_TIMEOUT. This is the fixed overhead every executor cycle
+// pays before any work happens.
+BENCHMARK_DEFINE_F(WaitSetFixture, attach_scan_detach)(benchmark::State & st)
+{
+  create_entities(st.range(0));
+  const rmw_time_t zero_timeout{0, 0};
+  for (auto _ : st) {
+    (void)_;
+    rmw_ret_t ret = wait_once(&zero_timeout);
+    if (RMW_RET_TIMEOUT != ret && RMW_RET_OK != ret) {
+      st.SkipWithError("wait failed");
+      break;
+    }
+  }
+  st.counters["entities"] = static_cast<double>(2 * st.range(0));
+}
+
+// Ready-entity return path: one guard condition is triggered before the
+// wait, so the wait returns without blocking but still scans and scrubs 2N
+// attachments to report the single ready entity.
+BENCHMARK_DEFINE_F(WaitSetFixture, pretriggered_wakeup)(benchmark::State & st)
+{
+  create_entities(st.range(0));
+  const rmw_time_t zero_timeout{0, 0};
+  for (auto _ : st) {
+    (void)_;
+    if (RMW_RET_OK != rmw_trigger_guard_condition(guard_conditions_.back())) {
+      st.SkipWithError("failed to trigger guard condition");
+      break;
+    }
+    if (RMW_RET_OK != wait_once(&zero_timeout)) {
+      st.SkipWithError("wait did not report the triggered guard condition");
+      break;
+    }
+  }
+  st.counters["entities"] = static_cast<double>(2 * st.range(0));
+}
+
+// Wakeup-to-return latency: the waiter blocks with 2N attachments and a
+// helper thread triggers a guard condition once it is armed; manual timing
+// covers trigger to wait return, which is the latency an executor adds to
+// every cross-thread notification.
+BENCHMARK_DEFINE_F(WaitSetFixture, cross_thread_wakeup)(benchmark::State & st)
+{
+  create_entities(st.range(0));
+  std::atomic<bool> armed{false};
+  std::atomic<bool> done{false};
+  std::atomic<int64_t> trigger_ns{0};
+  std::thread trigger_thread(
+    [&]() {
+      while (!done.load()) {
+        if (!armed.exchange(false)) {
+          std::this_thread::yield();
+          continue;
+        }
+        trigger_ns.store(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        rmw_trigger_guard_condition(guard_conditions_.front());
+      }
+    });
+
+  const rmw_time_t block_timeout{10, 0};
+  for (auto _ : st) {
+    (void)_;
+    armed.store(true);
+    rmw_ret_t ret = wait_once(&block_timeout);
+    const int64_t now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (RMW_RET_OK != ret) {
+      st.SkipWithError("wait timed out instead of waking");
+      break;
+    }
+    st.SetIterationTime(static_cast<double>(now_ns - trigger_ns.load()) * 1e-9);
+  }
+  done.store(true);
+  trigger_thread.join();
+  st.counters["entities"] = static_cast<double>(2 * st.range(0));
+}
+
+BENCHMARK_REGISTER_F(WaitSetFixture, attach_scan_detach)
+->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_REGISTER_F(WaitSetFixture, pretriggered_wakeup)
+->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_REGISTER_F(WaitSetFixture, cross_thread_wakeup)
+->UseManualTime()->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,275 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "rcutils/allocator.h"
+#include "rcutils/strdup.h"
+
+#include "rmw/rmw.h"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+#include "rosidl_typesupport_cpp/service_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/srv/basic_types.hpp"
+
+// Allocation regression guard for the hot paths. The first iterations of a
+// publish/take or request/response cycle may allocate - scratch buffer pools
+// fill, histories grow to their depth, queues park their first nodes - but
+// once warm, another iteration must not touch the heap. Each test warms a
+// canonical cycle up, then arms a counting global operator new and fails on
+// any allocation made from this thread during the measured iterations.
+// Background threads (transport, discovery) are deliberately not counted:
+// they are off the caller's critical path and allocate at their own cadence.
+
+namespace
+{
+
+std::atomic<uint64_t> g_allocation_count{0};
+thread_local bool t_count_allocations = false;
+
+/// Arms the counter on this thread for the enclosing scope.
+class AllocationCounter
+{
+public:
+  AllocationCounter()
+  {
+    g_allocation_count.store(0, std::memory_order_relaxed);
+    t_count_allocations = true;
+  }
+
+  ~AllocationCounter()
+  {
+    t_count_allocations = false;
+  }
+
+  uint64_t count() const
+  {
+    return g_allocation_count.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace
+
+// Interposed for the whole process; malloc itself is not replaced, so the
+// counting path below cannot recurse.
+void * operator new(std::size_t size)
+{
+  if (t_count_allocations) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void * ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+
+constexpr size_t kWarmupIterations = 64u;
+constexpr size_t kMeasuredIterations = 256u;
+
+class ZeroAllocationTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    init_options_ = rmw_get_zero_initialized_init_options();
+    ASSERT_EQ(RMW_RET_OK, rmw_init_options_init(&init_options_, rcutils_get_default_allocator()));
+    init_options_.enclave = rcutils_strdup("/", rcutils_get_default_allocator());
+    context_ = rmw_get_zero_initialized_context();
+    ASSERT_EQ(RMW_RET_OK, rmw_init(&init_options_, &context_));
+    node_ = rmw_create_node(&context_, "zero_allocation_node", "/", 0, false);
+    ASSERT_NE(nullptr, node_);
+  }
+
+  void TearDown() override
+  {
+    rmw_destroy_node(node_);
+    rmw_shutdown(&context_);
+    rmw_context_fini(&context_);
+    rmw_init_options_fini(&init_options_);
+  }
+
+  static const rosidl_message_type_support_t * message_type_support()
+  {
+    return rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::BasicTypes>();
+  }
+
+  rmw_publisher_t * create_publisher(const char * topic)
+  {
+    rmw_publisher_options_t options = rmw_get_default_publisher_options();
+    rmw_publisher_t * publisher = rmw_create_publisher(
+      node_, message_type_support(), topic, &rmw_qos_profile_default, &options);
+    EXPECT_NE(nullptr, publisher);
+    return publisher;
+  }
+
+  rmw_subscription_t * create_subscription(const char * topic)
+  {
+    rmw_subscription_options_t options = rmw_get_default_subscription_options();
+    rmw_subscription_t * subscription = rmw_create_subscription(
+      node_, message_type_support(), topic, &rmw_qos_profile_default, &options);
+    EXPECT_NE(nullptr, subscription);
+    return subscription;
+  }
+
+  void wait_for_match(rmw_publisher_t * publisher)
+  {
+    size_t count = 0;
+    while (count == 0) {
+      ASSERT_EQ(RMW_RET_OK, rmw_publisher_count_matched_subscriptions(publisher, &count));
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  rmw_init_options_t init_options_;
+  rmw_context_t context_;
+  rmw_node_t * node_{nullptr};
+};
+
+// Steady-state publish with a matched subscription draining the history;
+// the reusable serialization buffer in the publisher allocation makes the
+// writer side allocation-free once warm.
+TEST_F(ZeroAllocationTest, publish_take_steady_state_does_not_allocate) {
+  rmw_publisher_t * publisher = create_publisher("/zero_allocation_take");
+  rmw_subscription_t * subscription = create_subscription("/zero_allocation_take");
+  wait_for_match(publisher);
+
+  rmw_publisher_allocation_t publisher_allocation;
+  ASSERT_EQ(
+    RMW_RET_OK,
+    rmw_init_publisher_allocation(message_type_support(), nullptr, &publisher_allocation));
+  rmw_subscription_allocation_t subscription_allocation;
+  ASSERT_EQ(
+    RMW_RET_OK,
+    rmw_init_subscription_allocation(message_type_support(), nullptr, &subscription_allocation));
+
+  test_msgs::msg::BasicTypes message;
+  test_msgs::msg::BasicTypes taken_message;
+  auto cycle = [&]() {
+    ASSERT_EQ(RMW_RET_OK, rmw_publish(publisher, &message, &publisher_allocation));
+    bool taken = false;
+    while (!taken) {
+      ASSERT_EQ(
+        RMW_RET_OK, rmw_take(subscription, &taken_message, &taken, &subscription_allocation));
+    }
+  };
+
+  for (size_t i = 0; i < kWarmupIterations; ++i) {
+    cycle();
+  }
+  {
+    AllocationCounter counter;
+    for (size_t i = 0; i < kMeasuredIterations; ++i) {
+      cycle();
+    }
+    EXPECT_EQ(0u, counter.count());
+  }
+
+  EXPECT_EQ(RMW_RET_OK, rmw_fini_subscription_allocation(&subscription_allocation));
+  EXPECT_EQ(RMW_RET_OK, rmw_fini_publisher_allocation(&publisher_allocation));
+  EXPECT_EQ(RMW_RET_OK, rmw_destroy_subscription(node_, subscription));
+  EXPECT_EQ(RMW_RET_OK, rmw_destroy_publisher(node_, publisher));
+}
+
+// Full service round trip; requests and responses share the scratch buffer
+// pool and the response queues reuse their parked nodes, so a warm cycle
+// stays off the heap on both the client and the server thread (here the
+// same thread, which is exactly what the counter observes).
+TEST_F(ZeroAllocationTest, service_round_trip_steady_state_does_not_allocate) {
+  const rosidl_service_type_support_t * type_support =
+    rosidl_typesupport_cpp::get_service_type_support_handle<test_msgs::srv::BasicTypes>();
+  rmw_service_t * service = rmw_create_service(
+    node_, type_support, "zero_allocation_service", &rmw_qos_profile_services_default);
+  rmw_client_t * client = rmw_create_client(
+    node_, type_support, "zero_allocation_service", &rmw_qos_profile_services_default);
+  ASSERT_NE(nullptr, service);
+  ASSERT_NE(nullptr, client);
+  bool available = false;
+  while (!available) {
+    ASSERT_EQ(RMW_RET_OK, rmw_service_server_is_available(node_, client, &available));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  test_msgs::srv::BasicTypes::Request request;
+  test_msgs::srv::BasicTypes::Request taken_request;
+  test_msgs::srv::BasicTypes::Response response;
+  test_msgs::srv::BasicTypes::Response taken_response;
+  auto cycle = [&]() {
+    int64_t sequence_id = 0;
+    ASSERT_EQ(RMW_RET_OK, rmw_send_request(client, &request, &sequence_id));
+    rmw_service_info_t request_header;
+    bool taken = false;
+    while (!taken) {
+      ASSERT_EQ(RMW_RET_OK, rmw_take_request(service, &request_header, &taken_request, &taken));
+    }
+    ASSERT_EQ(RMW_RET_OK, rmw_send_response(service, &request_header.request_id, &response));
+    taken = false;
+    while (!taken) {
+      ASSERT_EQ(RMW_RET_OK, rmw_take_response(client, &request_header, &taken_response, &taken));
+    }
+  };
+
+  for (size_t i = 0; i < kWarmupIterations; ++i) {
+    cycle();
+  }
+  {
+    AllocationCounter counter;
+    for (size_t i = 0; i < kMeasuredIterations; ++i) {
+      cycle();
+    }
+    EXPECT_EQ(0u, counter.count());
+  }
+
+  EXPECT_EQ(RMW_RET_OK, rmw_destroy_client(node_, client));
+  EXPECT_EQ(RMW_RET_OK, rmw_destroy_service(node_, service));
+}
+
+}  // namespace
@@ -142,6 +142,19 @@ public:
 
   bool deserializeROSmessage(
     eprosima::fastcdr::Cdr & deser, void * ros_message, const void * impl) const override;
+
+private:
+  // Every inner type support is one of exactly two TypeSupport<MembersType>
+  // instantiations (introspection C or C++). The instantiation is resolved
+  // once at construction; the forwarding methods then call the final
+  // implementation through a static cast, so the per-message dispatch is a
+  // predictable branch instead of a second virtual call.
+  enum class Kind
+  {
+    INTROSPECTION_C,
+    INTROSPECTION_CPP,
+  };
+  Kind kind_;
 };
 
 class BaseTypeSupport : public rmw_fastrtps_shared_cpp::TypeSupport
@@ -166,13 +179,16 @@ template<typename MembersType>
 class TypeSupport : public BaseTypeSupport
 {
 public:
-  size_t getEstimatedSerializedSize(const void * ros_message, const void * impl) const override;
+  // final: lets calls through a statically typed pointer (the proxy's
+  // devirtualized forwarding) skip the vtable and inline the entry to the
+  // introspection walk.
+  size_t getEstimatedSerializedSize(const void * ros_message, const void * impl) const final;
 
   bool serializeROSmessage(
-    const void * ros_message, eprosima::fastcdr::Cdr & ser, const void * impl) const override;
+    const void * ros_message, eprosima::fastcdr::Cdr & ser, const void * impl) const final;
 
   bool deserializeROSmessage(
-    eprosima::fastcdr::Cdr & deser, void * ros_message, const void * impl) const override;
+    eprosima::fastcdr::Cdr & deser, void * ros_message, const void * impl) const final;
 
 protected:
   explicit TypeSupport(const void * ros_type_support);
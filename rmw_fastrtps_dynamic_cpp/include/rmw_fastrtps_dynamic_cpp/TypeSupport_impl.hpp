@@ -17,14 +17,18 @@
 
 #include <fastcdr/FastBuffer.h>
 #include <fastcdr/Cdr.h>
+#include <algorithm>
 #include <cassert>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "rmw_fastrtps_dynamic_cpp/TypeSupport.hpp"
 #include "rmw_fastrtps_dynamic_cpp/macros.hpp"
-#include "rosidl_typesupport_fastrtps_c/wstring_conversion.hpp"
-#include "rosidl_typesupport_fastrtps_cpp/wstring_conversion.hpp"
 #include "rosidl_typesupport_introspection_cpp/field_types.hpp"
 #include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
 #include "rosidl_typesupport_introspection_cpp/service_introspection.hpp"
@@ -209,6 +213,11 @@ static size_t calculateMaxAlign(const MembersType * members)
 }
 
 // C++ specialization
+//
+// Fixed arrays and sequences of primitives are handed to Fast-CDR as one
+// serializeArray() call over the contiguous storage, which the library
+// lowers to a single bounds check plus memcpy when no byte swapping is
+// needed. Only bool and the string types below are inherently per-element.
 template<typename T>
 void serialize_field(
   const rosidl_typesupport_introspection_cpp::MessageMember * member,
@@ -225,6 +234,60 @@ void serialize_field(
   }
 }
 
+// Wide strings travel on the wire as a length plus one 32-bit code unit per
+// character. Instead of round-tripping every field through a temporary
+// std::wstring, these helpers widen (or narrow) the UTF-16 code units through
+// a small stack buffer straight into the Cdr stream, producing the same bytes
+// as serializing the converted std::wstring would. Surrogate pairs pass
+// through unit by unit, exactly as the old conversion did.
+template<typename CharT>
+void serialize_wide_string(
+  const CharT * units, size_t size, eprosima::fastcdr::Cdr & ser)
+{
+  wchar_t chunk[128];
+  const size_t chunk_size = sizeof(chunk) / sizeof(chunk[0]);
+
+  ser << static_cast<uint32_t>(size);
+  size_t done = 0;
+  while (done < size) {
+    size_t n = std::min(size - done, chunk_size);
+    for (size_t i = 0; i < n; ++i) {
+      chunk[i] = static_cast<wchar_t>(static_cast<uint16_t>(units[done + i]));
+    }
+    ser.serializeArray(chunk, n);
+    done += n;
+  }
+}
+
+template<typename CharT>
+void deserialize_wide_string_units(
+  CharT * units, size_t size, eprosima::fastcdr::Cdr & deser)
+{
+  wchar_t chunk[128];
+  const size_t chunk_size = sizeof(chunk) / sizeof(chunk[0]);
+
+  size_t done = 0;
+  while (done < size) {
+    size_t n = std::min(size - done, chunk_size);
+    deser.deserializeArray(chunk, n);
+    for (size_t i = 0; i < n; ++i) {
+      units[done + i] = static_cast<CharT>(chunk[i]);
+    }
+    done += n;
+  }
+}
+
+inline void deserialize_c_wide_string(
+  rosidl_runtime_c__U16String * u16str, eprosima::fastcdr::Cdr & deser)
+{
+  uint32_t length = 0;
+  deser >> length;
+  if (!rosidl_runtime_c__U16String__resize(u16str, length)) {
+    throw std::runtime_error("unable to resize rosidl_runtime_c__U16String");
+  }
+  deserialize_wide_string_units(u16str->data, static_cast<size_t>(length), deser);
+}
+
 template<>
 inline
 void serialize_field<std::wstring>(
@@ -232,11 +295,9 @@ void serialize_field<std::wstring>(
   void * field,
   eprosima::fastcdr::Cdr & ser)
 {
-  std::wstring wstr;
   if (!member->is_array_) {
     auto u16str = static_cast<std::u16string *>(field);
-    rosidl_typesupport_fastrtps_cpp::u16string_to_wstring(*u16str, wstr);
-    ser << wstr;
+    serialize_wide_string(u16str->data(), u16str->size(), ser);
   } else {
     size_t size;
     if (member->array_size_ && !member->is_upper_bound_) {
@@ -248,8 +309,7 @@ void serialize_field<std::wstring>(
     for (size_t i = 0; i < size; ++i) {
       const void * element = member->get_const_function(field, i);
       auto u16str = static_cast<const std::u16string *>(element);
-      rosidl_typesupport_fastrtps_cpp::u16string_to_wstring(*u16str, wstr);
-      ser << wstr;
+      serialize_wide_string(u16str->data(), u16str->size(), ser);
     }
   }
 }
@@ -318,23 +378,19 @@ void serialize_field<std::wstring>(
   void * field,
   eprosima::fastcdr::Cdr & ser)
 {
-  std::wstring wstr;
   if (!member->is_array_) {
     auto u16str = static_cast<rosidl_runtime_c__U16String *>(field);
-    rosidl_typesupport_fastrtps_c::u16string_to_wstring(*u16str, wstr);
-    ser << wstr;
+    serialize_wide_string(u16str->data, u16str->size, ser);
   } else if (member->array_size_ && !member->is_upper_bound_) {
     auto array = static_cast<rosidl_runtime_c__U16String *>(field);
     for (size_t i = 0; i < member->array_size_; ++i) {
-      rosidl_typesupport_fastrtps_c::u16string_to_wstring(array[i], wstr);
-      ser << wstr;
+      serialize_wide_string(array[i].data, array[i].size, ser);
     }
   } else {
     auto sequence = static_cast<rosidl_runtime_c__U16String__Sequence *>(field);
     ser << static_cast<uint32_t>(sequence->size);
     for (size_t i = 0; i < sequence->size; ++i) {
-      rosidl_typesupport_fastrtps_c::u16string_to_wstring(sequence->data[i], wstr);
-      ser << wstr;
+      serialize_wide_string(sequence->data[i].data, sequence->data[i].size, ser);
     }
   }
 }
@@ -371,6 +427,141 @@ size_t get_array_size_and_assign_field(
   return tmpsequence->size;
 }
 
+// A serialization plan is the introspection member table of one message type
+// flattened into an array of ops with the per-member type switch already
+// resolved: primitive and string members carry pre-selected handler function
+// pointers, nested message members carry a pointer to the sub-type's own plan
+// plus its size and alignment, which the recursive walks previously recomputed
+// on every sample. Plans are built once per type on first use and live for the
+// rest of the process, so the hot serialize/deserialize/size paths reduce to a
+// tight loop over prebuilt entries.
+template<typename MembersType>
+struct SerializationPlan
+{
+  using MemberType = typename std::remove_pointer<decltype(MembersType::members_)>::type;
+
+  struct Op
+  {
+    // Introspection entry this op covers.
+    MemberType * member;
+    // Pre-resolved handlers for primitive and string members. All three are
+    // null for ROS_TYPE_MESSAGE members, which use the sub-plan fields below.
+    void (* serialize)(MemberType *, void *, eprosima::fastcdr::Cdr &);
+    void (* deserialize)(MemberType *, void *, eprosima::fastcdr::Cdr &, bool);
+    size_t (* estimate)(MemberType *, void *, size_t);
+    // Sub-message data resolved once at plan build time.
+    const SerializationPlan<MembersType> * sub_plan;
+    size_t sub_members_size;
+    size_t max_align;
+  };
+
+  std::vector<Op> ops;
+
+  // Non-zero when the type's CDR wire image is byte-identical to its
+  // in-memory layout; the whole message can then be handled with a single
+  // bulk copy of this many bytes. Zero when the layouts differ.
+  size_t trivial_copy_size;
+};
+
+// Non-array bools keep their historic special case as a dedicated handler.
+template<typename MemberType>
+void serialize_single_bool(
+  MemberType * member,
+  void * field,
+  eprosima::fastcdr::Cdr & ser)
+{
+  (void)member;
+  // don't cast to bool here because if the bool is
+  // uninitialized the random value can't be deserialized
+  ser << (*static_cast<uint8_t *>(field) ? true : false);
+}
+
+template<typename MembersType>
+const SerializationPlan<MembersType> * get_serialization_plan(const MembersType * members);
+
+template<typename MembersType>
+void serialize_with_plan(
+  eprosima::fastcdr::Cdr & ser,
+  const SerializationPlan<MembersType> * plan,
+  const void * ros_message)
+{
+  for (const auto & op : plan->ops) {
+    void * field =
+      const_cast<char *>(static_cast<const char *>(ros_message)) + op.member->offset_;
+    if (op.serialize) {
+      op.serialize(op.member, field, ser);
+      continue;
+    }
+    if (!op.member->is_array_) {
+      serialize_with_plan(ser, op.sub_plan, field);
+    } else {
+      void * subros_message = nullptr;
+      size_t array_size = 0;
+
+      if (op.member->array_size_ && !op.member->is_upper_bound_) {
+        subros_message = field;
+        array_size = op.member->array_size_;
+      } else {
+        array_size = get_array_size_and_assign_field(
+          op.member, field, subros_message, op.sub_members_size, op.max_align);
+
+        // Serialize length
+        ser << (uint32_t)array_size;
+      }
+
+      for (size_t index = 0; index < array_size; ++index) {
+        serialize_with_plan(ser, op.sub_plan, subros_message);
+        subros_message = static_cast<char *>(subros_message) + op.sub_members_size;
+        subros_message = align_(op.max_align, subros_message);
+      }
+    }
+  }
+}
+
+template<typename MembersType>
+size_t estimate_with_plan(
+  const SerializationPlan<MembersType> * plan,
+  const void * ros_message,
+  size_t current_alignment)
+{
+  size_t initial_alignment = current_alignment;
+
+  for (const auto & op : plan->ops) {
+    void * field =
+      const_cast<char *>(static_cast<const char *>(ros_message)) + op.member->offset_;
+    if (op.estimate) {
+      current_alignment = op.estimate(op.member, field, current_alignment);
+      continue;
+    }
+    if (!op.member->is_array_) {
+      current_alignment += estimate_with_plan(op.sub_plan, field, current_alignment);
+    } else {
+      void * subros_message = nullptr;
+      size_t array_size = 0;
+
+      if (op.member->array_size_ && !op.member->is_upper_bound_) {
+        subros_message = field;
+        array_size = op.member->array_size_;
+      } else {
+        array_size = get_array_size_and_assign_field(
+          op.member, field, subros_message, op.sub_members_size, op.max_align);
+
+        // Length serialization
+        current_alignment += 4 + eprosima::fastcdr::Cdr::alignment(current_alignment, 4);
+      }
+
+      for (size_t index = 0; index < array_size; ++index) {
+        current_alignment += estimate_with_plan(
+          op.sub_plan, subros_message, current_alignment);
+        subros_message = static_cast<char *>(subros_message) + op.sub_members_size;
+        subros_message = align_(op.max_align, subros_message);
+      }
+    }
+  }
+
+  return current_alignment - initial_alignment;
+}
+
 template<typename MembersType>
 bool TypeSupport<MembersType>::serializeROSmessage(
   eprosima::fastcdr::Cdr & ser,
@@ -380,92 +571,22 @@ bool TypeSupport<MembersType>::serializeROSmessage(
   assert(members);
   assert(ros_message);
 
-  for (uint32_t i = 0; i < members->member_count_; ++i) {
-    const auto member = members->members_ + i;
-    void * field = const_cast<char *>(static_cast<const char *>(ros_message)) + member->offset_;
-    switch (member->type_id_) {
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
-        if (!member->is_array_) {
-          // don't cast to bool here because if the bool is
-          // uninitialized the random value can't be deserialized
-          ser << (*static_cast<uint8_t *>(field) ? true : false);
-        } else {
-          serialize_field<bool>(member, field, ser);
-        }
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
-        serialize_field<uint8_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
-        serialize_field<char>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
-        serialize_field<float>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
-        serialize_field<double>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
-        serialize_field<int16_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
-        serialize_field<uint16_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
-        serialize_field<int32_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
-        serialize_field<uint32_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
-        serialize_field<int64_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
-        serialize_field<uint64_t>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
-        serialize_field<std::string>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
-        serialize_field<std::wstring>(member, field, ser);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
-        {
-          auto sub_members = static_cast<const MembersType *>(member->members_->data);
-          if (!member->is_array_) {
-            serializeROSmessage(ser, sub_members, field);
-          } else {
-            void * subros_message = nullptr;
-            size_t array_size = 0;
-            size_t sub_members_size = sub_members->size_of_;
-            size_t max_align = calculateMaxAlign(sub_members);
-
-            if (member->array_size_ && !member->is_upper_bound_) {
-              subros_message = field;
-              array_size = member->array_size_;
-            } else {
-              array_size = get_array_size_and_assign_field(
-                member, field, subros_message, sub_members_size, max_align);
-
-              // Serialize length
-              ser << (uint32_t)array_size;
-            }
-
-            for (size_t index = 0; index < array_size; ++index) {
-              serializeROSmessage(ser, sub_members, subros_message);
-              subros_message = static_cast<char *>(subros_message) + sub_members_size;
-              subros_message = align_(max_align, subros_message);
-            }
-          }
-        }
-        break;
-      default:
-        throw std::runtime_error("unknown type");
-    }
+  const SerializationPlan<MembersType> * plan = get_serialization_plan(members);
+
+  // For trivially-copyable types the wire image equals memory byte for byte,
+  // so emit the whole message as one bulk write. Valid here because the
+  // encapsulation header was just serialized, which resets the alignment
+  // base, and only when no byte swapping is needed.
+  if (0 != plan->trivial_copy_size &&
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN == ser.endianness())
+  {
+    ser.serializeArray(
+      static_cast<const uint8_t *>(ros_message), plan->trivial_copy_size);
+    return true;
   }
 
+  serialize_with_plan(ser, plan, ros_message);
+
   return true;
 }
 
@@ -640,92 +761,20 @@ size_t TypeSupport<MembersType>::getEstimatedSerializedSize(
   assert(members);
   assert(ros_message);
 
-  size_t initial_alignment = current_alignment;
+  const SerializationPlan<MembersType> * plan = get_serialization_plan(members);
 
-  for (uint32_t i = 0; i < members->member_count_; ++i) {
-    const auto member = members->members_ + i;
-    void * field = const_cast<char *>(static_cast<const char *>(ros_message)) + member->offset_;
-    switch (member->type_id_) {
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
-        current_alignment = next_field_align<bool>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
-        current_alignment = next_field_align<uint8_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
-        current_alignment = next_field_align<char>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
-        current_alignment = next_field_align<float>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
-        current_alignment = next_field_align<double>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
-        current_alignment = next_field_align<int16_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
-        current_alignment = next_field_align<uint16_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
-        current_alignment = next_field_align<int32_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
-        current_alignment = next_field_align<uint32_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
-        current_alignment = next_field_align<int64_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
-        current_alignment = next_field_align<uint64_t>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
-        current_alignment = next_field_align_string<std::string>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
-        current_alignment = next_field_align_string<std::wstring>(member, field, current_alignment);
-        break;
-      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
-        {
-          auto sub_members = static_cast<const MembersType *>(member->members_->data);
-          if (!member->is_array_) {
-            current_alignment += getEstimatedSerializedSize(sub_members, field, current_alignment);
-          } else {
-            void * subros_message = nullptr;
-            size_t array_size = 0;
-            size_t sub_members_size = sub_members->size_of_;
-            size_t max_align = calculateMaxAlign(sub_members);
-
-            if (member->array_size_ && !member->is_upper_bound_) {
-              subros_message = field;
-              array_size = member->array_size_;
-            } else {
-              array_size = get_array_size_and_assign_field(
-                member, field, subros_message, sub_members_size, max_align);
-
-              // Length serialization
-              current_alignment += 4 + eprosima::fastcdr::Cdr::alignment(current_alignment, 4);
-            }
-
-            for (size_t index = 0; index < array_size; ++index) {
-              current_alignment += getEstimatedSerializedSize(
-                sub_members, subros_message, current_alignment);
-              subros_message = static_cast<char *>(subros_message) + sub_members_size;
-              subros_message = align_(max_align, subros_message);
-            }
-          }
-        }
-        break;
-      default:
-        throw std::runtime_error("unknown type");
-    }
+  // The size of a trivially-copyable type is a constant, independent of the
+  // message contents; the shortcut only holds from the alignment base.
+  if (0 != plan->trivial_copy_size && 0 == current_alignment) {
+    return plan->trivial_copy_size;
   }
 
-  return current_alignment - initial_alignment;
+  return estimate_with_plan(plan, ros_message, current_alignment);
 }
 
+// Mirrors serialize_field: primitive arrays and sequences come back through
+// one bulk deserializeArray() over the contiguous storage, so the per-element
+// machinery is only exercised for bools and strings.
 template<typename T>
 void deserialize_field(
   const rosidl_typesupport_introspection_cpp::MessageMember * member,
@@ -786,11 +835,12 @@ inline void deserialize_field<std::wstring>(
   bool call_new)
 {
   (void)call_new;
-  std::wstring wstr;
   if (!member->is_array_) {
-    deser >> wstr;
-    rosidl_typesupport_fastrtps_cpp::wstring_to_u16string(
-      wstr, *static_cast<std::u16string *>(field));
+    uint32_t length = 0;
+    deser >> length;
+    auto u16str = static_cast<std::u16string *>(field);
+    u16str->resize(length);
+    deserialize_wide_string_units(&(*u16str)[0], length, deser);
   } else {
     uint32_t size;
     if (member->array_size_ && !member->is_upper_bound_) {
@@ -802,8 +852,10 @@ inline void deserialize_field<std::wstring>(
     for (size_t i = 0; i < size; ++i) {
       void * element = member->get_function(field, i);
       auto u16str = static_cast<std::u16string *>(element);
-      deser >> wstr;
-      rosidl_typesupport_fastrtps_cpp::wstring_to_u16string(wstr, *u16str);
+      uint32_t length = 0;
+      deser >> length;
+      u16str->resize(length);
+      deserialize_wide_string_units(&(*u16str)[0], length, deser);
     }
   }
 }
@@ -885,16 +937,12 @@ inline void deserialize_field<std::wstring>(
   bool call_new)
 {
   (void)call_new;
-  std::wstring wstr;
   if (!member->is_array_) {
-    deser >> wstr;
-    rosidl_typesupport_fastrtps_c::wstring_to_u16string(
-      wstr, *static_cast<rosidl_runtime_c__U16String *>(field));
+    deserialize_c_wide_string(static_cast<rosidl_runtime_c__U16String *>(field), deser);
   } else if (member->array_size_ && !member->is_upper_bound_) {
     auto array = static_cast<rosidl_runtime_c__U16String *>(field);
     for (size_t i = 0; i < member->array_size_; ++i) {
-      deser >> wstr;
-      rosidl_typesupport_fastrtps_c::wstring_to_u16string(wstr, array[i]);
+      deserialize_c_wide_string(&array[i], deser);
     }
   } else {
     uint32_t size;
@@ -904,8 +952,7 @@ inline void deserialize_field<std::wstring>(
       throw std::runtime_error("unable to initialize rosidl_runtime_c__U16String sequence");
     }
     for (size_t i = 0; i < sequence->size; ++i) {
-      deser >> wstr;
-      rosidl_typesupport_fastrtps_c::wstring_to_u16string(wstr, sequence->data[i]);
+      deserialize_c_wide_string(&sequence->data[i], deser);
     }
   }
 }
@@ -952,96 +999,270 @@ inline size_t get_submessage_array_deserialize(
   return vsize;
 }
 
+// Returns the CDR size of a message whose serialized image is byte-identical
+// to its in-memory layout, or 0 when the layouts differ. Fixed-size structs
+// of primitives (IMU, odometry, fixed covariance arrays, ...) qualify; bools
+// do not, because serialization normalizes them to 0/1, and strings and
+// dynamic sequences never do.
 template<typename MembersType>
-bool TypeSupport<MembersType>::deserializeROSmessage(
-  eprosima::fastcdr::Cdr & deser,
+size_t compute_trivial_copy_size(
   const MembersType * members,
-  void * ros_message,
-  bool call_new) const
+  const std::vector<typename SerializationPlan<MembersType>::Op> & ops)
 {
-  assert(members);
-  assert(ros_message);
+  (void)members;
+  size_t cdr_offset = 0;
+
+  for (const auto & op : ops) {
+    size_t count = 1;
+    if (op.member->is_array_) {
+      // Sequences carry a length prefix and keep their data out of line.
+      if (0 == op.member->array_size_ || op.member->is_upper_bound_) {
+        return 0;
+      }
+      count = op.member->array_size_;
+    }
+
+    if (::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE == op.member->type_id_) {
+      // A nested message only keeps the image contiguous when it is itself
+      // trivially copyable and has no trailing padding, so consecutive
+      // elements and following members line up.
+      if (nullptr == op.sub_plan ||
+        0 == op.sub_plan->trivial_copy_size ||
+        op.sub_plan->trivial_copy_size != op.sub_members_size ||
+        cdr_offset != op.member->offset_)
+      {
+        return 0;
+      }
+      cdr_offset += count * op.sub_members_size;
+      continue;
+    }
+
+    size_t item_size = 0;
+    switch (op.member->type_id_) {
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
+        item_size = 1;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
+        item_size = 2;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
+        item_size = 4;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
+        item_size = 8;
+        break;
+      default:
+        return 0;
+    }
+
+    cdr_offset += eprosima::fastcdr::Cdr::alignment(cdr_offset, item_size);
+    if (cdr_offset != op.member->offset_) {
+      return 0;
+    }
+    cdr_offset += count * item_size;
+  }
+
+  return cdr_offset;
+}
+
+template<typename MembersType>
+const SerializationPlan<MembersType> * build_serialization_plan(
+  const MembersType * members,
+  std::unordered_map<
+    const MembersType *, std::unique_ptr<SerializationPlan<MembersType>>> & plans)
+{
+  auto existing = plans.find(members);
+  if (existing != plans.end()) {
+    return existing->second.get();
+  }
+
+  auto plan = std::unique_ptr<SerializationPlan<MembersType>>(
+    new SerializationPlan<MembersType>());
+  plan->ops.reserve(members->member_count_);
 
   for (uint32_t i = 0; i < members->member_count_; ++i) {
-    const auto * member = members->members_ + i;
-    void * field = static_cast<char *>(ros_message) + member->offset_;
-    switch (member->type_id_) {
+    typename SerializationPlan<MembersType>::Op op{};
+    op.member = members->members_ + i;
+    switch (op.member->type_id_) {
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
-        deserialize_field<bool>(member, field, deser, call_new);
+        if (!op.member->is_array_) {
+          op.serialize = serialize_single_bool;
+        } else {
+          op.serialize = serialize_field<bool>;
+        }
+        op.deserialize = deserialize_field<bool>;
+        op.estimate = next_field_align<bool>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
-        deserialize_field<uint8_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<uint8_t>;
+        op.deserialize = deserialize_field<uint8_t>;
+        op.estimate = next_field_align<uint8_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
-        deserialize_field<char>(member, field, deser, call_new);
+        op.serialize = serialize_field<char>;
+        op.deserialize = deserialize_field<char>;
+        op.estimate = next_field_align<char>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
-        deserialize_field<float>(member, field, deser, call_new);
+        op.serialize = serialize_field<float>;
+        op.deserialize = deserialize_field<float>;
+        op.estimate = next_field_align<float>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
-        deserialize_field<double>(member, field, deser, call_new);
+        op.serialize = serialize_field<double>;
+        op.deserialize = deserialize_field<double>;
+        op.estimate = next_field_align<double>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
-        deserialize_field<int16_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<int16_t>;
+        op.deserialize = deserialize_field<int16_t>;
+        op.estimate = next_field_align<int16_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
-        deserialize_field<uint16_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<uint16_t>;
+        op.deserialize = deserialize_field<uint16_t>;
+        op.estimate = next_field_align<uint16_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
-        deserialize_field<int32_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<int32_t>;
+        op.deserialize = deserialize_field<int32_t>;
+        op.estimate = next_field_align<int32_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
-        deserialize_field<uint32_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<uint32_t>;
+        op.deserialize = deserialize_field<uint32_t>;
+        op.estimate = next_field_align<uint32_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
-        deserialize_field<int64_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<int64_t>;
+        op.deserialize = deserialize_field<int64_t>;
+        op.estimate = next_field_align<int64_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
-        deserialize_field<uint64_t>(member, field, deser, call_new);
+        op.serialize = serialize_field<uint64_t>;
+        op.deserialize = deserialize_field<uint64_t>;
+        op.estimate = next_field_align<uint64_t>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
-        deserialize_field<std::string>(member, field, deser, call_new);
+        op.serialize = serialize_field<std::string>;
+        op.deserialize = deserialize_field<std::string>;
+        op.estimate = next_field_align_string<std::string>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
-        deserialize_field<std::wstring>(member, field, deser, call_new);
+        op.serialize = serialize_field<std::wstring>;
+        op.deserialize = deserialize_field<std::wstring>;
+        op.estimate = next_field_align_string<std::wstring>;
         break;
       case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
         {
-          auto sub_members = (const MembersType *)member->members_->data;
-          if (!member->is_array_) {
-            deserializeROSmessage(deser, sub_members, field, call_new);
-          } else {
-            void * subros_message = nullptr;
-            size_t array_size = 0;
-            size_t sub_members_size = sub_members->size_of_;
-            size_t max_align = calculateMaxAlign(sub_members);
-            bool recall_new = call_new;
-
-            if (member->array_size_ && !member->is_upper_bound_) {
-              subros_message = field;
-              array_size = member->array_size_;
-            } else {
-              array_size = get_submessage_array_deserialize(
-                member, deser, field, subros_message,
-                call_new, sub_members_size, max_align);
-              recall_new = true;
-            }
-
-            for (size_t index = 0; index < array_size; ++index) {
-              deserializeROSmessage(deser, sub_members, subros_message, recall_new);
-              subros_message = static_cast<char *>(subros_message) + sub_members_size;
-              subros_message = align_(max_align, subros_message);
-            }
-          }
+          // ROS message types cannot be recursive, so resolving the
+          // sub-type's plan here terminates.
+          auto sub_members = static_cast<const MembersType *>(op.member->members_->data);
+          op.sub_plan = build_serialization_plan(sub_members, plans);
+          op.sub_members_size = sub_members->size_of_;
+          op.max_align = calculateMaxAlign(sub_members);
         }
         break;
       default:
         throw std::runtime_error("unknown type");
     }
+    plan->ops.push_back(op);
   }
 
+  plan->trivial_copy_size = compute_trivial_copy_size(members, plan->ops);
+
+  const SerializationPlan<MembersType> * result = plan.get();
+  plans.emplace(members, std::move(plan));
+  return result;
+}
+
+template<typename MembersType>
+const SerializationPlan<MembersType> * get_serialization_plan(const MembersType * members)
+{
+  // Plans are immutable once built, so the lock only guards the registry;
+  // after the first sample of a type this is a single map lookup.
+  static std::mutex plans_mutex;
+  static std::unordered_map<
+    const MembersType *, std::unique_ptr<SerializationPlan<MembersType>>> plans;
+
+  std::lock_guard<std::mutex> lock(plans_mutex);
+  return build_serialization_plan(members, plans);
+}
+
+template<typename MembersType>
+void deserialize_with_plan(
+  eprosima::fastcdr::Cdr & deser,
+  const SerializationPlan<MembersType> * plan,
+  void * ros_message,
+  bool call_new)
+{
+  for (const auto & op : plan->ops) {
+    void * field = static_cast<char *>(ros_message) + op.member->offset_;
+    if (op.deserialize) {
+      op.deserialize(op.member, field, deser, call_new);
+      continue;
+    }
+    if (!op.member->is_array_) {
+      deserialize_with_plan(deser, op.sub_plan, field, call_new);
+    } else {
+      void * subros_message = nullptr;
+      size_t array_size = 0;
+      bool recall_new = call_new;
+
+      if (op.member->array_size_ && !op.member->is_upper_bound_) {
+        subros_message = field;
+        array_size = op.member->array_size_;
+      } else {
+        array_size = get_submessage_array_deserialize(
+          op.member, deser, field, subros_message,
+          call_new, op.sub_members_size, op.max_align);
+        recall_new = true;
+      }
+
+      for (size_t index = 0; index < array_size; ++index) {
+        deserialize_with_plan(deser, op.sub_plan, subros_message, recall_new);
+        subros_message = static_cast<char *>(subros_message) + op.sub_members_size;
+        subros_message = align_(op.max_align, subros_message);
+      }
+    }
+  }
+}
+
+template<typename MembersType>
+bool TypeSupport<MembersType>::deserializeROSmessage(
+  eprosima::fastcdr::Cdr & deser,
+  const MembersType * members,
+  void * ros_message,
+  bool call_new) const
+{
+  assert(members);
+  assert(ros_message);
+
+  const SerializationPlan<MembersType> * plan = get_serialization_plan(members);
+
+  // Mirror of the bulk write on the serialize side: read_encapsulation()
+  // just reset the alignment base, and a trivially-copyable type holds no
+  // strings or sequences, so call_new has nothing to construct.
+  if (0 != plan->trivial_copy_size &&
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN == deser.endianness())
+  {
+    deser.deserializeArray(
+      static_cast<uint8_t *>(ros_message), plan->trivial_copy_size);
+    return true;
+  }
+
+  deserialize_with_plan(deser, plan, ros_message, call_new);
+
   return true;
 }
 
@@ -19,12 +19,15 @@
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/endpoint_options.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/topic_mux.hpp"
 
 #include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
 #include "rmw_fastrtps_dynamic_cpp/publisher.hpp"
@@ -71,7 +74,13 @@ rmw_fastrtps_dynamic_cpp::create_publisher(
     return nullptr;
   }
 
-  Participant * participant = participant_info->participant;
+  // A multiplexed publisher rides a shared channel endpoint (see
+  // EndpointOptions::mux_channel and topic_mux.hpp).
+  const char * mux_channel = rmw_fastrtps_shared_cpp::endpoint_mux_channel(
+    publisher_options->rmw_specific_publisher_payload);
+  std::string dds_topic_name = _create_topic_name(
+    qos_policies, ros_topic_prefix, nullptr != mux_channel ? mux_channel : topic_name);
+  Participant * participant = participant_info->participant_for_topic(dds_topic_name);
   if (!participant) {
     RMW_SET_ERROR_MSG("participant handle is null");
     return nullptr;
@@ -95,6 +104,7 @@ rmw_fastrtps_dynamic_cpp::create_publisher(
   CustomPublisherInfo * info = nullptr;
   rmw_publisher_t * rmw_publisher = nullptr;
   eprosima::fastrtps::PublisherAttributes publisherParam;
+  bool mux_reuse = false;
 
   // Load default XML profile.
   Domain::getDefaultPublisherAttributes(publisherParam);
@@ -115,61 +125,130 @@ rmw_fastrtps_dynamic_cpp::create_publisher(
 
   info->typesupport_identifier_ = type_support->typesupport_identifier;
   info->type_support_impl_ = type_impl;
+  info->participant_ = participant;
 
   std::string type_name = _create_type_name(
     type_support->data, info->typesupport_identifier_);
-  if (
-    !Domain::getRegisteredType(
-      participant, type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->type_support_)))
-  {
-    info->type_support_ = new (std::nothrow) TypeSupportProxy(type_impl);
-    if (!info->type_support_) {
-      RMW_SET_ERROR_MSG("failed to allocate TypeSupportProxy");
-      goto fail;
-    }
-    _register_type(participant, info->type_support_);
-  }
 
-  if (!participant_info->leave_middleware_default_qos) {
-    publisherParam.qos.m_publishMode.kind = eprosima::fastrtps::ASYNCHRONOUS_PUBLISH_MODE;
-    publisherParam.historyMemoryPolicy =
-      eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
+  if (nullptr != mux_channel) {
+    CustomPublisherInfo * shared = rmw_fastrtps_shared_cpp::mux_acquire_shared_publisher(
+      participant, dds_topic_name, type_name);
+    if (nullptr != shared) {
+      // The channel endpoint is already up; this logical publisher rides it
+      // with the channel's QoS, skipping endpoint creation entirely. The
+      // type support reference stays held, mirroring the return on destroy.
+      delete info;
+      info = shared;
+      mux_reuse = true;
+    }
   }
 
-  publisherParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
-  publisherParam.topic.topicDataType = type_name;
-  publisherParam.topic.topicName = _create_topic_name(qos_policies, ros_topic_prefix, topic_name);
-
-  // 1 Heartbeat every 10ms
-  // publisherParam.times.heartbeatPeriod.seconds = 0;
-  // publisherParam.times.heartbeatPeriod.fraction = 42949673;
+  if (!mux_reuse) {
+    info->type_support_ = participant_info->find_registered_type(participant, type_name);
+    if (!info->type_support_) {
+      if (
+        !Domain::getRegisteredType(
+          participant, type_name.c_str(),
+          reinterpret_cast<TopicDataType **>(&info->type_support_)))
+      {
+        info->type_support_ = new (std::nothrow) TypeSupportProxy(type_impl);
+        if (!info->type_support_) {
+          RMW_SET_ERROR_MSG("failed to allocate TypeSupportProxy");
+          goto fail;
+        }
+        _register_type(participant, info->type_support_);
+      }
+      participant_info->record_registered_type(participant, type_name, info->type_support_);
+    }
 
-  // 300000 bytes each 10ms
-  // ThroughputControllerDescriptor throughputController{3000000, 10};
-  // publisherParam.throughputController = throughputController;
+    if (!participant_info->leave_middleware_default_qos) {
+      publisherParam.qos.m_publishMode.kind = eprosima::fastrtps::ASYNCHRONOUS_PUBLISH_MODE;
+      publisherParam.historyMemoryPolicy =
+        eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
+    }
 
-  if (!get_datawriter_qos(*qos_policies, publisherParam)) {
-    RMW_SET_ERROR_MSG("failed to get datawriter qos");
-    goto fail;
-  }
+    // Explicit per-endpoint options override both of the above.
+    rmw_fastrtps_shared_cpp::apply_endpoint_memory_options(
+      publisher_options->rmw_specific_publisher_payload,
+      publisherParam.historyMemoryPolicy,
+      info->type_support_);
+    rmw_fastrtps_shared_cpp::apply_publisher_flow_control_options(
+      publisher_options->rmw_specific_publisher_payload,
+      publisherParam);
+
+    publisherParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
+    rmw_fastrtps_shared_cpp::apply_endpoint_key_options(
+      publisher_options->rmw_specific_publisher_payload,
+      publisherParam.topic.topicKind,
+      info->type_support_);
+    publisherParam.topic.topicDataType = type_name;
+    publisherParam.topic.topicName = dds_topic_name;
+
+    // 1 Heartbeat every 10ms
+    // publisherParam.times.heartbeatPeriod.seconds = 0;
+    // publisherParam.times.heartbeatPeriod.fraction = 42949673;
+
+    // 300000 bytes each 10ms
+    // ThroughputControllerDescriptor throughputController{3000000, 10};
+    // publisherParam.throughputController = throughputController;
+
+    if (!get_datawriter_qos(*qos_policies, publisherParam)) {
+      RMW_SET_ERROR_MSG("failed to get datawriter qos");
+      goto fail;
+    }
+    rmw_fastrtps_shared_cpp::apply_endpoint_resource_limit_options(
+      publisher_options->rmw_specific_publisher_payload,
+      publisherParam.topic.resourceLimitsQos);
+    rmw_fastrtps_shared_cpp::apply_publisher_reliability_timing_options(
+      publisher_options->rmw_specific_publisher_payload,
+      publisherParam);
+    rmw_fastrtps_shared_cpp::apply_endpoint_partition_options(
+      publisher_options->rmw_specific_publisher_payload,
+      publisherParam.qos.m_partition);
+
+    info->listener_ = new (std::nothrow) PubListener(info);
+    if (!info->listener_) {
+      RMW_SET_ERROR_MSG("create_publisher() could not create publisher listener");
+      goto fail;
+    }
 
-  info->listener_ = new (std::nothrow) PubListener(info);
-  if (!info->listener_) {
-    RMW_SET_ERROR_MSG("create_publisher() could not create publisher listener");
-    goto fail;
-  }
+    info->publisher_ = Domain::createPublisher(participant, publisherParam, info->listener_);
+    if (!info->publisher_) {
+      RMW_SET_ERROR_MSG("create_publisher() could not create publisher");
+      goto fail;
+    }
 
-  info->publisher_ = Domain::createPublisher(participant, publisherParam, info->listener_);
-  if (!info->publisher_) {
-    RMW_SET_ERROR_MSG("create_publisher() could not create publisher");
-    goto fail;
+    info->publisher_gid = rmw_fastrtps_shared_cpp::create_rmw_gid(
+      eprosima_fastrtps_identifier, info->publisher_->getGuid());
+
+    info->clock_sample_stride_ = rmw_fastrtps_shared_cpp::endpoint_clock_sample_stride(
+      publisher_options->rmw_specific_publisher_payload);
+
+    info->compress_payloads_ = rmw_fastrtps_shared_cpp::endpoint_compress_payloads(
+      publisher_options->rmw_specific_publisher_payload);
+
+    // Decided from the resolved writer QoS rather than the requested rmw
+    // profile; a system default resolving to reliable must never skip.
+    info->skip_unmatched_ = nullptr != info->listener_ &&
+      eprosima::fastrtps::BEST_EFFORT_RELIABILITY_QOS ==
+      publisherParam.qos.m_reliability.kind &&
+      eprosima::fastrtps::VOLATILE_DURABILITY_QOS ==
+      publisherParam.qos.m_durability.kind;
+
+    const uint32_t pipeline_depth = rmw_fastrtps_shared_cpp::endpoint_publish_pipeline_depth(
+      publisher_options->rmw_specific_publisher_payload);
+    if (pipeline_depth > 1) {
+      info->publish_pipeline_.reset(
+        new (std::nothrow) rmw_fastrtps_shared_cpp::PublishPipeline(info, pipeline_depth));
+      if (!info->publish_pipeline_) {
+        RMW_SET_ERROR_MSG("failed to allocate publish pipeline");
+        goto fail;
+      }
+    }
   }
 
-  info->publisher_gid = rmw_fastrtps_shared_cpp::create_rmw_gid(
-    eprosima_fastrtps_identifier, info->publisher_->getGuid());
-
-  rmw_publisher = rmw_publisher_allocate();
+  rmw_publisher = static_cast<rmw_publisher_t *>(
+    rmw_fastrtps_shared_cpp::handle_pool_allocate(sizeof(rmw_publisher_t)));
   if (!rmw_publisher) {
     RMW_SET_ERROR_MSG("failed to allocate publisher");
     goto fail;
@@ -177,27 +256,38 @@ rmw_fastrtps_dynamic_cpp::create_publisher(
   rmw_publisher->can_loan_messages = false;
   rmw_publisher->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_publisher->data = info;
-  rmw_publisher->topic_name = static_cast<char *>(rmw_allocate(strlen(topic_name) + 1));
+  rmw_publisher->topic_name = rmw_fastrtps_shared_cpp::handle_pool_copy_string(topic_name);
 
   if (!rmw_publisher->topic_name) {
     RMW_SET_ERROR_MSG("failed to allocate memory for publisher topic name");
     goto fail;
   }
 
-  memcpy(const_cast<char *>(rmw_publisher->topic_name), topic_name, strlen(topic_name) + 1);
-
   rmw_publisher->options = *publisher_options;
 
+  if (nullptr != mux_channel) {
+    if (!mux_reuse) {
+      rmw_fastrtps_shared_cpp::mux_register_shared_publisher(
+        participant, dds_topic_name, type_name, info);
+    }
+    // Keep the logical topic visible to local graph queries, which only
+    // discover the channel.
+    rmw_fastrtps_shared_cpp::mux_register_logical_topic(rmw_publisher, topic_name, type_name);
+  }
+
   return rmw_publisher;
 
 fail:
-  if (info) {
+  if (mux_reuse) {
+    // Hand the rider's channel reference back; the creator still holds one.
+    rmw_fastrtps_shared_cpp::mux_release_endpoint(rmw_publisher, info);
+  } else if (info) {
     delete info->type_support_;
     delete info->listener_;
     delete info;
   }
   type_registry.return_message_type_support(type_support);
-  rmw_publisher_free(rmw_publisher);
+  rmw_fastrtps_shared_cpp::handle_pool_release(rmw_publisher);
 
   return nullptr;
 }
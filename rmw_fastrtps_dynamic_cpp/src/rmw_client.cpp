@@ -23,8 +23,10 @@
 
 #include "rosidl_typesupport_introspection_c/identifier.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
@@ -125,42 +127,58 @@ rmw_create_client(
 
   info->request_type_support_impl_ = request_type_impl;
   info->response_type_support_impl_ = response_type_impl;
+  info->request_data_template_.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
+  info->request_data_template_.impl = request_type_impl;
+
+  // Resolved once per service type and cached in the registry, so the
+  // transient clients tooling creates in a loop skip the introspection
+  // walk and name mangling entirely.
+  const ServiceIntrospectionRecord * introspection =
+    type_registry.get_service_introspection(type_support);
+  if (!introspection) {
+    type_registry.return_request_type_support(type_support);
+    type_registry.return_response_type_support(type_support);
+    delete info;
+    return nullptr;
+  }
 
-  const void * untyped_request_members;
-  const void * untyped_response_members;
-
-  untyped_request_members =
-    get_request_ptr(type_support->data, info->typesupport_identifier_);
-  untyped_response_members = get_response_ptr(
-    type_support->data, info->typesupport_identifier_);
-
-  std::string request_type_name = _create_type_name(
-    untyped_request_members, info->typesupport_identifier_);
-  std::string response_type_name = _create_type_name(
-    untyped_response_members, info->typesupport_identifier_);
-
-  if (!Domain::getRegisteredType(
-      participant, request_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
-  {
-    info->request_type_support_ = new (std::nothrow) TypeSupportProxy(request_type_impl);
-    if (!info->request_type_support_) {
-      RMW_SET_ERROR_MSG("failed to allocate request TypeSupportProxy");
-      goto fail;
+  std::string request_type_name = introspection->request_type_name;
+  std::string response_type_name = introspection->response_type_name;
+
+  info->request_type_support_ =
+    participant_info->find_registered_type(participant, request_type_name);
+  if (!info->request_type_support_) {
+    if (!Domain::getRegisteredType(
+        participant, request_type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
+    {
+      info->request_type_support_ = new (std::nothrow) TypeSupportProxy(request_type_impl);
+      if (!info->request_type_support_) {
+        RMW_SET_ERROR_MSG("failed to allocate request TypeSupportProxy");
+        goto fail;
+      }
+      _register_type(participant, info->request_type_support_);
     }
-    _register_type(participant, info->request_type_support_);
+    participant_info->record_registered_type(
+      participant, request_type_name, info->request_type_support_);
   }
 
-  if (!Domain::getRegisteredType(
-      participant, response_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
-  {
-    info->response_type_support_ = new (std::nothrow) TypeSupportProxy(response_type_impl);
-    if (!info->response_type_support_) {
-      RMW_SET_ERROR_MSG("failed to allocate response TypeSupportProxy");
-      goto fail;
+  info->response_type_support_ =
+    participant_info->find_registered_type(participant, response_type_name);
+  if (!info->response_type_support_) {
+    if (!Domain::getRegisteredType(
+        participant, response_type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
+    {
+      info->response_type_support_ = new (std::nothrow) TypeSupportProxy(response_type_impl);
+      if (!info->response_type_support_) {
+        RMW_SET_ERROR_MSG("failed to allocate response TypeSupportProxy");
+        goto fail;
+      }
+      _register_type(participant, info->response_type_support_);
     }
-    _register_type(participant, info->response_type_support_);
+    participant_info->record_registered_type(
+      participant, response_type_name, info->response_type_support_);
   }
 
   if (!participant_info->leave_middleware_default_qos) {
@@ -223,7 +241,8 @@ rmw_create_client(
 
   info->writer_guid_ = info->request_publisher_->getGuid();
 
-  rmw_client = rmw_client_allocate();
+  rmw_client = static_cast<rmw_client_t *>(
+    rmw_fastrtps_shared_cpp::handle_pool_allocate(sizeof(rmw_client_t)));
   if (!rmw_client) {
     RMW_SET_ERROR_MSG("failed to allocate memory for client");
     goto fail;
@@ -231,13 +250,11 @@ rmw_create_client(
 
   rmw_client->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_client->data = info;
-  rmw_client->service_name = reinterpret_cast<const char *>(
-    rmw_allocate(strlen(service_name) + 1));
+  rmw_client->service_name = rmw_fastrtps_shared_cpp::handle_pool_copy_string(service_name);
   if (!rmw_client->service_name) {
     RMW_SET_ERROR_MSG("failed to allocate memory for client name");
     goto fail;
   }
-  memcpy(const_cast<char *>(rmw_client->service_name), service_name, strlen(service_name) + 1);
 
   {
     // Update graph
@@ -254,11 +271,8 @@ rmw_create_client(
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.associate_reader(
       gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      eprosima_fastrtps_identifier,
-      common_context->pub,
-      static_cast<void *>(&msg),
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      eprosima_fastrtps_identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       goto fail;
     }
@@ -320,10 +334,10 @@ fail:
 
   if (nullptr != rmw_client) {
     if (rmw_client->service_name != nullptr) {
-      rmw_free(const_cast<char *>(rmw_client->service_name));
+      rmw_fastrtps_shared_cpp::handle_pool_release(const_cast<char *>(rmw_client->service_name));
       rmw_client->service_name = nullptr;
     }
-    rmw_client_free(rmw_client);
+    rmw_fastrtps_shared_cpp::handle_pool_release(rmw_client);
   }
 
   return nullptr;
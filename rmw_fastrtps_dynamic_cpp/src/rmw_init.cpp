@@ -115,8 +115,9 @@ rmw_shutdown(rmw_context_t * context)
     context->implementation_identifier,
     eprosima_fastrtps_identifier,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
-  // Nothing to do here for now.
-  // This is just the middleware's notification that shutdown was called.
+  // Arms fast teardown when requested; otherwise this is just the
+  // middleware's notification that shutdown was called.
+  rmw_fastrtps_shared_cpp::mark_context_shutdown(context);
   return RMW_RET_OK;
 }
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "fastcdr/FastBuffer.h"
+#include "fastcdr/exceptions/NotEnoughMemoryException.h"
 
 #include "rmw/error_handling.h"
 #include "rmw/serialized_message.h"
@@ -40,13 +41,39 @@ rmw_serialize(
     }
   }
 
+  // Retained lookup: the registry keeps the entry cached, so repeated
+  // (de)serialization of a type with no live endpoint does not rebuild the
+  // introspection type support on every call.
   TypeSupportRegistry & type_registry = TypeSupportRegistry::get_instance();
-  auto tss = type_registry.get_message_type_support(ts);
+  auto tss = type_registry.get_message_type_support_retained(ts);
+
+  // One pass when the message fits: run the introspection walk straight into
+  // the existing capacity and only fall back to the sizing walk below when
+  // the buffer overflows. A reused serialized message keeps its capacity
+  // across calls, so a steady stream of messages pays the estimate traversal
+  // at most once per size step instead of once per message.
+  if (serialized_message->buffer_capacity > 0) {
+    eprosima::fastcdr::FastBuffer buffer(
+      reinterpret_cast<char *>(serialized_message->buffer),
+      serialized_message->buffer_capacity);
+    eprosima::fastcdr::Cdr ser(
+      buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    try {
+      if (!tss->serializeROSmessage(ros_message, ser, ts->data)) {
+        return RMW_RET_ERROR;
+      }
+      serialized_message->buffer_length = ser.getSerializedDataLength();
+      return RMW_RET_OK;
+    } catch (const eprosima::fastcdr::exception::NotEnoughMemoryException &) {
+      // Did not fit; size it exactly and serialize again.
+    }
+  }
+
   auto data_length = tss->getEstimatedSerializedSize(ros_message, ts->data);
   if (serialized_message->buffer_capacity < data_length) {
     if (rmw_serialized_message_resize(serialized_message, data_length) != RMW_RET_OK) {
       RMW_SET_ERROR_MSG("unable to dynamically resize serialized message");
-      type_registry.return_message_type_support(ts);
       return RMW_RET_ERROR;
     }
   }
@@ -55,12 +82,12 @@ rmw_serialize(
     reinterpret_cast<char *>(serialized_message->buffer),
     data_length);
   eprosima::fastcdr::Cdr ser(
-    buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN, eprosima::fastcdr::Cdr::DDS_CDR);
+    buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+    eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->serializeROSmessage(ros_message, ser, ts->data);
   serialized_message->buffer_length = data_length;
   serialized_message->buffer_capacity = data_length;
-  type_registry.return_message_type_support(ts);
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
@@ -82,14 +109,13 @@ rmw_deserialize(
   }
 
   TypeSupportRegistry & type_registry = TypeSupportRegistry::get_instance();
-  auto tss = type_registry.get_message_type_support(ts);
+  auto tss = type_registry.get_message_type_support_retained(ts);
   eprosima::fastcdr::FastBuffer buffer(
     reinterpret_cast<char *>(serialized_message->buffer), serialized_message->buffer_length);
   eprosima::fastcdr::Cdr deser(buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
     eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->deserializeROSmessage(deser, ros_message, ts->data);
-  type_registry.return_message_type_support(ts);
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
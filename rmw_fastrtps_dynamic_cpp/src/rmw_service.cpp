@@ -30,6 +30,7 @@
 #include "rmw/allocators.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 #include "rosidl_typesupport_introspection_cpp/identifier.hpp"
@@ -38,6 +39,7 @@
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
@@ -135,41 +137,50 @@ rmw_create_service(
   info->request_type_support_impl_ = request_type_impl;
   info->response_type_support_impl_ = response_type_impl;
 
-  const void * untyped_request_members;
-  const void * untyped_response_members;
-
-  untyped_request_members =
-    get_request_ptr(type_support->data, info->typesupport_identifier_);
-  untyped_response_members = get_response_ptr(
-    type_support->data, info->typesupport_identifier_);
-
-  std::string request_type_name = _create_type_name(
-    untyped_request_members, info->typesupport_identifier_);
-  std::string response_type_name = _create_type_name(
-    untyped_response_members, info->typesupport_identifier_);
+  // Cached per service type in the registry; repeated service creation
+  // reuses the resolved member tables and mangled names.
+  const ServiceIntrospectionRecord * introspection =
+    type_registry.get_service_introspection(type_support);
+  if (!introspection) {
+    type_registry.return_request_type_support(type_support);
+    type_registry.return_response_type_support(type_support);
+    delete info;
+    return nullptr;
+  }
 
-  if (!Domain::getRegisteredType(
-      participant, request_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
-  {
-    info->request_type_support_ = new (std::nothrow) TypeSupportProxy(request_type_impl);
-    if (!info->request_type_support_) {
-      RMW_SET_ERROR_MSG("failed to allocate request TypeSupportProxy");
-      goto fail;
+  std::string request_type_name = introspection->request_type_name;
+  std::string response_type_name = introspection->response_type_name;
+
+  info->request_type_support_ = impl->find_registered_type(participant, request_type_name);
+  if (!info->request_type_support_) {
+    if (!Domain::getRegisteredType(
+        participant, request_type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->request_type_support_)))
+    {
+      info->request_type_support_ = new (std::nothrow) TypeSupportProxy(request_type_impl);
+      if (!info->request_type_support_) {
+        RMW_SET_ERROR_MSG("failed to allocate request TypeSupportProxy");
+        goto fail;
+      }
+      _register_type(participant, info->request_type_support_);
     }
-    _register_type(participant, info->request_type_support_);
+    impl->record_registered_type(participant, request_type_name, info->request_type_support_);
   }
 
-  if (!Domain::getRegisteredType(
-      participant, response_type_name.c_str(),
-      reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
-  {
-    info->response_type_support_ = new (std::nothrow) TypeSupportProxy(response_type_impl);
-    if (!info->response_type_support_) {
-      RMW_SET_ERROR_MSG("failed to allocate response TypeSupportProxy");
-      goto fail;
+  info->response_type_support_ = impl->find_registered_type(participant, response_type_name);
+  if (!info->response_type_support_) {
+    if (!Domain::getRegisteredType(
+        participant, response_type_name.c_str(),
+        reinterpret_cast<TopicDataType **>(&info->response_type_support_)))
+    {
+      info->response_type_support_ = new (std::nothrow) TypeSupportProxy(response_type_impl);
+      if (!info->response_type_support_) {
+        RMW_SET_ERROR_MSG("failed to allocate response TypeSupportProxy");
+        goto fail;
+      }
+      _register_type(participant, info->response_type_support_);
     }
-    _register_type(participant, info->response_type_support_);
+    impl->record_registered_type(participant, response_type_name, info->response_type_support_);
   }
 
   if (!impl->leave_middleware_default_qos) {
@@ -229,20 +240,19 @@ rmw_create_service(
     goto fail;
   }
 
-  rmw_service = rmw_service_allocate();
+  rmw_service = static_cast<rmw_service_t *>(
+    rmw_fastrtps_shared_cpp::handle_pool_allocate(sizeof(rmw_service_t)));
   if (!rmw_service) {
     RMW_SET_ERROR_MSG("failed to allocate memory for service");
     goto fail;
   }
   rmw_service->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_service->data = info;
-  rmw_service->service_name = reinterpret_cast<const char *>(
-    rmw_allocate(strlen(service_name) + 1));
+  rmw_service->service_name = rmw_fastrtps_shared_cpp::handle_pool_copy_string(service_name);
   if (!rmw_service->service_name) {
     RMW_SET_ERROR_MSG("failed to allocate memory for service name");
     goto fail;
   }
-  memcpy(const_cast<char *>(rmw_service->service_name), service_name, strlen(service_name) + 1);
 
   {
     // Update graph
@@ -259,11 +269,8 @@ rmw_create_service(
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.associate_writer(
       gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      eprosima_fastrtps_identifier,
-      common_context->pub,
-      static_cast<void *>(&msg),
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      eprosima_fastrtps_identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       goto fail;
     }
@@ -314,10 +321,10 @@ fail:
   }
 
   if (rmw_service && rmw_service->service_name) {
-    rmw_free(const_cast<char *>(rmw_service->service_name));
+    rmw_fastrtps_shared_cpp::handle_pool_release(const_cast<char *>(rmw_service->service_name));
     rmw_service->service_name = nullptr;
   }
-  rmw_service_free(rmw_service);
+  rmw_fastrtps_shared_cpp::handle_pool_release(rmw_service);
 
   return nullptr;
 }
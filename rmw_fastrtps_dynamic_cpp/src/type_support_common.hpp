@@ -15,8 +15,10 @@
 #ifndef TYPE_SUPPORT_COMMON_HPP_
 #define TYPE_SUPPORT_COMMON_HPP_
 
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include "fastrtps/Domain.h"
 #include "fastrtps/participant/Participant.h"
@@ -26,6 +28,7 @@
 #include "rmw/error_handling.h"
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/type_name_compaction.hpp"
 
 #include "rmw_fastrtps_dynamic_cpp/MessageTypeSupport.hpp"
 #include "rmw_fastrtps_dynamic_cpp/ServiceTypeSupport.hpp"
@@ -83,16 +86,28 @@ _create_type_name(
     return "";
   }
 
-  std::ostringstream ss;
-  std::string message_namespace(members->message_namespace_);
-  // Find and replace C namespace separator with C++, in case this is using C typesupport
-  message_namespace = rcpputils::find_and_replace(message_namespace, "__", "::");
-  std::string message_name(members->message_name_);
-  if (!message_namespace.empty()) {
-    ss << message_namespace << "::";
+  // Interned per member table: repeated entity creation for the same type
+  // reuses the mangled name rather than rebuilding it each time.
+  static std::mutex cache_mutex;
+  static std::unordered_map<const MembersType *, std::string> cache;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  std::string & name = cache[members];
+  if (name.empty()) {
+    std::ostringstream ss;
+    std::string message_namespace(members->message_namespace_);
+    // Find and replace C namespace separator with C++, in case this is using C typesupport
+    message_namespace = rcpputils::find_and_replace(message_namespace, "__", "::");
+    std::string message_name(members->message_name_);
+    if (!message_namespace.empty()) {
+      ss << message_namespace << "::";
+    }
+    ss << "dds_::" << message_name << "_";
+    // Same hashing hook as the static package; a no-op unless
+    // RMW_FASTRTPS_COMPACT_TYPE_NAMES is set.
+    name = rmw_fastrtps_shared_cpp::compact_type_name(ss.str());
   }
-  ss << "dds_::" << message_name << "_";
-  return ss.str();
+  return name;
 }
 
 ROSIDL_TYPESUPPORT_INTROSPECTION_CPP_LOCAL
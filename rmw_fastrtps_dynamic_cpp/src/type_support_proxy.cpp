@@ -17,31 +17,54 @@
 namespace rmw_fastrtps_dynamic_cpp
 {
 
+using TypeSupport_c = TypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
+using TypeSupport_cpp = TypeSupport<rosidl_typesupport_introspection_cpp::MessageMembers>;
+
 TypeSupportProxy::TypeSupportProxy(rmw_fastrtps_shared_cpp::TypeSupport * inner_type)
 {
   setName(inner_type->getName());
   m_typeSize = inner_type->m_typeSize;
+  // One RTTI query at endpoint creation; the per-message forwarding below
+  // static-casts on kind_ and calls the final methods, which devirtualizes
+  // the inner dispatch.
+  kind_ = (nullptr != dynamic_cast<const TypeSupport_c *>(inner_type)) ?
+    Kind::INTROSPECTION_C : Kind::INTROSPECTION_CPP;
 }
 
 size_t TypeSupportProxy::getEstimatedSerializedSize(
   const void * ros_message, const void * impl) const
 {
   auto type_impl = static_cast<const rmw_fastrtps_shared_cpp::TypeSupport *>(impl);
-  return type_impl->getEstimatedSerializedSize(ros_message, impl);
+  if (Kind::INTROSPECTION_C == kind_) {
+    return static_cast<const TypeSupport_c *>(type_impl)->getEstimatedSerializedSize(
+      ros_message, impl);
+  }
+  return static_cast<const TypeSupport_cpp *>(type_impl)->getEstimatedSerializedSize(
+    ros_message, impl);
 }
 
 bool TypeSupportProxy::serializeROSmessage(
   const void * ros_message, eprosima::fastcdr::Cdr & ser, const void * impl) const
 {
   auto type_impl = static_cast<const rmw_fastrtps_shared_cpp::TypeSupport *>(impl);
-  return type_impl->serializeROSmessage(ros_message, ser, impl);
+  if (Kind::INTROSPECTION_C == kind_) {
+    return static_cast<const TypeSupport_c *>(type_impl)->serializeROSmessage(
+      ros_message, ser, impl);
+  }
+  return static_cast<const TypeSupport_cpp *>(type_impl)->serializeROSmessage(
+    ros_message, ser, impl);
 }
 
 bool TypeSupportProxy::deserializeROSmessage(
   eprosima::fastcdr::Cdr & deser, void * ros_message, const void * impl) const
 {
   auto type_impl = static_cast<const rmw_fastrtps_shared_cpp::TypeSupport *>(impl);
-  return type_impl->deserializeROSmessage(deser, ros_message, impl);
+  if (Kind::INTROSPECTION_C == kind_) {
+    return static_cast<const TypeSupport_c *>(type_impl)->deserializeROSmessage(
+      deser, ros_message, impl);
+  }
+  return static_cast<const TypeSupport_cpp *>(type_impl)->deserializeROSmessage(
+    deser, ros_message, impl);
 }
 
 }  // namespace rmw_fastrtps_dynamic_cpp
@@ -16,13 +16,17 @@
 
 #include "rmw/error_handling.h"
 
+#include <utility>
+
+#include "client_service_common.hpp"
 #include "type_support_common.hpp"
 #include "type_support_registry.hpp"
 
-template<typename key_type, typename map_type, typename creator>
+template<typename key_type, typename sharded_map_type, typename creator>
 type_support_ptr get_type_support(
-  const key_type & ros_type_support, map_type & map, creator fun)
+  const key_type & ros_type_support, sharded_map_type & sharded_map, creator fun)
 {
+  auto & map = sharded_map.shard_for(ros_type_support);
   std::lock_guard<std::mutex> guard(map.getMutex());
   RefCountedTypeSupport & item = map()[ros_type_support];
   if (0 == item.ref_count++) {
@@ -35,10 +39,33 @@ type_support_ptr get_type_support(
   return item.type_support;
 }
 
-template<typename key_type, typename map_type>
+template<typename key_type, typename sharded_map_type, typename creator>
+type_support_ptr get_type_support_retained(
+  const key_type & ros_type_support, sharded_map_type & sharded_map, creator fun)
+{
+  auto & map = sharded_map.shard_for(ros_type_support);
+  std::lock_guard<std::mutex> guard(map.getMutex());
+  RefCountedTypeSupport & item = map()[ros_type_support];
+  if (!item.retained) {
+    // The registry's own reference pins the entry; endpoints of the type
+    // come and go underneath it without triggering the delete-on-zero path.
+    if (0 == item.ref_count++) {
+      item.type_support = fun();
+      if (!item.type_support) {
+        map().erase(ros_type_support);
+        return nullptr;
+      }
+    }
+    item.retained = true;
+  }
+  return item.type_support;
+}
+
+template<typename key_type, typename sharded_map_type>
 void return_type_support(
-  const key_type & ros_type_support, map_type & map)
+  const key_type & ros_type_support, sharded_map_type & sharded_map)
 {
+  auto & map = sharded_map.shard_for(ros_type_support);
   std::lock_guard<std::mutex> guard(map.getMutex());
   auto it = map().find(ros_type_support);
   assert(it != map().end());
@@ -48,18 +75,20 @@ void return_type_support(
   }
 }
 
-template<typename map_type>
-void cleanup(map_type & map, const char * msg)
+template<typename sharded_map_type>
+void cleanup(sharded_map_type & sharded_map, const char * msg)
 {
-  std::lock_guard<std::mutex> guard(map.getMutex());
-  if (!map().empty()) {
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_fastrtps_dynamic_cpp",
-      "TypeSupportRegistry %s is not empty. Cleaning it up...", msg);
-    for (auto it : map() ) {
-      delete it.second.type_support;
+  for (auto & map : sharded_map.shards) {
+    std::lock_guard<std::mutex> guard(map.getMutex());
+    if (!map().empty()) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        "rmw_fastrtps_dynamic_cpp",
+        "TypeSupportRegistry %s is not empty. Cleaning it up...", msg);
+      for (auto it : map() ) {
+        delete it.second.type_support;
+      }
+      map().clear();
     }
-    map().clear();
   }
 }
 
@@ -76,27 +105,71 @@ TypeSupportRegistry & TypeSupportRegistry::get_instance()
   return type_registry_instance;
 }
 
+static type_support_ptr make_message_type_support(
+  const rosidl_message_type_support_t * ros_type_support)
+{
+  if (using_introspection_c_typesupport(ros_type_support->typesupport_identifier)) {
+    auto members = static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(
+      ros_type_support->data);
+    return new MessageTypeSupport_c(members, ros_type_support);
+  } else if (using_introspection_cpp_typesupport(ros_type_support->typesupport_identifier)) {
+    auto members = static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(
+      ros_type_support->data);
+    return new MessageTypeSupport_cpp(members, ros_type_support);
+  }
+  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
+  return nullptr;
+}
+
 type_support_ptr TypeSupportRegistry::get_message_type_support(
   const rosidl_message_type_support_t * ros_type_support)
 {
   auto creator_fun = [&ros_type_support]() -> type_support_ptr
     {
-      if (using_introspection_c_typesupport(ros_type_support->typesupport_identifier)) {
-        auto members = static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(
-          ros_type_support->data);
-        return new MessageTypeSupport_c(members, ros_type_support);
-      } else if (using_introspection_cpp_typesupport(ros_type_support->typesupport_identifier)) {
-        auto members = static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(
-          ros_type_support->data);
-        return new MessageTypeSupport_cpp(members, ros_type_support);
-      }
-      RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-      return nullptr;
+      return make_message_type_support(ros_type_support);
     };
 
   return get_type_support(ros_type_support, message_types_, creator_fun);
 }
 
+type_support_ptr TypeSupportRegistry::get_message_type_support_retained(
+  const rosidl_message_type_support_t * ros_type_support)
+{
+  auto creator_fun = [&ros_type_support]() -> type_support_ptr
+    {
+      return make_message_type_support(ros_type_support);
+    };
+
+  return get_type_support_retained(ros_type_support, message_types_, creator_fun);
+}
+
+const ServiceIntrospectionRecord * TypeSupportRegistry::get_service_introspection(
+  const rosidl_service_type_support_t * ros_type_support)
+{
+  auto & map = service_records_.shard_for(ros_type_support);
+  std::lock_guard<std::mutex> guard(map.getMutex());
+  auto it = map().find(ros_type_support);
+  if (it != map().end()) {
+    return &it->second;
+  }
+  const char * identifier = ros_type_support->typesupport_identifier;
+  ServiceIntrospectionRecord record;
+  record.request_members = get_request_ptr(ros_type_support->data, identifier);
+  record.response_members = get_response_ptr(ros_type_support->data, identifier);
+  if (!record.request_members || !record.response_members) {
+    // The lookup already set the rmw error.
+    return nullptr;
+  }
+  record.request_type_name = _create_type_name(record.request_members, identifier);
+  record.response_type_name = _create_type_name(record.response_members, identifier);
+  if (record.request_type_name.empty() || record.response_type_name.empty()) {
+    return nullptr;
+  }
+  // Node storage keeps the record's address stable across rehashes, so the
+  // pointer can be handed out past the lock.
+  return &map().emplace(ros_type_support, std::move(record)).first->second;
+}
+
 type_support_ptr TypeSupportRegistry::get_request_type_support(
   const rosidl_service_type_support_t * ros_type_support)
 {
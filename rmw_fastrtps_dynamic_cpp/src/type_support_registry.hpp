@@ -15,6 +15,8 @@
 #ifndef TYPE_SUPPORT_REGISTRY_HPP_
 #define TYPE_SUPPORT_REGISTRY_HPP_
 
+#include <cstdint>
+#include <string>
 #include <unordered_map>
 
 #include "rmw/rmw.h"
@@ -33,17 +35,62 @@ struct RefCountedTypeSupport
 {
   type_support_ptr type_support = nullptr;
   uint32_t ref_count = 0;
+  // The registry itself holds one of the references: the entry outlives the
+  // endpoints of its type and is reclaimed at registry destruction. Used by
+  // the per-call serialization entry points.
+  bool retained = false;
 };
 
 using msg_map_t = std::unordered_map<const rosidl_message_type_support_t *, RefCountedTypeSupport>;
 using srv_map_t = std::unordered_map<const rosidl_service_type_support_t *, RefCountedTypeSupport>;
 
+/**
+ * Introspection facts of a service, resolved once and reused by every
+ * client and service of the type: the request/response member tables and
+ * their mangled type names.
+ */
+struct ServiceIntrospectionRecord
+{
+  const void * request_members = nullptr;
+  const void * response_members = nullptr;
+  std::string request_type_name;
+  std::string response_type_name;
+};
+
+using srv_record_map_t =
+  std::unordered_map<const rosidl_service_type_support_t *, ServiceIntrospectionRecord>;
+
+/**
+ * A type registry map split into independently locked shards, selected by the
+ * type support pointer. Lookups for different types mostly hit different
+ * shards, so creating many publishers in parallel at startup no longer
+ * serializes on a single registry mutex. Every lookup mutates a reference
+ * count, so each access is a write and a per-shard lock is the lightest
+ * correct protection.
+ */
+template<typename map_t>
+struct ShardedTypeMap
+{
+  static constexpr size_t kShardCount = 16;
+
+  LockedObject<map_t> shards[kShardCount];
+
+  template<typename key_type>
+  LockedObject<map_t> & shard_for(const key_type * key)
+  {
+    // The low pointer bits are alignment artifacts; skip them when picking
+    // a shard.
+    return shards[(reinterpret_cast<uintptr_t>(key) >> 4) % kShardCount];
+  }
+};
+
 class TypeSupportRegistry
 {
 private:
-  LockedObject<msg_map_t> message_types_;
-  LockedObject<srv_map_t> request_types_;
-  LockedObject<srv_map_t> response_types_;
+  ShardedTypeMap<msg_map_t> message_types_;
+  ShardedTypeMap<srv_map_t> request_types_;
+  ShardedTypeMap<srv_map_t> response_types_;
+  ShardedTypeMap<srv_record_map_t> service_records_;
 
   TypeSupportRegistry() = default;
 
@@ -55,6 +102,26 @@ public:
   type_support_ptr get_message_type_support(
     const rosidl_message_type_support_t * ros_type_support);
 
+  /// Like get_message_type_support, but the reference is retained by the
+  /// registry itself and must not be returned: the entry stays cached for
+  /// the lifetime of the process. For the per-call users (rmw_serialize,
+  /// rmw_deserialize), which would otherwise rebuild the introspection
+  /// type support on every call once no endpoint of the type is alive.
+  type_support_ptr get_message_type_support_retained(
+    const rosidl_message_type_support_t * ros_type_support);
+
+  /// The cached introspection record of a service type support.
+  /**
+   * Resolved on first sight and immutable afterwards, so the returned
+   * pointer stays valid for the rest of the process; there is no return
+   * counterpart. Transient clients created in a loop pay the member table
+   * and type name derivation once per type rather than once per client.
+   * Returns nullptr (with the rmw error set) for an unknown typesupport
+   * identifier.
+   */
+  const ServiceIntrospectionRecord * get_service_introspection(
+    const rosidl_service_type_support_t * ros_type_support);
+
   type_support_ptr get_request_type_support(
     const rosidl_service_type_support_t * ros_type_support);
 
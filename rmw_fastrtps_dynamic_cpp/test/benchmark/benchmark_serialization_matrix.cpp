@@ -0,0 +1,207 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "rcutils/allocator.h"
+
+#include "rmw/rmw.h"
+#include "rmw/serialized_message.h"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/multi_nested.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+#include "test_msgs/msg/w_strings.hpp"
+
+// Serialization matrix for the introspection typesupport. The cases and
+// counters are kept byte-for-byte identical to the matrix shipped with
+// rmw_fastrtps_cpp; since a process links exactly one rmw implementation,
+// comparing the two targets' JSON output is how the cost of walking
+// introspection members at runtime versus compiled callbacks is measured.
+
+// Counts C++ heap allocations per operation by replacing global operator
+// new. The introspection walk allocates per member in several paths, which
+// is a large part of the gap this matrix exists to expose; rcutils buffers
+// use malloc directly and are not counted.
+namespace
+{
+std::atomic<uint64_t> g_allocation_count{0};
+}  // namespace
+
+void * operator new(std::size_t size)
+{
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void * ptr = std::malloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+
+template<typename MessageT>
+const rosidl_message_type_support_t *
+message_type_support()
+{
+  return rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>();
+}
+
+test_msgs::msg::BasicTypes
+make_small_pod()
+{
+  test_msgs::msg::BasicTypes message;
+  message.bool_value = true;
+  message.int32_value = -42;
+  message.uint64_value = 0x0123456789abcdefull;
+  message.float64_value = 3.14159;
+  return message;
+}
+
+test_msgs::msg::UnboundedSequences
+make_large_arrays()
+{
+  test_msgs::msg::UnboundedSequences message;
+  message.uint8_values.resize(16384, 0x2a);
+  message.int32_values.resize(4096, -7);
+  message.float64_values.resize(4096, 3.14159);
+  return message;
+}
+
+test_msgs::msg::MultiNested
+make_nested_sequences()
+{
+  test_msgs::msg::MultiNested message;
+  message.unbounded_sequence_of_unbounded_sequences.resize(8);
+  for (auto & inner : message.unbounded_sequence_of_unbounded_sequences) {
+    inner.int32_values.resize(32, 1);
+    inner.string_values.resize(4, "nested payload string");
+  }
+  return message;
+}
+
+test_msgs::msg::WStrings
+make_wide_strings()
+{
+  test_msgs::msg::WStrings message;
+  message.wstring_value.resize(128, u'w');
+  message.unbounded_sequence_of_wstrings.resize(64);
+  for (auto & value : message.unbounded_sequence_of_wstrings) {
+    value.resize(128, u'w');
+  }
+  return message;
+}
+
+template<typename MessageT>
+void
+run_serialize(benchmark::State & st, const MessageT & message)
+{
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+  if (RMW_RET_OK != rmw_serialized_message_init(&serialized, 0u, &allocator)) {
+    st.SkipWithError("failed to init serialized message");
+    return;
+  }
+  const uint64_t allocations_before = g_allocation_count.load(std::memory_order_relaxed);
+  for (auto _ : st) {
+    (void)_;
+    if (RMW_RET_OK != rmw_serialize(&message, message_type_support<MessageT>(), &serialized)) {
+      st.SkipWithError("failed to serialize message");
+      break;
+    }
+  }
+  const uint64_t allocations_after = g_allocation_count.load(std::memory_order_relaxed);
+  st.counters["bytes"] = static_cast<double>(serialized.buffer_length);
+  st.counters["allocs_per_op"] =
+    static_cast<double>(allocations_after - allocations_before) /
+    static_cast<double>(st.iterations());
+  rmw_serialized_message_fini(&serialized);
+}
+
+template<typename MessageT>
+void
+run_deserialize(benchmark::State & st, const MessageT & message)
+{
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+  if (RMW_RET_OK != rmw_serialized_message_init(&serialized, 0u, &allocator)) {
+    st.SkipWithError("failed to init serialized message");
+    return;
+  }
+  if (RMW_RET_OK != rmw_serialize(&message, message_type_support<MessageT>(), &serialized)) {
+    st.SkipWithError("failed to serialize message");
+    rmw_serialized_message_fini(&serialized);
+    return;
+  }
+  // The output message is reused so steady-state deserialization is
+  // measured, not per-message construction.
+  MessageT output;
+  const uint64_t allocations_before = g_allocation_count.load(std::memory_order_relaxed);
+  for (auto _ : st) {
+    (void)_;
+    if (RMW_RET_OK != rmw_deserialize(&serialized, message_type_support<MessageT>(), &output)) {
+      st.SkipWithError("failed to deserialize message");
+      break;
+    }
+  }
+  const uint64_t allocations_after = g_allocation_count.load(std::memory_order_relaxed);
+  st.counters["bytes"] = static_cast<double>(serialized.buffer_length);
+  st.counters["allocs_per_op"] =
+    static_cast<double>(allocations_after - allocations_before) /
+    static_cast<double>(st.iterations());
+  rmw_serialized_message_fini(&serialized);
+}
+
+void serialize_small_pod(benchmark::State & st) {run_serialize(st, make_small_pod());}
+void serialize_large_arrays(benchmark::State & st) {run_serialize(st, make_large_arrays());}
+void serialize_nested_sequences(benchmark::State & st) {run_serialize(st, make_nested_sequences());}
+void serialize_wide_strings(benchmark::State & st) {run_serialize(st, make_wide_strings());}
+void deserialize_small_pod(benchmark::State & st) {run_deserialize(st, make_small_pod());}
+void deserialize_large_arrays(benchmark::State & st) {run_deserialize(st, make_large_arrays());}
+void deserialize_nested_sequences(benchmark::State & st)
+{
+  run_deserialize(st, make_nested_sequences());
+}
+void deserialize_wide_strings(benchmark::State & st) {run_deserialize(st, make_wide_strings());}
+
+BENCHMARK(serialize_small_pod);
+BENCHMARK(serialize_large_arrays);
+BENCHMARK(serialize_nested_sequences);
+BENCHMARK(serialize_wide_strings);
+BENCHMARK(deserialize_small_pod);
+BENCHMARK(deserialize_large_arrays);
+BENCHMARK(deserialize_nested_sequences);
+BENCHMARK(deserialize_wide_strings);
+
+}  // namespace
+
+BENCHMARK_MAIN();
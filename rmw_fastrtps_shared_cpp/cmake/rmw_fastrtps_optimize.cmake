@@ -0,0 +1,108 @@
+# Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Link-time and profile-guided optimization for the rmw_fastrtps libraries.
+#
+# The hot publish/take path crosses library boundaries (rmw_fastrtps_cpp ->
+# rmw_fastrtps_shared_cpp) with virtual dispatch through TypeSupport, which
+# ordinary per-TU optimization cannot see across. LTO recovers most of that;
+# PGO additionally lets the compiler lay out the branchy QoS and wait-set
+# code for the trained workload.
+#
+# Options (all off by default, orthogonal to the other RMW_FASTRTPS_*
+# options):
+#
+#   RMW_FASTRTPS_ENABLE_LTO
+#     ThinLTO with Clang, classic LTO with GCC. Applied per target, not
+#     globally, so dependent packages opt in independently.
+#
+#   RMW_FASTRTPS_PGO_GENERATE
+#     Build instrumented; running any workload (the benchmark suite under
+#     rmw_fastrtps_cpp/test/benchmark is the intended trainer) drops raw
+#     profiles into RMW_FASTRTPS_PGO_DIR.
+#
+#   RMW_FASTRTPS_PGO_USE
+#     Path to the trained profile: for Clang a merged .profdata file
+#     (llvm-profdata merge -output=rmw.profdata ${RMW_FASTRTPS_PGO_DIR}/*),
+#     for GCC the RMW_FASTRTPS_PGO_DIR of the training build. Combine with
+#     RMW_FASTRTPS_ENABLE_LTO for the full optimized configuration.
+#
+# Typical flow:
+#   1. configure with -DRMW_FASTRTPS_PGO_GENERATE=ON, build, run benchmarks
+#   2. merge profiles (Clang only)
+#   3. reconfigure with -DRMW_FASTRTPS_ENABLE_LTO=ON
+#      -DRMW_FASTRTPS_PGO_USE=<profile>, rebuild
+
+# The module is included both by rmw_fastrtps_shared_cpp itself and through
+# the package's extras file by every dependent; define everything once.
+if(COMMAND rmw_fastrtps_optimize_target)
+  return()
+endif()
+
+option(RMW_FASTRTPS_ENABLE_LTO
+  "Build the rmw_fastrtps libraries with (Thin)LTO" OFF)
+option(RMW_FASTRTPS_PGO_GENERATE
+  "Build the rmw_fastrtps libraries instrumented for PGO training" OFF)
+set(RMW_FASTRTPS_PGO_DIR "${CMAKE_BINARY_DIR}/rmw_fastrtps_pgo" CACHE PATH
+  "Directory raw PGO training profiles are written to")
+set(RMW_FASTRTPS_PGO_USE "" CACHE PATH
+  "Trained PGO profile to optimize with (.profdata file for Clang, profile directory for GCC)")
+
+if(RMW_FASTRTPS_PGO_GENERATE AND RMW_FASTRTPS_PGO_USE)
+  message(FATAL_ERROR
+    "RMW_FASTRTPS_PGO_GENERATE and RMW_FASTRTPS_PGO_USE are mutually exclusive")
+endif()
+
+# Applies the configured LTO/PGO flags to one library target. A no-op when
+# every option is off or the compiler is neither GCC nor Clang; flags go on
+# both the compile and the link line because the optimization happens at
+# link time.
+function(rmw_fastrtps_optimize_target target)
+  if(NOT (CMAKE_COMPILER_IS_GNUCXX OR CMAKE_CXX_COMPILER_ID MATCHES "Clang"))
+    if(RMW_FASTRTPS_ENABLE_LTO OR RMW_FASTRTPS_PGO_GENERATE OR RMW_FASTRTPS_PGO_USE)
+      message(WARNING
+        "rmw_fastrtps LTO/PGO options are only supported with GCC or Clang; "
+        "ignored for ${target}")
+    endif()
+    return()
+  endif()
+
+  set(flags "")
+  if(RMW_FASTRTPS_ENABLE_LTO)
+    if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+      list(APPEND flags "-flto=thin")
+    else()
+      list(APPEND flags "-flto")
+    endif()
+  endif()
+  if(RMW_FASTRTPS_PGO_GENERATE)
+    list(APPEND flags "-fprofile-generate=${RMW_FASTRTPS_PGO_DIR}")
+  elseif(RMW_FASTRTPS_PGO_USE)
+    list(APPEND flags "-fprofile-use=${RMW_FASTRTPS_PGO_USE}")
+    if(CMAKE_COMPILER_IS_GNUCXX)
+      # Tolerates the small counter skew the multithreaded benchmarks leave
+      # behind instead of failing the build.
+      list(APPEND flags "-fprofile-correction")
+    endif()
+  endif()
+  if(NOT flags)
+    return()
+  endif()
+
+  target_compile_options(${target} PRIVATE ${flags})
+  # LINK_FLAGS rather than target_link_options to stay within the
+  # cmake_minimum_required of these packages.
+  string(REPLACE ";" " " link_flags "${flags}")
+  set_property(TARGET ${target} APPEND_STRING PROPERTY LINK_FLAGS " ${link_flags}")
+endfunction()
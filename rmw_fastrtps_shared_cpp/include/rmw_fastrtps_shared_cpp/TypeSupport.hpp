@@ -20,22 +20,157 @@
 
 #include <fastcdr/FastBuffer.h>
 #include <fastcdr/Cdr.h>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <utility>
 
 #include "rcutils/logging_macros.h"
 
+#include "rmw/serialized_message.h"
+
 #include "./visibility_control.h"
 
 namespace rmw_fastrtps_shared_cpp
 {
 
-// Publishers write method will receive a pointer to this struct
+/// Stream endianness the serialization paths write with.
+/**
+ * Normally the machine's native order, resolved by fastcdr at run time.
+ * Building with RMW_FASTRTPS_ASSUME_LITTLE_ENDIAN pins it at compile time
+ * instead: the encapsulation byte becomes a constant and fastcdr's
+ * swap-bytes flag is provably false wherever the stream order is visible to
+ * the compiler, which is what lets its bulk primitive array writes lower to
+ * plain memcpy. The wire format does not change - CDR_LE is what
+ * little-endian hosts emit anyway - and reception still honors the
+ * encapsulation header of whatever arrives, so interoperability is
+ * unaffected. A build on a big-endian host is rejected outright rather than
+ * silently swapping every field.
+ */
+#ifdef RMW_FASTRTPS_ASSUME_LITTLE_ENDIAN
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "RMW_FASTRTPS_ASSUME_LITTLE_ENDIAN requires a little-endian host"
+#endif
+constexpr eprosima::fastcdr::Cdr::Endianness kSerializationEndianness =
+  eprosima::fastcdr::Cdr::LITTLE_ENDIANNESS;
+#else
+const eprosima::fastcdr::Cdr::Endianness kSerializationEndianness =
+  eprosima::fastcdr::Cdr::DEFAULT_ENDIAN;
+#endif
+
+/// Predicate over one sample's serialized payload, including the 4 byte CDR
+/// encapsulation header. Returning false drops the sample before any of it
+/// is deserialized.
+using SerializedDataFilter = std::function<bool (const uint8_t * buffer, uint32_t length)>;
+
+// Publishers' write and subscribers' take methods receive a pointer to this
+// struct; type says what data points to and how the payload is moved.
 struct SerializedData
 {
-  bool is_cdr_buffer;  // Whether next field is a pointer to a Cdr or to a plain ros message
+  enum Type
+  {
+    // data is a plain ros message, serialized with the typesupport in impl
+    ROS_MESSAGE,
+    // data is an eprosima::fastcdr::Cdr holding already serialized bytes
+    CDR_BUFFER,
+    // data is an eprosima::fastcdr::FastBuffer the payload is copied into
+    FAST_BUFFER,
+    // data is an rmw_serialized_message_t resized and filled in place, so a
+    // serialized take needs no intermediate buffer
+    SERIALIZED_MESSAGE,
+    // data is unused; the sample is consumed from the history without being
+    // copied or decoded. Used to skip stale samples in take-newest mode.
+    DISCARD
+  };
+
+  Type type;
   void * data;
-  const void * impl;   // RMW implementation specific data
+  const void * impl;   // RMW implementation specific data, only used for ROS_MESSAGE
+  // Optional content filter applied to ROS_MESSAGE takes before
+  // deserialization; unfiltered paths leave it null.
+  const SerializedDataFilter * filter{nullptr};
+  // Output: payload length of the taken sample, filled on FAST_BUFFER takes
+  // where the buffer itself only records its capacity.
+  uint32_t taken_length{0};
+  // Compress the serialized bytes before they enter the writer's history
+  // (EndpointOptions::compress_payloads); write paths only. Takes always
+  // detect compressed payloads by their frame, never through this flag.
+  bool compress{false};
+};
+
+/// Plain copy of a type's allocation counters.
+struct AllocationStatisticsSnapshot
+{
+  /// Scratch buffers handed out through createData().
+  uint64_t buffers_acquired;
+  /// Buffers currently outstanding (acquired minus released).
+  uint64_t buffers_outstanding;
+  /// Times a buffer had to grow because a payload exceeded its capacity;
+  /// a steadily climbing count points at a type with unbounded sequences
+  /// churning the allocator.
+  uint64_t buffer_growths;
+  /// Bytes allocated by those growths.
+  uint64_t bytes_grown;
+  /// Largest single payload seen for this type.
+  uint64_t payload_high_water_mark;
+};
+
+/// Allocation counters for one registered type, accumulated with relaxed
+/// atomics so recording never serializes concurrent traffic.
+class AllocationStatistics
+{
+public:
+  void
+  record_acquire()
+  {
+    acquired_.fetch_add(1, std::memory_order_relaxed);
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void
+  record_release()
+  {
+    outstanding_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void
+  record_growth(uint64_t bytes)
+  {
+    growths_.fetch_add(1, std::memory_order_relaxed);
+    bytes_grown_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void
+  record_payload(uint64_t bytes)
+  {
+    uint64_t seen = payload_high_water_mark_.load(std::memory_order_relaxed);
+    while (bytes > seen &&
+      !payload_high_water_mark_.compare_exchange_weak(
+        seen, bytes, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  AllocationStatisticsSnapshot
+  snapshot() const
+  {
+    AllocationStatisticsSnapshot out;
+    out.buffers_acquired = acquired_.load(std::memory_order_relaxed);
+    out.buffers_outstanding = outstanding_.load(std::memory_order_relaxed);
+    out.buffer_growths = growths_.load(std::memory_order_relaxed);
+    out.bytes_grown = bytes_grown_.load(std::memory_order_relaxed);
+    out.payload_high_water_mark = payload_high_water_mark_.load(std::memory_order_relaxed);
+    return out;
+  }
+
+private:
+  std::atomic<uint64_t> acquired_{0};
+  std::atomic<uint64_t> outstanding_{0};
+  std::atomic<uint64_t> growths_{0};
+  std::atomic<uint64_t> bytes_grown_{0};
+  std::atomic<uint64_t> payload_high_water_mark_{0};
 };
 
 class TypeSupport : public eprosima::fastrtps::TopicDataType
@@ -53,11 +188,18 @@ public:
   bool getKey(
     void * data,
     eprosima::fastrtps::rtps::InstanceHandle_t * ihandle,
-    bool force_md5 = false) override
-  {
-    (void)data; (void)ihandle; (void)force_md5;
-    return false;
-  }
+    bool force_md5 = false) override;
+
+  /// Extracts the 16 byte instance key from a ros message; fields longer
+  /// than 16 bytes must be hashed by the extractor itself, mirroring the
+  /// DDS md5 rule. Returning false publishes the sample without a key.
+  using KeyExtractor = std::function<bool (const void * ros_message, uint8_t key_value[16])>;
+
+  /// Install the key extractor keyed endpoints of this type use; an empty
+  /// function reverts the type to unkeyed. The type is registered once per
+  /// participant, so the extractor is shared by all its endpoints there.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void set_key_extractor(KeyExtractor key_extractor);
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   bool serialize(void * data, eprosima::fastrtps::rtps::SerializedPayload_t * payload) override;
@@ -74,6 +216,21 @@ public:
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   void deleteData(void * data) override;
 
+  /// Raise the serialized-size estimate history payloads are preallocated
+  /// with; values at or below the current estimate are ignored, so it only
+  /// ever grows. The type is registered once per participant and the estimate
+  /// is shared by every endpoint of the type on it.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void raise_payload_size_estimate(uint32_t payload_size);
+
+  /// Counters for this type's scratch buffers; covers the middleware-layer
+  /// FastBuffers, not allocations inside the generated message code.
+  AllocationStatisticsSnapshot
+  allocation_statistics() const
+  {
+    return allocation_statistics_.snapshot();
+  }
+
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   virtual ~TypeSupport() {}
 
@@ -82,6 +239,8 @@ protected:
   TypeSupport();
 
   bool max_size_bound_;
+  mutable AllocationStatistics allocation_statistics_;
+  KeyExtractor key_extractor_;
 };
 
 inline void
@@ -0,0 +1,139 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__CDR_FIELD_CURSOR_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__CDR_FIELD_CURSOR_HPP_
+
+#include <fastcdr/Cdr.h>
+#include <fastcdr/FastBuffer.h>
+#include <fastcdr/exceptions/Exception.h>
+
+#include <cstdint>
+#include <string>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Field-at-a-time reader over a taken CDR payload.
+/**
+ * Large messages whose consumers only need a few leading fields (the stamp
+ * of a 2 MB occupancy grid, say) don't have to pay a full
+ * deserializeROSmessage: take the sample with
+ * \ref __rmw_take_serialized_message, which copies the raw CDR exactly once
+ * and decodes nothing, then walk the fields you need with this cursor. The
+ * caller supplies the field order and widths from the message definition;
+ * the cursor handles the encapsulation header, endianness and CDR
+ * alignment, which is everything the wire format adds on top.
+ *
+ * The cursor borrows the buffer and never copies or allocates except for
+ * read_string. A read past the end of the buffer puts the cursor in the
+ * failed state; every later read fails too, so a sequence of reads only
+ * needs one valid() check at the end.
+ */
+class CdrFieldCursor
+{
+public:
+  /// Open a cursor over \p length bytes of CDR starting at \p buffer.
+  /**
+   * The buffer must stay alive and unchanged while the cursor reads from
+   * it. It must start with the 4 byte RTPS encapsulation header, which is
+   * how every payload this rmw takes comes off the wire.
+   */
+  CdrFieldCursor(const void * buffer, size_t length)
+  : fastbuffer_(
+      reinterpret_cast<char *>(const_cast<void *>(buffer)), length),
+    cdr_(fastbuffer_, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR),
+    valid_(nullptr != buffer)
+  {
+    if (valid_) {
+      try {
+        cdr_.read_encapsulation();
+      } catch (const eprosima::fastcdr::exception::Exception &) {
+        valid_ = false;
+      }
+    }
+  }
+
+  /// Whether every read so far succeeded.
+  bool valid() const {return valid_;}
+
+  bool read_bool(bool * value) {return read(value);}
+  bool read_uint8(uint8_t * value) {return read(value);}
+  bool read_int8(int8_t * value) {return read(value);}
+  bool read_uint16(uint16_t * value) {return read(value);}
+  bool read_int16(int16_t * value) {return read(value);}
+  bool read_uint32(uint32_t * value) {return read(value);}
+  bool read_int32(int32_t * value) {return read(value);}
+  bool read_uint64(uint64_t * value) {return read(value);}
+  bool read_int64(int64_t * value) {return read(value);}
+  bool read_float32(float * value) {return read(value);}
+  bool read_float64(double * value) {return read(value);}
+
+  /// Read a string field; the only read that allocates.
+  bool read_string(std::string * value) {return read(value);}
+
+  /// Read the element count of a sequence field; the elements follow and
+  /// can be read or skipped individually.
+  bool read_sequence_length(uint32_t * length) {return read(length);}
+
+  /// Skip a string field without copying it out.
+  bool skip_string()
+  {
+    uint32_t length = 0;
+    // The on-wire length includes the terminating null byte.
+    return read(&length) && skip_bytes(length);
+  }
+
+  /// Skip \p count bytes of already-aligned fixed-width data.
+  /**
+   * Skipping a field of alignment > 1 needs a read of its first element
+   * instead, since jumping does not realign the stream.
+   */
+  bool skip_bytes(size_t count)
+  {
+    if (!valid_) {
+      return false;
+    }
+    try {
+      cdr_.jump(count);
+    } catch (const eprosima::fastcdr::exception::Exception &) {
+      valid_ = false;
+    }
+    return valid_;
+  }
+
+private:
+  template<typename T>
+  bool read(T * value)
+  {
+    if (!valid_) {
+      return false;
+    }
+    try {
+      cdr_ >> *value;
+    } catch (const eprosima::fastcdr::exception::Exception &) {
+      valid_ = false;
+    }
+    return valid_;
+  }
+
+  eprosima::fastcdr::FastBuffer fastbuffer_;
+  eprosima::fastcdr::Cdr cdr_;
+  bool valid_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__CDR_FIELD_CURSOR_HPP_
@@ -0,0 +1,78 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__CLIENT_ENDPOINT_POOL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__CLIENT_ENDPOINT_POOL_HPP_
+
+#include <string>
+
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Whether destroyed client endpoints are parked for reuse.
+/**
+ * Opt-in through RMW_FASTRTPS_REUSE_CLIENT_ENDPOINTS=1. Intended for
+ * processes that create and destroy short-lived clients of the same
+ * services: reviving a parked pair skips type registration, DDS endpoint
+ * creation and rediscovery, the dominant cost of a transient client.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+client_endpoint_pool_enabled();
+
+/// Take a parked client matching service name, type names and QoS.
+/**
+ * The revived endpoints are still matched from their previous life, so the
+ * new client is usable immediately. Any response that arrived while parked
+ * is dropped before the client is handed back.
+ *
+ * \return The parked CustomClientInfo, or nullptr on a miss (the caller
+ *   then creates the endpoints from scratch).
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+CustomClientInfo *
+client_endpoint_pool_take(
+  const void * graph_key,
+  const char * service_name,
+  const std::string & request_type_name,
+  const std::string & response_type_name,
+  const rmw_qos_profile_t & qos);
+
+/// Park a destroyed client's endpoints instead of tearing them down.
+/**
+ * \return true when the pair was parked; false when the pool is disabled,
+ *   full, or the client is not poolable (see CustomClientInfo::poolable_),
+ *   in which case the caller destroys the endpoints as usual.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+client_endpoint_pool_park(
+  const void * graph_key,
+  const char * service_name,
+  CustomClientInfo * info);
+
+/// Tear down everything parked for `graph_key` at context shutdown.
+/** Must run while the context's participant is still alive. */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+client_endpoint_pool_drain(const void * graph_key);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__CLIENT_ENDPOINT_POOL_HPP_
@@ -17,12 +17,13 @@
 
 #include <atomic>
 #include <condition_variable>
-#include <list>
+#include <functional>
 #include <memory>
 #include <mutex>
-#include <set>
+#include <unordered_set>
 #include <utility>
 
+#include "fastcdr/Cdr.h"
 #include "fastcdr/FastBuffer.h"
 
 #include "fastrtps/subscriber/SampleInfo.h"
@@ -34,12 +35,46 @@
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/guid_utils.hpp"
+#include "rmw_fastrtps_shared_cpp/mpsc_queue.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_slot.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/waitset_event_fd.hpp"
 
 class ClientListener;
 class ClientPubListener;
 
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Callbacks for the direct-dispatch client response mode.
+/**
+ * All three callables run on the middleware reception thread, so they must
+ * not block and must not call back into the same client.
+ */
+struct ClientResponseDispatch
+{
+  /// Hands out a ros response to deserialize into, or null when the caller's
+  /// pool is exhausted; the response then goes through the normal wait set
+  /// path.
+  std::function<void * ()> borrow_response;
+  /// Takes back a borrowed response that could not be filled.
+  std::function<void (void * ros_response)> return_response;
+  /// Receives every dispatched response together with ownership of the
+  /// borrowed storage. The header carries the same fields a take fills: the
+  /// request sequence number and both timestamps.
+  std::function<void (void * ros_response, const rmw_service_info_t * response_header)>
+  on_response;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
 typedef struct CustomClientInfo
+  : public rmw_fastrtps_shared_cpp::PooledAllocated
 {
   rmw_fastrtps_shared_cpp::TypeSupport * request_type_support_;
   const void * request_type_support_impl_;
@@ -54,21 +89,44 @@ typedef struct CustomClientInfo
   ClientPubListener * pub_listener_;
   std::atomic_size_t response_subscriber_matched_count_;
   std::atomic_size_t request_publisher_matched_count_;
+  // Prebuilt write dispatch for __rmw_send_request: everything but the ros
+  // message pointer is fixed for the life of the client, so a send stamps
+  // one pointer into a copy instead of rebuilding the struct.
+  rmw_fastrtps_shared_cpp::SerializedData request_data_template_{};
+  // QoS the endpoints were created with; lets the client endpoint pool check
+  // that a parked pair is compatible before reviving it.
+  rmw_qos_profile_t qos_profile_;
+  // Set by implementations whose type support objects outlive the client;
+  // only then is the endpoint pair safe to park in the client endpoint pool.
+  // The introspection-based implementation refcounts its type supports per
+  // client and must not set it.
+  bool poolable_{false};
+  // Signalled by the listeners whenever either matched count changes, so a
+  // caller can block until the server shows up instead of polling.
+  std::mutex matched_mutex_;
+  std::condition_variable matched_cv_;
+  // Optional direct-dispatch callbacks for responses; swapped with
+  // std::atomic_load / std::atomic_store like the subscription dispatch. The
+  // listener's cheap enabled flag keeps the per-response path from loading
+  // this shared_ptr while the mode is off.
+  std::shared_ptr<const rmw_fastrtps_shared_cpp::ClientResponseDispatch> response_dispatch_;
 } CustomClientInfo;
 
 typedef struct CustomClientResponse
 {
   eprosima::fastrtps::rtps::SampleIdentity sample_identity_;
-  std::unique_ptr<eprosima::fastcdr::FastBuffer> buffer_;
+  rmw_fastrtps_shared_cpp::PooledFastBufferPtr buffer_;
   eprosima::fastrtps::SampleInfo_t sample_info_ {};
 } CustomClientResponse;
 
-class ClientListener : public eprosima::fastrtps::SubscriberListener
+class ClientListener
+  : public eprosima::fastrtps::SubscriberListener,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
 public:
   explicit ClientListener(CustomClientInfo * info)
-  : info_(info), list_has_data_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+  : info_(info),
+    conditionMutex_(nullptr), conditionVariable_(nullptr), conditionReady_(nullptr) {}
 
 
   void
@@ -76,57 +134,87 @@ public:
   {
     assert(sub);
 
-    CustomClientResponse response;
-    // Todo(sloretz) eliminate heap allocation pending eprosima/Fast-CDR#19
-    response.buffer_.reset(new eprosima::fastcdr::FastBuffer());
+    // Take into the listener-owned scratch buffer first. The related GUID is
+    // only available once takeNextData has filled the sample info, and on a
+    // shared response topic most samples answer some other client's request;
+    // those are consumed right here without touching the pool, the queue or
+    // the wait set. Only the reception thread uses the scratch.
+    if (!scratch_buffer_) {
+      scratch_buffer_.reset(rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+    }
 
     rmw_fastrtps_shared_cpp::SerializedData data;
-    data.is_cdr_buffer = true;
-    data.data = response.buffer_.get();
-    data.impl = nullptr;    // not used when is_cdr_buffer is true
-    if (sub->takeNextData(&data, &response.sample_info_)) {
-      if (eprosima::fastrtps::rtps::ALIVE == response.sample_info_.sampleKind) {
-        response.sample_identity_ = response.sample_info_.related_sample_identity;
-
-        if (response.sample_identity_.writer_guid() == info_->writer_guid_) {
-          std::lock_guard<std::mutex> lock(internalMutex_);
-
-          if (conditionMutex_ != nullptr) {
-            std::unique_lock<std::mutex> clock(*conditionMutex_);
-            list.emplace_back(std::move(response));
-            // the change to list_has_data_ needs to be mutually exclusive with
-            // rmw_wait() which checks hasData() and decides if wait() needs to
-            // be called
-            list_has_data_.store(true);
-            clock.unlock();
-            conditionVariable_->notify_one();
-          } else {
-            list.emplace_back(std::move(response));
-            list_has_data_.store(true);
-          }
-        }
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
+    data.data = scratch_buffer_.get();
+    data.impl = nullptr;    // not used when type is FAST_BUFFER
+
+    eprosima::fastrtps::SampleInfo_t sample_info;
+    if (!sub->takeNextData(&data, &sample_info)) {
+      return;
+    }
+    if (eprosima::fastrtps::rtps::ALIVE != sample_info.sampleKind) {
+      return;
+    }
+    if (sample_info.related_sample_identity.writer_guid() != info_->writer_guid_) {
+      // Not ours; the scratch buffer is simply reused for the next sample.
+      return;
+    }
+
+    // Ours: the response steals the scratch buffer, so the payload is never
+    // copied a second time; the next callback re-acquires from the pool.
+    CustomClientResponse response;
+    response.buffer_ = std::move(scratch_buffer_);
+    response.sample_info_ = sample_info;
+    response.sample_identity_ = sample_info.related_sample_identity;
+
+    if (response_dispatch_enabled_.load(std::memory_order_relaxed) &&
+      dispatchResponse(response))
+    {
+      // Handed straight to the caller's callback; nothing to wake up.
+      return;
+    }
+    // The queue is lock-free, so the push happens before the wait-set
+    // handshake; a waiter that scans concurrently simply sees the data.
+    queue_.push(std::move(response));
+
+    std::lock_guard<std::mutex> lock(internalMutex_);
+
+    if (conditionMutex_ != nullptr) {
+      // Bit before flag: a waiter woken through the flag finds it set.
+      ready_slot_.mark();
+      // Before the suppression below: fd consumers never clear the flag.
+      rmw_fastrtps_shared_cpp::waitset_eventfd_signal(event_fd_);
+      if (nullptr != conditionReady_ && conditionReady_->exchange(true)) {
+        // An unconsumed wakeup is already pending; the waiter clears the
+        // flag before scanning and will observe the pushed response.
+        return;
+      }
+      // The empty critical section pairs with the waiter's predicate
+      // check, so the waiter is either before the check, and sees the
+      // data, or already waiting, and receives the notification.
+      {
+        std::lock_guard<std::mutex> clock(*conditionMutex_);
       }
+      conditionVariable_->notify_one();
     }
   }
 
   bool
   getResponse(CustomClientResponse & response)
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
-
-    if (conditionMutex_ != nullptr) {
-      std::unique_lock<std::mutex> clock(*conditionMutex_);
-      return popResponse(response);
-    }
-    return popResponse(response);
+    return queue_.pop(response);
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    std::atomic_bool * conditionReady)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    conditionReady_ = conditionReady;
   }
 
   void
@@ -135,12 +223,41 @@ public:
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    conditionReady_ = nullptr;
+    event_fd_ = -1;
+  }
+
+  void
+  setReadySlot(const rmw_fastrtps_shared_cpp::ReadySlot & slot)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    ready_slot_ = slot;
+  }
+
+  void
+  setEventFd(int event_fd)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    event_fd_ = event_fd;
   }
 
   bool
   hasData()
   {
-    return list_has_data_.load();
+    return !queue_.empty();
+  }
+
+  /// Drop the queue's parked-node cache; see __rmw_client_trim.
+  void
+  trimNodeCache()
+  {
+    queue_.trim_cache();
+  }
+
+  void
+  setResponseDispatchEnabled(bool enabled)
+  {
+    response_dispatch_enabled_.store(enabled, std::memory_order_relaxed);
   }
 
   void onSubscriptionMatched(
@@ -159,30 +276,99 @@ public:
       return;
     }
     info_->response_subscriber_matched_count_.store(publishers_.size());
+    {
+      std::lock_guard<std::mutex> lock(info_->matched_mutex_);
+    }
+    info_->matched_cv_.notify_all();
   }
 
 private:
-  bool popResponse(CustomClientResponse & response) RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  /// Deserialize and hand a response to the installed dispatch callbacks.
+  /**
+   * Runs on the reception thread. Returns false when no dispatch is
+   * installed, the borrow pool is exhausted or deserialization fails; the
+   * response then travels the normal queue and wait set path.
+   */
+  bool
+  dispatchResponse(CustomClientResponse & response)
   {
-    if (!list.empty()) {
-      response = std::move(list.front());
-      list.pop_front();
-      list_has_data_.store(!list.empty());
-      return true;
+    auto dispatch = std::atomic_load(&info_->response_dispatch_);
+    if (!dispatch) {
+      // The dispatch was cleared between the enabled check and this load.
+      return false;
+    }
+    void * ros_response = dispatch->borrow_response();
+    if (nullptr == ros_response) {
+      return false;
     }
-    return false;
-  };
+    eprosima::fastcdr::Cdr deser(
+      *response.buffer_,
+      eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    if (!info_->response_type_support_->deserializeROSmessage(
+        deser, ros_response, info_->response_type_support_impl_))
+    {
+      dispatch->return_response(ros_response);
+      return false;
+    }
+    // Same fields a take fills; the writer guid is this client's own and is
+    // not reported there either.
+    rmw_service_info_t response_header{};
+    response_header.source_timestamp = response.sample_info_.sourceTimestamp.to_ns();
+    response_header.received_timestamp = response.sample_info_.receptionTimestamp.to_ns();
+    response_header.request_id.sequence_number =
+      (static_cast<int64_t>(response.sample_identity_.sequence_number().high) << 32) |
+      response.sample_identity_.sequence_number().low;
+    dispatch->on_response(ros_response, &response_header);
+    return true;
+  }
 
   CustomClientInfo * info_;
   std::mutex internalMutex_;
-  std::list<CustomClientResponse> list RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::atomic_bool list_has_data_;
+  // Pushed from the Fast-RTPS reception threads, popped by the single thread
+  // taking responses; neither path contends on a mutex or the allocator.
+  rmw_fastrtps_shared_cpp::MpscQueue<CustomClientResponse> queue_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::set<eprosima::fastrtps::rtps::GUID_t> publishers_;
+  std::atomic_bool * conditionReady_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadySlot ready_slot_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Wait-set eventfd, part of the attachment like the pointers above.
+  int event_fd_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_) {-1};
+  // Cheap gate checked on every response before the dispatch shared_ptr is
+  // even loaded; raised and lowered by __rmw_client_set_response_dispatch.
+  std::atomic_bool response_dispatch_enabled_{false};
+  // Take target reused across callbacks; only touched by the reception
+  // thread. Responses for other clients never leave it, so they cost no
+  // pool traffic, and a matching response steals it instead of re-copying.
+  rmw_fastrtps_shared_cpp::PooledFastBufferPtr scratch_buffer_;
+  std::unordered_set<eprosima::fastrtps::rtps::GUID_t,
+    rmw_fastrtps_shared_cpp::FastrtpsGuidHash> publishers_;
 };
 
-class ClientPubListener : public eprosima::fastrtps::PublisherListener
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Install or clear direct dispatch of responses on a client.
+/**
+ * With direct dispatch installed, incoming responses are deserialized and
+ * handed to `on_response` straight from the reception callback, skipping the
+ * wait set wakeup, executor scheduling and the separate take. The wait set
+ * is only signalled when `borrow_response` returns null, which leaves that
+ * response to the normal path. A dispatch with all three callables empty
+ * clears the mode.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_client_set_response_dispatch(
+  const char * identifier,
+  const rmw_client_t * client,
+  ClientResponseDispatch dispatch);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+class ClientPubListener
+  : public eprosima::fastrtps::PublisherListener,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
 public:
   explicit ClientPubListener(CustomClientInfo * info)
@@ -206,11 +392,16 @@ public:
       return;
     }
     info_->request_publisher_matched_count_.store(subscriptions_.size());
+    {
+      std::lock_guard<std::mutex> lock(info_->matched_mutex_);
+    }
+    info_->matched_cv_.notify_all();
   }
 
 private:
   CustomClientInfo * info_;
-  std::set<eprosima::fastrtps::rtps::GUID_t> subscriptions_;
+  std::unordered_set<eprosima::fastrtps::rtps::GUID_t,
+    rmw_fastrtps_shared_cpp::FastrtpsGuidHash> subscriptions_;
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_CLIENT_INFO_HPP_
@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -32,24 +33,78 @@
 #include "fastrtps/publisher/PublisherListener.h"
 
 #include "rmw/event.h"
+#include "rmw/types.h"
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 
-class EventListenerInterface
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Implementation-specific event type: a subscription's unread backlog
+/// crossed its configured high watermark
+/// (see __rmw_subscription_set_backlog_watermark). The value sits well above
+/// the standard rmw event types so upstream additions cannot collide with
+/// it, while still fitting the 32 bit masks built with event_bit().
+constexpr rmw_event_type_t RMW_FASTRTPS_EVENT_BACKLOG = static_cast<rmw_event_type_t>(24);
+
+/// Status payload for RMW_FASTRTPS_EVENT_BACKLOG.
+struct BacklogStatus
+{
+  /// Unread samples at the moment of the last crossing.
+  uint64_t unread_count;
+  /// Times the backlog crossed the watermark from below.
+  uint32_t total_count;
+  /// Crossings since the status was last taken.
+  uint32_t total_count_change;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+/// Snapshot of every QoS event status an entity can raise.
+/**
+ * Only the members whose bits are set in the mask returned by
+ * EventListenerInterface::takeAllEvents hold meaningful data; an entity
+ * fills either the reader pair or the writer pair, never both.
+ */
+struct TakenEventStatuses
 {
-protected:
-  class ConditionalScopedLock;
+  rmw_liveliness_changed_status_t liveliness_changed;
+  rmw_requested_deadline_missed_status_t requested_deadline_missed;
+  rmw_liveliness_lost_status_t liveliness_lost;
+  rmw_offered_deadline_missed_status_t offered_deadline_missed;
+  // Only subscriptions with a configured watermark ever raise this one.
+  rmw_fastrtps_shared_cpp::BacklogStatus backlog;
+};
 
+class EventListenerInterface
+{
 public:
+  /// Bit used for an event type in the raised-event masks.
+  static constexpr uint32_t event_bit(rmw_event_type_t event_type)
+  {
+    return 1u << static_cast<uint32_t>(event_type);
+  }
+
   /// Connect a condition variable so a waiter can be notified of new data.
+  /**
+    * \param conditionReady Wait-set level flag raised together with every
+    *   notification, letting the waiter validate a wakeup in O(1) instead of
+    *   rescanning every attached entity.
+    */
   virtual void attachCondition(
     std::mutex * conditionMutex,
-    std::condition_variable * conditionVariable) = 0;
+    std::condition_variable * conditionVariable,
+    std::atomic_bool * conditionReady) = 0;
 
   /// Unset the information from attachCondition.
   virtual void detachCondition() = 0;
 
+  /// Set the wait set's exported eventfd, signaled with every notification
+  /// (see __rmw_wait_set_get_file_descriptor); -1 clears it, as does
+  /// detachCondition.
+  virtual void setEventFd(int event_fd) = 0;
+
   /// Check if there is new data available for a specific event type.
   /**
     * \param event_type The event type to check on.
@@ -65,34 +120,16 @@ public:
     * \return `false` if data was not available, in this case nothing was written to event_info.
     */
   virtual bool takeNextEvent(rmw_event_type_t event_type, void * event_info) = 0;
-};
-
-class EventListenerInterface::ConditionalScopedLock
-{
-public:
-  ConditionalScopedLock(
-    std::mutex * mutex,
-    std::condition_variable * condition_variable = nullptr)
-  : mutex_(mutex), cv_(condition_variable)
-  {
-    if (nullptr != mutex_) {
-      mutex_->lock();
-    }
-  }
 
-  ~ConditionalScopedLock()
-  {
-    if (nullptr != mutex_) {
-      mutex_->unlock();
-      if (nullptr != cv_) {
-        cv_->notify_all();
-      }
-    }
-  }
-
-private:
-  std::mutex * mutex_;
-  std::condition_variable * cv_;
+  /// Take every raised event in one call.
+  /**
+    * Drains all pending event statuses at once, so callers watching several
+    * event types pay one call instead of a check-and-take pair per type.
+    * \param statuses Filled for every taken event type.
+    * \return Bitmask of the taken event types, built with event_bit();
+    *   zero when nothing was raised.
+    */
+  virtual uint32_t takeAllEvents(TakenEventStatuses * statuses) = 0;
 };
 
 struct CustomEventInfo
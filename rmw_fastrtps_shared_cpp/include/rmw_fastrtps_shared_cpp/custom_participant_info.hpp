@@ -15,9 +15,14 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <mutex>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "fastrtps/rtps/common/InstanceHandle.h"
@@ -26,33 +31,112 @@
 #include "fastrtps/participant/ParticipantListener.h"
 
 #include "rcpputils/thread_safety_annotations.hpp"
+#include "rcutils/get_env.h"
 #include "rcutils/logging_macros.h"
 
-#include "rmw/impl/cpp/key_value.hpp"
 #include "rmw/qos_profiles.h"
 #include "rmw/rmw.h"
 
 #include "rmw_dds_common/context.hpp"
 
 #include "rmw_fastrtps_shared_cpp/create_rmw_gid.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_change_feed.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_snapshot.hpp"
+#include "rmw_fastrtps_shared_cpp/mpsc_queue.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/type_name_compaction.hpp"
 
 using rmw_dds_common::operator<<;
 
 class ParticipantListener;
 
+namespace rmw_fastrtps_shared_cpp
+{
+class TypeSupport;
+}  // namespace rmw_fastrtps_shared_cpp
+
 typedef struct CustomParticipantInfo
 {
   eprosima::fastrtps::Participant * participant;
   ::ParticipantListener * listener;
 
+  // Extra participants owned by this context when participant sharding is
+  // requested (RMW_FASTRTPS_PARTICIPANT_SHARDS). A single participant
+  // serializes all reception and discovery through its internal threads;
+  // spreading topic endpoints over several participants scales that work
+  // across cores. Empty unless sharding was requested. Only the primary
+  // participant carries the discovery listener: every participant of the
+  // process sees the same remote peers, so graph bookkeeping once is enough.
+  std::vector<eprosima::fastrtps::Participant *> shard_participants;
+
   // Flag to establish if the QoS of the participant,
   // its publishers and its subscribers are going
   // to be configured only from an XML file or if
   // their settings are going to be overwritten by code
   // with the default configuration.
   bool leave_middleware_default_qos;
+
+  /// Return the participant that endpoints of `topic_name` belong on.
+  /**
+   * With sharding disabled this is always the primary participant. With
+   * sharding enabled the (already mangled) topic name is hashed, so both
+   * directions of one topic within one process land on the same shard
+   * deterministically. Services and clients always live on the primary
+   * participant, keeping request/reply traffic on one set of threads.
+   */
+  eprosima::fastrtps::Participant *
+  participant_for_topic(const std::string & topic_name) const
+  {
+    if (shard_participants.empty()) {
+      return participant;
+    }
+    const size_t shard =
+      std::hash<std::string>()(topic_name) % (shard_participants.size() + 1u);
+    return 0u == shard ? participant : shard_participants[shard - 1u];
+  }
+
+  /// Return the type support registered on `on_participant` under
+  /// `type_name`, or nullptr if this rmw never registered it there.
+  /**
+   * Types are never unregistered, so a hit is valid for the participant's
+   * lifetime; repeat entity creations for the same type skip the name
+   * lookup inside Fast-RTPS entirely. Registrations are per participant,
+   * which matters once sharding puts more than one in play.
+   */
+  rmw_fastrtps_shared_cpp::TypeSupport *
+  find_registered_type(
+    const eprosima::fastrtps::Participant * on_participant,
+    const std::string & type_name) const
+  {
+    std::lock_guard<std::mutex> lock(registered_types_mutex_);
+    auto it = registered_types_.find(std::make_pair(on_participant, type_name));
+    return it == registered_types_.end() ? nullptr : it->second;
+  }
+
+  /// Record a type support as registered on `on_participant` under `type_name`.
+  void
+  record_registered_type(
+    const eprosima::fastrtps::Participant * on_participant,
+    const std::string & type_name,
+    rmw_fastrtps_shared_cpp::TypeSupport * type_support) const
+  {
+    std::lock_guard<std::mutex> lock(registered_types_mutex_);
+    registered_types_.emplace(std::make_pair(on_participant, type_name), type_support);
+  }
+
+private:
+  // mutable: the index is a cache, and the entity creation paths only hold
+  // a pointer-to-const participant info.
+  mutable std::mutex registered_types_mutex_;
+  // Every type name this rmw registered, keyed by the participant it was
+  // registered on. A few dozen entries at most; the win is skipping
+  // Domain::getRegisteredType per entity creation, which startup traces
+  // show on the cold-start path.
+  mutable std::map<
+    std::pair<const eprosima::fastrtps::Participant *, std::string>,
+    rmw_fastrtps_shared_cpp::TypeSupport *> registered_types_
+  RCPPUTILS_TSA_GUARDED_BY(registered_types_mutex_);
 } CustomParticipantInfo;
 
 class ParticipantListener : public eprosima::fastrtps::ParticipantListener
@@ -61,10 +145,58 @@ public:
   explicit ParticipantListener(
     const char * identifier,
     rmw_dds_common::Context * context)
-  : context(context),
+  : contexts_({context}),
     identifier_(identifier)
   {}
 
+  /// Attach another context to this listener.
+  /**
+   * Used when contexts share one participant: discovery callbacks are fanned
+   * out to the graph cache of every attached context. Fast-RTPS does not
+   * replay discovery data to a listener, so remote participants and endpoints
+   * discovered before the attach only become visible to the new context when
+   * they announce themselves again.
+   */
+  void add_context(rmw_dds_common::Context * context)
+  {
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    contexts_.push_back(context);
+  }
+
+  /// Detach a context; must be called before the context is destroyed.
+  void remove_context(rmw_dds_common::Context * context)
+  {
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    contexts_.erase(
+      std::remove(contexts_.begin(), contexts_.end(), context), contexts_.end());
+  }
+
+  /// Apply discovery events queued by the async graph mode.
+  /**
+   * With RMW_FASTRTPS_ASYNC_GRAPH=1 the Fast-RTPS discovery callbacks only
+   * enqueue; the listener thread calls this to fold the events into every
+   * attached context's graph cache. Without the mode the queue stays empty
+   * and the call returns immediately. Safe from any thread: concurrent
+   * drains (several contexts share one listener) serialize on the drain
+   * mutex, and the queue's producers never block.
+   */
+  void process_queued_discovery()
+  {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+    DiscoveryEvent event;
+    while (discovery_events_.pop(event)) {
+      std::lock_guard<std::mutex> lock(contexts_mutex_);
+      if (DiscoveryEvent::Kind::Participant == event.kind) {
+        apply_participant_locked(event.gid, event.name, event.is_alive);
+      } else {
+        apply_endpoint_locked(
+          event.gid, event.name.c_str(), event.type_name.c_str(),
+          event.participant_gid, event.qos_profile, event.is_reader,
+          event.is_alive);
+      }
+    }
+  }
+
   void onParticipantDiscovery(
     eprosima::fastrtps::Participant *,
     eprosima::fastrtps::rtps::ParticipantDiscoveryInfo && info) override
@@ -72,27 +204,47 @@ public:
     switch (info.status) {
       case eprosima::fastrtps::rtps::ParticipantDiscoveryInfo::DISCOVERED_PARTICIPANT:
         {
-          auto map = rmw::impl::cpp::parse_key_value(info.info.m_userData);
-          auto name_found = map.find("enclave");
+          // Scanned in place; parse_key_value built a map of vectors for
+          // every pair in the user data just to look up this one key.
+          size_t enclave_length = 0u;
+          const char * enclave_value =
+            find_user_data_value(info.info.m_userData, "enclave", &enclave_length);
 
-          if (name_found == map.end()) {
+          if (nullptr == enclave_value) {
             return;
           }
-          auto enclave =
-            std::string(name_found->second.begin(), name_found->second.end());
+          std::string enclave(enclave_value, enclave_length);
+          auto gid = rmw_fastrtps_shared_cpp::create_rmw_gid(identifier_, info.info.m_guid);
 
-          context->graph_cache.add_participant(
-            rmw_fastrtps_shared_cpp::create_rmw_gid(
-              identifier_, info.info.m_guid),
-            enclave);
+          if (async_graph_enabled()) {
+            DiscoveryEvent event;
+            event.kind = DiscoveryEvent::Kind::Participant;
+            event.is_alive = true;
+            event.gid = gid;
+            event.name = std::move(enclave);
+            enqueue_discovery(std::move(event));
+            return;
+          }
+          std::lock_guard<std::mutex> lock(contexts_mutex_);
+          apply_participant_locked(gid, enclave, true);
           break;
         }
       case eprosima::fastrtps::rtps::ParticipantDiscoveryInfo::REMOVED_PARTICIPANT:
       // fall through
       case eprosima::fastrtps::rtps::ParticipantDiscoveryInfo::DROPPED_PARTICIPANT:
-        context->graph_cache.remove_participant(
-          rmw_fastrtps_shared_cpp::create_rmw_gid(
-            identifier_, info.info.m_guid));
+        {
+          auto gid = rmw_fastrtps_shared_cpp::create_rmw_gid(identifier_, info.info.m_guid);
+          if (async_graph_enabled()) {
+            DiscoveryEvent event;
+            event.kind = DiscoveryEvent::Kind::Participant;
+            event.is_alive = false;
+            event.gid = gid;
+            enqueue_discovery(std::move(event));
+            return;
+          }
+          std::lock_guard<std::mutex> lock(contexts_mutex_);
+          apply_participant_locked(gid, std::string(), false);
+        }
         break;
       default:
         return;
@@ -122,37 +274,224 @@ public:
   }
 
 private:
-  template<class T>
-  void
-  process_discovery_info(T & proxyData, bool is_alive, bool is_reader)
+  /// Find `key=` in the ';' separated participant user data.
+  /**
+   * \return A pointer into the user data at the value, with `value_length`
+   *   set to its length, or nullptr when the key is absent. Nothing is
+   *   allocated or copied.
+   */
+  static const char *
+  find_user_data_value(
+    const std::vector<eprosima::fastrtps::rtps::octet> & user_data,
+    const char * key,
+    size_t * value_length)
+  {
+    const char * data = reinterpret_cast<const char *>(user_data.data());
+    const size_t size = user_data.size();
+    const size_t key_length = strlen(key);
+    size_t begin = 0;
+    while (begin < size) {
+      size_t end = begin;
+      while (end < size && ';' != data[end]) {
+        ++end;
+      }
+      if (end - begin > key_length &&
+        '=' == data[begin + key_length] &&
+        0 == memcmp(data + begin, key, key_length))
+      {
+        *value_length = end - begin - key_length - 1;
+        return data + begin + key_length + 1;
+      }
+      begin = end + 1;
+    }
+    return nullptr;
+  }
+
+  /// Return the interned copy of `name`, adding it on first sight.
+  /**
+   * The transparent comparator lets find() take the character array straight
+   * out of the proxy data, so re-announcements of known topic and type names
+   * allocate nothing. The set only ever holds names the graph cache holds
+   * too, so it does not meaningfully outgrow it.
+   */
+  const std::string &
+  intern(const char * name) RCPPUTILS_TSA_REQUIRES(contexts_mutex_)
+  {
+    auto it = interned_names_.find(name);
+    if (it == interned_names_.end()) {
+      it = interned_names_.emplace(name).first;
+    }
+    return *it;
+  }
+
+  /// One discovery callback's worth of graph work, deferred to the drain.
+  /**
+   * Everything the apply helpers need is extracted up front, so the
+   * discovery thread's remaining cost is two small string copies instead
+   * of the graph cache mutation. `name` holds the topic name for endpoint
+   * events and the enclave for participant events.
+   */
+  struct DiscoveryEvent
   {
+    enum class Kind
     {
-      if (is_alive) {
-        rmw_qos_profile_t qos_profile = rmw_qos_profile_unknown;
-        dds_qos_to_rmw_qos(proxyData.m_qos, &qos_profile);
+      Participant,
+      Endpoint,
+    };
+
+    Kind kind{Kind::Endpoint};
+    bool is_alive{false};
+    bool is_reader{false};
+    rmw_gid_t gid{};
+    rmw_gid_t participant_gid{};
+    std::string name;
+    std::string type_name;
+    rmw_qos_profile_t qos_profile = rmw_qos_profile_unknown;
+  };
+
+  /// Whether RMW_FASTRTPS_ASYNC_GRAPH=1 moved graph updates off the
+  /// discovery thread.
+  static bool
+  async_graph_enabled()
+  {
+    static const bool enabled = []() {
+        const char * env_value;
+        const char * error_str = rcutils_get_env("RMW_FASTRTPS_ASYNC_GRAPH", &env_value);
+        if (error_str != NULL) {
+          RCUTILS_LOG_DEBUG_NAMED(
+            "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+          return false;
+        }
+        return env_value != nullptr && strcmp(env_value, "1") == 0;
+      }();
+    return enabled;
+  }
+
+  /// Queue an event and wake the attached contexts' listener threads.
+  void
+  enqueue_discovery(DiscoveryEvent && event)
+  {
+    discovery_events_.push(std::move(event));
+    // A thread that is not running yet (lazy start) picks the backlog up
+    // when it first runs; until then graph queries see the cache as it was,
+    // the staleness the async mode trades for discovery-thread latency.
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    for (auto context : contexts_) {
+      if (context->thread_is_running.load() && context->listener_thread_gc) {
+        (void)rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
+          identifier_, context->listener_thread_gc);
+      }
+    }
+  }
+
+  void
+  apply_participant_locked(
+    const rmw_gid_t & gid, const std::string & enclave, bool is_alive)
+  RCPPUTILS_TSA_REQUIRES(contexts_mutex_)
+  {
+    if (is_alive) {
+      for (auto context : contexts_) {
+        context->graph_cache.add_participant(gid, enclave);
+        rmw_fastrtps_shared_cpp::graph_snapshot_record_participant(
+          context, gid, enclave);
+      }
+      return;
+    }
+    const std::string participant_key(
+      reinterpret_cast<const char *>(gid.data), RMW_GID_STORAGE_SIZE);
+    for (auto context : contexts_) {
+      context->graph_cache.remove_participant(gid);
+      // The vanished participant never retracts its node announcements;
+      // emit the removals from the feed's last known list.
+      rmw_fastrtps_shared_cpp::graph_change_feed_remove_participant(
+        context, participant_key);
+      rmw_fastrtps_shared_cpp::graph_snapshot_remove_participant(context, gid);
+    }
+  }
 
+  void
+  apply_endpoint_locked(
+    const rmw_gid_t & gid, const char * raw_topic_name, const char * raw_type_name,
+    const rmw_gid_t & participant_gid, const rmw_qos_profile_t & qos_profile,
+    bool is_reader, bool is_alive)
+  RCPPUTILS_TSA_REQUIRES(contexts_mutex_)
+  {
+    const std::string & topic_name = intern(raw_topic_name);
+    if (is_alive) {
+      // Hashed announcements from compact mode are resolved back to the
+      // full name before they reach the graph, so tooling is unaffected.
+      const std::string & type_name = intern(resolve_type_name(raw_type_name));
+      for (auto context : contexts_) {
         context->graph_cache.add_entity(
-          rmw_fastrtps_shared_cpp::create_rmw_gid(
-            identifier_,
-            proxyData.guid()),
-          proxyData.topicName().to_string(),
-          proxyData.typeName().to_string(),
-          rmw_fastrtps_shared_cpp::create_rmw_gid(
-            identifier_,
-            iHandle2GUID(proxyData.RTPSParticipantKey())),
+          gid,
+          topic_name,
+          type_name,
+          participant_gid,
           qos_profile,
           is_reader);
-      } else {
-        context->graph_cache.remove_entity(
-          rmw_fastrtps_shared_cpp::create_rmw_gid(
-            identifier_,
-            proxyData.guid()),
-          is_reader);
+        rmw_fastrtps_shared_cpp::graph_snapshot_record_endpoint(
+          context, gid, participant_gid, topic_name, type_name, qos_profile, is_reader);
+      }
+    } else {
+      for (auto context : contexts_) {
+        context->graph_cache.remove_entity(gid, is_reader);
+        rmw_fastrtps_shared_cpp::graph_snapshot_remove_endpoint(context, gid, is_reader);
       }
     }
+    for (auto context : contexts_) {
+      rmw_fastrtps_shared_cpp::graph_change_feed_push_endpoint(
+        context, is_alive, topic_name, is_reader);
+    }
+  }
+
+  template<class T>
+  void
+  process_discovery_info(T & proxyData, bool is_alive, bool is_reader)
+  {
+    auto gid = rmw_fastrtps_shared_cpp::create_rmw_gid(identifier_, proxyData.guid());
+    rmw_qos_profile_t qos_profile = rmw_qos_profile_unknown;
+    rmw_gid_t participant_gid{};
+    if (is_alive) {
+      dds_qos_to_rmw_qos(proxyData.m_qos, &qos_profile);
+      participant_gid = rmw_fastrtps_shared_cpp::create_rmw_gid(
+        identifier_, iHandle2GUID(proxyData.RTPSParticipantKey()));
+    }
+
+    if (async_graph_enabled()) {
+      DiscoveryEvent event;
+      event.kind = DiscoveryEvent::Kind::Endpoint;
+      event.is_alive = is_alive;
+      event.is_reader = is_reader;
+      event.gid = gid;
+      event.participant_gid = participant_gid;
+      event.name = proxyData.topicName().c_str();
+      if (is_alive) {
+        event.type_name = proxyData.typeName().c_str();
+      }
+      event.qos_profile = qos_profile;
+      enqueue_discovery(std::move(event));
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    apply_endpoint_locked(
+      gid, proxyData.topicName().c_str(),
+      is_alive ? proxyData.typeName().c_str() : "",
+      participant_gid, qos_profile, is_reader, is_alive);
   }
 
-  rmw_dds_common::Context * context;
+  std::mutex contexts_mutex_;
+  std::vector<rmw_dds_common::Context *> contexts_
+  RCPPUTILS_TSA_GUARDED_BY(contexts_mutex_);
+  // Every distinct topic and type name seen in discovery, so the endpoint
+  // path hands out references instead of building fresh std::strings per
+  // callback.
+  std::set<std::string, std::less<>> interned_names_
+  RCPPUTILS_TSA_GUARDED_BY(contexts_mutex_);
+  // Async graph mode: the discovery threads push, the listener threads pop
+  // under drain_mutex_ (the queue's consumer side is single-threaded).
+  rmw_fastrtps_shared_cpp::MpscQueue<DiscoveryEvent> discovery_events_;
+  std::mutex drain_mutex_;
   const char * const identifier_;
 };
 
@@ -15,47 +15,107 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_PUBLISHER_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_PUBLISHER_INFO_HPP_
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
-#include <set>
+#include <vector>
 
+#include "fastrtps/participant/Participant.h"
 #include "fastrtps/publisher/Publisher.h"
 #include "fastrtps/publisher/PublisherListener.h"
 
 #include "rcpputils/thread_safety_annotations.hpp"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
+#include "rmw_fastrtps_shared_cpp/entity_statistics.hpp"
+#include "rmw_fastrtps_shared_cpp/publish_pipeline.hpp"
 
 
 class PubListener;
 
-typedef struct CustomPublisherInfo : public CustomEventInfo
+typedef struct CustomPublisherInfo
+  : public CustomEventInfo,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
   virtual ~CustomPublisherInfo() = default;
 
   eprosima::fastrtps::Publisher * publisher_;
   PubListener * listener_;
+  // Participant the publisher and its type were created on; with sharding
+  // enabled this may be one of the context's shard participants.
+  eprosima::fastrtps::Participant * participant_{nullptr};
   rmw_fastrtps_shared_cpp::TypeSupport * type_support_;
   const void * type_support_impl_;
   rmw_gid_t publisher_gid;
   const char * typesupport_identifier_;
+  mutable rmw_fastrtps_shared_cpp::EntityStatistics statistics_;
+  // Publish-path timing stride (EndpointOptions::clock_sample_stride):
+  // clock reads for statistics_ happen on one publish in this many; the
+  // rest are recorded untimed. 1 times every publish.
+  uint32_t clock_sample_stride_{1};
+  // Rolling publish counter driving the stride; relaxed, a skewed sample
+  // choice under contention is harmless.
+  mutable std::atomic<uint32_t> clock_tick_{0};
+
+  /// Whether this publish should take the statistics clock reads.
+  bool
+  sample_clock_now() const
+  {
+    return 1u == clock_sample_stride_ ||
+           0 == clock_tick_.fetch_add(1, std::memory_order_relaxed) % clock_sample_stride_;
+  }
+
+  // Allows __rmw_publish to skip serialization and the RTPS write outright
+  // while no reader is matched. Set at creation, and only for best-effort
+  // volatile writers: nothing repairs or replays a skipped sample for them,
+  // so a reader that was not matched at publish time could never have
+  // received it anyway.
+  bool skip_unmatched_{false};
+
+  // Writes the writer rejected, in practice because the history was still
+  // full of unacknowledged samples when the reliability max blocking time
+  // ran out (EndpointOptions::max_blocking_ms; zero rejects immediately).
+  // Monotonic and relaxed: a diagnostic the application polls to see
+  // whether a slow subscriber is pushing back on this publisher.
+  mutable std::atomic<uint64_t> backpressure_count_{0};
+
+  // Wire compression (EndpointOptions::compress_payloads): the publish
+  // paths carry this into SerializedData::compress, and the type support
+  // compresses the payload as it enters the writer's history. Set at
+  // creation, never changed after.
+  bool compress_payloads_{false};
+
+  // Pipelined publishing (EndpointOptions::publish_pipeline_depth): when
+  // set, __rmw_publish serializes into the pipeline's slots and the RTPS
+  // send runs on its sender thread. Stopped explicitly in destroy_publisher,
+  // before the DDS writer is removed.
+  std::unique_ptr<rmw_fastrtps_shared_cpp::PublishPipeline> publish_pipeline_;
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   EventListenerInterface *
   getListener() const final;
 } CustomPublisherInfo;
 
-class PubListener : public EventListenerInterface, public eprosima::fastrtps::PublisherListener
+class PubListener
+  : public EventListenerInterface,
+  public eprosima::fastrtps::PublisherListener,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
 public:
   explicit PubListener(CustomPublisherInfo * info)
-  : deadline_changes_(false),
-    liveliness_changes_(false),
+  : event_changes_(0),
+    offered_deadline_total_count_(0),
+    offered_deadline_total_count_change_(0),
+    liveliness_lost_total_count_(0),
+    liveliness_lost_total_count_change_(0),
     conditionMutex_(nullptr),
-    conditionVariable_(nullptr)
+    conditionVariable_(nullptr),
+    conditionReady_(nullptr)
   {
     (void) info;
   }
@@ -68,11 +128,18 @@ public:
   {
     (void) pub;
     std::lock_guard<std::mutex> lock(internalMutex_);
+    auto it = std::lower_bound(
+      subscriptions_.begin(), subscriptions_.end(), info.remoteEndpointGuid);
     if (eprosima::fastrtps::rtps::MATCHED_MATCHING == info.status) {
-      subscriptions_.insert(info.remoteEndpointGuid);
+      if (it == subscriptions_.end() || *it != info.remoteEndpointGuid) {
+        subscriptions_.insert(it, info.remoteEndpointGuid);
+      }
     } else if (eprosima::fastrtps::rtps::REMOVED_MATCHING == info.status) {
-      subscriptions_.erase(info.remoteEndpointGuid);
+      if (it != subscriptions_.end() && *it == info.remoteEndpointGuid) {
+        subscriptions_.erase(it);
+      }
     }
+    subscription_count_.store(subscriptions_.size(), std::memory_order_relaxed);
   }
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
@@ -97,45 +164,79 @@ public:
   bool
   takeNextEvent(rmw_event_type_t event_type, void * event_info) final;
 
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  uint32_t
+  takeAllEvents(TakenEventStatuses * statuses) final;
+
   // PubListener API
   size_t subscriptionCount()
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
-    return subscriptions_.size();
+    return subscription_count_.load(std::memory_order_relaxed);
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    std::atomic_bool * conditionReady) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    conditionReady_ = conditionReady;
   }
 
   void
-  detachCondition()
+  detachCondition() final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    conditionReady_ = nullptr;
+    event_fd_ = -1;
   }
 
-private:
-  mutable std::mutex internalMutex_;
+  void
+  setEventFd(int event_fd) final
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    event_fd_ = event_fd;
+  }
 
-  std::set<eprosima::fastrtps::rtps::GUID_t> subscriptions_
-    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+private:
+  // Wait-set handshake shared by the event callbacks: the first signaler
+  // notifies, later ones find the flag still pending and return, so an event
+  // burst produces one wakeup per waiter scan.
+  void notify_waiter();
 
-  std::atomic_bool deadline_changes_;
-  eprosima::fastrtps::OfferedDeadlineMissedStatus offered_deadline_missed_status_
-    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  mutable std::mutex internalMutex_;
 
-  std::atomic_bool liveliness_changes_;
-  eprosima::fastrtps::LivelinessLostStatus liveliness_lost_status_
-    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // One bit per raised event type (see EventListenerInterface::event_bit),
+  // so an event check is a single relaxed load with no mutex.
+  std::atomic<uint32_t> event_changes_;
+  // Event statuses decomposed into atomics, mirroring SubListener: absolute
+  // values are stored, deltas accumulated, and the event takes consume them
+  // without touching internalMutex_, so status reads never contend with a
+  // matching callback holding it.
+  std::atomic<uint32_t> offered_deadline_total_count_;
+  std::atomic<uint32_t> offered_deadline_total_count_change_;
+  std::atomic<uint32_t> liveliness_lost_total_count_;
+  std::atomic<uint32_t> liveliness_lost_total_count_change_;
+
+  // Count mirror of the list below: a watchdog polling matched counts is a
+  // relaxed load away, regardless of matching activity.
+  std::atomic<size_t> subscription_count_{0};
 
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  std::atomic_bool * conditionReady_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Wait-set eventfd, part of the attachment like the pointers above.
+  int event_fd_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_) {-1};
+
+  // Sorted flat storage: matching storms insert and erase without per-event
+  // node allocations, and the atomic count above keeps queries wait-free.
+  std::vector<eprosima::fastrtps::rtps::GUID_t> subscriptions_
+    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_PUBLISHER_INFO_HPP_
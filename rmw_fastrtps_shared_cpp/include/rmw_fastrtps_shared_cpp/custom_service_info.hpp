@@ -15,10 +15,14 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <list>
+#include <cstring>
 #include <mutex>
+#include <thread>
+#include <utility>
 
 #include "fastcdr/FastBuffer.h"
 
@@ -31,11 +35,31 @@
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/entity_statistics.hpp"
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/mpsc_queue.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_slot.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/waitset_event_fd.hpp"
 
 class ServiceListener;
 
+/// One slot of the take-time reply identity cache (see CustomServiceInfo).
+struct PendingReply
+{
+  rmw_request_id_t request_id;
+  eprosima::fastrtps::rtps::SampleIdentity identity;
+  // When the request was taken; the reply path diffs against it for the
+  // handler-duration statistics.
+  std::chrono::steady_clock::time_point take_time;
+  bool valid{false};
+};
+
 typedef struct CustomServiceInfo
+  : public rmw_fastrtps_shared_cpp::PooledAllocated
 {
   rmw_fastrtps_shared_cpp::TypeSupport * request_type_support_;
   const void * request_type_support_impl_;
@@ -46,6 +70,101 @@ typedef struct CustomServiceInfo
   ServiceListener * listener_;
   eprosima::fastrtps::Participant * participant_;
   const char * typesupport_identifier_;
+  // Queue-residency and handler-duration histograms; the listener stamps
+  // requests on arrival and the take and response paths record the splits.
+  mutable rmw_fastrtps_shared_cpp::ServiceStatistics statistics_;
+
+  /// Remember a taken request's sample identity for the upcoming reply.
+  void
+  remember_pending_reply(
+    const eprosima::fastrtps::rtps::SampleIdentity & identity,
+    const rmw_request_id_t & request_id,
+    std::chrono::steady_clock::time_point take_time)
+  {
+    std::lock_guard<std::mutex> lock(pending_replies_mutex_);
+    PendingReply & slot = pending_replies_[next_pending_reply_];
+    next_pending_reply_ = (next_pending_reply_ + 1) % pending_replies_.size();
+    slot.request_id = request_id;
+    slot.identity = identity;
+    slot.take_time = take_time;
+    slot.valid = true;
+  }
+
+  /// Move the cached identity matching a reply header out of the cache.
+  /**
+   * \return true when the header matches a recently taken request and
+   *   `identity` was filled; false when it was never cached or already
+   *   evicted, in which case the caller rebuilds the identity from the
+   *   header bytes.
+   */
+  bool
+  take_pending_reply(
+    const rmw_request_id_t & request_id,
+    eprosima::fastrtps::rtps::SampleIdentity * identity,
+    std::chrono::steady_clock::time_point * take_time)
+  {
+    std::lock_guard<std::mutex> lock(pending_replies_mutex_);
+    for (PendingReply & slot : pending_replies_) {
+      if (slot.valid && slot.request_id.sequence_number == request_id.sequence_number &&
+        0 == memcmp(
+          slot.request_id.writer_guid, request_id.writer_guid,
+          sizeof(request_id.writer_guid)))
+      {
+        *identity = slot.identity;
+        *take_time = slot.take_time;
+        slot.valid = false;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Whether responses are being sent from more than one thread.
+  /**
+   * Called once per __rmw_send_response with the calling thread. The first
+   * sender is remembered; the first send from any other thread latches
+   * concurrent mode for the life of the service, which switches replies to
+   * pre-serializing outside the writer's lock. Single-threaded servers
+   * never pay for that path, and a worker pool pays the latch exactly one
+   * relaxed load per send after the first round.
+   */
+  bool
+  sending_concurrently()
+  {
+    if (concurrent_responses_.load(std::memory_order_relaxed)) {
+      return true;
+    }
+    const std::thread::id me = std::this_thread::get_id();
+    std::thread::id first = first_response_thread_.load(std::memory_order_relaxed);
+    if (std::thread::id() == first) {
+      if (first_response_thread_.compare_exchange_strong(
+          first, me, std::memory_order_relaxed))
+      {
+        return false;
+      }
+      // Lost the race; first now holds the winning thread's id.
+    }
+    if (first != me) {
+      concurrent_responses_.store(true, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+private:
+  // Thread-affinity latch behind sending_concurrently(). Relaxed is enough:
+  // a racy extra trip through the single-threaded path only delays the
+  // switch by one send, it never unlatches.
+  std::atomic<std::thread::id> first_response_thread_{};
+  std::atomic_bool concurrent_responses_{false};
+
+  // Fixed-capacity ring: a server answering promptly always hits it, while a
+  // backlog deeper than the ring merely evicts the oldest entries and those
+  // replies fall back to rebuilding the identity. No allocation either way.
+  std::mutex pending_replies_mutex_;
+  std::array<PendingReply, 16> pending_replies_
+  RCPPUTILS_TSA_GUARDED_BY(pending_replies_mutex_);
+  size_t next_pending_reply_ RCPPUTILS_TSA_GUARDED_BY(pending_replies_mutex_) {0};
 } CustomServiceInfo;
 
 typedef struct CustomServiceRequest
@@ -53,17 +172,21 @@ typedef struct CustomServiceRequest
   eprosima::fastrtps::rtps::SampleIdentity sample_identity_;
   eprosima::fastcdr::FastBuffer * buffer_;
   eprosima::fastrtps::SampleInfo_t sample_info_ {};
+  // Stamped in the listener callback when the request enters the queue.
+  std::chrono::steady_clock::time_point enqueue_time_ {};
 
   CustomServiceRequest()
   : buffer_(nullptr) {}
 } CustomServiceRequest;
 
-class ServiceListener : public eprosima::fastrtps::SubscriberListener
+class ServiceListener
+  : public eprosima::fastrtps::SubscriberListener,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
 public:
   explicit ServiceListener(CustomServiceInfo * info)
-  : info_(info), list_has_data_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr)
+  : info_(info),
+    conditionMutex_(nullptr), conditionVariable_(nullptr), conditionReady_(nullptr)
   {
     (void)info_;
   }
@@ -75,65 +198,119 @@ public:
     assert(sub);
 
     CustomServiceRequest request;
-    request.buffer_ = new eprosima::fastcdr::FastBuffer();
+    request.buffer_ = rmw_fastrtps_shared_cpp::FastBufferPool::acquire();
 
     rmw_fastrtps_shared_cpp::SerializedData data;
-    data.is_cdr_buffer = true;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
     data.data = request.buffer_;
-    data.impl = nullptr;    // not used when is_cdr_buffer is true
+    data.impl = nullptr;    // not used when type is FAST_BUFFER
     if (sub->takeNextData(&data, &request.sample_info_)) {
       if (eprosima::fastrtps::rtps::ALIVE == request.sample_info_.sampleKind) {
         request.sample_identity_ = request.sample_info_.sample_identity;
 
+        // Admission control: when the server has fallen this far behind,
+        // the arriving request is shed right here, before it costs a queue
+        // node or a wait-set wakeup. Requests that expire while queued are
+        // shed at take time instead.
+        const size_t max_depth = max_queue_depth_.load(std::memory_order_relaxed);
+        if (max_depth > 0u && queue_depth_.load(std::memory_order_relaxed) >= max_depth) {
+          shed_count_.fetch_add(1, std::memory_order_relaxed);
+          rmw_fastrtps_shared_cpp::FastBufferPool::release(request.buffer_);
+          return;
+        }
+        queue_depth_.fetch_add(1, std::memory_order_relaxed);
+        request.enqueue_time_ = std::chrono::steady_clock::now();
+
+        // The queue is lock-free, so the push happens before the wait-set
+        // handshake; a waiter that scans concurrently simply sees the data.
+        queue_.push(std::move(request));
+
         std::lock_guard<std::mutex> lock(internalMutex_);
 
         if (conditionMutex_ != nullptr) {
-          std::unique_lock<std::mutex> clock(*conditionMutex_);
-          list.push_back(request);
-          // the change to list_has_data_ needs to be mutually exclusive with
-          // rmw_wait() which checks hasData() and decides if wait() needs to
-          // be called
-          list_has_data_.store(true);
-          clock.unlock();
+          // Bit before flag: a waiter woken through the flag finds it set.
+          ready_slot_.mark();
+          // Before the suppression below: fd consumers never clear the flag.
+          rmw_fastrtps_shared_cpp::waitset_eventfd_signal(event_fd_);
+          if (nullptr != conditionReady_ && conditionReady_->exchange(true)) {
+            // An unconsumed wakeup is already pending; the waiter clears the
+            // flag before scanning and will observe the pushed request.
+            return;
+          }
+          // The empty critical section pairs with the waiter's predicate
+          // check, so the waiter is either before the check, and sees the
+          // data, or already waiting, and receives the notification.
+          {
+            std::lock_guard<std::mutex> clock(*conditionMutex_);
+          }
           conditionVariable_->notify_one();
-        } else {
-          list.push_back(request);
-          list_has_data_.store(true);
         }
+        return;
       }
     }
+    rmw_fastrtps_shared_cpp::FastBufferPool::release(request.buffer_);
   }
 
   CustomServiceRequest
   getRequest()
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
     CustomServiceRequest request;
-
-    if (conditionMutex_ != nullptr) {
-      std::unique_lock<std::mutex> clock(*conditionMutex_);
-      if (!list.empty()) {
-        request = list.front();
-        list.pop_front();
-        list_has_data_.store(!list.empty());
-      }
-    } else {
-      if (!list.empty()) {
-        request = list.front();
-        list.pop_front();
-        list_has_data_.store(!list.empty());
+    while (queue_.pop(request)) {
+      queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+      const int64_t max_age = max_request_age_ns_.load(std::memory_order_relaxed);
+      if (max_age > 0) {
+        // Source timestamps come from the caller's system clock, so the age
+        // limit should leave headroom for cross-host clock skew.
+        const int64_t age =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count() -
+          request.sample_info_.sourceTimestamp.to_ns();
+        if (age > max_age) {
+          // The caller has outlived its own timeout by now; shedding here
+          // skips the deserialization entirely.
+          shed_count_.fetch_add(1, std::memory_order_relaxed);
+          rmw_fastrtps_shared_cpp::FastBufferPool::release(request.buffer_);
+          request.buffer_ = nullptr;
+          continue;
+        }
       }
+      return request;
     }
+    return CustomServiceRequest();
+  }
 
-    return request;
+  /// Configure admission control; zero disables either limit.
+  /**
+   * `max_queue_depth` sheds arriving requests once that many are queued
+   * untaken; `max_request_age_ns` sheds queued requests older than this at
+   * take time, before they are deserialized. Either way the caller sees the
+   * same thing as a lost best-effort request: no response. Shed requests
+   * only increment the counter below.
+   */
+  void
+  setAdmissionControl(size_t max_queue_depth, int64_t max_request_age_ns)
+  {
+    max_queue_depth_.store(max_queue_depth, std::memory_order_relaxed);
+    max_request_age_ns_.store(max_request_age_ns, std::memory_order_relaxed);
+  }
+
+  /// Requests shed by admission control since the service was created.
+  uint64_t
+  shedCount() const
+  {
+    return shed_count_.load(std::memory_order_relaxed);
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    std::atomic_bool * conditionReady)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    conditionReady_ = conditionReady;
   }
 
   void
@@ -142,21 +319,56 @@ public:
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    conditionReady_ = nullptr;
+    event_fd_ = -1;
+  }
+
+  void
+  setReadySlot(const rmw_fastrtps_shared_cpp::ReadySlot & slot)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    ready_slot_ = slot;
+  }
+
+  void
+  setEventFd(int event_fd)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    event_fd_ = event_fd;
   }
 
   bool
   hasData()
   {
-    return list_has_data_.load();
+    return !queue_.empty();
+  }
+
+  /// Drop the queue's parked-node cache; see __rmw_service_trim.
+  void
+  trimNodeCache()
+  {
+    queue_.trim_cache();
   }
 
 private:
   CustomServiceInfo * info_;
   std::mutex internalMutex_;
-  std::list<CustomServiceRequest> list RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::atomic_bool list_has_data_;
+  // Pushed from the Fast-RTPS reception threads, popped by the single thread
+  // taking requests; neither path contends on a mutex or the allocator.
+  rmw_fastrtps_shared_cpp::MpscQueue<CustomServiceRequest> queue_;
+  // Admission control (setAdmissionControl): all relaxed. The depth counter
+  // can be momentarily stale against the queue, so the depth limit is a
+  // shed threshold, not an exact bound.
+  std::atomic<size_t> max_queue_depth_{0};
+  std::atomic<int64_t> max_request_age_ns_{0};
+  std::atomic<size_t> queue_depth_{0};
+  std::atomic<uint64_t> shed_count_{0};
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  std::atomic_bool * conditionReady_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadySlot ready_slot_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Wait-set eventfd, part of the attachment like the pointers above.
+  int event_fd_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_) {-1};
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
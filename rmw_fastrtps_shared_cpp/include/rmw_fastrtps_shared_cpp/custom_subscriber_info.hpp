@@ -15,12 +15,19 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_SUBSCRIBER_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_SUBSCRIBER_INFO_HPP_
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
-#include <set>
 #include <utility>
+#include <vector>
 
+#include "fastrtps/participant/Participant.h"
+#include "fastrtps/subscriber/SampleInfo.h"
 #include "fastrtps/subscriber/Subscriber.h"
 #include "fastrtps/subscriber/SubscriberListener.h"
 
@@ -28,41 +35,356 @@
 
 #include "rmw/impl/cpp/macros.hpp"
 
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/waitset_event_fd.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
+#include "rmw_fastrtps_shared_cpp/entity_statistics.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_slot.hpp"
+#include "rmw_fastrtps_shared_cpp/tracing.hpp"
 
 
 class SubListener;
 
-struct CustomSubscriberInfo : public CustomEventInfo
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Callbacks for the direct-dispatch subscription mode.
+/**
+ * All three callables run on the middleware reception thread, so they must
+ * not block and must not call back into the same subscription.
+ */
+struct SubscriptionDirectDispatch
+{
+  /// Stamped into the publisher gid of dispatched message infos; filled by
+  /// __rmw_subscription_set_direct_dispatch.
+  const char * implementation_identifier;
+  /// Hands out a ros message to deserialize into, or null when the caller's
+  /// pool is exhausted; remaining samples then go through the normal wait
+  /// set path.
+  std::function<void * ()> borrow_message;
+  /// Takes back a borrowed message that ended up without a sample.
+  std::function<void (void * ros_message)> return_message;
+  /// Receives every dispatched sample together with ownership of the
+  /// borrowed message.
+  std::function<void (void * ros_message, const rmw_message_info_t * message_info)> on_message;
+};
+
+/// One sample moved out of the reader history into the rmw-side overflow.
+struct SpilledSample
+{
+  PooledFastBufferPtr buffer;
+  eprosima::fastrtps::SampleInfo_t sample_info;
+  uint32_t length{0};
+  /// Arrival stamp popped when the sample was rescued; zero when arrival
+  /// timestamping is off (see SubListener::stamp_arrival).
+  int64_t arrival_timestamp{0};
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+struct CustomSubscriberInfo
+  : public CustomEventInfo,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
   virtual ~CustomSubscriberInfo() = default;
 
   eprosima::fastrtps::Subscriber * subscriber_;
   SubListener * listener_;
+  // Participant the subscriber and its type were created on; with sharding
+  // enabled this may be one of the context's shard participants.
+  eprosima::fastrtps::Participant * participant_{nullptr};
   rmw_fastrtps_shared_cpp::TypeSupport * type_support_;
   const void * type_support_impl_;
   rmw_gid_t subscription_gid_;
   const char * typesupport_identifier_;
+  mutable rmw_fastrtps_shared_cpp::EntityStatistics statistics_;
+
+  // Optional content filter over the serialized payload, applied before
+  // deserialization on ros message takes. Accessed with std::atomic_load /
+  // std::atomic_store so it can be swapped while takes are in flight.
+  std::shared_ptr<const rmw_fastrtps_shared_cpp::SerializedDataFilter> content_filter_;
+
+  // Optional direct-dispatch callbacks; same swapping discipline as the
+  // content filter. The listener's cheap enabled flag avoids loading this
+  // shared_ptr on the per-sample path when the mode is off.
+  std::shared_ptr<const rmw_fastrtps_shared_cpp::SubscriptionDirectDispatch> direct_dispatch_;
+
+  // When set, single takes consume everything but the newest unread sample
+  // without decoding it; see __rmw_subscription_set_take_newest.
+  std::atomic_bool take_newest_{false};
+
+  // When set, the reception callback moves every sample out of the reader
+  // history into the spill queue as soon as it is complete; see
+  // __rmw_subscription_set_arrival_prefetch.
+  std::atomic_bool arrival_prefetch_{false};
+
+  // rmw-side overflow extending the reader history at runtime; see
+  // __rmw_subscription_set_history_extension. spill_size_ mirrors the queue
+  // size so emptiness checks on the hot paths stay lock free.
+  std::atomic<size_t> spill_capacity_{0};
+  std::atomic<size_t> spill_size_{0};
+
+  void
+  push_spilled(rmw_fastrtps_shared_cpp::SpilledSample && sample)
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (!spilled_samples_) {
+      // Allocated on first spill: the overflow is opt-in, so the common
+      // subscription that never enables it does not carry an empty deque's
+      // initial chunk. Once allocated the deque is kept, high-water style.
+      spilled_samples_.reset(new std::deque<rmw_fastrtps_shared_cpp::SpilledSample>());
+    }
+    spilled_samples_->push_back(std::move(sample));
+    spill_size_.store(spilled_samples_->size(), std::memory_order_relaxed);
+  }
+
+  bool
+  take_spilled(rmw_fastrtps_shared_cpp::SpilledSample * sample)
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (!spilled_samples_ || spilled_samples_->empty()) {
+      return false;
+    }
+    *sample = std::move(spilled_samples_->front());
+    spilled_samples_->pop_front();
+    spill_size_.store(spilled_samples_->size(), std::memory_order_relaxed);
+    return true;
+  }
+
+  void
+  clear_spilled()
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spilled_samples_) {
+      spilled_samples_->clear();
+    }
+    spill_size_.store(0, std::memory_order_relaxed);
+  }
+
+  /// Borrow a message object from the loan pool; false when none is free.
+  bool
+  borrow_loanable_message(void ** ros_message)
+  {
+    std::lock_guard<std::mutex> lock(loan_pool_mutex_);
+    if (loanable_messages_.empty()) {
+      return false;
+    }
+    *ros_message = loanable_messages_.back();
+    loanable_messages_.pop_back();
+    return true;
+  }
+
+  /// Put a borrowed message object back; its grown field capacity is what
+  /// the next deserialization reuses.
+  void
+  return_loanable_message(void * ros_message)
+  {
+    std::lock_guard<std::mutex> lock(loan_pool_mutex_);
+    loanable_messages_.push_back(ros_message);
+  }
+
+  /// Replace the loan pool; see __rmw_subscription_set_loan_pool.
+  void
+  set_loanable_messages(void * const * ros_messages, size_t count)
+  {
+    std::lock_guard<std::mutex> lock(loan_pool_mutex_);
+    loanable_messages_.assign(ros_messages, ros_messages + count);
+  }
+
+  /// Release the overflow deque's memory if it is currently empty; spilled
+  /// samples are never dropped. The next spill reallocates on demand.
+  void
+  trim_spilled()
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spilled_samples_ && spilled_samples_->empty()) {
+      spilled_samples_.reset();
+    }
+  }
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   EventListenerInterface *
   getListener() const final;
+
+private:
+  // Caller-constructed message objects cycling through loaned takes. The
+  // caller keeps ownership of the objects themselves; this only tracks
+  // which are currently free. Takes are near-always single-threaded, so a
+  // plain mutex around the free list never contends in practice.
+  std::mutex loan_pool_mutex_;
+  std::vector<void *> loanable_messages_ RCPPUTILS_TSA_GUARDED_BY(loan_pool_mutex_);
+
+  std::mutex spill_mutex_;
+  // Allocated on first spill; see push_spilled.
+  std::unique_ptr<std::deque<rmw_fastrtps_shared_cpp::SpilledSample>> spilled_samples_
+    RCPPUTILS_TSA_GUARDED_BY(spill_mutex_);
 };
 
-class SubListener : public EventListenerInterface, public eprosima::fastrtps::SubscriberListener
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Install or clear direct dispatch on a subscription.
+/**
+ * With direct dispatch installed, new samples are taken, deserialized and
+ * handed to `on_message` straight from the reception callback, skipping the
+ * wait set wakeup, executor scheduling and the separate take. The wait set
+ * is only signalled when `borrow_message` returns null, which leaves the
+ * remaining samples to the normal path. A dispatch with all three callables
+ * empty clears the mode. An installed content filter is honored before
+ * deserialization.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_direct_dispatch(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  SubscriptionDirectDispatch dispatch);
+
+/// Enable or disable take-newest on a subscription.
+/**
+ * With take-newest enabled, a single take first consumes every unread sample
+ * but the last one through a discard path that neither copies nor decodes
+ * the payload, then takes the newest normally. The history is FIFO, so the
+ * last unread sample is the newest; recovering from a backlog costs
+ * O(depth) history operations instead of O(depth) deserializations.
+ * Sequence takes are unaffected — a caller asking for a sequence wants the
+ * intermediate samples.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_take_newest(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  bool take_newest);
+
+/// Set the unread-count watermark raising RMW_FASTRTPS_EVENT_BACKLOG.
+/**
+ * When the subscription's unread backlog reaches \p high_watermark the
+ * listener raises RMW_FASTRTPS_EVENT_BACKLOG through the regular event
+ * machinery, so an application learns it is falling behind from its wait
+ * loop instead of discovering it after keep-last starts dropping. The event
+ * is edge triggered: it fires once per excursion above the mark and re-arms
+ * when takes drain the backlog back below it. Zero, the default, disables
+ * the watermark. Initialize the event with the
+ * RMW_FASTRTPS_EVENT_BACKLOG type and take it into a BacklogStatus.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_backlog_watermark(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  uint64_t high_watermark);
+
+/// Set how many samples beyond the reader history depth a subscription holds.
+/**
+ * History depth is immutable once the reader exists, so a growing backlog
+ * normally drops the oldest unread samples. With an extension installed, the
+ * reception callback moves samples that are about to be overwritten into an
+ * rmw-side overflow of pooled buffers, and takes drain that overflow first,
+ * oldest samples first. The capacity can be raised and lowered at any time;
+ * lowering it only gates new spills, samples already held drain normally.
+ * Zero, the default, disables the overflow and releases held samples. Only
+ * keep-last readers ever overwrite, so the extension is inert on keep-all
+ * histories.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_history_extension(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t extra_capacity);
+
+/// Enable or disable arrival prefetch on a subscription.
+/**
+ * With prefetch enabled, the reception callback extracts each sample from
+ * the reader history into a pooled buffer the moment Fast-RTPS finishes
+ * (re)assembling it, and takes drain those buffers first. The extraction
+ * copy thus overlaps the wait set wakeup and executor scheduling instead of
+ * running inside the take, and the history slot frees immediately — for a
+ * heavily fragmented multi-megabyte sample that keeps a shallow keep-last
+ * history from overwriting the next arrival while the application is still
+ * waking up. The take itself then starts at deserialization (or, for
+ * serialized and loaned takes, is a plain copy or hand-over).
+ *
+ * This Fast-RTPS version only surfaces fully reassembled samples, so the
+ * pipeline begins at reassembly completion; decoding cannot start while
+ * fragments are still in flight. Prefetch is ignored while take-newest is
+ * set, whose discard path wants the stale backlog left in the history.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_arrival_prefetch(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  bool prefetch);
+
+/// Install or clear a content filter on a subscription.
+/**
+ * The filter runs on the take path against the serialized payload, including
+ * its 4 byte CDR encapsulation header, before the sample is deserialized;
+ * rejected samples are consumed from the history and the take reports
+ * nothing taken. An empty filter removes filtering. Filtering happens on the
+ * reader side only, so the samples still travel the wire.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_content_filter(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  SerializedDataFilter filter);
+
+/// Apply the configured CPU affinity to the calling reception thread.
+/**
+ * This Fast-RTPS version exposes no reception-thread count or affinity
+ * configuration, so the pinning happens from inside the first listener
+ * callback each reception thread delivers: RMW_FASTRTPS_RECEPTION_CPUSET
+ * is a comma separated list of CPU indices the thread is restricted to.
+ * Reception capacity itself is multiplied with
+ * RMW_FASTRTPS_PARTICIPANT_SHARDS, where every shard participant brings
+ * its own set of transport reception threads; this pinning then keeps all
+ * of them off the cores reserved for the executor. No-op when the
+ * variable is unset, on Windows, and on every call after a thread's first.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+pin_reception_thread();
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+/// Listener to a subscription's reader.
+/**
+ * Safe under parallel reception: with participant shards or multiple
+ * transports, several reception threads call into the listeners of this
+ * process concurrently. Everything the data path touches is therefore
+ * either atomic (the shadow unread count, backlog counters, event bits),
+ * guarded by a dedicated mutex (arrival stamps, the spill queue) or pinned
+ * by internalMutex_ (the wait-set condition pointers). Callbacks on one
+ * reader are serialized by Fast-RTPS; the concurrency to design for is
+ * across readers sharing the reception threads.
+ */
+class SubListener
+  : public EventListenerInterface,
+  public eprosima::fastrtps::SubscriberListener,
+  public rmw_fastrtps_shared_cpp::PooledAllocated
 {
 public:
   explicit SubListener(CustomSubscriberInfo * info)
-  : data_(0),
-    deadline_changes_(false),
-    liveliness_changes_(false),
+  : info_(info),
+    data_(0),
+    publisher_count_(0),
+    event_changes_(0),
+    requested_deadline_total_count_(0),
+    requested_deadline_total_count_change_(0),
+    liveliness_alive_count_(0),
+    liveliness_not_alive_count_(0),
+    liveliness_alive_count_change_(0),
+    liveliness_not_alive_count_change_(0),
     conditionMutex_(nullptr),
-    conditionVariable_(nullptr)
-  {
-    // Field is not used right now
-    (void)info;
-  }
+    conditionVariable_(nullptr),
+    conditionReady_(nullptr)
+  {}
 
   // SubscriberListener implementation
   void
@@ -70,31 +392,115 @@ public:
     eprosima::fastrtps::Subscriber * /*sub*/, eprosima::fastrtps::rtps::MatchingInfo & info) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
+    auto it = std::lower_bound(
+      publishers_.begin(), publishers_.end(), info.remoteEndpointGuid);
     if (eprosima::fastrtps::rtps::MATCHED_MATCHING == info.status) {
-      publishers_.insert(info.remoteEndpointGuid);
+      if (it == publishers_.end() || *it != info.remoteEndpointGuid) {
+        publishers_.insert(it, info.remoteEndpointGuid);
+      }
     } else if (eprosima::fastrtps::rtps::REMOVED_MATCHING == info.status) {
-      publishers_.erase(info.remoteEndpointGuid);
+      if (it != publishers_.end() && *it == info.remoteEndpointGuid) {
+        publishers_.erase(it);
+      }
     }
+    publisher_count_.store(publishers_.size(), std::memory_order_relaxed);
   }
 
   void
   onNewDataMessage(eprosima::fastrtps::Subscriber * sub) final
   {
-    // Make sure to call into Fast-RTPS before taking the lock to avoid an
-    // ABBA deadlock between internalMutex_ and mutexes inside of Fast-RTPS.
-#if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 9
-    uint64_t unread_count = sub->getUnreadCount();
-#else
-    uint64_t unread_count = sub->get_unread_count();
-#endif
+    // A reception thread's first delivery applies the configured CPU
+    // pinning; afterwards this is a thread-local flag check.
+    rmw_fastrtps_shared_cpp::pin_reception_thread();
+
+    // Capture the arrival time while still on the reception thread, before
+    // any wait-set or executor scheduling can add to it; a no-op unless
+    // arrival timestamping is enabled.
+    stamp_arrival();
+
+    // One callback per received sample: bump the shadow count instead of
+    // re-entering the reader history (and its mutex) for the unread count.
+    // A keep-last overwrite of an unread sample leaves the shadow one too
+    // high; an empty take then resyncs it through sync_unread_count, so the
+    // drift never outlives one spurious wakeup.
+    uint64_t unread_count = data_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    RMW_FASTRTPS_TRACEPOINT2(rmw_sub_new_data, &sub->getGuid(), unread_count);
+
+    uint64_t watermark = backlog_watermark_.load(std::memory_order_relaxed);
+    if (watermark > 0) {
+      if (unread_count >= watermark) {
+        // Edge triggered: one event per excursion above the mark, not one
+        // per arrival while above it. Taking back below the mark re-arms.
+        if (!backlog_above_.exchange(true, std::memory_order_relaxed)) {
+          backlog_unread_count_.store(unread_count, std::memory_order_relaxed);
+          backlog_total_count_.fetch_add(1, std::memory_order_relaxed);
+          backlog_total_count_change_.fetch_add(1, std::memory_order_relaxed);
+          event_changes_.fetch_or(
+            event_bit(rmw_fastrtps_shared_cpp::RMW_FASTRTPS_EVENT_BACKLOG),
+            std::memory_order_relaxed);
+        }
+      } else {
+        backlog_above_.store(false, std::memory_order_relaxed);
+      }
+    }
 
-    std::lock_guard<std::mutex> lock(internalMutex_);
+    if (unread_count > 0 && direct_dispatch_enabled_.load(std::memory_order_relaxed)) {
+      unread_count = dispatch_directly(sub, unread_count);
+      if (0 == unread_count) {
+        return;
+      }
+      // The dispatch pool ran dry; the remaining samples go through the
+      // regular wait set path below.
+    }
+
+    if (unread_count > 0 &&
+      info_->arrival_prefetch_.load(std::memory_order_relaxed) &&
+      !info_->take_newest_.load(std::memory_order_relaxed))
+    {
+      unread_count = prefetch_arrivals(sub, unread_count);
+      // Extraction consumed from the history; restore the shadow before any
+      // signaling, so a waiter that scans for data observes the new count.
+      data_.store(unread_count, std::memory_order_relaxed);
+    }
 
-    // the change to liveliness_lost_count_ needs to be mutually exclusive with
-    // rmw_wait() which checks hasEvent() and decides if wait() needs to be called
-    ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
+    if (unread_count > 0 &&
+      info_->spill_capacity_.load(std::memory_order_relaxed) > 0)
+    {
+      unread_count = spill_overflow(sub, unread_count);
+      // Spilling consumed from the history; restore the shadow before any
+      // signaling, so a waiter that scans for data observes the new count.
+      data_.store(unread_count, std::memory_order_relaxed);
+    }
 
-    data_.store(unread_count, std::memory_order_relaxed);
+    if (0 == unread_count &&
+      0 == info_->spill_size_.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    // internalMutex_ pins the condition pointers against attach/detach; it is
+    // uncontended in steady state since taking data no longer locks it.
+    std::lock_guard<std::mutex> lock(internalMutex_);
+
+    if (conditionMutex_ != nullptr) {
+      // Bit before flag: a waiter woken through the flag finds the bit set.
+      ready_slot_.mark();
+      // Before the suppression below: fd consumers never clear the flag.
+      rmw_fastrtps_shared_cpp::waitset_eventfd_signal(event_fd_);
+      if (nullptr != conditionReady_ && conditionReady_->exchange(true)) {
+        // An unconsumed wakeup is already pending; the waiter clears the flag
+        // before scanning and will observe the stored count.
+        return;
+      }
+      // The empty critical section pairs with the waiter's predicate check,
+      // so the waiter is either before the check, and sees the count, or
+      // already waiting, and receives the notification.
+      {
+        std::lock_guard<std::mutex> clock(*conditionMutex_);
+      }
+      conditionVariable_->notify_one();
+    }
   }
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
@@ -118,68 +524,244 @@ public:
   bool
   takeNextEvent(rmw_event_type_t event_type, void * event_info) final;
 
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  uint32_t
+  takeAllEvents(TakenEventStatuses * statuses) final;
+
   // SubListener API
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    std::atomic_bool * conditionReady) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    conditionReady_ = conditionReady;
   }
 
   void
-  detachCondition()
+  detachCondition() final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    conditionReady_ = nullptr;
+    event_fd_ = -1;
+  }
+
+  void
+  setReadySlot(const rmw_fastrtps_shared_cpp::ReadySlot & slot)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    ready_slot_ = slot;
+  }
+
+  void
+  setEventFd(int event_fd) final
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    event_fd_ = event_fd;
   }
 
   bool
   hasData() const
   {
-    return data_.load(std::memory_order_relaxed) > 0;
+    return data_.load(std::memory_order_relaxed) > 0 ||
+           info_->spill_size_.load(std::memory_order_relaxed) > 0;
   }
 
   void
-  data_taken(eprosima::fastrtps::Subscriber * sub)
+  data_taken(eprosima::fastrtps::Subscriber * sub, uint64_t taken_count = 1)
+  {
+    // Shadow decrement: lowering the count never needs to wake or fence
+    // against a waiter, and it no longer re-enters the reader history. At
+    // worst a concurrent scan sees the old count and the caller's take comes
+    // back empty, which the rmw contract allows.
+    size_t count = data_.load(std::memory_order_relaxed);
+    while (count >= taken_count &&
+      !data_.compare_exchange_weak(
+        count, count - static_cast<size_t>(taken_count), std::memory_order_relaxed))
+    {
+    }
+    if (count < taken_count) {
+      // The shadow disagrees with what was just taken (a keep-last overwrite
+      // ate an unread sample, or a racing reception resurrected a stale
+      // value); only this rare path re-enters Fast-RTPS.
+      sync_unread_count(sub);
+      return;
+    }
+    const uint64_t unread_count = count - taken_count;
+
+    // Draining below the watermark re-arms the backlog edge; with the
+    // watermark at zero (disabled) the comparison is never true.
+    if (unread_count < backlog_watermark_.load(std::memory_order_relaxed)) {
+      backlog_above_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  /// Resync the shadow unread count from the reader history.
+  /**
+   * Called when the shadow and the history disagree: after a take that came
+   * back empty while the count claimed data, and on shadow underflow. The
+   * common paths never pay this query.
+   */
+  void
+  sync_unread_count(eprosima::fastrtps::Subscriber * sub)
   {
-    // Make sure to call into Fast-RTPS before taking the lock to avoid an
-    // ABBA deadlock between internalMutex_ and mutexes inside of Fast-RTPS.
 #if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 9
     uint64_t unread_count = sub->getUnreadCount();
 #else
     uint64_t unread_count = sub->get_unread_count();
 #endif
-
-    std::lock_guard<std::mutex> lock(internalMutex_);
-    ConditionalScopedLock clock(conditionMutex_);
     data_.store(unread_count, std::memory_order_relaxed);
+    if (unread_count < backlog_watermark_.load(std::memory_order_relaxed)) {
+      backlog_above_.store(false, std::memory_order_relaxed);
+    }
+    // The disagreement means samples left the history without a take (a
+    // keep-last overwrite), so the stamp FIFO no longer lines up with it;
+    // drop it and fall back to receptionTimestamp until it refills.
+    clear_arrival_stamps();
+  }
+
+  /// Record a sample's arrival time on the reception thread.
+  /**
+   * No-op unless RMW_FASTRTPS_ARRIVAL_TIMESTAMPS selects a clock; then every
+   * arrival pushes a stamp that the takes pop in FIFO order and substitute
+   * for receptionTimestamp, which Fast-RTPS captures later in the stack.
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  stamp_arrival();
+
+  /// Pop the arrival stamp of the oldest unconsumed sample, zero when none.
+  int64_t
+  pop_arrival_stamp()
+  {
+    if (0 == arrival_stamp_count_.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(arrival_stamp_mutex_);
+    if (arrival_stamps_.empty()) {
+      return 0;
+    }
+    int64_t stamp = arrival_stamps_.front();
+    arrival_stamps_.pop_front();
+    arrival_stamp_count_.store(arrival_stamps_.size(), std::memory_order_relaxed);
+    return stamp;
+  }
+
+  /// Drop all arrival stamps after the FIFO lost sync with the history.
+  void
+  clear_arrival_stamps()
+  {
+    if (0 == arrival_stamp_count_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(arrival_stamp_mutex_);
+    arrival_stamps_.clear();
+    arrival_stamp_count_.store(0, std::memory_order_relaxed);
   }
 
   size_t publisherCount()
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
-    return publishers_.size();
+    return publisher_count_.load(std::memory_order_relaxed);
+  }
+
+  void
+  set_direct_dispatch_enabled(bool enabled)
+  {
+    direct_dispatch_enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  void
+  set_backlog_watermark(uint64_t watermark)
+  {
+    backlog_watermark_.store(watermark, std::memory_order_relaxed);
+    if (0 == watermark) {
+      backlog_above_.store(false, std::memory_order_relaxed);
+    }
   }
 
 private:
+  // Takes and delivers up to unread_count samples through the installed
+  // direct-dispatch callbacks; returns how many samples remain unread.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  uint64_t
+  dispatch_directly(eprosima::fastrtps::Subscriber * sub, uint64_t unread_count);
+
+  // Moves samples that are about to be overwritten by a full keep-last
+  // history into the info's overflow; returns the unread count afterwards.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  uint64_t
+  spill_overflow(eprosima::fastrtps::Subscriber * sub, uint64_t unread_count);
+
+  // Extracts every unread sample into the info's overflow at arrival time
+  // (see __rmw_subscription_set_arrival_prefetch); returns the unread count
+  // afterwards, zero unless a history take fails mid-drain.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  uint64_t
+  prefetch_arrivals(eprosima::fastrtps::Subscriber * sub, uint64_t unread_count);
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  notify_waiter();
+
+  CustomSubscriberInfo * info_;
+
+  // Arrival stamps paired FIFO with the history's unread samples; pushed by
+  // stamp_arrival on the reception thread, popped once per consumed sample.
+  // The shadow count mirrors the queue size so the disabled/common case
+  // checks a relaxed atomic instead of taking the mutex.
+  std::mutex arrival_stamp_mutex_;
+  std::deque<int64_t> arrival_stamps_ RCPPUTILS_TSA_GUARDED_BY(arrival_stamp_mutex_);
+  std::atomic<size_t> arrival_stamp_count_{0};
+
   mutable std::mutex internalMutex_;
 
   std::atomic_size_t data_;
 
-  std::atomic_bool deadline_changes_;
-  eprosima::fastrtps::RequestedDeadlineMissedStatus requested_deadline_missed_status_
-    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-
-  std::atomic_bool liveliness_changes_;
-  eprosima::fastrtps::LivelinessChangedStatus liveliness_changed_status_
-    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Cheap gate checked on every reception before touching the dispatch
+  // shared_ptr; raised only after the dispatch is installed on info_.
+  std::atomic_bool direct_dispatch_enabled_{false};
+
+  std::atomic_size_t publisher_count_;
+
+  // Status fields are per-field atomics: the reception callback writes them
+  // and takeNextEvent consumes the change deltas, so both sides mutate and a
+  // pure reader/writer scheme such as a seqlock does not apply. Exchanging
+  // the deltas keeps consumption lossless without internalMutex_. The raised
+  // events share one bitmask (see EventListenerInterface::event_bit), so a
+  // check or a take-all is a single atomic access.
+  std::atomic<uint32_t> event_changes_;
+  std::atomic<uint32_t> requested_deadline_total_count_;
+  std::atomic<uint32_t> requested_deadline_total_count_change_;
+
+  std::atomic<int32_t> liveliness_alive_count_;
+  std::atomic<int32_t> liveliness_not_alive_count_;
+  std::atomic<int32_t> liveliness_alive_count_change_;
+  std::atomic<int32_t> liveliness_not_alive_count_change_;
+
+  // Backlog watermark machinery; zero watermark means disabled. The above
+  // flag keeps the event edge triggered across reception callbacks.
+  std::atomic<uint64_t> backlog_watermark_{0};
+  std::atomic_bool backlog_above_{false};
+  std::atomic<uint64_t> backlog_unread_count_{0};
+  std::atomic<uint32_t> backlog_total_count_{0};
+  std::atomic<uint32_t> backlog_total_count_change_{0};
 
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-
-  std::set<eprosima::fastrtps::rtps::GUID_t> publishers_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  std::atomic_bool * conditionReady_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadySlot ready_slot_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Wait-set eventfd, part of the attachment like the pointers above.
+  int event_fd_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_) {-1};
+
+  // Sorted flat storage: matching storms insert and erase without per-event
+  // node allocations, and the atomic count above keeps queries wait-free.
+  std::vector<eprosima::fastrtps::rtps::GUID_t> publishers_
+    RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_SUBSCRIBER_INFO_HPP_
@@ -0,0 +1,281 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__ENDPOINT_OPTIONS_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__ENDPOINT_OPTIONS_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fastrtps/attributes/PublisherAttributes.h"
+#include "fastrtps/attributes/SubscriberAttributes.h"
+#include "fastrtps/qos/QosPolicies.h"
+#include "fastrtps/rtps/resources/ResourceManagement.h"
+
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Per-endpoint middleware configuration beyond what rmw QoS can express.
+/**
+ * Passed into create_publisher / create_subscription through the
+ * rmw_specific_publisher_payload / rmw_specific_subscription_payload pointer
+ * of the rmw endpoint options; a null pointer keeps the defaults. The struct
+ * only needs to stay alive for the duration of the create call.
+ */
+struct EndpointOptions
+{
+  /// History cache payload allocation policy for this endpoint. Bounded-size
+  /// topics can use PREALLOCATED_MEMORY_MODE to rule out reallocation in the
+  /// history outright.
+  eprosima::fastrtps::rtps::MemoryManagementPolicy_t history_memory_policy{
+    eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE};
+
+  /// Raises the serialized-size estimate payloads are preallocated with, so
+  /// the first samples of types with unbounded fields do not grow lazily.
+  /// Zero keeps the typesupport's own estimate. The estimate belongs to the
+  /// registered type, so the raise is shared by every endpoint of the type
+  /// on the same participant and never shrinks; endpoints created earlier
+  /// keep their already-allocated payloads.
+  uint32_t initial_payload_size{0};
+
+  /// Forces asynchronous publishing for this writer, so Publisher::write
+  /// queues the sample and returns instead of draining fragments inline.
+  /// Publishers only; ignored on subscriptions.
+  bool asynchronous_publishing{false};
+
+  /// Writer-side throughput controller: at most this many bytes are handed
+  /// to the transport per period. Zero leaves pacing off. Implies
+  /// asynchronous publishing, since pacing happens on the background sender.
+  /// Publishers only; ignored on subscriptions.
+  uint32_t throughput_bytes_per_period{0};
+
+  /// Period of the throughput controller, in milliseconds.
+  uint32_t throughput_period_ms{100};
+
+  /// Writer-side batching window for small-message topics, in milliseconds.
+  /// Samples published within a window leave together: publishing goes
+  /// asynchronous and the sender drains the accumulated queue once per
+  /// window, at which point Fast-RTPS packs the queued samples into shared
+  /// RTPS datagrams up to the transport message size instead of emitting
+  /// one datagram per write. Zero publishes each sample as it comes.
+  /// Publishers only; ignored on subscriptions. Adds up to one window of
+  /// latency, so this is for telemetry-style topics where the
+  /// packet-per-message overhead dominates, not for control loops.
+  uint32_t batch_window_ms{0};
+
+  /// Size threshold of the batching window: once this many bytes are
+  /// queued the window flushes early instead of waiting out the timer.
+  /// Zero sizes the threshold to a UDP datagram, which is the natural
+  /// aggregation limit.
+  uint32_t batch_flush_bytes{0};
+
+  /// Makes the topic keyed: the extractor designates the key fields by
+  /// producing the 16 byte instance key from each ros message, and the
+  /// history then retains samples per instance, so KEEP_LAST depth applies
+  /// per entity instead of per topic. The extractor is installed on the
+  /// registered type and therefore shared by every keyed endpoint of the
+  /// type on the participant; matching against unkeyed endpoints of the
+  /// same topic breaks DDS topic consistency, so all of them must opt in.
+  /// Readers rely on the key hash our writers propagate with each sample;
+  /// samples from foreign writers that omit it are not matched to an
+  /// instance. Empty leaves the topic unkeyed.
+  TypeSupport::KeyExtractor key_extractor{};
+
+  /// Hard cap on the samples this endpoint's history may hold across all
+  /// instances. Zero keeps the middleware default. For transient-local
+  /// writers this bounds how much replay material is retained for late
+  /// joiners.
+  int32_t history_max_samples{0};
+
+  /// Sample slots allocated in the history up front. A durable writer that
+  /// replays to reconnecting readers otherwise grows its history
+  /// allocation-by-allocation during the first replay storm; sizing this to
+  /// the expected retained depth moves that cost to endpoint creation.
+  /// Zero keeps the middleware default.
+  int32_t history_allocated_samples{0};
+
+  /// Writer heartbeat period, in milliseconds. Heartbeats are what tell
+  /// reliable readers they missed something, so on lossy links the default
+  /// period puts a multi-second floor under gap detection; video or
+  /// teleoperation writers want this in the tens of milliseconds. Zero
+  /// keeps the middleware default. Publishers only.
+  uint32_t heartbeat_period_ms{0};
+
+  /// Delay before a writer answers a received NACK with the
+  /// retransmission, in milliseconds. Zero retransmits immediately;
+  /// negative keeps the middleware default. Publishers only.
+  int32_t nack_response_delay_ms{-1};
+
+  /// Cap on how long a reliable write may block when the writer history is
+  /// full of unacknowledged samples behind a slow reader. Zero makes the
+  /// write fail fast instead of stalling the publishing thread - the
+  /// rejection is counted on the publisher's backpressure counter (see
+  /// __rmw_publisher_get_backpressure_count) and surfaced as a publish
+  /// error, so the caller chooses between dropping and retrying. Negative
+  /// keeps the middleware default, which blocks for up to 100 ms.
+  /// Publishers only.
+  int32_t max_blocking_ms{-1};
+
+  /// Delay before a reader answers a heartbeat that revealed a gap with
+  /// the NACK, in milliseconds. Zero requests the repair immediately;
+  /// negative keeps the middleware default. Subscriptions only.
+  int32_t heartbeat_response_delay_ms{-1};
+
+  /// Minimum spacing the reader enforces between processed heartbeats, in
+  /// milliseconds; heartbeats arriving closer together are ignored, which
+  /// bounds NACK traffic when a fast-heartbeating writer's repairs take a
+  /// while to arrive. Negative keeps the middleware default.
+  /// Subscriptions only.
+  int32_t nack_suppression_ms{-1};
+
+  /// Coarse publish-path timing: the per-sample clock reads that feed the
+  /// publish statistics are taken on one publish in this many, with the
+  /// skipped publishes recorded untimed. At tens of kilohertz aggregate
+  /// rate the two clock syscalls per sample are a measurable share of the
+  /// publish path, and a sampled latency histogram is statistically just
+  /// as useful. 1 (the default) times every publish. The DDS source
+  /// timestamp itself is captured inside Fast-RTPS and its write API takes
+  /// no caller timestamp, so that read cannot be coarsened from here.
+  uint32_t clock_sample_stride{1};
+
+  /// Pipelined publishing: this many payload slots and a per-publisher
+  /// sender thread decouple serialization from the RTPS send (see
+  /// publish_pipeline.hpp). The publish call serializes into a free slot
+  /// and returns while the sender transmits earlier samples; with all slots
+  /// in flight it blocks, which is the back-pressure. Send errors surface
+  /// on a later publish and the DDS source timestamp trails the publish by
+  /// the queueing delay. 0 or 1 (the default) publishes synchronously.
+  /// Publishers only; ignored on subscriptions.
+  uint32_t publish_pipeline_depth{0};
+
+  /// Compress serialized payloads before they enter the writer's history
+  /// (see payload_compression.hpp), trading publish-side CPU for wire
+  /// bytes on highly compressible CDR — occupancy grids, sparse arrays,
+  /// JSON-carrying diagnostics — over constrained uplinks. Samples that do
+  /// not shrink are sent plain; subscribers detect compressed payloads by
+  /// their frame, so nothing is configured on the reader side, but every
+  /// subscriber must be this implementation. Publishers only.
+  bool compress_payloads{false};
+
+  /// Multiplexes this endpoint onto a shared channel topic (see
+  /// topic_mux.hpp). The DDS endpoint is created on this ROS topic name
+  /// instead of the endpoint's own, and publishers of the same channel,
+  /// type and participant share one DDS writer — the channel's QoS is
+  /// whatever its first creator asked for. Each subscription keeps its own
+  /// reader on the channel (a shared reader would make co-located logical
+  /// subscriptions steal each other's samples) and narrows it to the
+  /// logical stream with its content filter. The logical topic stays
+  /// visible to local graph queries. Empty disables multiplexing.
+  std::string mux_channel{};
+
+  /// DDS partitions this endpoint joins. Endpoints only match when their
+  /// partition sets intersect, so fleet segmentation happens at discovery
+  /// time instead of through topic-name suffixes that defeat graph tooling;
+  /// unmatched remote readers then cost neither evaluation nor wire
+  /// fan-out. Empty falls back to the process-wide
+  /// RMW_FASTRTPS_PARTITIONS list, and to the default partition without
+  /// that.
+  std::vector<std::string> partitions{};
+};
+
+/// Apply the memory options an rmw payload pointer carries, if any.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_endpoint_memory_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::rtps::MemoryManagementPolicy_t & history_memory_policy,
+  TypeSupport * type_support);
+
+/// Apply the publish-mode and throughput-controller options, if any.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_publisher_flow_control_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::PublisherAttributes & pattr);
+
+/// Apply the endpoint's partitions, or the process-wide default set from
+/// RMW_FASTRTPS_PARTITIONS (semicolon separated). Applies to topic
+/// endpoints only; service and client endpoints stay in the default
+/// partition so request/reply keeps working across segments.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_endpoint_partition_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::PartitionQosPolicy & partition);
+
+/// Apply the endpoint's history resource limits, if any are carried.
+/**
+ * Called after get_datawriter_qos / get_datareader_qos so explicit limits
+ * override the durable-writer preallocation derived there.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_endpoint_resource_limit_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::ResourceLimitsQosPolicy & resource_limits);
+
+/// The clock sample stride an rmw payload pointer carries; 1 without one.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+uint32_t
+endpoint_clock_sample_stride(const void * rmw_specific_payload);
+
+/// Apply the writer-side reliability timings, if any are carried.
+/**
+ * Only meaningful on RELIABLE writers; Fast-RTPS ignores the times on
+ * best-effort endpoints, so applying unconditionally is safe.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_publisher_reliability_timing_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::PublisherAttributes & pattr);
+
+/// Apply the reader-side reliability timings, if any are carried.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_subscription_reliability_timing_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::SubscriberAttributes & sattr);
+
+/// The publish pipeline depth an rmw payload carries; 0 without one.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+uint32_t
+endpoint_publish_pipeline_depth(const void * rmw_specific_payload);
+
+/// Whether an rmw payload asks for payload compression; false without one.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+endpoint_compress_payloads(const void * rmw_specific_payload);
+
+/// The mux channel an rmw payload names, or null when not multiplexed.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+const char *
+endpoint_mux_channel(const void * rmw_specific_payload);
+
+/// Install the key extractor and flip the topic kind to WITH_KEY, if one
+/// is carried.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_endpoint_key_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::rtps::TopicKind_t & topic_kind,
+  TypeSupport * type_support);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__ENDPOINT_OPTIONS_HPP_
@@ -0,0 +1,355 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__ENTITY_STATISTICS_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__ENTITY_STATISTICS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Plain copy of an entity's counters, safe to read and ship around freely.
+struct EntityStatisticsSnapshot
+{
+  /// Number of statistics histogram buckets; bucket i counts operations
+  /// that took between 2^i and 2^(i+1) - 1 nanoseconds.
+  static constexpr size_t kHistogramBuckets = 32;
+
+  /// Samples written (publisher) or taken (subscription).
+  uint64_t samples;
+  /// Payload bytes serialized; 0 contribution from paths where the
+  /// serialized size is not observable.
+  uint64_t bytes;
+  /// Total nanoseconds spent in serialization / the take operation.
+  uint64_t operation_ns;
+  /// Log2-bucketed per-operation duration histogram.
+  uint64_t operation_ns_histogram[kHistogramBuckets];
+};
+
+/// Per-entity counters accumulated on the hot paths with relaxed atomics.
+/**
+ * Embedded in CustomPublisherInfo / CustomSubscriberInfo. Writers only do
+ * relaxed fetch-adds, so recording does not serialize concurrent traffic,
+ * and readers take a snapshot without stopping it. Counts are monotonic;
+ * sampling twice and diffing gives a rate.
+ */
+class EntityStatistics
+{
+public:
+  void
+  record(uint64_t bytes, uint64_t operation_ns)
+  {
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    operation_ns_.fetch_add(operation_ns, std::memory_order_relaxed);
+    size_t bucket = 0;
+    while (operation_ns >>= 1) {
+      ++bucket;
+    }
+    if (bucket >= EntityStatisticsSnapshot::kHistogramBuckets) {
+      bucket = EntityStatisticsSnapshot::kHistogramBuckets - 1;
+    }
+    histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Record an operation whose duration was not measured; samples and
+  /// bytes stay exact while the timing columns only cover timed samples.
+  /// Used by the sampled-timing publish mode (EndpointOptions::
+  /// clock_sample_stride), where most publishes skip the clock reads.
+  void
+  record_untimed(uint64_t bytes)
+  {
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  EntityStatisticsSnapshot
+  snapshot() const
+  {
+    EntityStatisticsSnapshot out;
+    out.samples = samples_.load(std::memory_order_relaxed);
+    out.bytes = bytes_.load(std::memory_order_relaxed);
+    out.operation_ns = operation_ns_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < EntityStatisticsSnapshot::kHistogramBuckets; ++i) {
+      out.operation_ns_histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+    }
+    return out;
+  }
+
+private:
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> operation_ns_{0};
+  std::atomic<uint64_t> histogram_[EntityStatisticsSnapshot::kHistogramBuckets] = {};
+};
+
+/// Plain copy of a service's queue-residency counters.
+struct ServiceStatisticsSnapshot
+{
+  /// Requests taken by the server.
+  uint64_t requests_taken;
+  /// Responses whose handler duration was observed; responses to requests
+  /// evicted from the reply cache are sent but not timed.
+  uint64_t responses_timed;
+  /// Total nanoseconds requests sat queued between arriving in the
+  /// listener callback and being taken.
+  uint64_t queue_ns;
+  /// Log2-bucketed queue-residency histogram, bucketed like
+  /// EntityStatisticsSnapshot::operation_ns_histogram.
+  uint64_t queue_ns_histogram[EntityStatisticsSnapshot::kHistogramBuckets];
+  /// Total nanoseconds between a request's take and its response send -
+  /// the application handler.
+  uint64_t handler_ns;
+  /// Log2-bucketed handler-duration histogram.
+  uint64_t handler_ns_histogram[EntityStatisticsSnapshot::kHistogramBuckets];
+};
+
+/// Per-service latency split, recorded like EntityStatistics: relaxed
+/// fetch-adds on the take and response paths, snapshots without stopping
+/// the server. Queue residency is take time minus the enqueue timestamp
+/// the listener stamped on arrival; handler time is response send minus
+/// take, matched through the pending-reply cache.
+class ServiceStatistics
+{
+public:
+  void
+  record_queue(uint64_t queue_ns)
+  {
+    requests_taken_.fetch_add(1, std::memory_order_relaxed);
+    queue_ns_.fetch_add(queue_ns, std::memory_order_relaxed);
+    size_t bucket = 0;
+    while (queue_ns >>= 1) {
+      ++bucket;
+    }
+    if (bucket >= EntityStatisticsSnapshot::kHistogramBuckets) {
+      bucket = EntityStatisticsSnapshot::kHistogramBuckets - 1;
+    }
+    queue_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void
+  record_handler(uint64_t handler_ns)
+  {
+    responses_timed_.fetch_add(1, std::memory_order_relaxed);
+    handler_ns_.fetch_add(handler_ns, std::memory_order_relaxed);
+    size_t bucket = 0;
+    while (handler_ns >>= 1) {
+      ++bucket;
+    }
+    if (bucket >= EntityStatisticsSnapshot::kHistogramBuckets) {
+      bucket = EntityStatisticsSnapshot::kHistogramBuckets - 1;
+    }
+    handler_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ServiceStatisticsSnapshot
+  snapshot() const
+  {
+    ServiceStatisticsSnapshot out;
+    out.requests_taken = requests_taken_.load(std::memory_order_relaxed);
+    out.responses_timed = responses_timed_.load(std::memory_order_relaxed);
+    out.queue_ns = queue_ns_.load(std::memory_order_relaxed);
+    out.handler_ns = handler_ns_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < EntityStatisticsSnapshot::kHistogramBuckets; ++i) {
+      out.queue_ns_histogram[i] = queue_histogram_[i].load(std::memory_order_relaxed);
+      out.handler_ns_histogram[i] = handler_histogram_[i].load(std::memory_order_relaxed);
+    }
+    return out;
+  }
+
+private:
+  std::atomic<uint64_t> requests_taken_{0};
+  std::atomic<uint64_t> responses_timed_{0};
+  std::atomic<uint64_t> queue_ns_{0};
+  std::atomic<uint64_t> handler_ns_{0};
+  std::atomic<uint64_t> queue_histogram_[EntityStatisticsSnapshot::kHistogramBuckets] = {};
+  std::atomic<uint64_t> handler_histogram_[EntityStatisticsSnapshot::kHistogramBuckets] = {};
+};
+
+/// Plain copy of a wait set's wakeup counters.
+struct WaitsetStatisticsSnapshot
+{
+  /// Completed blocking waits; zero-timeout polls never block and are not
+  /// counted here.
+  uint64_t waits;
+  /// Waits that returned without any entity ready.
+  uint64_t timeouts;
+  /// Wakeup-validation predicate evaluations that found the ready flag
+  /// clear. Each park contributes one baseline evaluation before sleeping;
+  /// anything beyond waits - timeouts on top of that baseline is a wakeup
+  /// the wait set absorbed without returning (a spurious one, or a
+  /// notification whose readiness another waiter already consumed).
+  uint64_t spurious_predicate_checks;
+  /// Ready entities reported by returning waits, by kind. A single wakeup
+  /// reporting three ready subscriptions counts three.
+  uint64_t subscription_wakeups;
+  uint64_t client_wakeups;
+  uint64_t service_wakeups;
+  uint64_t guard_condition_wakeups;
+  uint64_t event_wakeups;
+  /// Total nanoseconds spent inside blocking waits.
+  uint64_t wait_ns;
+  /// Log2-bucketed per-wait duration histogram, bucketed like
+  /// EntityStatisticsSnapshot::operation_ns_histogram.
+  uint64_t wait_ns_histogram[EntityStatisticsSnapshot::kHistogramBuckets];
+};
+
+/// Per-wait-set wakeup counters, recorded like EntityStatistics: relaxed
+/// fetch-adds on the wait path, snapshots without stopping the waiters.
+class WaitsetStatistics
+{
+public:
+  /// Add ready entities reported by one returning wait. Zero counts skip
+  /// the fetch-add, so idle kinds cost nothing.
+  void
+  add_ready(
+    uint64_t subscriptions, uint64_t clients, uint64_t services,
+    uint64_t guard_conditions)
+  {
+    if (subscriptions > 0u) {
+      subscription_wakeups_.fetch_add(subscriptions, std::memory_order_relaxed);
+    }
+    if (clients > 0u) {
+      client_wakeups_.fetch_add(clients, std::memory_order_relaxed);
+    }
+    if (services > 0u) {
+      service_wakeups_.fetch_add(services, std::memory_order_relaxed);
+    }
+    if (guard_conditions > 0u) {
+      guard_condition_wakeups_.fetch_add(guard_conditions, std::memory_order_relaxed);
+    }
+  }
+
+  void
+  add_ready_events(uint64_t events)
+  {
+    if (events > 0u) {
+      event_wakeups_.fetch_add(events, std::memory_order_relaxed);
+    }
+  }
+
+  void
+  count_spurious_check()
+  {
+    spurious_predicate_checks_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void
+  record_wait(uint64_t wait_ns, bool timed_out)
+  {
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    if (timed_out) {
+      timeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+    size_t bucket = 0;
+    while (wait_ns >>= 1) {
+      ++bucket;
+    }
+    if (bucket >= EntityStatisticsSnapshot::kHistogramBuckets) {
+      bucket = EntityStatisticsSnapshot::kHistogramBuckets - 1;
+    }
+    histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  WaitsetStatisticsSnapshot
+  snapshot() const
+  {
+    WaitsetStatisticsSnapshot out;
+    out.waits = waits_.load(std::memory_order_relaxed);
+    out.timeouts = timeouts_.load(std::memory_order_relaxed);
+    out.spurious_predicate_checks =
+      spurious_predicate_checks_.load(std::memory_order_relaxed);
+    out.subscription_wakeups = subscription_wakeups_.load(std::memory_order_relaxed);
+    out.client_wakeups = client_wakeups_.load(std::memory_order_relaxed);
+    out.service_wakeups = service_wakeups_.load(std::memory_order_relaxed);
+    out.guard_condition_wakeups =
+      guard_condition_wakeups_.load(std::memory_order_relaxed);
+    out.event_wakeups = event_wakeups_.load(std::memory_order_relaxed);
+    out.wait_ns = wait_ns_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < EntityStatisticsSnapshot::kHistogramBuckets; ++i) {
+      out.wait_ns_histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+    }
+    return out;
+  }
+
+private:
+  std::atomic<uint64_t> waits_{0};
+  std::atomic<uint64_t> timeouts_{0};
+  std::atomic<uint64_t> spurious_predicate_checks_{0};
+  std::atomic<uint64_t> subscription_wakeups_{0};
+  std::atomic<uint64_t> client_wakeups_{0};
+  std::atomic<uint64_t> service_wakeups_{0};
+  std::atomic<uint64_t> guard_condition_wakeups_{0};
+  std::atomic<uint64_t> event_wakeups_{0};
+  std::atomic<uint64_t> wait_ns_{0};
+  std::atomic<uint64_t> histogram_[EntityStatisticsSnapshot::kHistogramBuckets] = {};
+};
+
+/// Fetch the counters of a publisher without disturbing its traffic.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publisher_get_statistics(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  EntityStatisticsSnapshot * statistics);
+
+/// Fetch the counters of a subscription without disturbing its traffic.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_get_statistics(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  EntityStatisticsSnapshot * statistics);
+
+/// Fetch a service's latency split without disturbing its traffic.
+/**
+ * Separates where a slow service spends its time: the queue histogram is
+ * residency between a request's arrival and its take - where overload
+ * latency accumulates - and the handler histogram is take to response.
+ * Network time is the remainder against an end-to-end measurement on the
+ * client.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_service_get_statistics(
+  const char * identifier,
+  const rmw_service_t * service,
+  ServiceStatisticsSnapshot * statistics);
+
+/// Fetch a wait set's wakeup counters without disturbing its waiters.
+/**
+ * Sampling twice and diffing splits the wakeup budget by cause: which
+ * entity kinds actually woke the executor, how often a wait ran out its
+ * timeout, and how many wakeups were absorbed as spurious. The duration
+ * histogram shows whether waits are long parks or rapid-fire returns.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_wait_set_get_statistics(
+  const char * identifier,
+  const rmw_wait_set_t * wait_set,
+  WaitsetStatisticsSnapshot * statistics);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__ENTITY_STATISTICS_HPP_
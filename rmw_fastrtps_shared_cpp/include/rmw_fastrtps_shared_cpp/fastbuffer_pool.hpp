@@ -0,0 +1,153 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__FASTBUFFER_POOL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__FASTBUFFER_POOL_HPP_
+
+#include <fastcdr/FastBuffer.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Process-wide recycling pool for heap-allocated FastBuffers.
+/**
+ * Buffers handed back keep whatever capacity they grew to, so steady-state
+ * acquire/release cycles perform no heap operations once the pool has warmed
+ * up to the running maximum payload size.
+ *
+ * The pool is a fixed array of atomic slots. Acquire swaps a buffer out of
+ * the first occupied slot; release swaps it into the first empty one, or
+ * frees the buffer when the pool is full. Each slot is only ever exchanged
+ * whole, which keeps the pool safe for concurrent use from the Fast-RTPS
+ * reception threads and the taking threads without any locks.
+ *
+ * Pool misses and overflow deletions go through middleware_allocator(), so
+ * a deployment that installs a real-time pool backs even the cold path.
+ *
+ * On multi-socket hosts, RMW_FASTRTPS_NUMA_NODES=<n> stripes the slots by
+ * NUMA node: a thread only recycles buffers through its own node's stripe,
+ * so a buffer first-touched by a reception thread (the pool-miss path
+ * allocates lazily, and fastcdr grows the payload on first use, both on
+ * the acquiring thread) keeps serving that node instead of migrating to
+ * the other socket through a shared free list. Pair it with
+ * RMW_FASTRTPS_RECEPTION_CPUSET so the reception threads, and with them
+ * the stripes' working sets, stay put. Unset or 1 keeps one shared pool.
+ */
+class FastBufferPool
+{
+public:
+  static eprosima::fastcdr::FastBuffer *
+  acquire()
+  {
+    size_t begin;
+    size_t end;
+    current_stripe(&begin, &end);
+    for (size_t i = begin; i < end; ++i) {
+      eprosima::fastcdr::FastBuffer * buffer = slots_[i].exchange(nullptr);
+      if (buffer != nullptr) {
+        return buffer;
+      }
+    }
+    return allocate_buffer();
+  }
+
+  static void
+  release(eprosima::fastcdr::FastBuffer * buffer)
+  {
+    // High-water capacity tracking for trim(): relaxed max, a lost race
+    // only under-reports until the next release of a large buffer.
+    const size_t capacity = buffer->getBufferSize();
+    size_t seen = capacity_high_water_.load(std::memory_order_relaxed);
+    while (capacity > seen &&
+      !capacity_high_water_.compare_exchange_weak(
+        seen, capacity, std::memory_order_relaxed))
+    {
+    }
+    size_t begin;
+    size_t end;
+    current_stripe(&begin, &end);
+    for (size_t i = begin; i < end; ++i) {
+      eprosima::fastcdr::FastBuffer * expected = nullptr;
+      if (slots_[i].compare_exchange_strong(expected, buffer)) {
+        return;
+      }
+    }
+    deallocate_buffer(buffer);
+  }
+
+  /// Stock the calling thread's stripe with buffers grown to payload_size.
+  /**
+   * Every byte is touched, so an mlockall'd process takes the page faults
+   * here instead of on the first message (__rmw_publisher_prewarm,
+   * __rmw_subscription_prewarm). Striping applies: call from the thread,
+   * and with it the NUMA node, whose traffic the buffers should serve.
+   * Returns false when a buffer could not be grown; the rest are still
+   * warmed and returned to the pool.
+   */
+  static bool
+  prewarm(size_t count, size_t payload_size);
+
+  /// Free idle pooled buffers above the decayed capacity high-water mark.
+  /**
+   * The inverse of prewarm: after a startup or traffic burst the pooled
+   * buffers keep their grown capacity forever, so an idle process holds
+   * burst-sized memory indefinitely. Each trim halves the capacity
+   * high-water recorded since the last one and frees every idle buffer
+   * above the halved mark, so periodic trims release burst memory over a
+   * few idle cycles while a pool still cycling large payloads — whose
+   * releases keep pushing the mark back up — is left alone. Buffers
+   * currently acquired are unaffected. Returns the bytes released.
+   */
+  static size_t
+  trim();
+
+private:
+  static eprosima::fastcdr::FastBuffer *
+  allocate_buffer();
+
+  static void
+  deallocate_buffer(eprosima::fastcdr::FastBuffer * buffer);
+
+  /// The slot range the calling thread recycles through: the whole pool by
+  /// default, its NUMA node's stripe under RMW_FASTRTPS_NUMA_NODES.
+  static void
+  current_stripe(size_t * begin, size_t * end);
+
+  static constexpr size_t kPoolSize = 32;
+
+  static std::atomic<eprosima::fastcdr::FastBuffer *> slots_[kPoolSize];
+  static std::atomic<size_t> capacity_high_water_;
+};
+
+/// Deleter returning a buffer to the pool instead of the allocator.
+struct FastBufferPoolDeleter
+{
+  void
+  operator()(eprosima::fastcdr::FastBuffer * buffer) const
+  {
+    FastBufferPool::release(buffer);
+  }
+};
+
+/// Owning pointer to a pooled FastBuffer; recycles the buffer on destruction.
+using PooledFastBufferPtr =
+  std::unique_ptr<eprosima::fastcdr::FastBuffer, FastBufferPoolDeleter>;
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__FASTBUFFER_POOL_HPP_
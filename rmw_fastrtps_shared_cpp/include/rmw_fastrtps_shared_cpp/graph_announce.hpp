@@ -0,0 +1,82 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__GRAPH_ANNOUNCE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__GRAPH_ANNOUNCE_HPP_
+
+#include "rmw/ret_types.h"
+
+#include "rmw_dds_common/context.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Publish a participant entities announcement, coalescing bursts.
+/**
+ * Every announcement carries the participant's complete entity state, so a
+ * newer one supersedes everything published before it. With
+ * RMW_FASTRTPS_GRAPH_COALESCE_MS set to a positive window, an announcement
+ * is held back for up to that long and replaced in place by newer ones:
+ * bringing up a node with hundreds of endpoints then broadcasts a handful
+ * of snapshots instead of one per entity, at the price of remote graphs
+ * learning about local changes up to one window later. Zero, the default,
+ * publishes inline as before. RMW_FASTRTPS_GRAPH_MIN_INTERVAL_MS
+ * additionally spaces consecutive flushes at least that far apart, capping
+ * the announcement rate over metered links no matter how often local
+ * entities churn. The local graph cache is always updated synchronously by
+ * the caller; only the broadcast is deferred.
+ *
+ * \param[in] identifier The rmw implementation identifier.
+ * \param[in] common_context Context owning the graph publisher.
+ * \param[in] msg The announcement; copied when it is held back.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+graph_announce(
+  const char * identifier,
+  rmw_dds_common::Context * common_context,
+  rmw_dds_common::msg::ParticipantEntitiesInfo * msg);
+
+/// Whether the graph topic should run with reduced, WAN-friendly QoS.
+/**
+ * RMW_FASTRTPS_GRAPH_REDUCED_QOS=1 downgrades the `ros_discovery_info`
+ * reliability to best effort while keeping the transient-local history, so
+ * graph gossip stops generating reliable heartbeat/ACK round trips over
+ * metered links. Every announcement carries the participant's complete
+ * entity state, so a dropped one is corrected by the next change; until
+ * then remote graphs can be stale. Read once; all contexts in the process
+ * share the setting, and it must match on every peer sharing the domain
+ * for their readers to match the downgraded writer.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+graph_announce_reduced_qos();
+
+/// Flush the held-back announcement and stop the flusher for this context.
+/**
+ * Must run before the context's graph publisher is destroyed; safe to call
+ * for a context that never deferred anything.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+graph_announce_fini(
+  const char * identifier,
+  rmw_dds_common::Context * common_context);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__GRAPH_ANNOUNCE_HPP_
@@ -0,0 +1,138 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__GRAPH_CHANGE_FEED_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__GRAPH_CHANGE_FEED_HPP_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rmw/ret_types.h"
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Kind of a single graph delta.
+enum class GraphChangeKind
+{
+  NODE_ADDED,
+  NODE_REMOVED,
+  ENDPOINT_ADDED,
+  ENDPOINT_REMOVED,
+};
+
+/// One graph delta.
+/**
+ * Node changes fill name and namespace; endpoint changes fill the topic name
+ * as announced on the wire (i.e. with the ros prefix still mangled in) and
+ * the reader/writer direction. The feed reports changes observed through
+ * discovery, which covers every other process; a process's own entities are
+ * not echoed back through it.
+ */
+struct GraphChange
+{
+  GraphChangeKind kind;
+  std::string node_name;
+  std::string node_namespace;
+  std::string topic_name;
+  bool is_reader{false};
+};
+
+/// Subscribe a guard condition to graph deltas of one graph.
+/**
+ * Every delta is appended to a per-subscriber queue and the guard condition
+ * is triggered, so the caller can put it in a wait set and drain with
+ * graph_change_feed_take instead of polling the query functions. When the
+ * queue is full the oldest entries are dropped and the overflow is reported
+ * by the next take; consumers must then fall back to one full query.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner
+ *   (the common context).
+ * \param[in] identifier The rmw implementation identifier, used to trigger.
+ * \param[in] guard_condition Triggered on every delta; also the subscriber's
+ *   handle for take/detach. Must outlive the subscription.
+ * \param[in] queue_depth Maximum buffered deltas; zero picks a default.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+graph_change_feed_attach(
+  const void * graph_key,
+  const char * identifier,
+  const rmw_guard_condition_t * guard_condition,
+  size_t queue_depth);
+
+/// Unsubscribe; safe to call with a guard condition that is not attached.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+graph_change_feed_detach(
+  const void * graph_key,
+  const rmw_guard_condition_t * guard_condition);
+
+/// Drain the buffered deltas of one subscriber.
+/**
+ * \param[out] changes Appended with the queued deltas, oldest first.
+ * \param[out] overflowed True when deltas were dropped since the last take;
+ *   the caller should re-run its full queries to resynchronize.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+graph_change_feed_take(
+  const void * graph_key,
+  const rmw_guard_condition_t * guard_condition,
+  std::vector<GraphChange> * changes,
+  bool * overflowed);
+
+/// Drop all feed state for `graph_key` when its context is destroyed.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_change_feed_forget(const void * graph_key);
+
+/// Producer side: record a discovered or removed endpoint.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_change_feed_push_endpoint(
+  const void * graph_key,
+  bool added,
+  const std::string & topic_name,
+  bool is_reader);
+
+/// Producer side: diff a participant's announced node list against the
+/// previous one and emit node added/removed deltas.
+/**
+ * \param[in] participant_key The announcing participant's gid bytes, used to
+ *   key the previous node list.
+ * \param[in] nodes The announced (name, namespace) pairs.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_change_feed_update_nodes(
+  const void * graph_key,
+  const std::string & participant_key,
+  const std::vector<std::pair<std::string, std::string>> & nodes);
+
+/// Producer side: a participant vanished; emit node removals for everything
+/// it still announced.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_change_feed_remove_participant(
+  const void * graph_key,
+  const std::string & participant_key);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__GRAPH_CHANGE_FEED_HPP_
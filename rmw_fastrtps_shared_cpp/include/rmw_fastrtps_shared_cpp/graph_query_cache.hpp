@@ -0,0 +1,199 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__GRAPH_QUERY_CACHE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__GRAPH_QUERY_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+#include "rmw/names_and_types.h"
+#include "rmw/ret_types.h"
+#include "rmw/topic_endpoint_info_array.h"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Record that the graph cache owned by `graph_key` changed.
+/**
+ * Must be called from the graph cache's on-change callback; it invalidates
+ * every query snapshot held for that graph.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner
+ *   (the common context).
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_query_cache_on_change(const void * graph_key);
+
+/// Drop all cached state for `graph_key` when its context is destroyed.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_query_cache_forget(const void * graph_key);
+
+/// Serve a names-and-types query from a generation-stamped snapshot.
+/**
+ * If a snapshot for (`graph_key`, `query_id`) exists and the graph has not
+ * changed since it was taken, the result is rebuilt from the snapshot with
+ * the caller's allocator and the graph cache is not touched. Otherwise
+ * `fresh_query` is invoked to fill the result and a new snapshot is captured
+ * from it. The output must still be deep-copied per call because ownership
+ * of the arrays transfers to the caller together with its allocator.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner.
+ * \param[in] query_id Distinguishes independent queries against the same
+ *   graph (e.g. topics vs. services, demangled vs. raw).
+ * \param[in] allocator Allocator used to build the returned arrays.
+ * \param[out] names_and_types Zero-initialized result to fill.
+ * \param[in] fresh_query Runs the underlying graph cache query.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+cached_names_and_types_query(
+  const void * graph_key,
+  const char * query_id,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * names_and_types,
+  const std::function<rmw_ret_t(rmw_names_and_types_t *)> & fresh_query);
+
+/// Per-entry callback for visit_cached_names_and_types.
+/**
+ * Invoked once per name with its full type list; the references point into
+ * the immutable snapshot and stay valid only for the duration of the call.
+ * Return false to stop the iteration early.
+ */
+using NamesAndTypesVisitor =
+  std::function<bool (const std::string & name, const std::vector<std::string> & types)>;
+
+/// Iterate a names-and-types query in place, without building a result.
+/**
+ * Snapshot-backed sibling of cached_names_and_types_query for callers that
+ * only read: while the graph is unchanged the visitor walks the published
+ * snapshot directly, so a scan over any number of entries allocates nothing.
+ * On a stale or missing snapshot, `fresh_query` is run once into scratch
+ * arrays built with the allocator it is handed (the process middleware
+ * allocator, see middleware_allocator.hpp), the snapshot is recaptured and
+ * the scratch freed before the visitor runs.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner.
+ * \param[in] query_id Distinguishes independent queries against the same
+ *   graph; shared with cached_names_and_types_query, so both entry points
+ *   serve from one snapshot.
+ * \param[in] fresh_query Runs the underlying graph cache query with the
+ *   provided allocator when the snapshot needs refreshing.
+ * \param[in] visitor Called per entry under no lock.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+visit_cached_names_and_types(
+  const void * graph_key,
+  const char * query_id,
+  const std::function<rmw_ret_t(rcutils_allocator_t *, rmw_names_and_types_t *)> & fresh_query,
+  const NamesAndTypesVisitor & visitor);
+
+/// Serve one bounded chunk of a names-and-types query.
+/**
+ * Pagination sibling of cached_names_and_types_query for results too large
+ * to materialize in one piece: each call builds at most `max_entries`
+ * entries starting at `offset` with the caller's allocator, and no lock is
+ * held while the chunk is built. The pull is anchored to one immutable
+ * snapshot through `continuation`: pass zero to start, which refreshes the
+ * snapshot if the graph changed and writes the pull's token; pass the token
+ * back unchanged for every further chunk. Chunks of one pull are therefore
+ * mutually consistent even if the graph moves between calls. If a refresh
+ * replaces the snapshot mid-pull, continuation calls fail with
+ * RMW_RET_ERROR instead of splicing two graph states together, and the
+ * caller restarts from a zero token.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner.
+ * \param[in] query_id Distinguishes independent queries against the same
+ *   graph; shared with the unchunked entry points, so all of them serve
+ *   from one snapshot.
+ * \param[in] allocator Allocator used to build the returned chunk.
+ * \param[in] offset Index of the first entry of this chunk.
+ * \param[in] max_entries Upper bound on entries built into this chunk.
+ * \param[in,out] continuation Zero to start a pull; carries the pull's
+ *   snapshot token between chunks afterwards.
+ * \param[out] names_and_types Zero-initialized result to fill; left empty
+ *   when `offset` is past the end.
+ * \param[out] more True when entries remain beyond this chunk.
+ * \param[in] fresh_query Runs the underlying graph cache query with the
+ *   provided allocator when the snapshot needs refreshing.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+cached_names_and_types_query_chunk(
+  const void * graph_key,
+  const char * query_id,
+  rcutils_allocator_t * allocator,
+  size_t offset,
+  size_t max_entries,
+  uint64_t * continuation,
+  rmw_names_and_types_t * names_and_types,
+  bool * more,
+  const std::function<rmw_ret_t(rcutils_allocator_t *, rmw_names_and_types_t *)> & fresh_query);
+
+/// Serve an endpoint-count query from a generation-stamped snapshot.
+/**
+ * Same scheme as cached_names_and_types_query, for the per-topic
+ * publisher/subscriber counts: while the graph is unchanged the count is a
+ * single map lookup and the graph cache is not touched.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner.
+ * \param[in] query_id Distinguishes independent counts against the same
+ *   graph; callers prefix the topic name with the endpoint direction.
+ * \param[out] count Where the result is written.
+ * \param[in] fresh_query Runs the underlying graph cache count.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+cached_count_query(
+  const void * graph_key,
+  const char * query_id,
+  size_t * count,
+  const std::function<rmw_ret_t(size_t *)> & fresh_query);
+
+/// Serve a per-topic endpoint-info query from a generation-stamped snapshot.
+/**
+ * Same scheme as cached_names_and_types_query. The result is still rebuilt
+ * with the caller's allocator on every call, because ownership of every
+ * string transfers to the caller, who finalizes them one by one; only the
+ * graph cache walk is saved.
+ *
+ * \param[in] graph_key Pointer identifying the graph cache owner.
+ * \param[in] query_id Distinguishes independent queries against the same
+ *   graph; callers prefix the topic name with direction and mangling.
+ * \param[in] allocator Allocator used to build the returned array.
+ * \param[out] info_array Zero-initialized result to fill.
+ * \param[in] fresh_query Runs the underlying graph cache query.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+cached_topic_endpoint_info_query(
+  const void * graph_key,
+  const char * query_id,
+  rcutils_allocator_t * allocator,
+  rmw_topic_endpoint_info_array_t * info_array,
+  const std::function<rmw_ret_t(rmw_topic_endpoint_info_array_t *)> & fresh_query);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__GRAPH_QUERY_CACHE_HPP_
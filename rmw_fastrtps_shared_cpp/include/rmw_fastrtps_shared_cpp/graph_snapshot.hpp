@@ -0,0 +1,110 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__GRAPH_SNAPSHOT_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__GRAPH_SNAPSHOT_HPP_
+
+#include <string>
+
+#include "rmw/types.h"
+
+#include "rmw_dds_common/context.hpp"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Whether the graph warm-start snapshot is active.
+/**
+ * Opt-in through RMW_FASTRTPS_GRAPH_SNAPSHOT_FILE=<path>. When set, the
+ * remote participants and endpoints seen through discovery are journaled,
+ * written to that file at context shutdown, and preloaded into the graph
+ * cache of the next context that starts with the same setting — so a
+ * supervised restart sees the converged graph immediately instead of waiting
+ * for discovery to replay it.
+ *
+ * Preloaded entries are provisional: live discovery overwrites or removes
+ * them as the real participants announce themselves, and a snapshot older
+ * than RMW_FASTRTPS_GRAPH_SNAPSHOT_MAX_AGE_SEC (default 60) is discarded
+ * unread. Entries for a participant that died while the process was down
+ * linger until the validity window would have rejected them, which is the
+ * trade the opt-in accepts.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+graph_snapshot_enabled();
+
+/// Journal a discovered remote participant.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_record_participant(
+  const void * graph_key,
+  const rmw_gid_t & gid,
+  const std::string & enclave);
+
+/// Drop a removed participant and everything it announced from the journal.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_remove_participant(
+  const void * graph_key,
+  const rmw_gid_t & gid);
+
+/// Journal a discovered remote endpoint.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_record_endpoint(
+  const void * graph_key,
+  const rmw_gid_t & gid,
+  const rmw_gid_t & participant_gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rmw_qos_profile_t & qos,
+  bool is_reader);
+
+/// Drop a removed endpoint from the journal.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_remove_endpoint(
+  const void * graph_key,
+  const rmw_gid_t & gid,
+  bool is_reader);
+
+/// Preload the snapshot file into a freshly initialized graph cache.
+/**
+ * Reads the configured file, validates its header and age, and inserts the
+ * recorded participants and endpoints tagged with `identifier`. A missing,
+ * malformed or stale file is skipped silently; discovery then fills the
+ * cache as it always has. The journal is not seeded from the file, so the
+ * next save only contains what this incarnation actually saw alive.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_preload(
+  const char * identifier,
+  rmw_dds_common::Context * common_context);
+
+/// Write the journal for `graph_key` to the snapshot file.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_save(const void * graph_key);
+
+/// Drop all journal state for `graph_key` when its context is destroyed.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+graph_snapshot_forget(const void * graph_key);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__GRAPH_SNAPSHOT_HPP_
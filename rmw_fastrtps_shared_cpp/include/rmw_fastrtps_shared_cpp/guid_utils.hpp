@@ -16,6 +16,8 @@
 #define RMW_FASTRTPS_SHARED_CPP__GUID_UTILS_HPP_
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <type_traits>
 
@@ -55,6 +57,45 @@ copy_from_fastrtps_guid_to_byte_array(
   memcpy(&guid_byte_array[prefix_size], &guid.entityId, guid.entityId.size);
 }
 
+/// Hash a Fast-RTPS GUID by mixing its two 64-bit halves.
+/**
+ * The 16 GUID bytes are loaded word-wise and run through a splitmix64-style
+ * finalizer. GUIDs from one participant differ only in a few entity id bytes,
+ * so truncation or xor-folding alone would cluster badly; the multiply/shift
+ * rounds spread those bits across the whole word.
+ */
+inline uint64_t
+hash_fastrtps_guid(const eprosima::fastrtps::rtps::GUID_t & guid)
+{
+  uint64_t words[2];
+  constexpr auto prefix_size = sizeof(guid.guidPrefix.value);
+  static_assert(
+    prefix_size + eprosima::fastrtps::rtps::EntityId_t::size == sizeof(words),
+    "a guid prefix plus an entity id should be exactly two words");
+  memcpy(words, guid.guidPrefix.value, prefix_size);
+  memcpy(
+    reinterpret_cast<uint8_t *>(words) + prefix_size,
+    guid.entityId.value, guid.entityId.size);
+
+  uint64_t h = words[0] + 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h += words[1];
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+/// Hash functor for unordered containers keyed by GUID.
+struct FastrtpsGuidHash
+{
+  size_t operator()(const eprosima::fastrtps::rtps::GUID_t & guid) const
+  {
+    return static_cast<size_t>(hash_fastrtps_guid(guid));
+  }
+};
+
 }  // namespace rmw_fastrtps_shared_cpp
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__GUID_UTILS_HPP_
@@ -0,0 +1,93 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__HANDLE_POOL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__HANDLE_POOL_HPP_
+
+#include <cstddef>
+#include <new>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Allocate a zeroed block from the process-wide handle pool.
+/**
+ * Backing store for the fixed-size blocks entity creation churns through:
+ * the rmw_*_t handle structs, their topic/service name copies and the
+ * Custom*Info and listener blocks. Freed blocks park in per-size-class
+ * atomic slot arrays (the same whole-slot exchange FastBufferPool uses,
+ * which sidesteps the free-list ABA problem without locks), so steady
+ * create/destroy cycles recycle warm blocks instead of exercising the
+ * global allocator. Oversize requests and pool misses fall back to
+ * middleware_allocator().
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void *
+handle_pool_allocate(size_t size);
+
+/// Return a block obtained from handle_pool_allocate; null is a no-op.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+handle_pool_release(void * ptr);
+
+/// Pooled equivalent of rcutils_strdup for entity name copies.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+char *
+handle_pool_copy_string(const char * str);
+
+/// Routes a type's new/delete through the handle pool.
+/**
+ * The Custom*Info and listener blocks derive from this, so every creation
+ * site in the typesupport packages pools them without changing; deletion
+ * through a base pointer still reaches these operators. Class-scope
+ * lookup hides the global forms, so the nothrow pair the creation sites
+ * use is declared here as well.
+ */
+class PooledAllocated
+{
+public:
+  static void *
+  operator new(size_t size)
+  {
+    void * ptr = handle_pool_allocate(size);
+    if (nullptr == ptr) {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+
+  static void *
+  operator new(size_t size, const std::nothrow_t &) noexcept
+  {
+    return handle_pool_allocate(size);
+  }
+
+  static void
+  operator delete(void * ptr)
+  {
+    handle_pool_release(ptr);
+  }
+
+  static void
+  operator delete(void * ptr, const std::nothrow_t &) noexcept
+  {
+    handle_pool_release(ptr);
+  }
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__HANDLE_POOL_HPP_
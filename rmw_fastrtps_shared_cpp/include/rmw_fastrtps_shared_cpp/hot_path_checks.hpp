@@ -0,0 +1,70 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__HOT_PATH_CHECKS_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__HOT_PATH_CHECKS_HPP_
+
+#include "rmw/error_handling.h"
+
+// Entry-point validation for the publish and take hot paths.
+//
+// The regular RMW_SET_ERROR_MSG / RCUTILS_CHECK_FOR_NULL_WITH_MSG macros
+// expand their error machinery inline, so every hot function carries the
+// format-string setup of its failure branches in its body.
+// RMW_FASTRTPS_CHECK_HANDLE keeps the fast path to a branch-hinted compare:
+// the error reporting is outlined into a cold, noinline helper.
+//
+// Building with -DRMW_FASTRTPS_MINIMAL_HANDLE_CHECKS=ON compiles the checks
+// out entirely, for production builds running fixed, validated graphs where
+// a mismatched or null handle cannot occur. Misuse the checks would have
+// caught becomes undefined behavior in such builds.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RMW_FASTRTPS_UNLIKELY(expr) (__builtin_expect(!!(expr), 0))
+#define RMW_FASTRTPS_COLD __attribute__((cold, noinline))
+#else
+#define RMW_FASTRTPS_UNLIKELY(expr) (expr)
+#define RMW_FASTRTPS_COLD
+#endif
+
+namespace rmw_fastrtps_shared_cpp
+{
+namespace detail
+{
+
+/// Outlined error reporting for failed hot-path handle checks.
+RMW_FASTRTPS_COLD
+inline void
+set_error_cold(const char * msg)
+{
+  RMW_SET_ERROR_MSG(msg);
+}
+
+}  // namespace detail
+}  // namespace rmw_fastrtps_shared_cpp
+
+#ifdef RMW_FASTRTPS_MINIMAL_HANDLE_CHECKS
+#define RMW_FASTRTPS_CHECK_HANDLE(cond, msg, fail_ret) \
+  do {(void)sizeof(cond);} while (0)
+#else
+#define RMW_FASTRTPS_CHECK_HANDLE(cond, msg, fail_ret) \
+  do { \
+    if (RMW_FASTRTPS_UNLIKELY(!(cond))) { \
+      rmw_fastrtps_shared_cpp::detail::set_error_cold(msg); \
+      return fail_ret; \
+    } \
+  } while (0)
+#endif
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__HOT_PATH_CHECKS_HPP_
@@ -0,0 +1,106 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__HUGEPAGE_ALLOCATOR_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__HUGEPAGE_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Hugepage backing for large payload buffers (RMW_FASTRTPS_HUGEPAGES=1).
+/**
+ * A gigabyte per second of payload through 4 KB pages keeps the TLB busy
+ * with the buffers alone. With the environment variable set, allocations
+ * of at least one huge page (2 MB) are served from explicit hugetlb
+ * mappings; when the hugetlb pool is exhausted or not configured the
+ * allocation falls back to a normal mapping advised towards transparent
+ * huge pages, with a single warning. Small allocations and non-Linux
+ * platforms always use the plain heap. Off by default: explicit huge
+ * pages round every buffer up to 2 MB and draw from a finite reserved
+ * pool, which only pays off on streams big enough to show TLB pressure.
+ */
+
+/// Whether RMW_FASTRTPS_HUGEPAGES asked for hugepage backing; parsed once.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+hugepages_enabled();
+
+/// Allocate size bytes, hugepage-backed when enabled and large enough.
+/**
+ * Returns null when the memory cannot be obtained at all.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void *
+hugepage_allocate(size_t size);
+
+/// Release memory from hugepage_allocate; size must match the allocation.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+hugepage_deallocate(void * ptr, size_t size);
+
+/// Standard allocator over hugepage_allocate, for the scratch vectors.
+template<typename T>
+struct HugePageAllocator
+{
+  using value_type = T;
+
+  HugePageAllocator() = default;
+
+  template<typename U>
+  HugePageAllocator(const HugePageAllocator<U> &) {}  // NOLINT(runtime/explicit)
+
+  T *
+  allocate(size_t n)
+  {
+    void * memory = hugepage_allocate(n * sizeof(T));
+    if (nullptr == memory) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(memory);
+  }
+
+  void
+  deallocate(T * ptr, size_t n)
+  {
+    hugepage_deallocate(ptr, n * sizeof(T));
+  }
+};
+
+template<typename T, typename U>
+bool
+operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &)
+{
+  return true;
+}
+
+template<typename T, typename U>
+bool
+operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &)
+{
+  return false;
+}
+
+/// Serialization scratch storage; hugepage-backed when requested and big
+/// enough to matter, a plain heap vector otherwise.
+using SerializationScratchBuffer = std::vector<char, HugePageAllocator<char>>;
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__HUGEPAGE_ALLOCATOR_HPP_
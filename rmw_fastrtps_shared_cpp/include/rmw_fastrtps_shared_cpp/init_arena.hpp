@@ -0,0 +1,67 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__INIT_ARENA_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__INIT_ARENA_HPP_
+
+#include <cstddef>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Monotonic bump allocator for initialization-phase scratch.
+/**
+ * Context startup makes many small allocations - peer list tokens, security
+ * file paths, attribute scratch - that die before or with the init phase.
+ * Freed individually they interleave with the long-lived allocations made
+ * while the participant comes up and leave fragmentation behind for the
+ * lifetime of the process. An arena hands them out from a few large chunks
+ * instead: allocations are a pointer bump, nothing is freed per object, and
+ * the chunks go back to middleware_allocator() in one sweep when the arena
+ * is destroyed at the end of the phase.
+ *
+ * Not thread safe; initialization runs on one thread and each arena stays
+ * on it. Allocation failures surface as nullptr, same as the handle pool.
+ */
+class RMW_FASTRTPS_SHARED_CPP_PUBLIC InitArena
+{
+public:
+  InitArena() = default;
+  ~InitArena();
+
+  InitArena(const InitArena &) = delete;
+  InitArena & operator=(const InitArena &) = delete;
+
+  /// Allocate `size` bytes, aligned for any type; freed only with the arena.
+  void *
+  allocate(size_t size);
+
+  /// Copy a NUL-terminated string into the arena.
+  char *
+  copy_string(const char * str);
+
+  /// Copy `length` bytes of `str` into the arena and NUL-terminate them.
+  char *
+  copy_string(const char * str, size_t length);
+
+private:
+  struct Chunk;
+  Chunk * head_{nullptr};
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__INIT_ARENA_HPP_
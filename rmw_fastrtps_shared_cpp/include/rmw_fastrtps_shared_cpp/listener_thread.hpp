@@ -22,10 +22,36 @@
 namespace rmw_fastrtps_shared_cpp
 {
 
+/// Start the discovery listener thread for `context`.
+/**
+ * With RMW_FASTRTPS_LAZY_GRAPH set to "1" the thread is not started here:
+ * the start is recorded as deferred and happens on the first graph query or
+ * graph guard condition use (see ensure_listener_thread). Discovery
+ * announcements accumulate in the reader history meanwhile and are drained
+ * once the thread runs, so processes that never look at the graph never pay
+ * for the thread or its wakeups.
+ *
+ * With RMW_FASTRTPS_SHARED_LISTENER_THREAD set to "1" the context instead
+ * registers its graph subscription with one process-wide listener thread
+ * that demultiplexes to the right graph cache, so a process hosting many
+ * contexts carries one near-idle discovery thread instead of one each.
+ * Combines with the lazy start above: a deferred context registers on its
+ * first graph use.
+ */
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 run_listener_thread(rmw_context_t * context);
 
+/// Start the discovery listener thread if its start was deferred.
+/**
+ * Called from every entry point that serves results out of the graph cache.
+ * When the thread is already running - the default - this is a single
+ * relaxed atomic load.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+ensure_listener_thread(rmw_context_t * context);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 join_listener_thread(rmw_context_t * context);
@@ -0,0 +1,54 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__MIDDLEWARE_ALLOCATOR_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__MIDDLEWARE_ALLOCATOR_HPP_
+
+#include "rcutils/allocator.h"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Install the allocator backing the middleware's own allocations.
+/**
+ * The rmw API threads caller allocators through the graph queries, but the
+ * take path has no allocator parameter, so its buffers have to come from
+ * somewhere the caller cannot name per call. This hook lets a deployment
+ * back those allocations — the pooled FastBuffers and internal transient
+ * queries — with a real-time pool instead of the default heap.
+ *
+ * Must be installed before the first rmw entity is created and never
+ * changed afterwards; memory obtained from one allocator is returned to
+ * whichever allocator is installed at release time, so swapping mid-flight
+ * mismatches the two. The allocator has to be thread safe: the Fast-RTPS
+ * reception threads allocate through it concurrently with takers.
+ *
+ * Buffer storage grown inside fastcdr still uses its own malloc/realloc;
+ * the pool's warm steady state performs no allocations at all, which is
+ * the property the hook extends to pool misses and warm-up.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+set_middleware_allocator(const rcutils_allocator_t & allocator);
+
+/// The installed middleware allocator; the rcutils default until one is set.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+const rcutils_allocator_t &
+middleware_allocator();
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__MIDDLEWARE_ALLOCATOR_HPP_
@@ -0,0 +1,162 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__MPSC_QUEUE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__MPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Unbounded lock-free multi-producer single-consumer queue.
+/**
+ * A push is one atomic exchange plus one store, a pop is one atomic load plus
+ * one store; neither side ever takes a lock. Popped nodes are parked in a
+ * small lock-free cache and handed back to producers, so steady-state traffic
+ * does not touch the allocator.
+ *
+ * pop() may report the queue as empty while a concurrent push is between its
+ * two steps; the element becomes visible once the push completes. Callers
+ * therefore must tolerate a spurious "empty" result, which matches the rmw
+ * take contract of setting taken to false.
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+  MpscQueue()
+  {
+    Node * stub = new Node();
+    head_.store(stub);
+    tail_ = stub;
+    for (auto & slot : cache_) {
+      slot.store(nullptr);
+    }
+  }
+
+  ~MpscQueue()
+  {
+    // No producer or consumer may be active at this point.
+    Node * node = tail_;
+    while (node != nullptr) {
+      Node * next = node->next.load();
+      delete node;
+      node = next;
+    }
+    for (auto & slot : cache_) {
+      delete slot.exchange(nullptr);
+    }
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue & operator=(const MpscQueue &) = delete;
+
+  void
+  push(T && value)
+  {
+    Node * node = acquire_node();
+    node->value = std::move(value);
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node * prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_release);
+  }
+
+  bool
+  pop(T & value)
+  {
+    Node * tail = tail_;
+    Node * next = tail->next.load(std::memory_order_acquire);
+    if (nullptr == next) {
+      return false;
+    }
+    value = std::move(next->value);
+    // next stays in the queue as the new stub; its moved-from value is
+    // overwritten by the push that eventually links past it.
+    tail_ = next;
+    release_node(tail);
+    size_.fetch_sub(1, std::memory_order_release);
+    return true;
+  }
+
+  bool
+  empty() const
+  {
+    return 0 == size_.load(std::memory_order_acquire);
+  }
+
+  /// Return the parked-node cache to the allocator.
+  /**
+   * Safe against concurrent producers and the consumer: nodes leave the
+   * cache through the same whole-slot exchanges it always uses. Traffic
+   * after a trim refills the cache through the ordinary miss path.
+   */
+  void
+  trim_cache()
+  {
+    for (auto & slot : cache_) {
+      delete slot.exchange(nullptr);
+    }
+  }
+
+private:
+  struct Node
+  {
+    std::atomic<Node *> next{nullptr};
+    T value;
+  };
+
+  Node *
+  acquire_node()
+  {
+    for (auto & slot : cache_) {
+      Node * node = slot.exchange(nullptr);
+      if (node != nullptr) {
+        return node;
+      }
+    }
+    return new Node();
+  }
+
+  void
+  release_node(Node * node)
+  {
+    node->value = T();
+    for (auto & slot : cache_) {
+      Node * expected = nullptr;
+      if (slot.compare_exchange_strong(expected, node)) {
+        return;
+      }
+    }
+    delete node;
+  }
+
+  static constexpr size_t kCacheSize = 16;
+
+  std::atomic<Node *> head_;
+  // Only touched by the single consumer.
+  Node * tail_;
+  std::atomic<size_t> size_{0};
+  // Same whole-slot exchange scheme as FastBufferPool; a node is either in
+  // exactly one slot or owned by exactly one thread, so there is no ABA
+  // hazard.
+  std::atomic<Node *> cache_[kCacheSize];
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__MPSC_QUEUE_HPP_
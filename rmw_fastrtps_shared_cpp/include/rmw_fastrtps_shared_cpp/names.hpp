@@ -15,6 +15,7 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__NAMES_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__NAMES_HPP_
 
+#include <cstring>
 #include <string>
 
 #include "fastrtps/utils/fixed_size_string.hpp"
@@ -34,15 +35,19 @@ _mangle_topic_name(
   const char * base,
   const char * suffix = nullptr)
 {
-  std::ostringstream topicName;
+  // Plain concatenation into a pre-sized string; an ostringstream would drag
+  // in stream and locale machinery for what is at most three appends.
+  std::string topicName;
+  topicName.reserve(
+    (prefix ? strlen(prefix) : 0) + strlen(base) + (suffix ? strlen(suffix) : 0));
   if (prefix) {
-    topicName << prefix;
+    topicName += prefix;
   }
-  topicName << base;
+  topicName += base;
   if (suffix) {
-    topicName << suffix;
+    topicName += suffix;
   }
-  return topicName.str();
+  return topicName;
 }
 
 /// Construct a topic name according to proper conventions.
@@ -25,6 +25,22 @@
 namespace rmw_fastrtps_shared_cpp
 {
 
+/// Create a participant, or attach to an existing one when sharing is enabled.
+/**
+ * With `RMW_FASTRTPS_SHARE_PARTICIPANT=1` in the environment, contexts of one
+ * process whose domain id, localhost setting and enclave match share a single
+ * participant, cutting per-context discovery traffic, threads and memory.
+ * The sharing contexts' graph caches are all updated from the shared
+ * discovery callbacks.
+ *
+ * Limitations of the sharing mode, which is why it is opt-in:
+ * contexts sharing a participant also share its GUID, so their node graph
+ * announcements overwrite each other in graph caches and node name queries
+ * become unreliable; topic and service discovery, matching and counts are
+ * unaffected. A context attaching to an existing participant also only
+ * learns about remote participants and endpoints that announce themselves
+ * after the attach. Secure participants are never shared.
+ */
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 CustomParticipantInfo *
 create_participant(
@@ -35,9 +51,16 @@ create_participant(
   const char * enclave,
   rmw_dds_common::Context * common_context);
 
+/// Destroy a participant, or just detach from it while it is still shared.
+/**
+ * \param common_context context being torn down; it is detached from the
+ *   participant listener before any teardown, so it must still be alive.
+ */
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
-destroy_participant(CustomParticipantInfo * info);
+destroy_participant(
+  CustomParticipantInfo * info,
+  rmw_dds_common::Context * common_context);
 
 }  // namespace rmw_fastrtps_shared_cpp
 
@@ -0,0 +1,87 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__PAYLOAD_COMPRESSION_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__PAYLOAD_COMPRESSION_HPP_
+
+#include <cstdint>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Wire compression for serialized payloads (EndpointOptions::compress_payloads).
+/**
+ * Compressed payloads are self-describing: an 8 byte frame (4 byte magic,
+ * 4 byte little-endian original length) followed by a PackBits-style
+ * run-length stream. The codec only ever replaces a payload when the framed
+ * result is strictly smaller, so a payload that starts with the magic is
+ * either compressed or a one-in-2^32 plain collision; topics whose plain
+ * bytes can begin with the magic should not mix compressed and plain
+ * publishers. Run-length coding was chosen because it needs no tables, no
+ * allocation and no external dependency while capturing most of the win on
+ * the sparse payloads (occupancy grids, padded structs, repeated strings)
+ * that make wire compression worth turning on; the framing carries the
+ * whole codec behind these four functions, so swapping the stream format
+ * for a dictionary coder later is local to payload_compression.cpp.
+ */
+
+/// Frame bytes preceding the compressed stream.
+constexpr uint32_t kCompressionFrameSize = 8u;
+
+/// Whether a payload carries the compression frame.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+payload_is_compressed(const uint8_t * data, uint32_t length);
+
+/// The original payload length a compressed frame announces.
+/**
+ * Only meaningful when payload_is_compressed() returned true.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+uint32_t
+compressed_payload_original_length(const uint8_t * data, uint32_t length);
+
+/// Compress input into output, frame included.
+/**
+ * Returns the framed length, or 0 when the framed result would not be
+ * strictly smaller than the input or does not fit output_capacity; on 0 the
+ * caller sends the payload plain. Input and output must not overlap.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+uint32_t
+compress_payload(
+  const uint8_t * input,
+  uint32_t length,
+  uint8_t * output,
+  uint32_t output_capacity);
+
+/// Expand a framed payload into output.
+/**
+ * Returns false on a malformed stream or when the announced original length
+ * exceeds output_capacity; output contents are unspecified then. Input and
+ * output must not overlap.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+decompress_payload(
+  const uint8_t * input,
+  uint32_t length,
+  uint8_t * output,
+  uint32_t output_capacity);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__PAYLOAD_COMPRESSION_HPP_
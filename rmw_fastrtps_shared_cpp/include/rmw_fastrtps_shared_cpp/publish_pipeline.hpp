@@ -0,0 +1,121 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__PUBLISH_PIPELINE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__PUBLISH_PIPELINE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw/ret_types.h"
+
+#include "rmw_fastrtps_shared_cpp/hugepage_allocator.hpp"
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+struct CustomPublisherInfo;
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Publish pipeline overlapping serialization with the RTPS send.
+/**
+ * With synchronous publishing, Publisher::write serializes the sample and
+ * drains the transport before returning, so serializing sample k+1 cannot
+ * start until sample k is on the wire. A pipeline holds a small ring of
+ * payload slots and a sender thread: the publish call serializes into the
+ * next free slot and returns, while the sender writes filled slots in order.
+ * With two slots, serialization of k+1 runs while k transmits; more slots
+ * absorb burstier send times. When every slot is filled the publish call
+ * blocks until one frees, which is the natural back-pressure.
+ *
+ * Created per publisher via EndpointOptions::publish_pipeline_depth and
+ * owned by its CustomPublisherInfo. A write failure on the sender thread is
+ * latched and reported by the next publish call (once, then cleared); the
+ * failed sample itself is lost, as it would be with an asynchronous writer.
+ * The DDS source timestamp is stamped when the sender writes, so it trails
+ * the publish call by the queueing delay.
+ */
+class PublishPipeline
+{
+public:
+  /// Start the sender; `depth` is clamped to at least two slots.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  PublishPipeline(CustomPublisherInfo * info, uint32_t depth);
+
+  /// Drains the remaining slots, then stops and joins the sender.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  ~PublishPipeline();
+
+  /// Serialize `ros_message` into a free slot and hand it to the sender.
+  /**
+   * Blocks only while every slot is in flight. Serialization happens under
+   * the pipeline mutex, which the sender never holds while writing, so
+   * concurrent publishers are serialized against each other exactly as the
+   * writer itself would serialize them.
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  rmw_ret_t
+  publish(const void * ros_message);
+
+  /// Block until every queued sample has been handed to the writer.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  rmw_ret_t
+  flush();
+
+  /// Grow every free slot to payload_size and touch its pages
+  /// (__rmw_publisher_prewarm). Slots currently in flight are left alone.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  prewarm(size_t payload_size);
+
+private:
+  struct Slot
+  {
+    // Kept at high-water size, so steady-state publishes of a stable-sized
+    // topic never reallocate; hugepage-backed when requested
+    // (hugepage_allocator.hpp).
+    SerializationScratchBuffer buffer;
+    uint32_t length = 0;
+  };
+
+  void run();
+
+  CustomPublisherInfo * info_;
+  std::vector<Slot> slots_;
+
+  std::mutex mutex_;
+  // Waited by publish() and flush(); signalled when the sender frees a slot.
+  std::condition_variable slot_free_;
+  // Waited by the sender; signalled when publish() fills a slot or on stop.
+  std::condition_variable slot_ready_;
+  // Ring state: the sender consumes from head_, publishes fill behind it.
+  size_t head_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = 0;
+  size_t queued_count_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = 0;
+  bool stop_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = false;
+
+  // Set by the sender on a failed write, consumed by the next publish.
+  std::atomic_bool failed_{false};
+
+  std::thread sender_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__PUBLISH_PIPELINE_HPP_
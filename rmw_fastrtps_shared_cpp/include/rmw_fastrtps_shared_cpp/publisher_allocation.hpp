@@ -0,0 +1,34 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__PUBLISHER_ALLOCATION_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__PUBLISHER_ALLOCATION_HPP_
+
+#include "rmw_fastrtps_shared_cpp/hugepage_allocator.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+// Payload carried by rmw_publisher_allocation_t::data.
+// Holds a reusable serialization buffer so that repeated publishes do not
+// allocate; for bounded types it is preallocated to the maximum serialized
+// size, for unbounded types it grows on demand and is kept for reuse.
+struct PublisherAllocation
+{
+  SerializationScratchBuffer buffer;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__PUBLISHER_ALLOCATION_HPP_
@@ -0,0 +1,55 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__READY_SLOT_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__READY_SLOT_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// One entity's bit in a wait set's two-level readiness index.
+/**
+ * The wait set groups its attached entities into 64 bit words and keeps one
+ * summary word with a bit per group. A listener marks its slot whenever it
+ * becomes ready, so the waiter can validate a wakeup by walking only the set
+ * summary bits and the words under them instead of polling every attached
+ * entity; on large wait sets that makes the scan O(ready) rather than
+ * O(attached). The slot is handed out when the entity is attached and
+ * cleared when it is detached; a default constructed slot marks nothing.
+ */
+struct ReadySlot
+{
+  std::atomic<uint64_t> * word{nullptr};
+  uint64_t word_bit{0};
+  std::atomic<uint64_t> * summary{nullptr};
+  uint64_t summary_bit{0};
+
+  void
+  mark() const
+  {
+    if (nullptr != word) {
+      // Entity bit before summary bit: a scanner that follows a set summary
+      // bit always finds the entity bit already set under it.
+      word->fetch_or(word_bit, std::memory_order_relaxed);
+      summary->fetch_or(summary_bit, std::memory_order_relaxed);
+    }
+  }
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__READY_SLOT_HPP_
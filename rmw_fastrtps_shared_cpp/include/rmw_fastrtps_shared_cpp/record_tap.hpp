@@ -0,0 +1,57 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__RECORD_TAP_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__RECORD_TAP_HPP_
+
+#include <cstdint>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Append one CDR payload to the process record ring, if one is configured.
+/**
+ * RMW_FASTRTPS_RECORD_TAP_FILE names a file that is memory mapped as a
+ * process-wide ring an external recorder consumes; without it this is a
+ * pointer check and a return. Every outgoing payload is captured right after
+ * serialization and every consumed incoming payload right before
+ * deserialization, so a recorder gets the exact CDR bytes without
+ * subscribing to each topic and paying a second take/deserialize.
+ *
+ * Each record is a fixed header (payload length, direction, wall-clock
+ * nanosecond timestamp, 64 bit hash of the type name) followed by the
+ * payload, padded to 8 bytes. The writer side is lock free: concurrent
+ * writers reserve disjoint ranges with one fetch_add and copy without
+ * further coordination. The ring is overwrite-on-wrap; a reader that lags a
+ * full ring behind loses records, and it validates a record against the
+ * write position before trusting it, since an in-flight copy is visible.
+ *
+ * RMW_FASTRTPS_RECORD_TAP_SIZE sizes the ring data region in bytes
+ * (rounded up to a power of two, default 64 MiB).
+ *
+ * \param[in] type_name Registered type name of the payload.
+ * \param[in] payload The CDR bytes, including encapsulation.
+ * \param[in] length Length of \p payload in bytes.
+ * \param[in] incoming true for received samples, false for published ones.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+record_tap_capture(
+  const char * type_name, const void * payload, uint32_t length, bool incoming);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__RECORD_TAP_HPP_
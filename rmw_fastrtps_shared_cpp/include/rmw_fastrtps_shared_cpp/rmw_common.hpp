@@ -24,6 +24,10 @@
 #include "rmw/types.h"
 #include "rmw/names_and_types.h"
 
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
+
+struct TakenEventStatuses;
+
 namespace rmw_fastrtps_shared_cpp
 {
 
@@ -79,10 +83,34 @@ __rmw_trigger_guard_condition(
   const char * identifier,
   const rmw_guard_condition_t * guard_condition_handle);
 
+/// Apply RMW_FASTRTPS_GRAPH_QUIET_US trigger coalescing to the context's
+/// graph guard condition, so a discovery storm wakes graph watchers once
+/// per quiet window instead of once per discovered entity.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+apply_graph_guard_coalescing(rmw_guard_condition_t * guard_condition);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_set_log_severity(rmw_log_severity_t severity);
 
+/// Release idle pooled middleware memory held on the context's behalf.
+/**
+ * After a startup or traffic burst the process-wide buffer pool keeps its
+ * buffers at burst capacity forever. This trims idle buffers above the
+ * pool's decayed high-water mark (see FastBufferPool::trim) and reports the
+ * bytes released; call it from a housekeeping task during idle stretches,
+ * where each call decays the mark further. Entity-local caches are trimmed
+ * separately through __rmw_subscription_trim, __rmw_client_trim and
+ * __rmw_service_trim. Traffic after a trim re-grows everything on demand.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_context_trim_memory(
+  const char * identifier,
+  rmw_context_t * context,
+  size_t * bytes_released);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_node_t *
 __rmw_create_node(
@@ -133,6 +161,32 @@ __rmw_get_node_names_with_enclaves(
   rcutils_string_array_t * node_namespaces,
   rcutils_string_array_t * enclaves);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_init_publisher_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_publisher_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_fini_publisher_allocation(
+  const char * identifier,
+  rmw_publisher_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_init_subscription_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_subscription_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_fini_subscription_allocation(
+  const char * identifier,
+  rmw_subscription_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_publish(
@@ -141,6 +195,19 @@ __rmw_publish(
   const void * ros_message,
   rmw_publisher_allocation_t * allocation);
 
+/// Publish a batch of messages on one publisher.
+/// The batch is serialized into a single contiguous arena (the allocation
+/// scratch buffer, when one is given) before being handed to the writer,
+/// amortizing per-publish sizing and buffer allocation over the batch.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publish_batch(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const void * const * ros_messages,
+  size_t count,
+  rmw_publisher_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_publish_serialized_message(
@@ -149,6 +216,29 @@ __rmw_publish_serialized_message(
   const rmw_serialized_message_t * serialized_message,
   rmw_publisher_allocation_t * allocation);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publish_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const void * ros_message,
+  rmw_publisher_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_borrow_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const rosidl_message_type_support_t * type_support,
+  void ** ros_message);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_return_loaned_message_from_publisher(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * loaned_message);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_publisher_assert_liveliness(
@@ -168,12 +258,57 @@ __rmw_publisher_count_matched_subscriptions(
   const rmw_publisher_t * publisher,
   size_t * subscription_count);
 
+/// Number of writes this publisher's writer has rejected under backpressure.
+/**
+ * A reliable writer whose history is full of unacknowledged samples blocks
+ * the publish call for at most its max blocking time
+ * (EndpointOptions::max_blocking_ms; zero rejects immediately) and then
+ * fails the write. Each such rejection increments this monotonic counter,
+ * so an application that chose fail-fast can see how much a slow
+ * subscriber is pushing back and decide whether to drop, retry or slow
+ * down. Never reset for the life of the publisher.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publisher_get_backpressure_count(
+  const rmw_publisher_t * publisher,
+  uint64_t * backpressure_count);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_publisher_get_actual_qos(
   const rmw_publisher_t * publisher,
   rmw_qos_profile_t * qos);
 
+/// Preallocate and pre-touch the publisher's steady-state buffers; the
+/// publish-side twin of __rmw_subscription_prewarm. Warms the pipeline
+/// slots when pipelined publishing is on, and buffer_count pooled
+/// serialization buffers.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publisher_prewarm(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  size_t payload_size,
+  size_t buffer_count);
+
+/// Block until every matched reliable reader acknowledged all samples.
+/**
+ * Lets a batch publisher release or reuse its buffers the moment the data
+ * actually arrived instead of sleeping a conservative margin. \p wait_timeout
+ * null blocks until everything is acked; a zero timeout polls the current
+ * acknowledgment state without blocking, which a pipeline can call between
+ * batches as a cheap flush check. Returns RMW_RET_TIMEOUT when samples are
+ * still outstanding at the deadline. Best-effort publishers report success
+ * immediately.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publisher_wait_for_acknowledgments(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const rmw_time_t * wait_timeout);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_send_request(
@@ -182,6 +317,25 @@ __rmw_send_request(
   const void * ros_request,
   int64_t * sequence_id);
 
+/// Send a burst of requests to one service in a single call.
+/**
+ * Serializes all `count` requests into one contiguous arena before the
+ * first write, so the per-request work under the writer's lock shrinks to
+ * the payload copy and the history insertion, and the writes land
+ * back-to-back for the RTPS layer to cover with shared heartbeat
+ * bookkeeping. `sequence_ids` receives one id per request, in order, for
+ * pairing the responses. On a write failure the requests already written
+ * are on the wire with their ids filled and the rest were not sent.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_send_request_batch(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * const * ros_requests,
+  size_t count,
+  int64_t * sequence_ids);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_request(
@@ -191,6 +345,20 @@ __rmw_take_request(
   void * ros_request,
   bool * taken);
 
+/// Take up to `count` pending requests in one call.
+/// Drains the service's request queue into the caller-provided header and
+/// message arrays, amortizing per-call overhead over a burst; `taken` is set
+/// to the number of requests actually dequeued and deserialized.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_request_batch(
+  const char * identifier,
+  const rmw_service_t * service,
+  rmw_service_info_t * request_headers,
+  void ** ros_requests,
+  size_t count,
+  size_t * taken);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_response(
@@ -200,6 +368,21 @@ __rmw_take_response(
   void * ros_response,
   bool * taken);
 
+/// Take up to `count` completed responses in one call.
+/// The counterpart of __rmw_take_request_batch for clients with many
+/// requests in flight: one call drains the listener's queue into the
+/// caller's header and message arrays, and the headers' sequence numbers
+/// pair each response with its request.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_response_batch(
+  const char * identifier,
+  const rmw_client_t * client,
+  rmw_service_info_t * response_headers,
+  void ** ros_responses,
+  size_t count,
+  size_t * taken);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_send_response(
@@ -265,6 +448,70 @@ __rmw_get_subscriber_names_and_types_by_node(
   bool no_demangle,
   rmw_names_and_types_t * topic_names_and_types);
 
+/// Resolved-node handle for repeated by-node graph queries.
+/**
+ * Opaque; obtained from `__rmw_node_query_handle_create` and released with
+ * `__rmw_node_query_handle_destroy`.
+ */
+struct NodeQueryHandle;
+
+/// Resolve a node by name and namespace once for repeated graph queries.
+/**
+ * Validates the arguments and confirms the node currently exists in the
+ * graph, then returns a handle holding the resolved name, namespace and
+ * pre-composed query keys. The by-handle queries below skip the per-call
+ * string validation and are served from the generation-stamped query
+ * snapshots while the graph is unchanged, so a periodic poll of a settled
+ * graph never re-walks the graph cache. If the node goes away after
+ * resolution, the next by-handle query returns
+ * RMW_RET_NODE_NAME_NON_EXISTENT just like the by-name query would.
+ *
+ * \return RMW_RET_NODE_NAME_NON_EXISTENT if no such node is in the graph.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_node_query_handle_create(
+  const char * identifier,
+  const rmw_node_t * node,
+  const char * node_name,
+  const char * node_namespace,
+  NodeQueryHandle ** handle);
+
+/// Release a resolved-node handle.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_node_query_handle_destroy(NodeQueryHandle * handle);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_subscriber_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  bool no_demangle,
+  rmw_names_and_types_t * topic_names_and_types);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_publisher_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  bool no_demangle,
+  rmw_names_and_types_t * topic_names_and_types);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_service_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * service_names_and_types);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_client_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * service_names_and_types);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_service_server_is_available(
@@ -273,6 +520,105 @@ __rmw_service_server_is_available(
   const rmw_client_t * client,
   bool * is_available);
 
+/// Block until the client's service server is available or the timeout hits.
+/**
+ * Waits on the client's matching notifications rather than polling
+ * `__rmw_service_server_is_available`; a null `wait_timeout` waits forever.
+ * Returns RMW_RET_TIMEOUT if the timeout expires first.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_client_wait_for_service_server(
+  const char * identifier,
+  const rmw_node_t * node,
+  const rmw_client_t * client,
+  const rmw_time_t * wait_timeout,
+  bool * is_available);
+
+/// Whether a response is waiting to be taken, as one relaxed atomic load.
+/**
+ * Non-blocking readiness predicate for polling consumers; unlike a
+ * zero-timeout wait it touches no wait set and attaches nothing. Like any
+ * poll the answer can be stale by the time the take runs, so a take after
+ * `true` can still come back empty.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_client_has_response(
+  const char * identifier,
+  const rmw_client_t * client,
+  bool * has_response);
+
+/// Send a request and block in place until its response arrives.
+/**
+ * Fuses send, wait and take for synchronous callers: the wait parks directly
+ * on the client's listener instead of going through a wait set, removing the
+ * attach/detach cycles and the cross-thread wakeup handoff of the generic
+ * path. Responses to other, abandoned requests of this client are discarded
+ * while waiting. A null `wait_timeout` waits forever; on RMW_RET_TIMEOUT
+ * `taken` stays false and the response, if it still arrives, is dropped by a
+ * later call or the client's destruction. The client must not be attached to
+ * a wait set concurrently, same as it must not sit in two wait sets.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_client_call(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * ros_request,
+  rmw_service_info_t * response_header,
+  void * ros_response,
+  const rmw_time_t * wait_timeout,
+  bool * taken);
+
+/// Release the client's idle queue caches; see __rmw_context_trim_memory.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_client_trim(
+  const char * identifier,
+  const rmw_client_t * client);
+
+/// Whether a request is waiting to be taken; see __rmw_client_has_response.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_service_has_request(
+  const char * identifier,
+  const rmw_service_t * service,
+  bool * has_request);
+
+/// Bound a service's request queue by depth and by request age.
+/**
+ * With a depth limit, requests arriving while that many sit untaken are
+ * dropped on reception; with an age limit, queued requests whose source
+ * timestamp is older than `max_request_age_ns` are dropped at take time,
+ * before being deserialized — callers that have already timed out no longer
+ * cost the overloaded server anything. Zero disables either limit (the
+ * default). Dropped requests get no response, like a lost best-effort
+ * sample; they are only counted, see __rmw_service_get_shed_count.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_service_set_admission_control(
+  const char * identifier,
+  const rmw_service_t * service,
+  size_t max_queue_depth,
+  int64_t max_request_age_ns);
+
+/// Requests dropped by admission control since the service was created.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_service_get_shed_count(
+  const char * identifier,
+  const rmw_service_t * service,
+  uint64_t * shed_count);
+
+/// Release the service's idle queue caches; see __rmw_context_trim_memory.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_service_trim(
+  const char * identifier,
+  const rmw_service_t * service);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_destroy_subscription(
@@ -286,6 +632,43 @@ __rmw_subscription_count_matched_publishers(
   const rmw_subscription_t * subscription,
   size_t * publisher_count);
 
+/// Preallocate and pre-touch the subscription's steady-state buffers.
+/**
+ * For an mlockall'd real-time process: the pooled take/spill buffers are
+ * grown to payload_size (0 uses the type's current size estimate) and every
+ * page is touched, so the faults land here at startup instead of on the
+ * first message inside the control loop. buffer_count says how many buffers
+ * to warm — pass the history depth the subscription is expected to hold.
+ * Call from the thread whose NUMA node should own the pages (the buffer
+ * pool stripes by node). The reader history itself lives inside Fast-RTPS
+ * and is preallocated by its PREALLOCATED memory policies, not from here.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_prewarm(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t payload_size,
+  size_t buffer_count);
+
+/// Release the subscription's idle overflow storage; the reclamation twin
+/// of __rmw_subscription_prewarm. Spilled samples still waiting to be
+/// taken are never dropped, so trimming is always safe.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_trim(
+  const char * identifier,
+  const rmw_subscription_t * subscription);
+
+/// Whether unread samples are waiting to be taken, including any held by
+/// the history extension; see __rmw_client_has_response.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_has_data(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  bool * has_data);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_subscription_get_actual_qos(
@@ -320,6 +703,21 @@ __rmw_take_event(
   void * event_info,
   bool * taken);
 
+/// Drain every raised QoS event of the entity behind `event_handle`.
+/**
+ * One call replaces a check-and-take pair per watched event type; the mask
+ * identifies which members of `statuses` were filled (see
+ * EventListenerInterface::event_bit). Returns RMW_RET_OK with a zero mask
+ * when nothing was raised.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_all_events(
+  const char * identifier,
+  const rmw_event_t * event_handle,
+  TakenEventStatuses * statuses,
+  uint32_t * taken_mask);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_with_info(
@@ -330,6 +728,42 @@ __rmw_take_with_info(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation);
 
+/// One entry of a fused multi-take (see `__rmw_take_multi`).
+struct TakeMultiEntry
+{
+  /// Subscription to take from for this entry.
+  const rmw_subscription_t * subscription;
+  /// Destination for the deserialized message.
+  void * ros_message;
+  /// Filled when non-null.
+  rmw_message_info_t * message_info;
+  /// Optional preallocated take resources, may be null.
+  rmw_subscription_allocation_t * allocation;
+  /// Set by the call: whether a message was written to `ros_message`.
+  bool taken;
+};
+
+/// Take one message from each of `count` subscriptions in a single pass.
+/**
+ * Equivalent to calling `__rmw_take_with_info` once per entry, but an
+ * executor waking with many ready subscriptions crosses the rmw boundary
+ * once per cycle instead of once per subscription. Feed it the ready list
+ * collected by `__rmw_wait` (see CustomWaitsetInfo::last_ready_entities),
+ * keeping entries of the same subscription adjacent so its reader history
+ * stays hot across them. Entries are drained in order; an empty history
+ * just leaves that entry's `taken` false.
+ *
+ * Stops at the first failing entry and returns its error; `taken_count`
+ * always reflects the messages actually delivered.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_multi(
+  const char * identifier,
+  TakeMultiEntry * entries,
+  size_t count,
+  size_t * taken_count);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_serialized_message(
@@ -349,6 +783,126 @@ __rmw_take_serialized_message_with_info(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation);
 
+/// A serialized sample on loan from the middleware
+/// (see `__rmw_take_loaned_serialized_sample`).
+struct LoanedSerializedSample
+{
+  /// Borrowed view of the raw CDR payload, including the 4 byte
+  /// encapsulation header. Valid until the sample is returned.
+  const uint8_t * buffer;
+  /// Payload length in bytes.
+  uint32_t length;
+  /// GUID of the writer the sample came from.
+  rmw_gid_t writer_gid;
+  /// The writer's sequence number for this sample; together with
+  /// `writer_gid` this is the sample's full DDS identity.
+  uint64_t sequence_number;
+  /// Source timestamp of the sample, in nanoseconds.
+  int64_t source_timestamp;
+  /// Reception timestamp, in nanoseconds; the arrival stamp when arrival
+  /// timestamping is on (see RMW_FASTRTPS_ARRIVAL_TIMESTAMPS).
+  int64_t received_timestamp;
+  /// Loan token owned by the middleware; callers leave it alone.
+  void * impl;
+};
+
+/// Take the next sample as a borrowed payload view instead of a copy.
+/**
+ * Fills \p sample with the sample's CDR bytes and full identity. The one
+ * payload copy this Fast-RTPS version requires happens out of the reader
+ * history into a pooled scratch buffer; that buffer is then lent to the
+ * caller as-is, so unlike `__rmw_take_serialized_message` nothing is copied
+ * into a caller-owned message. Bridges forwarding raw CDR hand the view
+ * straight to their uplink and return it.
+ *
+ * Every successful take (`*taken` true) must be paired with
+ * `__rmw_return_loaned_serialized_sample`, which recycles the buffer;
+ * the view is invalid afterwards. Loans are independent, so several may be
+ * outstanding at once. Content filters do not apply to raw takes.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_loaned_serialized_sample(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  LoanedSerializedSample * sample,
+  bool * taken);
+
+/// Hand a loaned sample back, recycling its buffer.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_return_loaned_serialized_sample(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  LoanedSerializedSample * sample);
+
+/// Install caller-constructed message objects for loaned ros message takes.
+/**
+ * For types with strings and sequences, deserializing into a fresh message
+ * every take reallocates the same fields cycle after cycle. The pool cycles
+ * `count` pre-constructed messages through `__rmw_take_loaned_ros_message`,
+ * so each deserialization lands in an object whose fields already carry
+ * their steady-state capacity. The constructing and destroying of ROS
+ * messages is type-support business the rmw layer cannot do generically,
+ * so ownership stays with the caller: clear the pool (count 0) and collect
+ * all outstanding loans before destroying the objects or the subscription.
+ * Replacing a non-empty pool forgets the free entries of the old one.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_subscription_set_loan_pool(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * const * ros_messages,
+  size_t count);
+
+/// Wait for a sample on one subscription and take it in the same call.
+/**
+ * Fuses the wait and the take for a dedicated single-subscription consumer:
+ * a queued sample is returned immediately, otherwise the call parks on the
+ * subscription's listener until data arrives or `wait_timeout` elapses
+ * (NULL blocks indefinitely, zero polls), then takes. One middleware
+ * crossing per message instead of a __rmw_wait pass plus a __rmw_take.
+ * Returns RMW_RET_TIMEOUT when the deadline passes without a sample. The
+ * call occupies the listener's condition slot, so the subscription must
+ * not be attached to a wait set while it is consumed this way.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_with_deadline(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * ros_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  const rmw_time_t * wait_timeout);
+
+/// Take the next sample into a pooled message object instead of a copy.
+/**
+ * Borrows a message from the subscription's loan pool, deserializes into it
+ * (reusing the object's grown string and sequence capacity) and hands it to
+ * the caller; with `*taken` true the loan must be paired with
+ * `__rmw_return_loaned_ros_message`. Fails when the pool is empty — either
+ * not installed, or all objects are out on loan. Content filters and the
+ * history extension apply exactly as in `__rmw_take_with_info`.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_loaned_ros_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** ros_message,
+  bool * taken,
+  rmw_message_info_t * message_info);
+
+/// Return a loaned message object to the subscription's pool.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_return_loaned_ros_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * ros_message);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_get_topic_names_and_types(
@@ -358,6 +912,48 @@ __rmw_get_topic_names_and_types(
   bool no_demangle,
   rmw_names_and_types_t * topic_names_and_types);
 
+/// Visit the topic graph in place instead of materializing a result.
+/**
+ * Same view as __rmw_get_topic_names_and_types, served through
+ * visit_cached_names_and_types (graph_query_cache.hpp): while the graph is
+ * unchanged the visitor walks the cached snapshot directly and the call
+ * allocates nothing, whatever the topic count. For monitoring loops that
+ * only read the graph, not the rmw_names_and_types_t contract.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_visit_topic_names_and_types(
+  const char * identifier,
+  const rmw_node_t * node,
+  bool no_demangle,
+  const NamesAndTypesVisitor & visitor);
+
+/// Retrieve the topic graph in bounded chunks instead of one array.
+/**
+ * Same view as __rmw_get_topic_names_and_types, served through
+ * cached_names_and_types_query_chunk (graph_query_cache.hpp): each call
+ * builds at most \p max_entries entries starting at \p offset with the
+ * caller's allocator, and \p more reports whether entries remain. A pull is
+ * anchored to one immutable snapshot via \p continuation - pass zero to
+ * start, then the returned token unchanged per chunk - so the chunks of a
+ * fleet-scale pull stay mutually consistent while discovery keeps moving,
+ * and no allocation or lock ever covers more than one chunk. If the
+ * snapshot is replaced mid-pull the continuation call fails and the pull
+ * restarts from a zero token.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_get_topic_names_and_types_chunk(
+  const char * identifier,
+  const rmw_node_t * node,
+  rcutils_allocator_t * allocator,
+  bool no_demangle,
+  size_t offset,
+  size_t max_entries,
+  uint64_t * continuation,
+  bool * more,
+  rmw_names_and_types_t * topic_names_and_types);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_wait(
@@ -369,6 +965,63 @@ __rmw_wait(
   rmw_wait_set_t * wait_set,
   const rmw_time_t * wait_timeout);
 
+/// Wait bounded by an absolute deadline instead of a relative timeout.
+/**
+ * \p deadline_ns is nanoseconds on the monotonic clock
+ * (std::chrono::steady_clock); a negative value blocks until something is
+ * ready. A periodic caller computes its next wakeup once and passes it to
+ * every wait of the cycle, so time spent taking and executing between waits
+ * is charged against the period instead of silently extending it — with a
+ * relative timeout each re-wait restarts the budget and the drift
+ * accumulates.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_wait_until(
+  rmw_subscriptions_t * subscriptions,
+  rmw_guard_conditions_t * guard_conditions,
+  rmw_services_t * services,
+  rmw_clients_t * clients,
+  rmw_events_t * events,
+  rmw_wait_set_t * wait_set,
+  int64_t deadline_ns);
+
+/// Copy out the compact ready list from the last wait on a wait set.
+/**
+ * The entities found ready by the previous __rmw_wait are collected while
+ * the entity arrays are scrubbed, so an executor can iterate exactly what
+ * fired instead of rescanning every array entry for the non-null survivors.
+ * The list holds the same pointers the arrays keep non-null: entity data
+ * pointers, and the rmw_event_t pointer for events. Up to \p capacity
+ * pointers are copied into \p entities; \p count receives the full ready
+ * count, which may exceed \p capacity. Only meaningful between two waits on
+ * the same wait set and not synchronized against a concurrent wait.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_wait_set_get_last_ready(
+  const char * identifier,
+  const rmw_wait_set_t * wait_set,
+  void ** entities,
+  size_t capacity,
+  size_t * count);
+
+/// Assign a dispatch priority to a waitable entity.
+/**
+ * `entity` is the data pointer the wait arrays carry and the ready list
+ * reports (subscription/client/service data, guard condition data, or the
+ * rmw_event_t pointer). With any nonzero priority registered, every wait
+ * stable-sorts its ready list so higher priorities come first: an executor
+ * dispatching in list order then services a safety heartbeat before bulk
+ * telemetry that woke in the same cycle. Unregistered entities rank at
+ * zero, negative priorities sort after them, and setting zero removes the
+ * entry again. The priority follows the entity across wait sets and is
+ * dropped when the entity is destroyed.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_wait_set_entity_priority(void * entity, int32_t priority);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_wait_set_t *
 __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t max_conditions);
@@ -377,6 +1030,27 @@ RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set);
 
+/// Export the wait set as a pollable file descriptor (Linux only).
+/**
+ * Returns an eventfd the attached listeners signal whenever they would wake
+ * a blocked `__rmw_wait`, so the wait set can join an external epoll/select
+ * loop directly. The fd is created on first call, stays valid until the
+ * wait set is destroyed, and covers whatever entities the most recent
+ * `__rmw_wait` attached — callers should do one blocking-capable wait (or
+ * at least a zero-timeout one) after changing the composition so new
+ * entities pick the fd up.
+ *
+ * When the fd becomes readable, drain its 8-byte counter and call
+ * `__rmw_wait` with a zero timeout to collect the ready entities; the
+ * counter coalesces bursts, so one wakeup may cover many events.
+ *
+ * Returns RMW_RET_UNSUPPORTED on platforms without eventfd.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_wait_set_get_file_descriptor(
+  const char * identifier, rmw_wait_set_t * wait_set, int * fd);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_get_publishers_info_by_topic(
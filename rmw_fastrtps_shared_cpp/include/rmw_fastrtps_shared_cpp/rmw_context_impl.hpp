@@ -15,6 +15,7 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__RMW_CONTEXT_IMPL_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__RMW_CONTEXT_IMPL_HPP_
 
+#include <atomic>
 #include <mutex>
 
 struct rmw_context_impl_t
@@ -27,6 +28,13 @@ struct rmw_context_impl_t
   std::mutex mutex;
   /// Reference count.
   uint64_t count;
+  /// True while the discovery listener thread start has been deferred
+  /// (see RMW_FASTRTPS_LAZY_GRAPH); cleared once the thread is running.
+  std::atomic<bool> listener_thread_deferred{false};
+  /// True once rmw_shutdown ran with RMW_FASTRTPS_FAST_TEARDOWN=1; entity
+  /// destruction then skips the per-entity graph updates and announcements,
+  /// leaving the participant disposal to retract everything at once.
+  std::atomic<bool> fast_teardown{false};
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__RMW_CONTEXT_IMPL_HPP_
@@ -38,6 +38,20 @@ RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 rmw_init_options_fini(const char * identifier, rmw_init_options_t * init_options);
 
+/// Record that rmw_shutdown was called on `context`.
+/**
+ * With RMW_FASTRTPS_FAST_TEARDOWN=1 this arms fast teardown: entities
+ * destroyed after this point skip the per-entity graph-cache dissociation
+ * and announcement broadcast. Remote graphs clean up from the participant
+ * disposal emitted when the context is finalized, which retracts every
+ * entity of this participant in one go; a node with hundreds of endpoints
+ * then shuts down without publishing hundreds of full-state snapshots.
+ * Without the variable set, shutdown stays a no-op.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+mark_context_shutdown(rmw_context_t * context);
+
 }  // namespace rmw_fastrtps_shared_cpp
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__RMW_INIT_HPP_
@@ -0,0 +1,87 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__SERIALIZATION_PROFILING_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__SERIALIZATION_PROFILING_HPP_
+
+#include <cstdint>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Read the cycle counter (TSC on x86, a monotonic nanosecond clock
+/// elsewhere). Only meaningful relative to another read on the same thread.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+uint64_t
+serialization_profile_now();
+
+/// Record one (de)serialization of \p type_name that took \p cycles.
+/**
+ * Samples land in a log2-bucketed histogram owned by the calling thread, so
+ * recording is a map lookup and an increment with no shared-state
+ * synchronization on the hot path.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+serialization_profile_record(const char * type_name, bool deserialize, uint64_t cycles);
+
+/// Dump the histograms of every thread, aggregated per type.
+/**
+ * Writes to the file named by RMW_FASTRTPS_SERIALIZATION_PROFILE_FILE, or to
+ * stderr without it. Counters are read without stopping the recording
+ * threads; a dump taken under load is a close approximation, not an exact
+ * snapshot, which is fine for the regression-hunting this exists for.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+serialization_profile_dump();
+
+#ifdef RMW_FASTRTPS_PROFILE_SERIALIZATION
+
+/// Times its enclosing scope and records it on destruction, so every return
+/// path of the instrumented function is covered.
+class SerializationProfileScope
+{
+public:
+  SerializationProfileScope(const char * type_name, bool deserialize)
+  : type_name_(type_name), deserialize_(deserialize), begin_(serialization_profile_now())
+  {}
+
+  ~SerializationProfileScope()
+  {
+    serialization_profile_record(
+      type_name_, deserialize_, serialization_profile_now() - begin_);
+  }
+
+private:
+  const char * type_name_;
+  bool deserialize_;
+  uint64_t begin_;
+};
+
+#define RMW_FASTRTPS_SERIALIZATION_PROFILE_SCOPE(type_name, deserialize) \
+  rmw_fastrtps_shared_cpp::SerializationProfileScope _serialization_profile_scope( \
+    type_name, deserialize)
+
+#else
+
+#define RMW_FASTRTPS_SERIALIZATION_PROFILE_SCOPE(type_name, deserialize) do {} while (0)
+
+#endif  // RMW_FASTRTPS_PROFILE_SERIALIZATION
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__SERIALIZATION_PROFILING_HPP_
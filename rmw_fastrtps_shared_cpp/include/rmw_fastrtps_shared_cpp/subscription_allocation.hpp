@@ -0,0 +1,37 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__SUBSCRIPTION_ALLOCATION_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__SUBSCRIPTION_ALLOCATION_HPP_
+
+#include <fastcdr/FastBuffer.h>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+// Payload carried by rmw_subscription_allocation_t::data.
+// Holds a reusable deserialization scratch: a take handed an allocation
+// copies the payload into this buffer under the history mutex and decodes it
+// after releasing it, without going through the shared buffer pool. For
+// bounded types the buffer is preallocated to the maximum serialized size,
+// so such takes touch no allocator; for unbounded types it grows on demand
+// and keeps its high-water capacity.
+struct SubscriptionAllocation
+{
+  eprosima::fastcdr::FastBuffer buffer;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__SUBSCRIPTION_ALLOCATION_HPP_
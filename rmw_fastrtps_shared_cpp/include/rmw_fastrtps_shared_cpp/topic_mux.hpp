@@ -0,0 +1,98 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__TOPIC_MUX_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__TOPIC_MUX_HPP_
+
+#include <string>
+
+#include "fastrtps/participant/Participant.h"
+
+#include "rcutils/allocator.h"
+#include "rmw/names_and_types.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+// Topic multiplexing (see EndpointOptions::mux_channel): many logical ROS
+// topics ride one DDS channel topic, so a fleet of per-asset topics costs
+// one endpoint's worth of discovery state instead of one per asset. The
+// registry below tracks shared channel writers for reuse, and the logical
+// topics carried over channels so the graph functions keep showing them.
+
+/// Look up a shared channel writer to ride, bumping its reference count.
+/**
+ * Returns null when this process has no channel writer for this
+ * participant/topic/type combination yet; the caller then creates one and
+ * publishes it with `mux_register_shared_publisher`.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+CustomPublisherInfo *
+mux_acquire_shared_publisher(
+  const eprosima::fastrtps::Participant * participant,
+  const std::string & dds_topic_name,
+  const std::string & type_name);
+
+/// Publish a newly created channel writer for later riders.
+/** The creator's own reference is counted. */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+mux_register_shared_publisher(
+  const eprosima::fastrtps::Participant * participant,
+  const std::string & dds_topic_name,
+  const std::string & type_name,
+  CustomPublisherInfo * info);
+
+/// Record the logical ROS topic an endpoint carries over a mux channel.
+/**
+ * \p endpoint_handle identifies the registration for removal at destroy
+ * time (the rmw publisher or subscription pointer); \p dds_type_name is
+ * demangled when the graph functions report the logical topic.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+void
+mux_register_logical_topic(
+  const void * endpoint_handle,
+  const std::string & ros_topic_name,
+  const std::string & dds_type_name);
+
+/// Forget an endpoint at destruction time.
+/**
+ * Drops the endpoint's logical-topic registration and its channel
+ * reference, when it has them. Returns true when the DDS entities must
+ * actually be torn down: the endpoint was not multiplexed, or it was the
+ * channel's last rider.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+mux_release_endpoint(const void * endpoint_handle, const void * endpoint_info);
+
+/// Append the logical mux topics missing from a names-and-types result.
+/**
+ * DDS discovery only shows the channel topics, so remote-only
+ * introspection sees channels; a process participating in the mux expands
+ * the result with the logical topics it registered locally.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+mux_expand_names_and_types(
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * names_and_types);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__TOPIC_MUX_HPP_
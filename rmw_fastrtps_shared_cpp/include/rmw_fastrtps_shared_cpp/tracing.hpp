@@ -0,0 +1,50 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__TRACING_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__TRACING_HPP_
+
+/// \file
+/// USDT tracepoints for the publish/take/wait hot paths.
+/**
+ * Compiled in only when the library is configured with
+ * -DRMW_FASTRTPS_ENABLE_TRACEPOINTS=ON; the macros expand to nothing
+ * otherwise, so the instrumented code carries zero overhead by default.
+ * When enabled, each site is a single nop until a tracer (bpftrace,
+ * perf probe, SystemTap) attaches to the `rmw_fastrtps` provider.
+ *
+ * GUID arguments are passed as pointers to the 16-byte Fast-RTPS GUID_t,
+ * valid for the duration of the probe.
+ */
+
+#if defined(RMW_FASTRTPS_ENABLE_TRACEPOINTS)
+
+#include <sys/sdt.h>
+
+#define RMW_FASTRTPS_TRACEPOINT1(probe, a1) \
+  DTRACE_PROBE1(rmw_fastrtps, probe, a1)
+#define RMW_FASTRTPS_TRACEPOINT2(probe, a1, a2) \
+  DTRACE_PROBE2(rmw_fastrtps, probe, a1, a2)
+#define RMW_FASTRTPS_TRACEPOINT3(probe, a1, a2, a3) \
+  DTRACE_PROBE3(rmw_fastrtps, probe, a1, a2, a3)
+
+#else
+
+#define RMW_FASTRTPS_TRACEPOINT1(probe, a1) do {} while (0)
+#define RMW_FASTRTPS_TRACEPOINT2(probe, a1, a2) do {} while (0)
+#define RMW_FASTRTPS_TRACEPOINT3(probe, a1, a2, a3) do {} while (0)
+
+#endif  // defined(RMW_FASTRTPS_ENABLE_TRACEPOINTS)
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__TRACING_HPP_
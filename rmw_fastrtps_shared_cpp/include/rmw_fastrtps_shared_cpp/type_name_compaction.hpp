@@ -0,0 +1,67 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__TYPE_NAME_COMPACTION_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__TYPE_NAME_COMPACTION_HPP_
+
+#include <string>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Whether RMW_FASTRTPS_COMPACT_TYPE_NAMES=1 is set for this process.
+/**
+ * Every endpoint announcement carries its full mangled type name; on hosts
+ * with thousands of endpoints the EDP exchange after a restart is megabytes
+ * of redundant strings. In compact mode the announced type name is replaced
+ * by a fixed-width hash of the full name. Endpoints match on the announced
+ * string, so the mode must be enabled on every participant of a deployment;
+ * it is therefore strictly opt-in.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+bool
+compact_type_names_enabled();
+
+/// The name to announce for `type_name`; `type_name` itself unless compact
+/// mode is on.
+/**
+ * The compact form is "rthc_" + 16 hex digits + "_", a valid DDS type name
+ * an order of magnitude shorter than typical mangled names. The full name
+ * is recorded in a process-local registry so discovery processing can
+ * resolve announcements back for the graph. On the vanishingly unlikely
+ * hash collision between two distinct full names the second one keeps its
+ * full name, which is always correct on the wire.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+std::string
+compact_type_name(const std::string & type_name);
+
+/// Resolve a discovered type name back to its full form where possible.
+/**
+ * Non-compact names pass through untouched. Compact names are looked up in
+ * the local registry, which knows every type this process itself uses; a
+ * hash this process has never registered stays visible as-is, so tooling
+ * sees full names for everything it can exchange with and the raw hash for
+ * the rest. The returned pointer is either `discovered_name` or a registry
+ * entry that lives for the rest of the process.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+const char *
+resolve_type_name(const char * discovered_name);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__TYPE_NAME_COMPACTION_HPP_
@@ -0,0 +1,53 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__WAITSET_EVENT_FD_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__WAITSET_EVENT_FD_HPP_
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Signal a wait set's exported eventfd; a no-op for fd -1 (not exported).
+/**
+ * Called by the listeners at the same points they notify the wait set's
+ * condition variable, so an external poller holding the fd from
+ * `__rmw_wait_set_get_file_descriptor` wakes for exactly the same activity
+ * a blocked `__rmw_wait` would. The eventfd counter coalesces bursts on its
+ * own; a saturated counter (EAGAIN) still leaves the fd readable, so every
+ * failure mode of the write is benign.
+ */
+inline void
+waitset_eventfd_signal(int fd)
+{
+#ifdef __linux__
+  if (fd < 0) {
+    return;
+  }
+  const uint64_t one = 1;
+  const ssize_t bytes = ::write(fd, &one, sizeof(one));
+  (void)bytes;
+#else
+  (void)fd;
+#endif
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__WAITSET_EVENT_FD_HPP_
@@ -22,3 +22,7 @@ find_package(FastRTPS REQUIRED MODULE)
 list(APPEND rmw_fastrtps_shared_cpp_INCLUDE_DIRS ${FastRTPS_INCLUDE_DIR})
 # specific order: dependents before dependencies
 list(APPEND rmw_fastrtps_shared_cpp_LIBRARIES fastrtps fastcdr)
+
+# LTO/PGO options and the rmw_fastrtps_optimize_target() function, so the
+# typesupport packages build with the same optimization configuration.
+include("${rmw_fastrtps_shared_cpp_DIR}/rmw_fastrtps_optimize.cmake")
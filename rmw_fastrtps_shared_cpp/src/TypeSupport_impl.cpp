@@ -14,12 +14,21 @@
 
 #include <fastcdr/FastBuffer.h>
 #include <fastcdr/Cdr.h>
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "rmw/serialized_message.h"
+
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/payload_compression.hpp"
+#include "rmw_fastrtps_shared_cpp/record_tap.hpp"
+#include "rmw_fastrtps_shared_cpp/serialization_profiling.hpp"
+
 namespace rmw_fastrtps_shared_cpp
 {
 
@@ -29,15 +38,49 @@ TypeSupport::TypeSupport()
   max_size_bound_ = false;
 }
 
+bool TypeSupport::getKey(
+  void * data,
+  eprosima::fastrtps::rtps::InstanceHandle_t * ihandle,
+  bool force_md5)
+{
+  // The extractor already emits a 16 byte value, so the md5 fallback for
+  // oversized keys is its responsibility.
+  (void)force_md5;
+  if (!key_extractor_) {
+    return false;
+  }
+  auto ser_data = static_cast<SerializedData *>(data);
+  if (SerializedData::ROS_MESSAGE != ser_data->type) {
+    // Pre-serialized payloads carry no ros message to extract from.
+    return false;
+  }
+  return key_extractor_(ser_data->data, ihandle->value);
+}
+
+void TypeSupport::set_key_extractor(KeyExtractor key_extractor)
+{
+  key_extractor_ = std::move(key_extractor);
+  m_isGetKeyDefined = static_cast<bool>(key_extractor_);
+}
+
+void TypeSupport::raise_payload_size_estimate(uint32_t payload_size)
+{
+  if (payload_size > m_typeSize) {
+    m_typeSize = payload_size;
+  }
+}
+
 void TypeSupport::deleteData(void * data)
 {
   assert(data);
-  delete static_cast<eprosima::fastcdr::FastBuffer *>(data);
+  allocation_statistics_.record_release();
+  FastBufferPool::release(static_cast<eprosima::fastcdr::FastBuffer *>(data));
 }
 
 void * TypeSupport::createData()
 {
-  return new eprosima::fastcdr::FastBuffer();
+  allocation_statistics_.record_acquire();
+  return FastBufferPool::acquire();
 }
 
 bool TypeSupport::serialize(
@@ -46,26 +89,73 @@ bool TypeSupport::serialize(
   assert(data);
   assert(payload);
 
+  RMW_FASTRTPS_SERIALIZATION_PROFILE_SCOPE(getName(), false);
+
   auto ser_data = static_cast<SerializedData *>(data);
-  if (ser_data->is_cdr_buffer) {
+  if (SerializedData::CDR_BUFFER == ser_data->type) {
     auto ser = static_cast<eprosima::fastcdr::Cdr *>(ser_data->data);
     if (payload->max_size >= ser->getSerializedDataLength()) {
-      payload->length = static_cast<uint32_t>(ser->getSerializedDataLength());
+      const uint32_t length = static_cast<uint32_t>(ser->getSerializedDataLength());
       payload->encapsulation = ser->endianness() ==
         eprosima::fastcdr::Cdr::BIG_ENDIANNESS ? CDR_BE : CDR_LE;
-      memcpy(payload->data, ser->getBufferPointer(), ser->getSerializedDataLength());
+      // The recorder captures the decodable CDR, not the wire form.
+      record_tap_capture(getName(), ser->getBufferPointer(), length, false);
+      if (ser_data->compress) {
+        const uint32_t compressed = compress_payload(
+          reinterpret_cast<const uint8_t *>(ser->getBufferPointer()), length,
+          payload->data, payload->max_size);
+        if (compressed != 0u) {
+          payload->length = compressed;
+          return true;
+        }
+        // Not smaller compressed; fall through to the plain copy.
+      }
+      payload->length = length;
+      memcpy(payload->data, ser->getBufferPointer(), length);
+      return true;
+    }
+  } else if (ser_data->compress) {
+    // Serialization normally targets the history payload directly; the
+    // compressor needs the plain CDR first, so a compressing publisher
+    // serializes into a pooled buffer and compresses from there. The extra
+    // copy only exists on the opt-in path, and only when the sample turns
+    // out incompressible.
+    PooledFastBufferPtr scratch(FastBufferPool::acquire());
+    if (scratch->getBufferSize() < payload->max_size) {
+      if (!scratch->reserve(payload->max_size) && !scratch->resize(payload->max_size)) {
+        return false;
+      }
+    }
+    eprosima::fastcdr::FastBuffer fastbuffer(scratch->getBuffer(), payload->max_size);
+    eprosima::fastcdr::Cdr ser(fastbuffer, kSerializationEndianness,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    if (this->serializeROSmessage(ser_data->data, ser, ser_data->impl)) {
+      const uint32_t length = static_cast<uint32_t>(ser.getSerializedDataLength());
+      payload->encapsulation = ser.endianness() ==
+        eprosima::fastcdr::Cdr::BIG_ENDIANNESS ? CDR_BE : CDR_LE;
+      record_tap_capture(getName(), scratch->getBuffer(), length, false);
+      const uint32_t compressed = compress_payload(
+        reinterpret_cast<const uint8_t *>(scratch->getBuffer()), length,
+        payload->data, payload->max_size);
+      if (compressed != 0u) {
+        payload->length = compressed;
+      } else {
+        payload->length = length;
+        memcpy(payload->data, scratch->getBuffer(), length);
+      }
       return true;
     }
   } else {
     eprosima::fastcdr::FastBuffer fastbuffer(
       reinterpret_cast<char *>(payload->data),
       payload->max_size);  // Object that manages the raw buffer.
-    eprosima::fastcdr::Cdr ser(fastbuffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    eprosima::fastcdr::Cdr ser(fastbuffer, kSerializationEndianness,
       eprosima::fastcdr::Cdr::DDS_CDR);  // Object that serializes the data.
     if (this->serializeROSmessage(ser_data->data, ser, ser_data->impl)) {
       payload->encapsulation = ser.endianness() ==
         eprosima::fastcdr::Cdr::BIG_ENDIANNESS ? CDR_BE : CDR_LE;
       payload->length = (uint32_t)ser.getSerializedDataLength();
+      record_tap_capture(getName(), payload->data, payload->length, false);
       return true;
     }
   }
@@ -81,18 +171,90 @@ bool TypeSupport::deserialize(
   assert(payload);
 
   auto ser_data = static_cast<SerializedData *>(data);
-  if (ser_data->is_cdr_buffer) {
-    auto buffer = static_cast<eprosima::fastcdr::FastBuffer *>(ser_data->data);
-    if (!buffer->reserve(payload->length)) {
+  if (SerializedData::DISCARD == ser_data->type) {
+    // Marks the sample read at O(1); nothing is copied or decoded.
+    return true;
+  }
+  // After the discard path on purpose: O(1) consumes would only dilute the
+  // histogram of real decodes.
+  RMW_FASTRTPS_SERIALIZATION_PROFILE_SCOPE(getName(), true);
+  allocation_statistics_.record_payload(payload->length);
+  // A compressed payload (payload_compression.hpp) is expanded once into a
+  // pooled buffer here, and every branch below reads the plain CDR from it;
+  // the scratch's lifetime spans the whole take.
+  const uint8_t * bytes = payload->data;
+  uint32_t length = payload->length;
+  PooledFastBufferPtr scratch;
+  if (payload_is_compressed(bytes, length)) {
+    const uint32_t original = compressed_payload_original_length(bytes, length);
+    scratch = PooledFastBufferPtr(FastBufferPool::acquire());
+    if (scratch->getBufferSize() < original) {
+      if (!scratch->reserve(original) && !scratch->resize(original)) {
+        return false;
+      }
+    }
+    if (!decompress_payload(
+        bytes, length, reinterpret_cast<uint8_t *>(scratch->getBuffer()), original))
+    {
       return false;
     }
-    memcpy(buffer->getBuffer(), payload->data, payload->length);
+    bytes = reinterpret_cast<const uint8_t *>(scratch->getBuffer());
+    length = original;
+  }
+  // Before the content filter on purpose: the recorder wants every received
+  // payload, including ones a subscription then filters out. Discarded
+  // samples above were never payloads anybody consumed.
+  record_tap_capture(getName(), bytes, length, true);
+  if (SerializedData::FAST_BUFFER == ser_data->type) {
+    auto buffer = static_cast<eprosima::fastcdr::FastBuffer *>(ser_data->data);
+    // reserve() only works on buffers that never allocated; recycled buffers
+    // keep their capacity and are grown through resize() when needed.
+    // Growth doubles at minimum and the buffer never shrinks, so a stream
+    // whose sample sizes vary settles on its high-water mark after
+    // logarithmically many reallocations instead of one per size step.
+    if (buffer->getBufferSize() < length) {
+      size_t target = (std::max)(
+        static_cast<size_t>(length), buffer->getBufferSize() * 2);
+      allocation_statistics_.record_growth(target - buffer->getBufferSize());
+      if (!buffer->reserve(target) && !buffer->resize(target)) {
+        return false;
+      }
+    }
+    memcpy(buffer->getBuffer(), bytes, length);
+    ser_data->taken_length = length;
+    return true;
+  }
+  if (SerializedData::SERIALIZED_MESSAGE == ser_data->type) {
+    // Copy the payload straight into the caller's serialized message, so a
+    // serialized take moves the CDR bytes exactly once.
+    auto msg = static_cast<rmw_serialized_message_t *>(ser_data->data);
+    // Same doubling, never-shrink policy as the pooled buffers above; the
+    // capacity a recorder's reused message ends up with tracks its largest
+    // sample, not the size variance of the stream.
+    if (msg->buffer_capacity < length) {
+      size_t target = (std::max)(
+        static_cast<size_t>(length), msg->buffer_capacity * 2);
+      allocation_statistics_.record_growth(target - msg->buffer_capacity);
+      if (RMW_RET_OK != rmw_serialized_message_resize(msg, target)) {
+        return false;
+      }
+    }
+    memcpy(msg->buffer, bytes, length);
+    msg->buffer_length = length;
     return true;
   }
 
+  if (ser_data->filter && *ser_data->filter &&
+    !(*ser_data->filter)(bytes, length))
+  {
+    // The subscription's content filter rejected the sample; skipping the
+    // deserialization below is exactly what the filter is for.
+    return false;
+  }
+
   eprosima::fastcdr::FastBuffer fastbuffer(
-    reinterpret_cast<char *>(payload->data),
-    payload->length);
+    reinterpret_cast<char *>(const_cast<uint8_t *>(bytes)),
+    length);
   eprosima::fastcdr::Cdr deser(
     fastbuffer,
     eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
@@ -105,9 +267,16 @@ std::function<uint32_t()> TypeSupport::getSerializedSizeProvider(void * data)
   assert(data);
 
   auto ser_data = static_cast<SerializedData *>(data);
+  if (SerializedData::ROS_MESSAGE == ser_data->type && max_size_bound_) {
+    // For bounded types the maximum payload size was computed once at type
+    // registration; capture it by value so the callable neither walks the
+    // message nor needs any captured pointers.
+    uint32_t type_size = m_typeSize;
+    return [type_size]() -> uint32_t {return type_size;};
+  }
   auto ser_size = [this, ser_data]() -> uint32_t
     {
-      if (ser_data->is_cdr_buffer) {
+      if (SerializedData::CDR_BUFFER == ser_data->type) {
         auto ser = static_cast<eprosima::fastcdr::Cdr *>(ser_data->data);
         return static_cast<uint32_t>(ser->getSerializedDataLength());
       }
@@ -0,0 +1,198 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fastrtps/Domain.h"
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+#include "rmw_fastrtps_shared_cpp/client_endpoint_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+struct ParkedClient
+{
+  std::string service_name;
+  std::string request_type_name;
+  std::string response_type_name;
+  rmw_qos_profile_t qos;
+  CustomClientInfo * info;
+};
+
+// Bounds how many destroyed clients one context keeps alive; beyond this a
+// destroy tears the endpoints down as if the pool did not exist.
+constexpr size_t kMaxParkedPerContext = 32;
+
+std::mutex g_pool_mutex;
+std::map<const void *, std::vector<ParkedClient>> g_pools;
+
+bool
+_qos_profiles_match(const rmw_qos_profile_t & a, const rmw_qos_profile_t & b)
+{
+  // Field-wise: the struct has padding, so memcmp would reject equal profiles.
+  return a.history == b.history &&
+         a.depth == b.depth &&
+         a.reliability == b.reliability &&
+         a.durability == b.durability &&
+         a.deadline.sec == b.deadline.sec &&
+         a.deadline.nsec == b.deadline.nsec &&
+         a.lifespan.sec == b.lifespan.sec &&
+         a.lifespan.nsec == b.lifespan.nsec &&
+         a.liveliness == b.liveliness &&
+         a.liveliness_lease_duration.sec == b.liveliness_lease_duration.sec &&
+         a.liveliness_lease_duration.nsec == b.liveliness_lease_duration.nsec &&
+         a.avoid_ros_namespace_conventions == b.avoid_ros_namespace_conventions;
+}
+
+// Same teardown __rmw_destroy_client performs when the pool is not involved.
+void
+_destroy_parked(CustomClientInfo * info)
+{
+  if (info->response_subscriber_ != nullptr) {
+    eprosima::fastrtps::Domain::removeSubscriber(info->response_subscriber_);
+  }
+  if (info->request_publisher_ != nullptr) {
+    eprosima::fastrtps::Domain::removePublisher(info->request_publisher_);
+  }
+  if (info->pub_listener_ != nullptr) {
+    delete info->pub_listener_;
+  }
+  if (info->listener_ != nullptr) {
+    delete info->listener_;
+  }
+  if (info->request_type_support_ != nullptr) {
+    _unregister_type(info->participant_, info->request_type_support_);
+  }
+  if (info->response_type_support_ != nullptr) {
+    _unregister_type(info->participant_, info->response_type_support_);
+  }
+  delete info;
+}
+
+}  // namespace
+
+bool
+client_endpoint_pool_enabled()
+{
+  // Process-wide switch, read once.
+  static const bool enabled = []() {
+    const char * env_value;
+    const char * error_str;
+    error_str = rcutils_get_env("RMW_FASTRTPS_REUSE_CLIENT_ENDPOINTS", &env_value);
+    if (error_str != NULL) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+      return false;
+    }
+    return env_value != nullptr && strcmp(env_value, "1") == 0;
+  }();
+  return enabled;
+}
+
+CustomClientInfo *
+client_endpoint_pool_take(
+  const void * graph_key,
+  const char * service_name,
+  const std::string & request_type_name,
+  const std::string & response_type_name,
+  const rmw_qos_profile_t & qos)
+{
+  if (!client_endpoint_pool_enabled()) {
+    return nullptr;
+  }
+  CustomClientInfo * info = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    auto pool_it = g_pools.find(graph_key);
+    if (pool_it == g_pools.end()) {
+      return nullptr;
+    }
+    auto & parked = pool_it->second;
+    for (auto it = parked.begin(); it != parked.end(); ++it) {
+      if (it->service_name == service_name &&
+        it->request_type_name == request_type_name &&
+        it->response_type_name == response_type_name &&
+        _qos_profiles_match(it->qos, qos))
+      {
+        info = it->info;
+        parked.erase(it);
+        break;
+      }
+    }
+  }
+  if (nullptr != info) {
+    // Drop anything that arrived while parked; it belongs to the previous
+    // incarnation and its sequence numbers would never be matched anyway.
+    CustomClientResponse stale;
+    while (info->listener_->getResponse(stale)) {
+    }
+  }
+  return info;
+}
+
+bool
+client_endpoint_pool_park(
+  const void * graph_key,
+  const char * service_name,
+  CustomClientInfo * info)
+{
+  if (!client_endpoint_pool_enabled() || !info->poolable_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(g_pool_mutex);
+  auto & parked = g_pools[graph_key];
+  if (parked.size() >= kMaxParkedPerContext) {
+    return false;
+  }
+  ParkedClient entry;
+  entry.service_name = service_name;
+  entry.request_type_name = info->request_type_support_->getName();
+  entry.response_type_name = info->response_type_support_->getName();
+  entry.qos = info->qos_profile_;
+  entry.info = info;
+  parked.push_back(std::move(entry));
+  return true;
+}
+
+void
+client_endpoint_pool_drain(const void * graph_key)
+{
+  std::vector<ParkedClient> parked;
+  {
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    auto pool_it = g_pools.find(graph_key);
+    if (pool_it == g_pools.end()) {
+      return;
+    }
+    parked = std::move(pool_it->second);
+    g_pools.erase(pool_it);
+  }
+  for (auto & entry : parked) {
+    _destroy_parked(entry.info);
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
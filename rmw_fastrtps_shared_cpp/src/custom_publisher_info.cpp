@@ -26,75 +26,85 @@ PubListener::on_offered_deadline_missed(
   eprosima::fastrtps::Publisher * /* publisher */,
   const eprosima::fastrtps::OfferedDeadlineMissedStatus & status)
 {
-  std::lock_guard<std::mutex> lock(internalMutex_);
-
-  // the change to liveliness_lost_count_ needs to be mutually exclusive with
-  // rmw_wait() which checks hasEvent() and decides if wait() needs to be called
-  ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
-
-  // Assign absolute values
-  offered_deadline_missed_status_.total_count = status.total_count;
-  // Accumulate deltas
-  offered_deadline_missed_status_.total_count_change += status.total_count_change;
+  // Assign absolute values, accumulate deltas; stored before any signaling
+  // so a waiter that scans for events observes them regardless of the wakeup.
+  offered_deadline_total_count_.store(status.total_count, std::memory_order_relaxed);
+  offered_deadline_total_count_change_.fetch_add(
+    status.total_count_change, std::memory_order_relaxed);
+  event_changes_.fetch_or(
+    event_bit(RMW_EVENT_OFFERED_DEADLINE_MISSED), std::memory_order_relaxed);
 
-  deadline_changes_.store(true, std::memory_order_relaxed);
+  notify_waiter();
 }
 
 void PubListener::on_liveliness_lost(
   eprosima::fastrtps::Publisher * /* publisher */,
   const eprosima::fastrtps::LivelinessLostStatus & status)
 {
-  std::lock_guard<std::mutex> lock(internalMutex_);
-
-  // the change to liveliness_lost_count_ needs to be mutually exclusive with
-  // rmw_wait() which checks hasEvent() and decides if wait() needs to be called
-  ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
+  // Assign absolute values, accumulate deltas; stored before any signaling
+  // so a waiter that scans for events observes them regardless of the wakeup.
+  liveliness_lost_total_count_.store(status.total_count, std::memory_order_relaxed);
+  liveliness_lost_total_count_change_.fetch_add(
+    status.total_count_change, std::memory_order_relaxed);
+  event_changes_.fetch_or(
+    event_bit(RMW_EVENT_LIVELINESS_LOST), std::memory_order_relaxed);
 
-  // Assign absolute values
-  liveliness_lost_status_.total_count = status.total_count;
-  // Accumulate deltas
-  liveliness_lost_status_.total_count_change += status.total_count_change;
+  notify_waiter();
+}
 
-  liveliness_changes_.store(true, std::memory_order_relaxed);
+void PubListener::notify_waiter()
+{
+  std::lock_guard<std::mutex> lock(internalMutex_);
+  if (conditionMutex_ != nullptr) {
+    // Before the suppression below: fd consumers never clear the flag.
+    rmw_fastrtps_shared_cpp::waitset_eventfd_signal(event_fd_);
+    if (nullptr != conditionReady_ && conditionReady_->exchange(true)) {
+      // An unconsumed wakeup is already pending; the waiter clears the flag
+      // before scanning and will observe the stored status.
+      return;
+    }
+    // The empty critical section pairs with the waiter's predicate check, so
+    // the waiter is either before the check, and sees the status, or already
+    // waiting, and receives the notification.
+    {
+      std::lock_guard<std::mutex> clock(*conditionMutex_);
+    }
+    conditionVariable_->notify_one();
+  }
 }
 
 bool PubListener::hasEvent(rmw_event_type_t event_type) const
 {
   assert(rmw_fastrtps_shared_cpp::internal::is_event_supported(event_type));
-  switch (event_type) {
-    case RMW_EVENT_LIVELINESS_LOST:
-      return liveliness_changes_.load(std::memory_order_relaxed);
-    case RMW_EVENT_OFFERED_DEADLINE_MISSED:
-      return deadline_changes_.load(std::memory_order_relaxed);
-    default:
-      break;
-  }
-  return false;
+  return 0 != (event_changes_.load(std::memory_order_relaxed) & event_bit(event_type));
 }
 
 bool PubListener::takeNextEvent(rmw_event_type_t event_type, void * event_info)
 {
   assert(rmw_fastrtps_shared_cpp::internal::is_event_supported(event_type));
-  std::lock_guard<std::mutex> lock(internalMutex_);
+  // The changed flag is cleared before the deltas are consumed, so an update
+  // racing with this take re-raises it and surfaces on the next event check.
   switch (event_type) {
     case RMW_EVENT_LIVELINESS_LOST:
       {
         rmw_liveliness_lost_status_t * rmw_data =
           static_cast<rmw_liveliness_lost_status_t *>(event_info);
-        rmw_data->total_count = liveliness_lost_status_.total_count;
-        rmw_data->total_count_change = liveliness_lost_status_.total_count_change;
-        liveliness_lost_status_.total_count_change = 0;
-        liveliness_changes_.store(false, std::memory_order_relaxed);
+        event_changes_.fetch_and(
+          ~event_bit(RMW_EVENT_LIVELINESS_LOST), std::memory_order_relaxed);
+        rmw_data->total_count = liveliness_lost_total_count_.load(std::memory_order_relaxed);
+        rmw_data->total_count_change =
+          liveliness_lost_total_count_change_.exchange(0, std::memory_order_relaxed);
       }
       break;
     case RMW_EVENT_OFFERED_DEADLINE_MISSED:
       {
         rmw_offered_deadline_missed_status_t * rmw_data =
           static_cast<rmw_offered_deadline_missed_status_t *>(event_info);
-        rmw_data->total_count = offered_deadline_missed_status_.total_count;
-        rmw_data->total_count_change = offered_deadline_missed_status_.total_count_change;
-        offered_deadline_missed_status_.total_count_change = 0;
-        deadline_changes_.store(false, std::memory_order_relaxed);
+        event_changes_.fetch_and(
+          ~event_bit(RMW_EVENT_OFFERED_DEADLINE_MISSED), std::memory_order_relaxed);
+        rmw_data->total_count = offered_deadline_total_count_.load(std::memory_order_relaxed);
+        rmw_data->total_count_change =
+          offered_deadline_total_count_change_.exchange(0, std::memory_order_relaxed);
       }
       break;
     default:
@@ -102,3 +112,24 @@ bool PubListener::takeNextEvent(rmw_event_type_t event_type, void * event_info)
   }
   return true;
 }
+
+uint32_t PubListener::takeAllEvents(TakenEventStatuses * statuses)
+{
+  uint32_t mask = event_changes_.exchange(0, std::memory_order_relaxed);
+  if (0 == mask) {
+    return 0;
+  }
+  if (mask & event_bit(RMW_EVENT_LIVELINESS_LOST)) {
+    statuses->liveliness_lost.total_count =
+      liveliness_lost_total_count_.load(std::memory_order_relaxed);
+    statuses->liveliness_lost.total_count_change =
+      liveliness_lost_total_count_change_.exchange(0, std::memory_order_relaxed);
+  }
+  if (mask & event_bit(RMW_EVENT_OFFERED_DEADLINE_MISSED)) {
+    statuses->offered_deadline_missed.total_count =
+      offered_deadline_total_count_.load(std::memory_order_relaxed);
+    statuses->offered_deadline_missed.total_count_change =
+      offered_deadline_total_count_change_.exchange(0, std::memory_order_relaxed);
+  }
+  return mask;
+}
@@ -12,7 +12,26 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <utility>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif  // _WIN32
+
+#include "fastrtps/attributes/SubscriberAttributes.h"
+#include "fastrtps/subscriber/SampleInfo.h"
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/guid_utils.hpp"
 #include "types/event_types.hpp"
 
 EventListenerInterface *
@@ -21,85 +40,393 @@ CustomSubscriberInfo::getListener() const
   return listener_;
 }
 
+#ifndef _WIN32
+/// Resolve the arrival timestamp clock, once.
+/**
+ * RMW_FASTRTPS_ARRIVAL_TIMESTAMPS selects the clock received_timestamp is
+ * captured with, on the reception thread as each sample arrives:
+ *   realtime   CLOCK_REALTIME
+ *   tai        CLOCK_TAI, for hosts whose TAI offset is steered by a PTP
+ *              daemon, so timestamps line up across machines on the PTP
+ *              domain instead of carrying each host's NTP wander
+ * Unset leaves received_timestamp as Fast-RTPS's receptionTimestamp. The
+ * stamp-to-sample pairing is FIFO, so it is exact on subscriptions whose
+ * history never overwrites unread samples (keep-all, sufficient depth, or
+ * the history extension); after an overwrite the pairing resets and takes
+ * fall back to receptionTimestamp until the queue refills.
+ */
+static
+bool
+_arrival_clock(clockid_t * clock_id)
+{
+  struct ParsedClock
+  {
+    bool enabled;
+    clockid_t clock;
+  };
+  static const ParsedClock parsed = []() {
+      ParsedClock result{false, CLOCK_REALTIME};
+      const char * env_value;
+      const char * error_str = rcutils_get_env("RMW_FASTRTPS_ARRIVAL_TIMESTAMPS", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return result;
+      }
+      if (nullptr == env_value || '\0' == env_value[0]) {
+        return result;
+      }
+      if (0 == strcmp(env_value, "realtime")) {
+        result.enabled = true;
+#if defined(CLOCK_TAI)
+      } else if (0 == strcmp(env_value, "tai")) {
+        result.enabled = true;
+        result.clock = CLOCK_TAI;
+#endif
+      } else {
+        RCUTILS_LOG_WARN_NAMED(
+          "rmw_fastrtps_shared_cpp",
+          "RMW_FASTRTPS_ARRIVAL_TIMESTAMPS is not a supported clock name, ignoring it");
+      }
+      return result;
+    }();
+  *clock_id = parsed.clock;
+  return parsed.enabled;
+}
+
+/// Resolve the reception-thread CPU set, once.
+/**
+ * RMW_FASTRTPS_RECEPTION_CPUSET is a comma separated list of CPU indices;
+ * any parse failure disables the pinning for the whole process.
+ */
+static
+bool
+_reception_cpuset(cpu_set_t * out)
+{
+  struct ParsedSet
+  {
+    bool enabled;
+    cpu_set_t set;
+  };
+  static const ParsedSet parsed = []() {
+      ParsedSet result;
+      result.enabled = false;
+      CPU_ZERO(&result.set);
+      const char * env_value;
+      const char * error_str = rcutils_get_env("RMW_FASTRTPS_RECEPTION_CPUSET", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return result;
+      }
+      if (nullptr == env_value || '\0' == env_value[0]) {
+        return result;
+      }
+      const char * position = env_value;
+      while ('\0' != *position) {
+        char * end = nullptr;
+        unsigned long cpu = strtoul(position, &end, 10);  // NOLINT(runtime/int)
+        if (end == position || (',' != *end && '\0' != *end) || cpu >= CPU_SETSIZE) {
+          RCUTILS_LOG_WARN_NAMED(
+            "rmw_fastrtps_shared_cpp",
+            "RMW_FASTRTPS_RECEPTION_CPUSET is not a comma separated CPU list, ignoring it");
+          result.enabled = false;
+          CPU_ZERO(&result.set);
+          return result;
+        }
+        CPU_SET(cpu, &result.set);
+        result.enabled = true;
+        position = (',' == *end) ? end + 1 : end;
+      }
+      return result;
+    }();
+  if (parsed.enabled) {
+    *out = parsed.set;
+  }
+  return parsed.enabled;
+}
+#endif  // _WIN32
+
+void
+rmw_fastrtps_shared_cpp::pin_reception_thread()
+{
+#ifndef _WIN32
+  // One pthread_setaffinity_np per reception thread, on its first delivery;
+  // every later call is this flag check.
+  static thread_local bool applied = false;
+  if (applied) {
+    return;
+  }
+  applied = true;
+  cpu_set_t set;
+  if (!_reception_cpuset(&set)) {
+    return;
+  }
+  if (0 != pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "failed to apply RMW_FASTRTPS_RECEPTION_CPUSET to a reception thread");
+  }
+#endif  // _WIN32
+}
+
+void
+SubListener::stamp_arrival()
+{
+#ifndef _WIN32
+  clockid_t clock_id;
+  if (!_arrival_clock(&clock_id)) {
+    return;
+  }
+  struct timespec ts;
+  if (0 != clock_gettime(clock_id, &ts)) {
+    return;
+  }
+  const int64_t stamp = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+
+  std::lock_guard<std::mutex> lock(arrival_stamp_mutex_);
+  // A taker that stalls for thousands of samples has lost the pairing
+  // anyway (the history is overwriting); clearing keeps the queue bounded
+  // and honest rather than shifting every later stamp onto a wrong sample.
+  constexpr size_t kMaxArrivalStamps = 4096;
+  if (arrival_stamps_.size() >= kMaxArrivalStamps) {
+    arrival_stamps_.clear();
+  }
+  arrival_stamps_.push_back(stamp);
+  arrival_stamp_count_.store(arrival_stamps_.size(), std::memory_order_relaxed);
+#endif  // _WIN32
+}
+
+uint64_t
+SubListener::dispatch_directly(eprosima::fastrtps::Subscriber * sub, uint64_t unread_count)
+{
+  auto dispatch = std::atomic_load(&info_->direct_dispatch_);
+  if (!dispatch) {
+    // The dispatch was cleared between the enabled check and this load.
+    return unread_count;
+  }
+  auto content_filter = std::atomic_load(&info_->content_filter_);
+
+  for (uint64_t i = 0; i < unread_count; ++i) {
+    void * ros_message = dispatch->borrow_message();
+    if (nullptr == ros_message) {
+      // Pool exhausted; leave the rest to the wait set path.
+      break;
+    }
+
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
+    data.data = ros_message;
+    data.impl = info_->type_support_impl_;
+    data.filter = content_filter.get();
+
+    eprosima::fastrtps::SampleInfo_t sinfo;
+    if (!sub->takeNextData(&data, &sinfo)) {
+      dispatch->return_message(ros_message);
+      if (data.filter) {
+        // The content filter dropped the sample, which still consumed it.
+        pop_arrival_stamp();
+        continue;
+      }
+      break;
+    }
+    const int64_t arrival = pop_arrival_stamp();
+    if (eprosima::fastrtps::rtps::ALIVE != sinfo.sampleKind) {
+      dispatch->return_message(ros_message);
+      continue;
+    }
+
+    rmw_message_info_t message_info;
+    message_info.source_timestamp = sinfo.sourceTimestamp.to_ns();
+    message_info.received_timestamp =
+      0 != arrival ? arrival : sinfo.receptionTimestamp.to_ns();
+    rmw_gid_t * sender_gid = &message_info.publisher_gid;
+    sender_gid->implementation_identifier = dispatch->implementation_identifier;
+    memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
+    rmw_fastrtps_shared_cpp::copy_from_fastrtps_guid_to_byte_array(
+      sinfo.sample_identity.writer_guid(),
+      sender_gid->data);
+
+    dispatch->on_message(ros_message, &message_info);
+  }
+
+#if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 9
+  uint64_t remaining = sub->getUnreadCount();
+#else
+  uint64_t remaining = sub->get_unread_count();
+#endif
+  data_.store(remaining, std::memory_order_relaxed);
+  return remaining;
+}
+
+uint64_t
+SubListener::spill_overflow(eprosima::fastrtps::Subscriber * sub, uint64_t unread_count)
+{
+  const auto & history = sub->getAttributes().topic.historyQos;
+  if (eprosima::fastrtps::KEEP_LAST_HISTORY_QOS != history.kind || history.depth <= 0) {
+    // Keep-all histories never overwrite, so there is nothing to rescue.
+    return unread_count;
+  }
+  const uint64_t depth = static_cast<uint64_t>(history.depth);
+  const size_t capacity = info_->spill_capacity_.load(std::memory_order_relaxed);
+
+  // Take oldest samples while the history is at the brink of overwriting,
+  // i.e. while one more arrival would evict an unread sample.
+  while (unread_count >= depth &&
+    info_->spill_size_.load(std::memory_order_relaxed) < capacity)
+  {
+    rmw_fastrtps_shared_cpp::SpilledSample sample;
+    sample.buffer.reset(rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
+    data.data = sample.buffer.get();
+    data.impl = nullptr;
+
+    if (!sub->takeNextData(&data, &sample.sample_info)) {
+      break;
+    }
+    sample.length = data.taken_length;
+    sample.arrival_timestamp = pop_arrival_stamp();
+    info_->push_spilled(std::move(sample));
+
+    // Taking the oldest unread sample lowers the unread count by exactly
+    // one, and only this reception thread adds samples, so the count can be
+    // tracked locally instead of re-querying the history per iteration.
+    --unread_count;
+  }
+  return unread_count;
+}
+
+uint64_t
+SubListener::prefetch_arrivals(eprosima::fastrtps::Subscriber * sub, uint64_t unread_count)
+{
+  // Unlike spill_overflow there is no capacity gate: prefetch empties the
+  // history unconditionally so the extraction copy runs here, overlapping
+  // the waiter's wakeup, instead of inside the take.
+  while (unread_count > 0) {
+    rmw_fastrtps_shared_cpp::SpilledSample sample;
+    sample.buffer.reset(rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
+    data.data = sample.buffer.get();
+    data.impl = nullptr;
+
+    if (!sub->takeNextData(&data, &sample.sample_info)) {
+      break;
+    }
+    sample.length = data.taken_length;
+    sample.arrival_timestamp = pop_arrival_stamp();
+    info_->push_spilled(std::move(sample));
+    --unread_count;
+  }
+  return unread_count;
+}
+
 void
 SubListener::on_requested_deadline_missed(
   eprosima::fastrtps::Subscriber * /* subscriber */,
   const eprosima::fastrtps::RequestedDeadlineMissedStatus & status)
 {
-  std::lock_guard<std::mutex> lock(internalMutex_);
-
-  // the change to liveliness_lost_count_ needs to be mutually exclusive with
-  // rmw_wait() which checks hasEvent() and decides if wait() needs to be called
-  ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
-
-  // Assign absolute values
-  requested_deadline_missed_status_.total_count = status.total_count;
-  // Accumulate deltas
-  requested_deadline_missed_status_.total_count_change += status.total_count_change;
+  // Assign absolute values, accumulate deltas; stored before any signaling so
+  // a waiter that scans for events observes them regardless of the wakeup.
+  requested_deadline_total_count_.store(status.total_count, std::memory_order_relaxed);
+  requested_deadline_total_count_change_.fetch_add(
+    status.total_count_change, std::memory_order_relaxed);
+  event_changes_.fetch_or(
+    event_bit(RMW_EVENT_REQUESTED_DEADLINE_MISSED), std::memory_order_relaxed);
 
-  deadline_changes_.store(true, std::memory_order_relaxed);
+  notify_waiter();
 }
 
 void SubListener::on_liveliness_changed(
   eprosima::fastrtps::Subscriber * /* subscriber */,
   const eprosima::fastrtps::LivelinessChangedStatus & status)
 {
-  std::lock_guard<std::mutex> lock(internalMutex_);
+  // Assign absolute values, accumulate deltas; stored before any signaling so
+  // a waiter that scans for events observes them regardless of the wakeup.
+  liveliness_alive_count_.store(status.alive_count, std::memory_order_relaxed);
+  liveliness_not_alive_count_.store(status.not_alive_count, std::memory_order_relaxed);
+  liveliness_alive_count_change_.fetch_add(status.alive_count_change, std::memory_order_relaxed);
+  liveliness_not_alive_count_change_.fetch_add(
+    status.not_alive_count_change, std::memory_order_relaxed);
+  event_changes_.fetch_or(
+    event_bit(RMW_EVENT_LIVELINESS_CHANGED), std::memory_order_relaxed);
 
-  // the change to liveliness_lost_count_ needs to be mutually exclusive with
-  // rmw_wait() which checks hasEvent() and decides if wait() needs to be called
-  ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
+  notify_waiter();
+}
 
-  // Assign absolute values
-  liveliness_changed_status_.alive_count = status.alive_count;
-  liveliness_changed_status_.not_alive_count = status.not_alive_count;
-  // Accumulate deltas
-  liveliness_changed_status_.alive_count_change += status.alive_count_change;
-  liveliness_changed_status_.not_alive_count_change += status.not_alive_count_change;
+void SubListener::notify_waiter()
+{
+  std::lock_guard<std::mutex> lock(internalMutex_);
 
-  liveliness_changes_.store(true, std::memory_order_relaxed);
+  if (conditionMutex_ != nullptr) {
+    // Before the suppression below: fd consumers never clear the flag.
+    rmw_fastrtps_shared_cpp::waitset_eventfd_signal(event_fd_);
+    if (nullptr != conditionReady_ && conditionReady_->exchange(true)) {
+      // An unconsumed wakeup is already pending; the waiter clears the flag
+      // before scanning and will observe the stored status.
+      return;
+    }
+    // The empty critical section pairs with the waiter's predicate check, so
+    // the waiter is either before the check, and sees the status, or already
+    // waiting, and receives the notification.
+    {
+      std::lock_guard<std::mutex> clock(*conditionMutex_);
+    }
+    conditionVariable_->notify_one();
+  }
 }
 
 bool SubListener::hasEvent(rmw_event_type_t event_type) const
 {
   assert(rmw_fastrtps_shared_cpp::internal::is_event_supported(event_type));
-  switch (event_type) {
-    case RMW_EVENT_LIVELINESS_CHANGED:
-      return liveliness_changes_.load(std::memory_order_relaxed);
-    case RMW_EVENT_REQUESTED_DEADLINE_MISSED:
-      return deadline_changes_.load(std::memory_order_relaxed);
-    default:
-      break;
-  }
-  return false;
+  return 0 != (event_changes_.load(std::memory_order_relaxed) & event_bit(event_type));
 }
 
 bool SubListener::takeNextEvent(rmw_event_type_t event_type, void * event_info)
 {
   assert(rmw_fastrtps_shared_cpp::internal::is_event_supported(event_type));
-  std::lock_guard<std::mutex> lock(internalMutex_);
+  // The changed flag is cleared before the deltas are consumed, so an update
+  // racing with this take re-raises it and surfaces on the next event check.
   switch (event_type) {
     case RMW_EVENT_LIVELINESS_CHANGED:
       {
         rmw_liveliness_changed_status_t * rmw_data =
           static_cast<rmw_liveliness_changed_status_t *>(event_info);
-        rmw_data->alive_count = liveliness_changed_status_.alive_count;
-        rmw_data->not_alive_count = liveliness_changed_status_.not_alive_count;
-        rmw_data->alive_count_change = liveliness_changed_status_.alive_count_change;
-        rmw_data->not_alive_count_change = liveliness_changed_status_.not_alive_count_change;
-        liveliness_changed_status_.alive_count_change = 0;
-        liveliness_changed_status_.not_alive_count_change = 0;
-        liveliness_changes_.store(false, std::memory_order_relaxed);
+        event_changes_.fetch_and(
+          ~event_bit(RMW_EVENT_LIVELINESS_CHANGED), std::memory_order_relaxed);
+        rmw_data->alive_count = liveliness_alive_count_.load(std::memory_order_relaxed);
+        rmw_data->not_alive_count = liveliness_not_alive_count_.load(std::memory_order_relaxed);
+        rmw_data->alive_count_change =
+          liveliness_alive_count_change_.exchange(0, std::memory_order_relaxed);
+        rmw_data->not_alive_count_change =
+          liveliness_not_alive_count_change_.exchange(0, std::memory_order_relaxed);
       }
       break;
     case RMW_EVENT_REQUESTED_DEADLINE_MISSED:
       {
         rmw_requested_deadline_missed_status_t * rmw_data =
           static_cast<rmw_requested_deadline_missed_status_t *>(event_info);
-        rmw_data->total_count = requested_deadline_missed_status_.total_count;
-        rmw_data->total_count_change = requested_deadline_missed_status_.total_count_change;
-        requested_deadline_missed_status_.total_count_change = 0;
-        deadline_changes_.store(false, std::memory_order_relaxed);
+        event_changes_.fetch_and(
+          ~event_bit(RMW_EVENT_REQUESTED_DEADLINE_MISSED), std::memory_order_relaxed);
+        rmw_data->total_count = requested_deadline_total_count_.load(std::memory_order_relaxed);
+        rmw_data->total_count_change =
+          requested_deadline_total_count_change_.exchange(0, std::memory_order_relaxed);
+      }
+      break;
+    case rmw_fastrtps_shared_cpp::RMW_FASTRTPS_EVENT_BACKLOG:
+      {
+        rmw_fastrtps_shared_cpp::BacklogStatus * status =
+          static_cast<rmw_fastrtps_shared_cpp::BacklogStatus *>(event_info);
+        event_changes_.fetch_and(
+          ~event_bit(rmw_fastrtps_shared_cpp::RMW_FASTRTPS_EVENT_BACKLOG),
+          std::memory_order_relaxed);
+        status->unread_count = backlog_unread_count_.load(std::memory_order_relaxed);
+        status->total_count = backlog_total_count_.load(std::memory_order_relaxed);
+        status->total_count_change =
+          backlog_total_count_change_.exchange(0, std::memory_order_relaxed);
       }
       break;
     default:
@@ -107,3 +434,33 @@ bool SubListener::takeNextEvent(rmw_event_type_t event_type, void * event_info)
   }
   return true;
 }
+
+uint32_t SubListener::takeAllEvents(TakenEventStatuses * statuses)
+{
+  // The mask is cleared before the deltas are consumed, so an update racing
+  // with this take re-raises its bit and surfaces on the next event check.
+  uint32_t mask = event_changes_.exchange(0, std::memory_order_relaxed);
+  if (mask & event_bit(RMW_EVENT_LIVELINESS_CHANGED)) {
+    statuses->liveliness_changed.alive_count =
+      liveliness_alive_count_.load(std::memory_order_relaxed);
+    statuses->liveliness_changed.not_alive_count =
+      liveliness_not_alive_count_.load(std::memory_order_relaxed);
+    statuses->liveliness_changed.alive_count_change =
+      liveliness_alive_count_change_.exchange(0, std::memory_order_relaxed);
+    statuses->liveliness_changed.not_alive_count_change =
+      liveliness_not_alive_count_change_.exchange(0, std::memory_order_relaxed);
+  }
+  if (mask & event_bit(RMW_EVENT_REQUESTED_DEADLINE_MISSED)) {
+    statuses->requested_deadline_missed.total_count =
+      requested_deadline_total_count_.load(std::memory_order_relaxed);
+    statuses->requested_deadline_missed.total_count_change =
+      requested_deadline_total_count_change_.exchange(0, std::memory_order_relaxed);
+  }
+  if (mask & event_bit(rmw_fastrtps_shared_cpp::RMW_FASTRTPS_EVENT_BACKLOG)) {
+    statuses->backlog.unread_count = backlog_unread_count_.load(std::memory_order_relaxed);
+    statuses->backlog.total_count = backlog_total_count_.load(std::memory_order_relaxed);
+    statuses->backlog.total_count_change =
+      backlog_total_count_change_.exchange(0, std::memory_order_relaxed);
+  }
+  return mask;
+}
@@ -14,7 +14,10 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/find_and_replace.hpp"
@@ -25,6 +28,40 @@
 
 #include "demangle.hpp"
 
+namespace
+{
+
+/// Memoize a demangling function keyed by the raw DDS name.
+/**
+ * Type demangling performs several scans and substring allocations per name,
+ * and graph queries re-demangle every entry in the graph cache on each poll.
+ * The set of DDS type names a process encounters is small and stable, so
+ * steady-state queries become a single lookup. Topic demangling stays
+ * uncached: it is one prefix strip, cheaper than hashing the name.
+ */
+std::string
+_memoize_demangling(
+  const std::string & dds_name,
+  std::string (* demangle)(const std::string &),
+  std::mutex & cache_mutex,
+  std::unordered_map<std::string, std::string> & cache)
+{
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(dds_name);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+
+  std::string demangled = demangle(dds_name);
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return cache.emplace(dds_name, std::move(demangled)).first->second;
+}
+
+}  // namespace
+
 /// Return the demangle ROS topic or the original if not a ROS topic.
 std::string
 _demangle_if_ros_topic(const std::string & topic_name)
@@ -32,9 +69,8 @@ _demangle_if_ros_topic(const std::string & topic_name)
   return _strip_ros_prefix_if_exists(topic_name);
 }
 
-/// Return the demangled ROS type or the original if not a ROS type.
-std::string
-_demangle_if_ros_type(const std::string & dds_type_string)
+static std::string
+_demangle_if_ros_type_impl(const std::string & dds_type_string)
 {
   if (dds_type_string[dds_type_string.size() - 1] != '_') {
     // not a ROS type
@@ -55,6 +91,15 @@ _demangle_if_ros_type(const std::string & dds_type_string)
   return type_namespace + type_name;
 }
 
+/// Return the demangled ROS type or the original if not a ROS type.
+std::string
+_demangle_if_ros_type(const std::string & dds_type_string)
+{
+  static std::mutex cache_mutex;
+  static std::unordered_map<std::string, std::string> cache;
+  return _memoize_demangling(dds_type_string, _demangle_if_ros_type_impl, cache_mutex, cache);
+}
+
 /// Return the topic name for a given topic if it is part of one, else "".
 std::string
 _demangle_ros_topic_from_topic(const std::string & topic_name)
@@ -114,9 +159,8 @@ _demangle_service_reply_from_topic(const std::string & topic_name)
   return _demangle_service_from_topic(ros_service_response_prefix, topic_name, "Reply");
 }
 
-/// Return the demangled service type if it is a ROS srv type, else "".
-std::string
-_demangle_service_type_only(const std::string & dds_type_name)
+static std::string
+_demangle_service_type_only_impl(const std::string & dds_type_name)
 {
   std::string ns_substring = "dds_::";
   size_t ns_substring_position = dds_type_name.find(ns_substring);
@@ -160,6 +204,16 @@ _demangle_service_type_only(const std::string & dds_type_name)
   return type_namespace + type_name;
 }
 
+/// Return the demangled service type if it is a ROS srv type, else "".
+std::string
+_demangle_service_type_only(const std::string & dds_type_name)
+{
+  static std::mutex cache_mutex;
+  static std::unordered_map<std::string, std::string> cache;
+  return _memoize_demangling(
+    dds_type_name, _demangle_service_type_only_impl, cache_mutex, cache);
+}
+
 std::string
 _identity_demangle(const std::string & name)
 {
@@ -0,0 +1,255 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fastrtps/rtps/flowcontrol/ThroughputControllerDescriptor.h"
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+#include "rmw_fastrtps_shared_cpp/endpoint_options.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+// Fleet-wide segmentation without per-endpoint code changes:
+// RMW_FASTRTPS_PARTITIONS is a semicolon separated list of partition names
+// every topic endpoint of the process joins unless its options name their
+// own. Parsed once; partitions are fixed for the life of an endpoint anyway.
+const std::vector<std::string> &
+_default_partitions()
+{
+  static const std::vector<std::string> partitions = []() {
+      std::vector<std::string> names;
+      const char * env_value;
+      const char * error_str = rcutils_get_env("RMW_FASTRTPS_PARTITIONS", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return names;
+      }
+      if (nullptr == env_value || '\0' == env_value[0]) {
+        return names;
+      }
+      std::istringstream entries(env_value);
+      std::string entry;
+      while (std::getline(entries, entry, ';')) {
+        if (!entry.empty()) {
+          names.push_back(entry);
+        }
+      }
+      return names;
+    }();
+  return partitions;
+}
+
+}  // namespace
+
+void
+apply_endpoint_memory_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::rtps::MemoryManagementPolicy_t & history_memory_policy,
+  TypeSupport * type_support)
+{
+  if (nullptr == rmw_specific_payload) {
+    return;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  history_memory_policy = options->history_memory_policy;
+  if (options->initial_payload_size > 0 && nullptr != type_support) {
+    type_support->raise_payload_size_estimate(options->initial_payload_size);
+  }
+}
+
+void
+apply_publisher_flow_control_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::PublisherAttributes & pattr)
+{
+  if (nullptr == rmw_specific_payload) {
+    return;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  if (options->asynchronous_publishing || options->throughput_bytes_per_period > 0 ||
+    options->batch_window_ms > 0)
+  {
+    pattr.qos.m_publishMode.kind = eprosima::fastrtps::ASYNCHRONOUS_PUBLISH_MODE;
+  }
+  if (options->throughput_bytes_per_period > 0) {
+    pattr.throughputController = eprosima::fastrtps::rtps::ThroughputControllerDescriptor(
+      options->throughput_bytes_per_period, options->throughput_period_ms);
+  } else if (options->batch_window_ms > 0) {
+    // Batching is the throughput controller wearing a different hat: the
+    // budget is the flush-size threshold and the period is the window, so
+    // the asynchronous sender wakes once per window and packs everything
+    // queued since the last flush into shared datagrams.
+    constexpr uint32_t kUdpDatagramBytes = 65500;
+    uint32_t flush_bytes =
+      options->batch_flush_bytes > 0 ? options->batch_flush_bytes : kUdpDatagramBytes;
+    pattr.throughputController = eprosima::fastrtps::rtps::ThroughputControllerDescriptor(
+      flush_bytes, options->batch_window_ms);
+  }
+}
+
+void
+apply_endpoint_partition_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::PartitionQosPolicy & partition)
+{
+  const std::vector<std::string> * names = &_default_partitions();
+  if (nullptr != rmw_specific_payload) {
+    auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+    if (!options->partitions.empty()) {
+      names = &options->partitions;
+    }
+  }
+  for (const std::string & name : *names) {
+    partition.push_back(name.c_str());
+  }
+}
+
+void
+apply_endpoint_resource_limit_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::ResourceLimitsQosPolicy & resource_limits)
+{
+  if (nullptr == rmw_specific_payload) {
+    return;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  if (options->history_max_samples > 0) {
+    resource_limits.max_samples = options->history_max_samples;
+  }
+  if (options->history_allocated_samples > 0) {
+    resource_limits.allocated_samples = options->history_allocated_samples;
+    // The cap must admit what is preallocated, or endpoint creation fails.
+    if (resource_limits.max_samples < resource_limits.allocated_samples) {
+      resource_limits.max_samples = resource_limits.allocated_samples;
+    }
+  }
+}
+
+namespace
+{
+
+eprosima::fastrtps::Duration_t
+_duration_from_ms(int64_t milliseconds)
+{
+  return eprosima::fastrtps::Duration_t(
+    static_cast<int32_t>(milliseconds / 1000),
+    static_cast<uint32_t>((milliseconds % 1000) * 1000000));
+}
+
+}  // namespace
+
+void
+apply_publisher_reliability_timing_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::PublisherAttributes & pattr)
+{
+  if (nullptr == rmw_specific_payload) {
+    return;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  if (options->heartbeat_period_ms > 0) {
+    pattr.times.heartbeatPeriod = _duration_from_ms(options->heartbeat_period_ms);
+  }
+  if (options->nack_response_delay_ms >= 0) {
+    pattr.times.nackResponseDelay = _duration_from_ms(options->nack_response_delay_ms);
+  }
+  if (options->max_blocking_ms >= 0) {
+    pattr.qos.m_reliability.max_blocking_time = _duration_from_ms(options->max_blocking_ms);
+  }
+}
+
+void
+apply_subscription_reliability_timing_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::SubscriberAttributes & sattr)
+{
+  if (nullptr == rmw_specific_payload) {
+    return;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  if (options->heartbeat_response_delay_ms >= 0) {
+    sattr.times.heartbeatResponseDelay = _duration_from_ms(options->heartbeat_response_delay_ms);
+  }
+  if (options->nack_suppression_ms >= 0) {
+    sattr.times.heartbeatSupressionDuration = _duration_from_ms(options->nack_suppression_ms);
+  }
+}
+
+uint32_t
+endpoint_clock_sample_stride(const void * rmw_specific_payload)
+{
+  if (nullptr == rmw_specific_payload) {
+    return 1u;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  return options->clock_sample_stride > 0 ? options->clock_sample_stride : 1u;
+}
+
+uint32_t
+endpoint_publish_pipeline_depth(const void * rmw_specific_payload)
+{
+  if (nullptr == rmw_specific_payload) {
+    return 0u;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  return options->publish_pipeline_depth;
+}
+
+bool
+endpoint_compress_payloads(const void * rmw_specific_payload)
+{
+  if (nullptr == rmw_specific_payload) {
+    return false;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  return options->compress_payloads;
+}
+
+const char *
+endpoint_mux_channel(const void * rmw_specific_payload)
+{
+  if (nullptr == rmw_specific_payload) {
+    return nullptr;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  return options->mux_channel.empty() ? nullptr : options->mux_channel.c_str();
+}
+
+void
+apply_endpoint_key_options(
+  const void * rmw_specific_payload,
+  eprosima::fastrtps::rtps::TopicKind_t & topic_kind,
+  TypeSupport * type_support)
+{
+  if (nullptr == rmw_specific_payload) {
+    return;
+  }
+  auto options = static_cast<const EndpointOptions *>(rmw_specific_payload);
+  if (options->key_extractor && nullptr != type_support) {
+    type_support->set_key_extractor(options->key_extractor);
+    topic_kind = eprosima::fastrtps::rtps::WITH_KEY;
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
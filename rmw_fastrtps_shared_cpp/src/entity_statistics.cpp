@@ -0,0 +1,118 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw/error_handling.h"
+#include "rmw/rmw.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/entity_statistics.hpp"
+
+#include "types/custom_wait_set_info.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+rmw_ret_t
+__rmw_publisher_get_statistics(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  EntityStatisticsSnapshot * statistics)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    publisher, "publisher pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    statistics, "statistics pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher info pointer is null", return RMW_RET_ERROR);
+
+  *statistics = info->statistics_.snapshot();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_get_statistics(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  EntityStatisticsSnapshot * statistics)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    statistics, "statistics pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  *statistics = info->statistics_.snapshot();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_service_get_statistics(
+  const char * identifier,
+  const rmw_service_t * service,
+  ServiceStatisticsSnapshot * statistics)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    service, "service pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    statistics, "statistics pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  if (service->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomServiceInfo *>(service->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "service info pointer is null", return RMW_RET_ERROR);
+
+  *statistics = info->statistics_.snapshot();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_wait_set_get_statistics(
+  const char * identifier,
+  const rmw_wait_set_t * wait_set,
+  WaitsetStatisticsSnapshot * statistics)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    wait_set, "wait set handle is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    statistics, "statistics pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  if (wait_set->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("wait set handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto wait_set_info = static_cast<CustomWaitsetInfo *>(wait_set->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    wait_set_info, "wait set info is null", return RMW_RET_ERROR);
+
+  *statistics = wait_set_info->statistics.snapshot();
+  return RMW_RET_OK;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
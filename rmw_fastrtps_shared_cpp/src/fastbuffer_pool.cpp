@@ -0,0 +1,176 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+#include "rmw_fastrtps_shared_cpp/middleware_allocator.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+constexpr size_t FastBufferPool::kPoolSize;
+
+// RMW_FASTRTPS_NUMA_NODES=N (N > 1) stripes the pool across N NUMA nodes;
+// capped so every stripe keeps at least four slots.
+static
+size_t
+__requested_numa_nodes()
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_NUMA_NODES", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return 1u;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return 1u;
+  }
+  char * end = nullptr;
+  unsigned long nodes = strtoul(env_value, &end, 10);  // NOLINT(runtime/int)
+  if (end == env_value || *end != '\0' || nodes > 8) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_NUMA_NODES is not a number between 0 and 8, ignoring it");
+    return 1u;
+  }
+  return nodes > 1u ? static_cast<size_t>(nodes) : 1u;
+}
+
+void
+FastBufferPool::current_stripe(size_t * begin, size_t * end)
+{
+  static const size_t nodes = __requested_numa_nodes();
+  if (nodes <= 1u) {
+    *begin = 0;
+    *end = kPoolSize;
+    return;
+  }
+#ifdef __linux__
+  // getcpu is a vDSO call on current kernels, so the per-operation cost is
+  // comparable to the slot scan itself. The node can change if the thread
+  // migrates; with the reception threads pinned it never does, and an
+  // occasional buffer recycled through a neighbour stripe is only a
+  // placement miss, never a correctness problem.
+  unsigned int cpu = 0;
+  unsigned int node = 0;
+  if (0 != syscall(SYS_getcpu, &cpu, &node, nullptr)) {
+    node = 0;
+  }
+  const size_t width = kPoolSize / nodes;
+  *begin = (node % nodes) * width;
+  *end = *begin + width;
+#else
+  // No portable node lookup here; keep the shared pool.
+  *begin = 0;
+  *end = kPoolSize;
+#endif  // __linux__
+}
+
+std::atomic<eprosima::fastcdr::FastBuffer *> FastBufferPool::slots_[FastBufferPool::kPoolSize] = {};
+std::atomic<size_t> FastBufferPool::capacity_high_water_{0};
+
+size_t
+FastBufferPool::trim()
+{
+  // Decay first: the threshold this call enforces is half of the high-water
+  // seen since the previous trim. Storing it back means a pool that stays
+  // idle is released over successive trims, halving toward zero.
+  const size_t threshold = capacity_high_water_.load(std::memory_order_relaxed) / 2u;
+  capacity_high_water_.store(threshold, std::memory_order_relaxed);
+
+  size_t released = 0;
+  // All stripes are walked: trim is a maintenance path, and a kept buffer
+  // recycled back through the caller's stripe is at worst a placement miss.
+  for (size_t i = 0; i < kPoolSize; ++i) {
+    eprosima::fastcdr::FastBuffer * buffer = slots_[i].exchange(nullptr);
+    if (nullptr == buffer) {
+      continue;
+    }
+    if (buffer->getBufferSize() > threshold) {
+      released += buffer->getBufferSize();
+      deallocate_buffer(buffer);
+    } else {
+      release(buffer);
+    }
+  }
+  return released;
+}
+
+bool
+FastBufferPool::prewarm(size_t count, size_t payload_size)
+{
+  size_t begin;
+  size_t end;
+  current_stripe(&begin, &end);
+  if (count > end - begin) {
+    // More would only recycle through the overflow delete path below.
+    count = end - begin;
+  }
+  // All buffers are held at once: acquiring and releasing one at a time
+  // would warm the same buffer over and over.
+  eprosima::fastcdr::FastBuffer * held[kPoolSize] = {};
+  bool ok = true;
+  for (size_t i = 0; i < count; ++i) {
+    held[i] = acquire();
+    if (held[i]->getBufferSize() < payload_size) {
+      if (!held[i]->reserve(payload_size) && !held[i]->resize(payload_size)) {
+        ok = false;
+        continue;
+      }
+    }
+    // Touching every byte is the point: an allocation alone leaves the
+    // pages unmapped and the first message still faults them in.
+    if (payload_size > 0u) {
+      memset(held[i]->getBuffer(), 0, payload_size);
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    release(held[i]);
+  }
+  return ok;
+}
+
+eprosima::fastcdr::FastBuffer *
+FastBufferPool::allocate_buffer()
+{
+  const rcutils_allocator_t & allocator = middleware_allocator();
+  void * memory = allocator.allocate(sizeof(eprosima::fastcdr::FastBuffer), allocator.state);
+  if (nullptr == memory) {
+    // Callers relied on plain new never returning null; keep that contract.
+    throw std::bad_alloc();
+  }
+  return new (memory) eprosima::fastcdr::FastBuffer();
+}
+
+void
+FastBufferPool::deallocate_buffer(eprosima::fastcdr::FastBuffer * buffer)
+{
+  const rcutils_allocator_t & allocator = middleware_allocator();
+  buffer->~FastBuffer();
+  allocator.deallocate(buffer, allocator.state);
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
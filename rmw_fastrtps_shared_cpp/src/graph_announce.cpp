@@ -0,0 +1,229 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+std::chrono::milliseconds
+_millis_env(const char * name)
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env(name, &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return std::chrono::milliseconds(0);
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return std::chrono::milliseconds(0);
+  }
+  char * end = nullptr;
+  long window_ms = strtol(env_value, &end, 10);  // NOLINT(runtime/int)
+  if (end == env_value || *end != '\0' || window_ms < 0) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "%s is not a non-negative number, ignoring it", name);
+    return std::chrono::milliseconds(0);
+  }
+  return std::chrono::milliseconds(window_ms);
+}
+
+std::chrono::milliseconds
+_coalesce_window()
+{
+  return _millis_env("RMW_FASTRTPS_GRAPH_COALESCE_MS");
+}
+
+std::chrono::milliseconds
+_min_interval()
+{
+  return _millis_env("RMW_FASTRTPS_GRAPH_MIN_INTERVAL_MS");
+}
+
+struct AnnounceState
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  const char * identifier = nullptr;
+  rmw_dds_common::Context * common_context = nullptr;
+  // Announcements are complete state, so one held-back message is enough:
+  // a newer one within the window simply overwrites it.
+  rmw_dds_common::msg::ParticipantEntitiesInfo pending;
+  bool has_pending = false;
+  std::chrono::steady_clock::time_point deadline;
+  // When the last announcement left, so the minimum inter-announcement
+  // interval spans flushes, not just changes within one window.
+  std::chrono::steady_clock::time_point last_flush;
+  bool running = false;
+  std::thread flusher;
+};
+
+std::mutex g_announce_mutex;
+std::unordered_map<rmw_dds_common::Context *,
+  std::shared_ptr<AnnounceState>> g_announce_states;
+
+void
+_flusher(std::shared_ptr<AnnounceState> state)
+{
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while (state->running) {
+    if (!state->has_pending) {
+      state->cv.wait(lock);
+      continue;
+    }
+    if (std::chrono::steady_clock::now() < state->deadline) {
+      state->cv.wait_until(lock, state->deadline);
+      continue;
+    }
+    rmw_dds_common::msg::ParticipantEntitiesInfo msg = std::move(state->pending);
+    state->has_pending = false;
+    state->last_flush = std::chrono::steady_clock::now();
+    // Published without the state mutex, so announcements arriving while the
+    // publish runs are coalesced into the next window instead of blocking.
+    lock.unlock();
+    if (RMW_RET_OK != __rmw_publish(
+        state->identifier, state->common_context->pub,
+        static_cast<void *>(&msg), nullptr))
+    {
+      // Nobody is left to return this to; the next announcement carries the
+      // complete state again anyway.
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "failed to publish coalesced graph announcement");
+      rmw_reset_error();
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace
+
+rmw_ret_t
+graph_announce(
+  const char * identifier,
+  rmw_dds_common::Context * common_context,
+  rmw_dds_common::msg::ParticipantEntitiesInfo * msg)
+{
+  static const std::chrono::milliseconds window = _coalesce_window();
+  static const std::chrono::milliseconds min_interval = _min_interval();
+  if (window.count() <= 0 && min_interval.count() <= 0) {
+    return __rmw_publish(
+      identifier, common_context->pub, static_cast<void *>(msg), nullptr);
+  }
+
+  std::shared_ptr<AnnounceState> state;
+  {
+    std::lock_guard<std::mutex> lock(g_announce_mutex);
+    auto & slot = g_announce_states[common_context];
+    if (!slot) {
+      slot = std::make_shared<AnnounceState>();
+      slot->identifier = identifier;
+      slot->common_context = common_context;
+      slot->running = true;
+      slot->flusher = std::thread(_flusher, slot);
+    }
+    state = slot;
+  }
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  const bool had_pending = state->has_pending;
+  state->pending = *msg;
+  state->has_pending = true;
+  if (!had_pending) {
+    // The window opens at the first held-back announcement, so a steady
+    // stream of changes still flushes once per window instead of being
+    // pushed out indefinitely. The minimum interval then pushes the flush
+    // out further when the previous announcement left too recently.
+    state->deadline = std::max(
+      std::chrono::steady_clock::now() + window,
+      state->last_flush + min_interval);
+    state->cv.notify_one();
+  }
+  return RMW_RET_OK;
+}
+
+bool
+graph_announce_reduced_qos()
+{
+  static const bool reduced = []() {
+      const char * env_value;
+      const char * error_str = rcutils_get_env("RMW_FASTRTPS_GRAPH_REDUCED_QOS", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return false;
+      }
+      return env_value != nullptr && strcmp(env_value, "1") == 0;
+    }();
+  return reduced;
+}
+
+rmw_ret_t
+graph_announce_fini(
+  const char * identifier,
+  rmw_dds_common::Context * common_context)
+{
+  std::shared_ptr<AnnounceState> state;
+  {
+    std::lock_guard<std::mutex> lock(g_announce_mutex);
+    auto it = g_announce_states.find(common_context);
+    if (it == g_announce_states.end()) {
+      return RMW_RET_OK;
+    }
+    state = std::move(it->second);
+    g_announce_states.erase(it);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->running = false;
+    state->cv.notify_one();
+  }
+  state->flusher.join();
+
+  // Flush what is still held back, so the final announcement (typically the
+  // removals of this context's nodes) reaches the network before the graph
+  // publisher goes away.
+  if (state->has_pending) {
+    state->has_pending = false;
+    return __rmw_publish(
+      identifier, common_context->pub,
+      static_cast<void *>(&state->pending), nullptr);
+  }
+  return RMW_RET_OK;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
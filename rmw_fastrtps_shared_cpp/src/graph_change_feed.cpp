@@ -0,0 +1,253 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rmw/error_handling.h"
+
+#include "rmw_fastrtps_shared_cpp/graph_change_feed.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+constexpr size_t kDefaultQueueDepth = 1024;
+
+struct FeedSubscriber
+{
+  const char * identifier;
+  const rmw_guard_condition_t * guard_condition;
+  size_t queue_depth;
+  bool overflowed = false;
+  std::deque<GraphChange> queue;
+};
+
+struct FeedState
+{
+  std::vector<FeedSubscriber> subscribers;
+  // Last announced node list per remote participant, so announcements can be
+  // diffed into added/removed deltas.
+  std::map<std::string, std::set<std::pair<std::string, std::string>>> node_sets;
+};
+
+std::mutex g_feed_mutex;
+std::unordered_map<const void *, FeedState> g_feed_states;
+
+// Appends to every subscriber of the feed and collects who to wake; the
+// guard conditions are triggered after the lock is released.
+void
+_push(const void * graph_key, const GraphChange & change)
+{
+  std::vector<std::pair<const char *, const rmw_guard_condition_t *>> to_trigger;
+  {
+    std::lock_guard<std::mutex> lock(g_feed_mutex);
+    auto state_it = g_feed_states.find(graph_key);
+    if (state_it == g_feed_states.end()) {
+      return;
+    }
+    for (auto & subscriber : state_it->second.subscribers) {
+      if (subscriber.queue.size() >= subscriber.queue_depth) {
+        subscriber.queue.pop_front();
+        subscriber.overflowed = true;
+      }
+      subscriber.queue.push_back(change);
+      to_trigger.emplace_back(subscriber.identifier, subscriber.guard_condition);
+    }
+  }
+  for (const auto & target : to_trigger) {
+    if (RMW_RET_OK != __rmw_trigger_guard_condition(target.first, target.second)) {
+      rmw_reset_error();
+    }
+  }
+}
+
+}  // namespace
+
+rmw_ret_t
+graph_change_feed_attach(
+  const void * graph_key,
+  const char * identifier,
+  const rmw_guard_condition_t * guard_condition,
+  size_t queue_depth)
+{
+  if (!graph_key || !identifier || !guard_condition) {
+    RMW_SET_ERROR_MSG("graph change feed attach got a null argument");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (guard_condition->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("guard condition handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+  std::lock_guard<std::mutex> lock(g_feed_mutex);
+  auto & subscribers = g_feed_states[graph_key].subscribers;
+  for (const auto & subscriber : subscribers) {
+    if (subscriber.guard_condition == guard_condition) {
+      RMW_SET_ERROR_MSG("guard condition is already attached to this feed");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+  }
+  FeedSubscriber subscriber;
+  subscriber.identifier = identifier;
+  subscriber.guard_condition = guard_condition;
+  subscriber.queue_depth = queue_depth > 0 ? queue_depth : kDefaultQueueDepth;
+  subscribers.push_back(std::move(subscriber));
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+graph_change_feed_detach(
+  const void * graph_key,
+  const rmw_guard_condition_t * guard_condition)
+{
+  std::lock_guard<std::mutex> lock(g_feed_mutex);
+  auto state_it = g_feed_states.find(graph_key);
+  if (state_it == g_feed_states.end()) {
+    return RMW_RET_OK;
+  }
+  auto & subscribers = state_it->second.subscribers;
+  subscribers.erase(
+    std::remove_if(
+      subscribers.begin(), subscribers.end(),
+      [guard_condition](const FeedSubscriber & subscriber) {
+        return subscriber.guard_condition == guard_condition;
+      }),
+    subscribers.end());
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+graph_change_feed_take(
+  const void * graph_key,
+  const rmw_guard_condition_t * guard_condition,
+  std::vector<GraphChange> * changes,
+  bool * overflowed)
+{
+  if (!changes || !overflowed) {
+    RMW_SET_ERROR_MSG("graph change feed take got a null argument");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  *overflowed = false;
+  std::lock_guard<std::mutex> lock(g_feed_mutex);
+  auto state_it = g_feed_states.find(graph_key);
+  if (state_it == g_feed_states.end()) {
+    return RMW_RET_OK;
+  }
+  for (auto & subscriber : state_it->second.subscribers) {
+    if (subscriber.guard_condition != guard_condition) {
+      continue;
+    }
+    changes->insert(changes->end(), subscriber.queue.begin(), subscriber.queue.end());
+    subscriber.queue.clear();
+    *overflowed = subscriber.overflowed;
+    subscriber.overflowed = false;
+    return RMW_RET_OK;
+  }
+  RMW_SET_ERROR_MSG("guard condition is not attached to this feed");
+  return RMW_RET_INVALID_ARGUMENT;
+}
+
+void
+graph_change_feed_forget(const void * graph_key)
+{
+  std::lock_guard<std::mutex> lock(g_feed_mutex);
+  g_feed_states.erase(graph_key);
+}
+
+void
+graph_change_feed_push_endpoint(
+  const void * graph_key,
+  bool added,
+  const std::string & topic_name,
+  bool is_reader)
+{
+  GraphChange change;
+  change.kind = added ? GraphChangeKind::ENDPOINT_ADDED : GraphChangeKind::ENDPOINT_REMOVED;
+  change.topic_name = topic_name;
+  change.is_reader = is_reader;
+  _push(graph_key, change);
+}
+
+void
+graph_change_feed_update_nodes(
+  const void * graph_key,
+  const std::string & participant_key,
+  const std::vector<std::pair<std::string, std::string>> & nodes)
+{
+  std::set<std::pair<std::string, std::string>> announced(nodes.begin(), nodes.end());
+  std::vector<GraphChange> deltas;
+  {
+    std::lock_guard<std::mutex> lock(g_feed_mutex);
+    auto state_it = g_feed_states.find(graph_key);
+    if (state_it == g_feed_states.end()) {
+      return;
+    }
+    auto & previous = state_it->second.node_sets[participant_key];
+    for (const auto & node : announced) {
+      if (previous.find(node) == previous.end()) {
+        deltas.push_back(
+          GraphChange{GraphChangeKind::NODE_ADDED, node.first, node.second, "", false});
+      }
+    }
+    for (const auto & node : previous) {
+      if (announced.find(node) == announced.end()) {
+        deltas.push_back(
+          GraphChange{GraphChangeKind::NODE_REMOVED, node.first, node.second, "", false});
+      }
+    }
+    previous = std::move(announced);
+  }
+  for (const auto & delta : deltas) {
+    _push(graph_key, delta);
+  }
+}
+
+void
+graph_change_feed_remove_participant(
+  const void * graph_key,
+  const std::string & participant_key)
+{
+  std::vector<GraphChange> deltas;
+  {
+    std::lock_guard<std::mutex> lock(g_feed_mutex);
+    auto state_it = g_feed_states.find(graph_key);
+    if (state_it == g_feed_states.end()) {
+      return;
+    }
+    auto node_set_it = state_it->second.node_sets.find(participant_key);
+    if (node_set_it == state_it->second.node_sets.end()) {
+      return;
+    }
+    for (const auto & node : node_set_it->second) {
+      deltas.push_back(
+        GraphChange{GraphChangeKind::NODE_REMOVED, node.first, node.second, "", false});
+    }
+    state_it->second.node_sets.erase(node_set_it);
+  }
+  for (const auto & delta : deltas) {
+    _push(graph_key, delta);
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
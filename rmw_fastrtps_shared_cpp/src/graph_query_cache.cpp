@@ -0,0 +1,511 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcutils/strdup.h"
+#include "rcutils/types/string_array.h"
+
+#include "rmw/error_handling.h"
+#include "rmw/topic_endpoint_info.h"
+
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
+#include "rmw_fastrtps_shared_cpp/middleware_allocator.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+struct QuerySnapshot
+{
+  uint64_t generation = 0;
+  std::vector<std::pair<std::string, std::vector<std::string>>> entries;
+};
+
+struct CountSnapshot
+{
+  uint64_t generation = 0;
+  size_t count = 0;
+};
+
+struct EndpointInfoEntry
+{
+  std::string node_name;
+  std::string node_namespace;
+  std::string topic_type;
+  rmw_endpoint_type_t endpoint_type = RMW_ENDPOINT_INVALID;
+  std::array<uint8_t, RMW_GID_STORAGE_SIZE> endpoint_gid{};
+  rmw_qos_profile_t qos_profile = rmw_qos_profile_unknown;
+};
+
+struct EndpointInfoSnapshot
+{
+  uint64_t generation = 0;
+  std::vector<EndpointInfoEntry> entries;
+};
+
+// Read-copy-update discipline: a snapshot is immutable once it is published
+// into the maps below, and refreshing a query replaces the stored shared_ptr
+// wholesale. Readers grab the pointer under the brief snapshots_mutex and
+// build their result with no lock held, so a discovery burst bumping the
+// generation never waits behind a reader rebuilding arrays, and a reader
+// holding a superseded snapshot simply keeps it alive until it is done.
+struct GraphQueryState
+{
+  // Bumped on every graph cache change; snapshots taken at an older
+  // generation are stale and get refreshed on the next query. Atomic so the
+  // discovery callback invalidates without touching the maps.
+  std::atomic<uint64_t> generation{0};
+  // Guards the three maps only, never the snapshot contents; held for
+  // pointer lookups and publications, not for copies.
+  std::mutex snapshots_mutex;
+  std::map<std::string, std::shared_ptr<const QuerySnapshot>> snapshots;
+  std::map<std::string, CountSnapshot> counts;
+  std::map<std::string, std::shared_ptr<const EndpointInfoSnapshot>> endpoint_infos;
+};
+
+// Guards only the key-to-state map; the states themselves synchronize their
+// own content. Held for one hash lookup per call.
+std::mutex g_graph_query_mutex;
+std::unordered_map<const void *, std::shared_ptr<GraphQueryState>> g_graph_query_states;
+
+std::shared_ptr<GraphQueryState>
+_state_for(const void * graph_key)
+{
+  std::lock_guard<std::mutex> lock(g_graph_query_mutex);
+  auto & state = g_graph_query_states[graph_key];
+  if (!state) {
+    state = std::make_shared<GraphQueryState>();
+  }
+  return state;
+}
+
+rmw_ret_t
+_fill_from_snapshot(
+  const QuerySnapshot & snapshot,
+  size_t offset,
+  size_t count,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * names_and_types)
+{
+  if (0u == count) {
+    // Mirror the graph cache, which leaves the result zero-initialized
+    // when there is nothing to report.
+    return RMW_RET_OK;
+  }
+
+  rmw_ret_t ret = rmw_names_and_types_init(
+    names_and_types, count, allocator);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const auto & entry = snapshot.entries[offset + i];
+    names_and_types->names.data[i] = rcutils_strdup(entry.first.c_str(), *allocator);
+    if (!names_and_types->names.data[i]) {
+      goto fail;
+    }
+    if (RCUTILS_RET_OK != rcutils_string_array_init(
+        &names_and_types->types[i], entry.second.size(), allocator))
+    {
+      goto fail;
+    }
+    for (size_t j = 0; j < entry.second.size(); ++j) {
+      names_and_types->types[i].data[j] =
+        rcutils_strdup(entry.second[j].c_str(), *allocator);
+      if (!names_and_types->types[i].data[j]) {
+        goto fail;
+      }
+    }
+  }
+  return RMW_RET_OK;
+
+fail:
+  RMW_SET_ERROR_MSG("failed to allocate names and types from snapshot");
+  if (RMW_RET_OK != rmw_names_and_types_fini(names_and_types)) {
+    RMW_SET_ERROR_MSG("failed to cleanup names and types from snapshot");
+  }
+  return RMW_RET_BAD_ALLOC;
+}
+
+void
+_capture_snapshot(
+  const rmw_names_and_types_t * names_and_types,
+  QuerySnapshot & snapshot)
+{
+  snapshot.entries.reserve(names_and_types->names.size);
+  for (size_t i = 0; i < names_and_types->names.size; ++i) {
+    std::vector<std::string> types;
+    types.reserve(names_and_types->types[i].size);
+    for (size_t j = 0; j < names_and_types->types[i].size; ++j) {
+      types.emplace_back(names_and_types->types[i].data[j]);
+    }
+    snapshot.entries.emplace_back(names_and_types->names.data[i], std::move(types));
+  }
+}
+
+rmw_ret_t
+_fill_endpoint_info_from_snapshot(
+  const EndpointInfoSnapshot & snapshot,
+  rcutils_allocator_t * allocator,
+  rmw_topic_endpoint_info_array_t * info_array)
+{
+  if (snapshot.entries.empty()) {
+    // Like the graph cache, leave the zero-initialized array as-is when
+    // there are no endpoints on the topic.
+    return RMW_RET_OK;
+  }
+
+  rmw_ret_t ret = rmw_topic_endpoint_info_array_init_with_size(
+    info_array, snapshot.entries.size(), allocator);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  for (size_t i = 0; i < snapshot.entries.size(); ++i) {
+    const auto & entry = snapshot.entries[i];
+    rmw_topic_endpoint_info_t * info = &info_array->info_array[i];
+    *info = rmw_get_zero_initialized_topic_endpoint_info();
+    if (RMW_RET_OK != rmw_topic_endpoint_info_set_node_name(
+        info, entry.node_name.c_str(), allocator) ||
+      RMW_RET_OK != rmw_topic_endpoint_info_set_node_namespace(
+        info, entry.node_namespace.c_str(), allocator) ||
+      RMW_RET_OK != rmw_topic_endpoint_info_set_topic_type(
+        info, entry.topic_type.c_str(), allocator) ||
+      RMW_RET_OK != rmw_topic_endpoint_info_set_endpoint_type(
+        info, entry.endpoint_type) ||
+      RMW_RET_OK != rmw_topic_endpoint_info_set_gid(
+        info, entry.endpoint_gid.data(), entry.endpoint_gid.size()) ||
+      RMW_RET_OK != rmw_topic_endpoint_info_set_qos_profile(
+        info, &entry.qos_profile))
+    {
+      rmw_error_string_t error_string = rmw_get_error_string();
+      rmw_reset_error();
+      if (RMW_RET_OK != rmw_topic_endpoint_info_array_fini(info_array, allocator)) {
+        rmw_reset_error();
+      }
+      RMW_SET_ERROR_MSG(error_string.str);
+      return RMW_RET_BAD_ALLOC;
+    }
+  }
+  return RMW_RET_OK;
+}
+
+void
+_capture_endpoint_info_snapshot(
+  const rmw_topic_endpoint_info_array_t * info_array,
+  EndpointInfoSnapshot & snapshot)
+{
+  snapshot.entries.reserve(info_array->size);
+  for (size_t i = 0; i < info_array->size; ++i) {
+    const rmw_topic_endpoint_info_t & info = info_array->info_array[i];
+    EndpointInfoEntry entry;
+    entry.node_name = info.node_name;
+    entry.node_namespace = info.node_namespace;
+    entry.topic_type = info.topic_type;
+    entry.endpoint_type = info.endpoint_type;
+    static_assert(
+      sizeof(info.endpoint_gid) == RMW_GID_STORAGE_SIZE,
+      "unexpected endpoint gid storage size");
+    memcpy(entry.endpoint_gid.data(), info.endpoint_gid, RMW_GID_STORAGE_SIZE);
+    entry.qos_profile = info.qos_profile;
+    snapshot.entries.push_back(std::move(entry));
+  }
+}
+
+}  // namespace
+
+void
+graph_query_cache_on_change(const void * graph_key)
+{
+  // Only the generation moves; the snapshots stay in place and age out on
+  // their next lookup. Release pairs with the acquire in the queries, so a
+  // reader that sees the new generation also sees the graph mutation that
+  // preceded this call.
+  _state_for(graph_key)->generation.fetch_add(1, std::memory_order_release);
+}
+
+void
+graph_query_cache_forget(const void * graph_key)
+{
+  // Queries still in flight hold the state through their shared_ptr and
+  // finish against it; the erase only stops new lookups from finding it.
+  std::lock_guard<std::mutex> lock(g_graph_query_mutex);
+  g_graph_query_states.erase(graph_key);
+}
+
+rmw_ret_t
+cached_names_and_types_query(
+  const void * graph_key,
+  const char * query_id,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * names_and_types,
+  const std::function<rmw_ret_t(rmw_names_and_types_t *)> & fresh_query)
+{
+  auto state = _state_for(graph_key);
+  uint64_t generation = state->generation.load(std::memory_order_acquire);
+  std::shared_ptr<const QuerySnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+    auto snapshot_it = state->snapshots.find(query_id);
+    if (snapshot_it != state->snapshots.end() &&
+      snapshot_it->second->generation == generation)
+    {
+      snapshot = snapshot_it->second;
+    }
+  }
+  if (snapshot) {
+    // The snapshot is immutable once published, so the copy-out runs with no
+    // lock held and never stalls discovery or other queries.
+    return _fill_from_snapshot(
+      *snapshot, 0u, snapshot->entries.size(), allocator, names_and_types);
+  }
+
+  rmw_ret_t ret = fresh_query(names_and_types);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  // Stamp the snapshot with the generation read before the query: if the
+  // graph changed while the query ran, the snapshot is treated as stale and
+  // refreshed next time, never served beyond its generation.
+  auto new_snapshot = std::make_shared<QuerySnapshot>();
+  new_snapshot->generation = generation;
+  _capture_snapshot(names_and_types, *new_snapshot);
+  std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+  // A superseded snapshot still being copied from stays alive through its
+  // readers' references and is freed when the last one finishes.
+  state->snapshots[query_id] = std::move(new_snapshot);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+visit_cached_names_and_types(
+  const void * graph_key,
+  const char * query_id,
+  const std::function<rmw_ret_t(rcutils_allocator_t *, rmw_names_and_types_t *)> & fresh_query,
+  const NamesAndTypesVisitor & visitor)
+{
+  auto state = _state_for(graph_key);
+  uint64_t generation = state->generation.load(std::memory_order_acquire);
+  std::shared_ptr<const QuerySnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+    auto snapshot_it = state->snapshots.find(query_id);
+    if (snapshot_it != state->snapshots.end() &&
+      snapshot_it->second->generation == generation)
+    {
+      snapshot = snapshot_it->second;
+    }
+  }
+  if (!snapshot) {
+    // Only the refresh allocates: the query result is built into scratch
+    // arrays, captured into a snapshot and freed again before visiting.
+    rcutils_allocator_t allocator = middleware_allocator();
+    rmw_names_and_types_t scratch = rmw_get_zero_initialized_names_and_types();
+    rmw_ret_t ret = fresh_query(&allocator, &scratch);
+    if (RMW_RET_OK != ret) {
+      return ret;
+    }
+    // Same staleness rule as cached_names_and_types_query: the snapshot
+    // carries the generation read before the query ran.
+    auto new_snapshot = std::make_shared<QuerySnapshot>();
+    new_snapshot->generation = generation;
+    _capture_snapshot(&scratch, *new_snapshot);
+    ret = rmw_names_and_types_fini(&scratch);
+    if (RMW_RET_OK != ret) {
+      return ret;
+    }
+    {
+      std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+      state->snapshots[query_id] = new_snapshot;
+    }
+    snapshot = std::move(new_snapshot);
+  }
+  // The snapshot is immutable once published; the shared_ptr held here keeps
+  // it alive even if a graph change publishes a successor mid-walk.
+  for (const auto & entry : snapshot->entries) {
+    if (!visitor(entry.first, entry.second)) {
+      break;
+    }
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+cached_names_and_types_query_chunk(
+  const void * graph_key,
+  const char * query_id,
+  rcutils_allocator_t * allocator,
+  size_t offset,
+  size_t max_entries,
+  uint64_t * continuation,
+  rmw_names_and_types_t * names_and_types,
+  bool * more,
+  const std::function<rmw_ret_t(rcutils_allocator_t *, rmw_names_and_types_t *)> & fresh_query)
+{
+  auto state = _state_for(graph_key);
+  uint64_t generation = state->generation.load(std::memory_order_acquire);
+  std::shared_ptr<const QuerySnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+    auto snapshot_it = state->snapshots.find(query_id);
+    if (snapshot_it != state->snapshots.end()) {
+      snapshot = snapshot_it->second;
+    }
+  }
+
+  if (0u != *continuation) {
+    // Continuation of a pull in progress: serve only from the snapshot the
+    // pull started against, whether or not the graph moved since - the
+    // chunks of one pull must agree with each other. Matching the token
+    // against the published snapshot keeps the cursor stateless; if another
+    // query refreshed the snapshot in between, restarting is the only
+    // answer that does not splice two graph states together.
+    if (!snapshot || snapshot->generation + 1u != *continuation) {
+      RMW_SET_ERROR_MSG("graph changed during chunked query, restart the pull");
+      return RMW_RET_ERROR;
+    }
+  } else {
+    if (snapshot && snapshot->generation != generation) {
+      snapshot.reset();
+    }
+    if (!snapshot) {
+      // Same refresh as visit_cached_names_and_types: the query result is
+      // built into scratch arrays, captured and freed before any chunk is
+      // served, so later chunks never re-run the graph walk.
+      rcutils_allocator_t scratch_allocator = middleware_allocator();
+      rmw_names_and_types_t scratch = rmw_get_zero_initialized_names_and_types();
+      rmw_ret_t ret = fresh_query(&scratch_allocator, &scratch);
+      if (RMW_RET_OK != ret) {
+        return ret;
+      }
+      auto new_snapshot = std::make_shared<QuerySnapshot>();
+      new_snapshot->generation = generation;
+      _capture_snapshot(&scratch, *new_snapshot);
+      ret = rmw_names_and_types_fini(&scratch);
+      if (RMW_RET_OK != ret) {
+        return ret;
+      }
+      {
+        std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+        state->snapshots[query_id] = new_snapshot;
+      }
+      snapshot = std::move(new_snapshot);
+    }
+    // Generations start at zero, so the token is offset by one to keep zero
+    // free as the start-of-pull sentinel.
+    *continuation = snapshot->generation + 1u;
+  }
+
+  // The chunk is built from the immutable snapshot with no lock held, like
+  // the full copy-out above, only bounded.
+  const size_t total = snapshot->entries.size();
+  const size_t count =
+    offset >= total ? 0u : (max_entries < total - offset ? max_entries : total - offset);
+  *more = offset + count < total;
+  return _fill_from_snapshot(*snapshot, offset, count, allocator, names_and_types);
+}
+
+rmw_ret_t
+cached_count_query(
+  const void * graph_key,
+  const char * query_id,
+  size_t * count,
+  const std::function<rmw_ret_t(size_t *)> & fresh_query)
+{
+  auto state = _state_for(graph_key);
+  uint64_t generation = state->generation.load(std::memory_order_acquire);
+  {
+    // Counts are two words; copying them out under the brief map mutex is
+    // cheaper than a shared_ptr round trip.
+    std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+    auto count_it = state->counts.find(query_id);
+    if (count_it != state->counts.end() &&
+      count_it->second.generation == generation)
+    {
+      *count = count_it->second.count;
+      return RMW_RET_OK;
+    }
+  }
+
+  rmw_ret_t ret = fresh_query(count);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  // Stamped with the pre-query generation for the same staleness rule as
+  // the names-and-types snapshots.
+  CountSnapshot snapshot;
+  snapshot.generation = generation;
+  snapshot.count = *count;
+  std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+  state->counts[query_id] = snapshot;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+cached_topic_endpoint_info_query(
+  const void * graph_key,
+  const char * query_id,
+  rcutils_allocator_t * allocator,
+  rmw_topic_endpoint_info_array_t * info_array,
+  const std::function<rmw_ret_t(rmw_topic_endpoint_info_array_t *)> & fresh_query)
+{
+  auto state = _state_for(graph_key);
+  uint64_t generation = state->generation.load(std::memory_order_acquire);
+  std::shared_ptr<const EndpointInfoSnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+    auto snapshot_it = state->endpoint_infos.find(query_id);
+    if (snapshot_it != state->endpoint_infos.end() &&
+      snapshot_it->second->generation == generation)
+    {
+      snapshot = snapshot_it->second;
+    }
+  }
+  if (snapshot) {
+    // Immutable once published; the copy-out runs with no lock held.
+    return _fill_endpoint_info_from_snapshot(*snapshot, allocator, info_array);
+  }
+
+  rmw_ret_t ret = fresh_query(info_array);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  // Stamped with the pre-query generation for the same staleness rule as
+  // the names-and-types snapshots.
+  auto new_snapshot = std::make_shared<EndpointInfoSnapshot>();
+  new_snapshot->generation = generation;
+  _capture_endpoint_info_snapshot(info_array, *new_snapshot);
+  std::lock_guard<std::mutex> lock(state->snapshots_mutex);
+  state->endpoint_infos[query_id] = std::move(new_snapshot);
+  return RMW_RET_OK;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
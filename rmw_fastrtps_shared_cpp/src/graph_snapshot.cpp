@@ -0,0 +1,437 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+#include "rmw/qos_profiles.h"
+
+#include "rmw_fastrtps_shared_cpp/graph_snapshot.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'R', 'M', 'W', 'G', 'S', 'N', 'P', '1'};
+constexpr uint64_t kDefaultMaxAgeSec = 60;
+
+struct SnapshotEndpoint
+{
+  std::string participant_key;
+  std::string topic_name;
+  std::string type_name;
+  rmw_qos_profile_t qos;
+};
+
+struct SnapshotState
+{
+  // All keys are the raw gid bytes, the same keying the change feed uses.
+  std::map<std::string, std::string> participants;  // gid -> enclave
+  std::map<std::string, SnapshotEndpoint> readers;
+  std::map<std::string, SnapshotEndpoint> writers;
+};
+
+std::mutex g_snapshot_mutex;
+std::map<const void *, SnapshotState> g_snapshots;
+
+std::string
+_gid_key(const rmw_gid_t & gid)
+{
+  return std::string(reinterpret_cast<const char *>(gid.data), RMW_GID_STORAGE_SIZE);
+}
+
+const char *
+_snapshot_file()
+{
+  const char * env_value;
+  const char * error_str;
+  error_str = rcutils_get_env("RMW_FASTRTPS_GRAPH_SNAPSHOT_FILE", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return nullptr;
+  }
+  if (env_value == nullptr || env_value[0] == '\0') {
+    return nullptr;
+  }
+  return env_value;
+}
+
+uint64_t
+_max_age_sec()
+{
+  const char * env_value;
+  const char * error_str;
+  error_str = rcutils_get_env("RMW_FASTRTPS_GRAPH_SNAPSHOT_MAX_AGE_SEC", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return kDefaultMaxAgeSec;
+  }
+  if (env_value == nullptr || env_value[0] == '\0') {
+    return kDefaultMaxAgeSec;
+  }
+  char * end = nullptr;
+  uint64_t age = strtoull(env_value, &end, 10);
+  if (end == env_value || *end != '\0') {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_GRAPH_SNAPSHOT_MAX_AGE_SEC is not a number of seconds, ignoring it");
+    return kDefaultMaxAgeSec;
+  }
+  return age;
+}
+
+uint64_t
+_now_sec()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void
+_write_u64(std::ofstream & out, uint64_t value)
+{
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void
+_write_string(std::ofstream & out, const std::string & value)
+{
+  _write_u64(out, value.size());
+  out.write(value.data(), value.size());
+}
+
+void
+_write_qos(std::ofstream & out, const rmw_qos_profile_t & qos)
+{
+  // Field by field; the struct has padding and enum widths that must not
+  // leak into the file format.
+  _write_u64(out, static_cast<uint64_t>(qos.history));
+  _write_u64(out, qos.depth);
+  _write_u64(out, static_cast<uint64_t>(qos.reliability));
+  _write_u64(out, static_cast<uint64_t>(qos.durability));
+  _write_u64(out, qos.deadline.sec);
+  _write_u64(out, qos.deadline.nsec);
+  _write_u64(out, qos.lifespan.sec);
+  _write_u64(out, qos.lifespan.nsec);
+  _write_u64(out, static_cast<uint64_t>(qos.liveliness));
+  _write_u64(out, qos.liveliness_lease_duration.sec);
+  _write_u64(out, qos.liveliness_lease_duration.nsec);
+  _write_u64(out, qos.avoid_ros_namespace_conventions ? 1u : 0u);
+}
+
+bool
+_read_u64(std::ifstream & in, uint64_t * value)
+{
+  in.read(reinterpret_cast<char *>(value), sizeof(*value));
+  return in.good();
+}
+
+bool
+_read_string(std::ifstream & in, std::string * value, uint64_t max_size = 1u << 20)
+{
+  uint64_t size = 0;
+  if (!_read_u64(in, &size) || size > max_size) {
+    return false;
+  }
+  value->resize(size);
+  in.read(&(*value)[0], size);
+  return in.good();
+}
+
+bool
+_read_qos(std::ifstream & in, rmw_qos_profile_t * qos)
+{
+  uint64_t v[12];
+  for (auto & field : v) {
+    if (!_read_u64(in, &field)) {
+      return false;
+    }
+  }
+  *qos = rmw_qos_profile_unknown;
+  qos->history = static_cast<rmw_qos_history_policy_t>(v[0]);
+  qos->depth = static_cast<size_t>(v[1]);
+  qos->reliability = static_cast<rmw_qos_reliability_policy_t>(v[2]);
+  qos->durability = static_cast<rmw_qos_durability_policy_t>(v[3]);
+  qos->deadline.sec = v[4];
+  qos->deadline.nsec = v[5];
+  qos->lifespan.sec = v[6];
+  qos->lifespan.nsec = v[7];
+  qos->liveliness = static_cast<rmw_qos_liveliness_policy_t>(v[8]);
+  qos->liveliness_lease_duration.sec = v[9];
+  qos->liveliness_lease_duration.nsec = v[10];
+  qos->avoid_ros_namespace_conventions = (0u != v[11]);
+  return true;
+}
+
+bool
+_read_gid(std::ifstream & in, const char * identifier, rmw_gid_t * gid)
+{
+  *gid = {};
+  gid->implementation_identifier = identifier;
+  in.read(reinterpret_cast<char *>(gid->data), RMW_GID_STORAGE_SIZE);
+  return in.good();
+}
+
+void
+_write_endpoints(
+  std::ofstream & out,
+  const std::map<std::string, SnapshotEndpoint> & endpoints)
+{
+  _write_u64(out, endpoints.size());
+  for (const auto & pair : endpoints) {
+    out.write(pair.first.data(), RMW_GID_STORAGE_SIZE);
+    out.write(pair.second.participant_key.data(), RMW_GID_STORAGE_SIZE);
+    _write_string(out, pair.second.topic_name);
+    _write_string(out, pair.second.type_name);
+    _write_qos(out, pair.second.qos);
+  }
+}
+
+bool
+_preload_endpoints(
+  std::ifstream & in,
+  const char * identifier,
+  rmw_dds_common::Context * common_context,
+  bool is_reader)
+{
+  uint64_t count = 0;
+  if (!_read_u64(in, &count)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    rmw_gid_t gid;
+    rmw_gid_t participant_gid;
+    SnapshotEndpoint endpoint;
+    if (!_read_gid(in, identifier, &gid) ||
+      !_read_gid(in, identifier, &participant_gid) ||
+      !_read_string(in, &endpoint.topic_name) ||
+      !_read_string(in, &endpoint.type_name) ||
+      !_read_qos(in, &endpoint.qos))
+    {
+      return false;
+    }
+    common_context->graph_cache.add_entity(
+      gid,
+      endpoint.topic_name,
+      endpoint.type_name,
+      participant_gid,
+      endpoint.qos,
+      is_reader);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool
+graph_snapshot_enabled()
+{
+  static const bool enabled = nullptr != _snapshot_file();
+  return enabled;
+}
+
+void
+graph_snapshot_record_participant(
+  const void * graph_key,
+  const rmw_gid_t & gid,
+  const std::string & enclave)
+{
+  if (!graph_snapshot_enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_snapshot_mutex);
+  g_snapshots[graph_key].participants[_gid_key(gid)] = enclave;
+}
+
+void
+graph_snapshot_remove_participant(
+  const void * graph_key,
+  const rmw_gid_t & gid)
+{
+  if (!graph_snapshot_enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_snapshot_mutex);
+  auto state_it = g_snapshots.find(graph_key);
+  if (state_it == g_snapshots.end()) {
+    return;
+  }
+  const std::string participant_key = _gid_key(gid);
+  state_it->second.participants.erase(participant_key);
+  // The participant never retracts its endpoints; drop them with it.
+  for (auto endpoints : {&state_it->second.readers, &state_it->second.writers}) {
+    for (auto it = endpoints->begin(); it != endpoints->end(); ) {
+      if (it->second.participant_key == participant_key) {
+        it = endpoints->erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+void
+graph_snapshot_record_endpoint(
+  const void * graph_key,
+  const rmw_gid_t & gid,
+  const rmw_gid_t & participant_gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rmw_qos_profile_t & qos,
+  bool is_reader)
+{
+  if (!graph_snapshot_enabled()) {
+    return;
+  }
+  SnapshotEndpoint endpoint;
+  endpoint.participant_key = _gid_key(participant_gid);
+  endpoint.topic_name = topic_name;
+  endpoint.type_name = type_name;
+  endpoint.qos = qos;
+  std::lock_guard<std::mutex> lock(g_snapshot_mutex);
+  auto & state = g_snapshots[graph_key];
+  auto & endpoints = is_reader ? state.readers : state.writers;
+  endpoints[_gid_key(gid)] = std::move(endpoint);
+}
+
+void
+graph_snapshot_remove_endpoint(
+  const void * graph_key,
+  const rmw_gid_t & gid,
+  bool is_reader)
+{
+  if (!graph_snapshot_enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_snapshot_mutex);
+  auto state_it = g_snapshots.find(graph_key);
+  if (state_it == g_snapshots.end()) {
+    return;
+  }
+  auto & endpoints = is_reader ? state_it->second.readers : state_it->second.writers;
+  endpoints.erase(_gid_key(gid));
+}
+
+void
+graph_snapshot_preload(
+  const char * identifier,
+  rmw_dds_common::Context * common_context)
+{
+  const char * path = _snapshot_file();
+  if (nullptr == path) {
+    return;
+  }
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return;
+  }
+  char magic[sizeof(kMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in.good() || 0 != memcmp(magic, kMagic, sizeof(kMagic))) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "graph snapshot file '%s' is not in the expected format, ignoring it", path);
+    return;
+  }
+  uint64_t saved_sec = 0;
+  if (!_read_u64(in, &saved_sec)) {
+    return;
+  }
+  const uint64_t now_sec = _now_sec();
+  if (now_sec < saved_sec || now_sec - saved_sec > _max_age_sec()) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "graph snapshot file '%s' is stale, ignoring it", path);
+    return;
+  }
+
+  uint64_t participant_count = 0;
+  if (!_read_u64(in, &participant_count)) {
+    return;
+  }
+  for (uint64_t i = 0; i < participant_count; ++i) {
+    rmw_gid_t gid;
+    std::string enclave;
+    if (!_read_gid(in, identifier, &gid) || !_read_string(in, &enclave)) {
+      return;
+    }
+    common_context->graph_cache.add_participant(gid, enclave);
+  }
+  if (!_preload_endpoints(in, identifier, common_context, true) ||
+    !_preload_endpoints(in, identifier, common_context, false))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "graph snapshot file '%s' ended early; the preloaded part stands and "
+      "discovery fills in the rest", path);
+  }
+}
+
+void
+graph_snapshot_save(const void * graph_key)
+{
+  const char * path = _snapshot_file();
+  if (nullptr == path) {
+    return;
+  }
+  SnapshotState state;
+  {
+    std::lock_guard<std::mutex> lock(g_snapshot_mutex);
+    auto state_it = g_snapshots.find(graph_key);
+    if (state_it == g_snapshots.end()) {
+      return;
+    }
+    state = state_it->second;
+  }
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "could not write graph snapshot file '%s'", path);
+    return;
+  }
+  out.write(kMagic, sizeof(kMagic));
+  _write_u64(out, _now_sec());
+  _write_u64(out, state.participants.size());
+  for (const auto & pair : state.participants) {
+    out.write(pair.first.data(), RMW_GID_STORAGE_SIZE);
+    _write_string(out, pair.second);
+  }
+  _write_endpoints(out, state.readers);
+  _write_endpoints(out, state.writers);
+}
+
+void
+graph_snapshot_forget(const void * graph_key)
+{
+  std::lock_guard<std::mutex> lock(g_snapshot_mutex);
+  g_snapshots.erase(graph_key);
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
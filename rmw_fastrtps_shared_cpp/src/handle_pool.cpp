@@ -0,0 +1,136 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "rcutils/allocator.h"
+
+#include "rmw_fastrtps_shared_cpp/middleware_allocator.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+// Size classes sized for what entity creation allocates: the rmw_*_t
+// handles and name copies land in the small classes, the Custom*Info and
+// listener blocks in the large ones. Requests beyond the last class go
+// straight to the allocator and come back with kFallbackClass.
+constexpr size_t kClassSizes[] = {64u, 256u, 1024u, 4096u};
+constexpr size_t kClassCount = sizeof(kClassSizes) / sizeof(kClassSizes[0]);
+constexpr uint32_t kFallbackClass = 0xffffffffu;
+
+// Slots per class; entity churn rarely has more handles in flight between
+// destroy and the next create than this, and overflow just frees.
+constexpr size_t kSlotsPerClass = 32u;
+
+// Keeps the user block aligned for any handle struct behind it.
+struct alignas(alignof(std::max_align_t)) Header
+{
+  uint32_t size_class;
+};
+
+std::atomic<void *> g_slots[kClassCount][kSlotsPerClass] = {};
+
+void *
+user_block(Header * header)
+{
+  return static_cast<void *>(header + 1);
+}
+
+Header *
+header_of(void * ptr)
+{
+  return static_cast<Header *>(ptr) - 1;
+}
+
+}  // namespace
+
+void *
+handle_pool_allocate(size_t size)
+{
+  for (size_t c = 0; c < kClassCount; ++c) {
+    if (size > kClassSizes[c]) {
+      continue;
+    }
+    for (size_t i = 0; i < kSlotsPerClass; ++i) {
+      void * recycled = g_slots[c][i].exchange(nullptr);
+      if (nullptr != recycled) {
+        // Blocks park zeroed-on-release would cost a pass per destroy even
+        // when never reused; zeroing on the way out keeps the cost on the
+        // path that needs the guarantee.
+        memset(recycled, 0, kClassSizes[c]);
+        return recycled;
+      }
+    }
+    const rcutils_allocator_t & allocator = middleware_allocator();
+    Header * header = static_cast<Header *>(
+      allocator.zero_allocate(1u, sizeof(Header) + kClassSizes[c], allocator.state));
+    if (nullptr == header) {
+      return nullptr;
+    }
+    header->size_class = static_cast<uint32_t>(c);
+    return user_block(header);
+  }
+
+  const rcutils_allocator_t & allocator = middleware_allocator();
+  Header * header = static_cast<Header *>(
+    allocator.zero_allocate(1u, sizeof(Header) + size, allocator.state));
+  if (nullptr == header) {
+    return nullptr;
+  }
+  header->size_class = kFallbackClass;
+  return user_block(header);
+}
+
+void
+handle_pool_release(void * ptr)
+{
+  if (nullptr == ptr) {
+    return;
+  }
+  Header * header = header_of(ptr);
+  const uint32_t size_class = header->size_class;
+  if (size_class < kClassCount) {
+    for (size_t i = 0; i < kSlotsPerClass; ++i) {
+      void * expected = nullptr;
+      if (g_slots[size_class][i].compare_exchange_strong(expected, ptr)) {
+        return;
+      }
+    }
+  }
+  const rcutils_allocator_t & allocator = middleware_allocator();
+  allocator.deallocate(header, allocator.state);
+}
+
+char *
+handle_pool_copy_string(const char * str)
+{
+  if (nullptr == str) {
+    return nullptr;
+  }
+  const size_t length = strlen(str) + 1u;
+  char * copy = static_cast<char *>(handle_pool_allocate(length));
+  if (nullptr != copy) {
+    memcpy(copy, str, length);
+  }
+  return copy;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
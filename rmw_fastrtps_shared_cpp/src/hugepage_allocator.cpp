@@ -0,0 +1,125 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/hugepage_allocator.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif  // __linux__
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+// The common hugetlb size; a pool configured for 1 GB pages still accepts
+// mappings rounded to this, the kernel rounds further itself.
+constexpr size_t kHugePageSize = 2u * 1024u * 1024u;
+
+bool
+__requested_hugepages()
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_HUGEPAGES", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return false;
+  }
+  if (0 == strcmp(env_value, "1")) {
+    return true;
+  }
+  if (0 != strcmp(env_value, "0")) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_HUGEPAGES is neither 0 nor 1, ignoring it");
+  }
+  return false;
+}
+
+}  // namespace
+
+bool
+hugepages_enabled()
+{
+  static const bool enabled = __requested_hugepages();
+  return enabled;
+}
+
+void *
+hugepage_allocate(size_t size)
+{
+#ifdef __linux__
+  if (hugepages_enabled() && size >= kHugePageSize) {
+    const size_t rounded = (size + kHugePageSize - 1u) & ~(kHugePageSize - 1u);
+    void * memory = mmap(
+      nullptr, rounded, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (MAP_FAILED != memory) {
+      return memory;
+    }
+    // Exhausted or unconfigured hugetlb pool. A normal mapping advised
+    // towards transparent huge pages keeps most of the TLB win; warned
+    // once so an undersized nr_hugepages shows up in the logs.
+    static std::atomic_bool warned{false};
+    if (!warned.exchange(true, std::memory_order_relaxed)) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "hugetlb allocation failed, falling back to transparent huge pages;"
+        " check vm.nr_hugepages");
+    }
+    memory = mmap(
+      nullptr, rounded, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == memory) {
+      return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(memory, rounded, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+    return memory;
+  }
+#endif  // __linux__
+  return malloc(size);
+}
+
+void
+hugepage_deallocate(void * ptr, size_t size)
+{
+  if (nullptr == ptr) {
+    return;
+  }
+#ifdef __linux__
+  // Mirrors the branch taken in hugepage_allocate: enabled is latched for
+  // the process lifetime, so size alone identifies the mapping kind.
+  if (hugepages_enabled() && size >= kHugePageSize) {
+    const size_t rounded = (size + kHugePageSize - 1u) & ~(kHugePageSize - 1u);
+    munmap(ptr, rounded);
+    return;
+  }
+#endif  // __linux__
+  free(ptr);
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
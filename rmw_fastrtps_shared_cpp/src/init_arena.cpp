@@ -0,0 +1,99 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/init_arena.hpp"
+
+#include <cstring>
+
+#include "rcutils/allocator.h"
+
+#include "rmw_fastrtps_shared_cpp/middleware_allocator.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+// Large enough that a typical init phase fits in one chunk; oversize
+// requests get a chunk of their own instead of growing this.
+constexpr size_t kChunkPayload = 4096u;
+
+}  // namespace
+
+// The payload follows the header; the alignas keeps it aligned for any
+// type, and allocate() rounds sizes up to preserve that for later bumps.
+struct alignas(alignof(std::max_align_t)) InitArena::Chunk
+{
+  Chunk * next;
+  size_t capacity;
+  size_t used;
+};
+
+InitArena::~InitArena()
+{
+  const rcutils_allocator_t & allocator = middleware_allocator();
+  Chunk * chunk = head_;
+  while (nullptr != chunk) {
+    Chunk * next = chunk->next;
+    allocator.deallocate(chunk, allocator.state);
+    chunk = next;
+  }
+}
+
+void *
+InitArena::allocate(size_t size)
+{
+  const size_t alignment = alignof(std::max_align_t);
+  size = (size + alignment - 1u) / alignment * alignment;
+  if (nullptr == head_ || head_->used + size > head_->capacity) {
+    const size_t capacity = size > kChunkPayload ? size : kChunkPayload;
+    const rcutils_allocator_t & allocator = middleware_allocator();
+    Chunk * chunk = static_cast<Chunk *>(
+      allocator.allocate(sizeof(Chunk) + capacity, allocator.state));
+    if (nullptr == chunk) {
+      return nullptr;
+    }
+    chunk->next = head_;
+    chunk->capacity = capacity;
+    chunk->used = 0u;
+    head_ = chunk;
+  }
+  char * payload = reinterpret_cast<char *>(head_ + 1);
+  void * block = payload + head_->used;
+  head_->used += size;
+  return block;
+}
+
+char *
+InitArena::copy_string(const char * str)
+{
+  if (nullptr == str) {
+    return nullptr;
+  }
+  return copy_string(str, strlen(str));
+}
+
+char *
+InitArena::copy_string(const char * str, size_t length)
+{
+  char * copy = static_cast<char *>(allocate(length + 1u));
+  if (nullptr != copy) {
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+  }
+  return copy;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
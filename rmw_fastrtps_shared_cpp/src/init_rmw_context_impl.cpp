@@ -22,7 +22,12 @@
 #include "rmw_dds_common/context.hpp"
 #include "rmw_dds_common/msg/participant_entities_info.hpp"
 
+#include "rmw_fastrtps_shared_cpp/client_endpoint_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_change_feed.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_snapshot.hpp"
 #include "rmw_fastrtps_shared_cpp/participant.hpp"
 #include "rmw_fastrtps_shared_cpp/publisher.hpp"
 #include "rmw_fastrtps_shared_cpp/subscription.hpp"
@@ -52,12 +57,29 @@ rmw_fastrtps_shared_cpp::decrement_context_impl_ref_count(rmw_context_t * contex
     auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
     auto participant_info = static_cast<CustomParticipantInfo *>(context->impl->participant_info);
 
+    // Persist what discovery gathered while the journal is still complete;
+    // a restart preloads it instead of waiting for discovery to replay.
+    rmw_fastrtps_shared_cpp::graph_snapshot_save(common_context);
+
     if (!common_context->graph_cache.remove_participant(common_context->gid)) {
       RMW_SAFE_FWRITE_TO_STDERR(
         RCUTILS_STRINGIFY(__function__) ":" RCUTILS_STRINGIFY(__line__) ": "
         "couldn't remove Participant gid from graph_cache when destroying Participant");
     }
 
+    // Parked client endpoints must go before the participant does.
+    rmw_fastrtps_shared_cpp::client_endpoint_pool_drain(common_context);
+
+    // Flush any coalesced announcement while the graph publisher still exists.
+    if (RMW_RET_OK != rmw_fastrtps_shared_cpp::graph_announce_fini(
+        context->implementation_identifier, common_context))
+    {
+      RMW_SAFE_FWRITE_TO_STDERR(
+        RCUTILS_STRINGIFY(__function__) ":" RCUTILS_STRINGIFY(__LINE__)
+        ": 'graph_announce_fini' failed\n");
+      rmw_reset_error();
+    }
+
     ret = rmw_fastrtps_shared_cpp::destroy_subscription(
       context->implementation_identifier,
       participant_info,
@@ -80,7 +102,7 @@ rmw_fastrtps_shared_cpp::decrement_context_impl_ref_count(rmw_context_t * contex
       error_string = rmw_get_error_string();
       rmw_reset_error();
     }
-    err = rmw_fastrtps_shared_cpp::destroy_participant(participant_info);
+    err = rmw_fastrtps_shared_cpp::destroy_participant(participant_info, common_context);
     if (RMW_RET_OK != ret && RMW_RET_OK != err) {
       RMW_SAFE_FWRITE_TO_STDERR(
         RCUTILS_STRINGIFY(__function__) ":" RCUTILS_STRINGIFY(__LINE__)
@@ -91,6 +113,9 @@ rmw_fastrtps_shared_cpp::decrement_context_impl_ref_count(rmw_context_t * contex
     }
 
     common_context->graph_cache.clear_on_change_callback();
+    rmw_fastrtps_shared_cpp::graph_query_cache_forget(common_context);
+    rmw_fastrtps_shared_cpp::graph_change_feed_forget(common_context);
+    rmw_fastrtps_shared_cpp::graph_snapshot_forget(common_context);
     if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_destroy_guard_condition(
         common_context->graph_guard_condition))
     {
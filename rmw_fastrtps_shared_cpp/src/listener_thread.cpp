@@ -12,11 +12,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
 #include "rcutils/macros.h"
 
 #include "rmw/allocators.h"
@@ -31,6 +45,10 @@
 #include "rmw_dds_common/gid_utils.hpp"
 #include "rmw_dds_common/msg/participant_entities_info.hpp"
 
+#include "rmw_fastrtps_shared_cpp/cdr_field_cursor.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_change_feed.hpp"
 #include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
@@ -41,9 +59,427 @@ static
 void
 node_listener(rmw_context_t * context);
 
+static
+void
+shared_node_listener(rmw_context_t * creator);
+
+static
+void
+__configure_listener_thread(std::thread & thread);
+
+/// Drop this process' own announcements before they are ever deserialized.
+/**
+ * The gid is the leading field of ParticipantEntitiesInfo - a fixed byte
+ * array right behind the encapsulation header - so the filter compares
+ * just those bytes of the raw payload and the sample is consumed from the
+ * history without decoding the node list behind them. The gid check in
+ * the drain loop stays as the fallback should installing the filter fail.
+ */
+static
+void
+__install_local_announcement_filter(rmw_context_t * context)
+{
+  auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
+  std::array<uint8_t, RMW_GID_STORAGE_SIZE> local_gid;
+  std::memcpy(local_gid.data(), common_context->gid.data, RMW_GID_STORAGE_SIZE);
+  if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_subscription_set_content_filter(
+      context->implementation_identifier,
+      common_context->sub,
+      [local_gid](const uint8_t * buffer, uint32_t length) -> bool {
+        rmw_fastrtps_shared_cpp::CdrFieldCursor cursor(buffer, length);
+        for (uint8_t local_byte : local_gid) {
+          uint8_t byte = 0;
+          if (!cursor.read_uint8(&byte) || byte != local_byte) {
+            // Someone else's announcement, or a payload too short to hold a
+            // gid that the normal take path should report: keep it.
+            return true;
+          }
+        }
+        return false;
+      }))
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "failed to install the local announcement filter; "
+      "own graph updates will be dropped after deserialization instead");
+    rmw_reset_error();
+  }
+}
+
+/// Drain every queued announcement into the context's graph cache.
+/**
+ * Discovery messages arrive in bursts when many participants (re)start at
+ * once; everything already available is consumed in one pass instead of
+ * paying one wait set round trip per message. Returns false when a take
+ * failed.
+ */
+static
+bool
+__drain_graph_subscription(rmw_context_t * context)
+{
+  auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
+  // The message object is constructed once and reused across iterations.
+  rmw_dds_common::msg::ParticipantEntitiesInfo msg;
+  bool taken = true;
+  while (taken) {
+    if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_take(
+        context->implementation_identifier,
+        common_context->sub,
+        static_cast<void *>(&msg),
+        &taken,
+        nullptr))
+    {
+      return false;
+    }
+    if (!taken) {
+      break;
+    }
+    if (std::memcmp(
+        reinterpret_cast<char *>(common_context->gid.data),
+        reinterpret_cast<char *>(&msg.gid.data),
+        RMW_GID_STORAGE_SIZE) == 0)
+    {
+      // Ignore local messages; normally the content filter already
+      // dropped them, this is the fallback for when it is not installed.
+      continue;
+    }
+    common_context->graph_cache.update_participant_entities(msg);
+
+    // Announcements replace the participant's node list wholesale; the
+    // feed diffs them into added/removed deltas for its subscribers.
+    std::vector<std::pair<std::string, std::string>> nodes;
+    nodes.reserve(msg.node_entities_info_seq.size());
+    for (const auto & node_info : msg.node_entities_info_seq) {
+      nodes.emplace_back(node_info.node_name, node_info.node_namespace);
+    }
+    rmw_fastrtps_shared_cpp::graph_change_feed_update_nodes(
+      common_context,
+      std::string(
+        reinterpret_cast<const char *>(&msg.gid.data), RMW_GID_STORAGE_SIZE),
+      nodes);
+  }
+  return true;
+}
+
+/// One listener thread for every context in the process.
+/**
+ * Registered contexts hand their graph subscription to a single thread
+ * that demultiplexes wakeups to the right graph cache, so a process with
+ * dozens of contexts carries one near-idle thread instead of one each.
+ * The registry generation plus acked_generation handshake guarantees a
+ * deregistering context returns only once the thread works on a snapshot
+ * that no longer includes it; the subscription itself is scrubbed from
+ * the thread's wait set later by waitset_forget_entity when destroyed.
+ */
+struct SharedListenerState
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<rmw_context_t *> contexts;
+  rmw_guard_condition_t * gc{nullptr};
+  std::thread thread;
+  bool running{false};
+  // Set while a last-context deregistration joins the thread and destroys
+  // the guard condition outside the lock; registrations wait it out so
+  // they never touch state.thread or state.gc mid-teardown.
+  bool tearing_down{false};
+  uint64_t generation{0};
+  uint64_t acked_generation{0};
+};
+
+static
+SharedListenerState &
+__shared_listener_state()
+{
+  static SharedListenerState state;
+  return state;
+}
+
+/// Whether all contexts share one process-wide listener thread.
+static
+bool
+__shared_listener_enabled()
+{
+  static const bool enabled = []() {
+      const char * env_value;
+      const char * error_str;
+      error_str = rcutils_get_env("RMW_FASTRTPS_SHARED_LISTENER_THREAD", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return false;
+      }
+      return env_value != nullptr && strcmp(env_value, "1") == 0;
+    }();
+  return enabled;
+}
+
+static
 rmw_ret_t
-rmw_fastrtps_shared_cpp::run_listener_thread(rmw_context_t * context)
+__register_with_shared_listener(rmw_context_t * context)
 {
+  auto & state = __shared_listener_state();
+  auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
+
+  // Installed before the thread can see the subscription, so even the first
+  // wakeup skips this process' own announcements.
+  __install_local_announcement_filter(context);
+
+  std::unique_lock<std::mutex> lock(state.mutex);
+  // A concurrent last-context teardown joins the thread and destroys the
+  // guard condition outside the lock; reusing state.thread or state.gc
+  // before it finishes would join the same std::thread from two threads
+  // and hand this incarnation a guard condition about to be destroyed.
+  state.cv.wait(lock, [&state]() {return !state.tearing_down;});
+  if (!state.running) {
+    if (state.thread.joinable()) {
+      // A previous incarnation exited on error; collect it before reuse.
+      state.thread.join();
+    }
+    if (nullptr == state.gc) {
+      state.gc = rmw_fastrtps_shared_cpp::__rmw_create_guard_condition(
+        context->implementation_identifier);
+      if (nullptr == state.gc) {
+        RMW_SET_ERROR_MSG("Failed to create shared listener guard condition");
+        return RMW_RET_ERROR;
+      }
+    }
+    state.running = true;
+    try {
+      state.thread = std::thread(shared_node_listener, context);
+      __configure_listener_thread(state.thread);
+    } catch (const std::exception & exc) {
+      state.running = false;
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to create std::thread: %s", exc.what());
+      return RMW_RET_ERROR;
+    } catch (...) {
+      state.running = false;
+      RMW_SET_ERROR_MSG("Failed to create std::thread");
+      return RMW_RET_ERROR;
+    }
+  }
+  common_context->thread_is_running.store(true);
+  // Existing wakeup sites (async graph, join) trigger through this pointer;
+  // in shared mode they all reach the one shared guard condition.
+  common_context->listener_thread_gc = state.gc;
+  state.contexts.push_back(context);
+  ++state.generation;
+  // Wake the thread so a wait already in flight picks the new composition
+  // up. Triggered under the lock: a concurrent last-context teardown could
+  // otherwise destroy the guard condition between unlock and trigger.
+  if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
+      context->implementation_identifier, state.gc))
+  {
+    rmw_reset_error();
+  }
+  return RMW_RET_OK;
+}
+
+static
+rmw_ret_t
+__deregister_from_shared_listener(rmw_context_t * context)
+{
+  auto & state = __shared_listener_state();
+  auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
+
+  std::unique_lock<std::mutex> lock(state.mutex);
+  for (auto it = state.contexts.begin(); it != state.contexts.end(); ++it) {
+    if (*it == context) {
+      state.contexts.erase(it);
+      break;
+    }
+  }
+  common_context->thread_is_running.store(false);
+  ++state.generation;
+  const uint64_t target = state.generation;
+  const bool last = state.contexts.empty();
+  if (last) {
+    state.running = false;
+    state.tearing_down = true;
+  }
+  // Triggered under the lock, like registration, so the guard condition
+  // cannot be destroyed by a racing teardown before the trigger lands.
+  if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
+      context->implementation_identifier, state.gc))
+  {
+    rmw_reset_error();
+  }
+  if (last) {
+    lock.unlock();
+    if (state.thread.joinable()) {
+      try {
+        state.thread.join();
+      } catch (const std::exception & exc) {
+        RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to join std::thread: %s", exc.what());
+        // Lift the barrier even on failure; a registration parked on it
+        // would otherwise never wake.
+        lock.lock();
+        state.tearing_down = false;
+        state.cv.notify_all();
+        return RMW_RET_ERROR;
+      }
+    }
+    lock.lock();
+    rmw_guard_condition_t * gc = state.gc;
+    state.gc = nullptr;
+    state.tearing_down = false;
+    // Registrations held back by the barrier resume against a clean slate:
+    // thread collected, guard condition slot empty.
+    state.cv.notify_all();
+    lock.unlock();
+    common_context->listener_thread_gc = nullptr;
+    return rmw_fastrtps_shared_cpp::__rmw_destroy_guard_condition(gc);
+  }
+  // Until the thread has taken a snapshot without this context, it may
+  // still drain the context's subscription; returning earlier would let
+  // the caller destroy it under the thread.
+  state.cv.wait(
+    lock, [&state, target]() {
+      return state.acked_generation >= target || !state.running;
+    });
+  lock.unlock();
+  common_context->listener_thread_gc = nullptr;
+  return RMW_RET_OK;
+}
+
+/// Name, pin and (re)schedule the discovery listener thread.
+/**
+ * The thread only drains discovery traffic, yet by default it competes with
+ * every other thread: on RT systems it can preempt control threads, on large
+ * machines it bounces across sockets. Configured like the other runtime
+ * knobs, through environment variables:
+ *   RMW_FASTRTPS_LISTENER_THREAD_SCHED=fifo|rr|other
+ *   RMW_FASTRTPS_LISTENER_THREAD_PRIORITY=<int> (implies fifo if no sched)
+ *   RMW_FASTRTPS_LISTENER_THREAD_CPUS=<cpu>[,<cpu>...]
+ * Failures (typically missing privileges) are logged and ignored; the thread
+ * then runs with default attributes as before.
+ */
+static
+void
+__configure_listener_thread(std::thread & thread)
+{
+#if defined(__linux__)
+  pthread_t handle = thread.native_handle();
+  // Shows up in top/ps; limited to 15 characters by the kernel.
+  pthread_setname_np(handle, "rmw_discovery");
+
+  const char * env_value;
+  const char * error_str;
+
+  int policy = -1;
+  error_str = rcutils_get_env("RMW_FASTRTPS_LISTENER_THREAD_SCHED", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+  } else if (env_value != nullptr && env_value[0] != '\0') {
+    if (0 == strcmp(env_value, "fifo")) {
+      policy = SCHED_FIFO;
+    } else if (0 == strcmp(env_value, "rr")) {
+      policy = SCHED_RR;
+    } else if (0 == strcmp(env_value, "other")) {
+      policy = SCHED_OTHER;
+    } else {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "RMW_FASTRTPS_LISTENER_THREAD_SCHED is not fifo, rr or other, ignoring it");
+    }
+  }
+
+  long priority = -1;  // NOLINT(runtime/int)
+  error_str = rcutils_get_env("RMW_FASTRTPS_LISTENER_THREAD_PRIORITY", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+  } else if (env_value != nullptr && env_value[0] != '\0') {
+    char * end = nullptr;
+    priority = strtol(env_value, &end, 10);
+    if (end == env_value || *end != '\0') {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "RMW_FASTRTPS_LISTENER_THREAD_PRIORITY is not a number, ignoring it");
+      priority = -1;
+    } else if (-1 == policy) {
+      // A priority alone only makes sense with a real-time class.
+      policy = SCHED_FIFO;
+    }
+  }
+
+  if (-1 != policy) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = (SCHED_OTHER == policy || priority < 0) ?
+      0 : static_cast<int>(priority);
+    if (0 != pthread_setschedparam(handle, policy, &param)) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "could not set scheduling of the discovery listener thread "
+        "(missing privileges?), leaving defaults");
+    }
+  }
+
+  error_str = rcutils_get_env("RMW_FASTRTPS_LISTENER_THREAD_CPUS", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+  } else if (env_value != nullptr && env_value[0] != '\0') {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    bool valid = false;
+    const char * cursor = env_value;
+    while (*cursor != '\0') {
+      char * end = nullptr;
+      unsigned long cpu = strtoul(cursor, &end, 10);  // NOLINT(runtime/int)
+      if (end == cursor || (*end != '\0' && *end != ',') || cpu >= CPU_SETSIZE) {
+        valid = false;
+        break;
+      }
+      CPU_SET(cpu, &cpus);
+      valid = true;
+      cursor = (*end == ',') ? end + 1 : end;
+    }
+    if (!valid) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "RMW_FASTRTPS_LISTENER_THREAD_CPUS is not a comma separated cpu list, "
+        "ignoring it");
+    } else if (0 != pthread_setaffinity_np(handle, sizeof(cpus), &cpus)) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "could not set affinity of the discovery listener thread, "
+        "leaving defaults");
+    }
+  }
+#else
+  (void)thread;
+#endif  // defined(__linux__)
+}
+
+/// Whether the listener thread start is deferred to the first graph use.
+static
+bool
+__lazy_listener_thread_enabled()
+{
+  static const bool enabled = []() {
+      const char * env_value;
+      const char * error_str;
+      error_str = rcutils_get_env("RMW_FASTRTPS_LAZY_GRAPH", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return false;
+      }
+      return env_value != nullptr && strcmp(env_value, "1") == 0;
+    }();
+  return enabled;
+}
+
+static
+rmw_ret_t
+__start_listener_thread(rmw_context_t * context)
+{
+  if (__shared_listener_enabled()) {
+    return __register_with_shared_listener(context);
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
   common_context->thread_is_running.store(true);
   common_context->listener_thread_gc = rmw_fastrtps_shared_cpp::__rmw_create_guard_condition(
@@ -51,6 +487,7 @@ rmw_fastrtps_shared_cpp::run_listener_thread(rmw_context_t * context)
   if (common_context->listener_thread_gc) {
     try {
       common_context->listener_thread = std::thread(node_listener, context);
+      __configure_listener_thread(common_context->listener_thread);
       return RMW_RET_OK;
     } catch (const std::exception & exc) {
       RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("Failed to create std::thread: %s", exc.what());
@@ -73,9 +510,49 @@ rmw_fastrtps_shared_cpp::run_listener_thread(rmw_context_t * context)
   return RMW_RET_ERROR;
 }
 
+rmw_ret_t
+rmw_fastrtps_shared_cpp::run_listener_thread(rmw_context_t * context)
+{
+  if (__lazy_listener_thread_enabled()) {
+    // Discovery announcements keep accumulating in the reader history (the
+    // graph subscription is reliable and transient local); the first graph
+    // use starts the thread, which then drains the backlog in one burst.
+    context->impl->listener_thread_deferred.store(true, std::memory_order_relaxed);
+    return RMW_RET_OK;
+  }
+  return __start_listener_thread(context);
+}
+
+rmw_ret_t
+rmw_fastrtps_shared_cpp::ensure_listener_thread(rmw_context_t * context)
+{
+  if (!context->impl->listener_thread_deferred.load(std::memory_order_relaxed)) {
+    return RMW_RET_OK;
+  }
+  // Same mutex the init/fini paths hold around run/join, so a start races
+  // neither a concurrent first query nor context destruction.
+  std::lock_guard<std::mutex> guard(context->impl->mutex);
+  if (!context->impl->listener_thread_deferred.load(std::memory_order_relaxed)) {
+    return RMW_RET_OK;
+  }
+  rmw_ret_t ret = __start_listener_thread(context);
+  if (RMW_RET_OK == ret) {
+    context->impl->listener_thread_deferred.store(false, std::memory_order_relaxed);
+  }
+  return ret;
+}
+
 rmw_ret_t
 rmw_fastrtps_shared_cpp::join_listener_thread(rmw_context_t * context)
 {
+  if (context->impl->listener_thread_deferred.exchange(false)) {
+    // The deferred start never happened: there is no thread to wake and no
+    // guard condition was created.
+    return RMW_RET_OK;
+  }
+  if (__shared_listener_enabled()) {
+    return __deregister_from_shared_listener(context);
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
   common_context->thread_is_running.exchange(false);
   rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
@@ -116,7 +593,29 @@ node_listener(rmw_context_t * context)
   assert(nullptr != context->impl);
   assert(nullptr != context->impl->common);
   auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
+  // The wait set is reused across iterations; recreating it per received
+  // discovery message would construct and destroy a condition variable and
+  // mutex every time.
+  // number of conditions of a subscription is 2
+  rmw_wait_set_t * wait_set = rmw_fastrtps_shared_cpp::__rmw_create_wait_set(
+    context->implementation_identifier, context, 2);
+  if (nullptr == wait_set) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(
+      RCUTILS_STRINGIFY(__FILE__) ":" RCUTILS_STRINGIFY(__function__) ":"
+      RCUTILS_STRINGIFY(__LINE__) "failed to create wait set"
+      ": ros discovery info listener thread will shutdown ...\n");
+    return;
+  }
+  __install_local_announcement_filter(context);
+  auto participant_info =
+    static_cast<CustomParticipantInfo *>(context->impl->participant_info);
   while (common_context->thread_is_running.load()) {
+    // Fold in graph updates the discovery threads deferred (see
+    // RMW_FASTRTPS_ASYNC_GRAPH); the first pass also drains anything queued
+    // before this thread started. A no-op in the default synchronous mode.
+    if (participant_info && participant_info->listener) {
+      participant_info->listener->process_queued_discovery();
+    }
     assert(nullptr != common_context->sub);
     assert(nullptr != common_context->sub->data);
     void * subscriptions_buffer[] = {common_context->sub->data};
@@ -127,12 +626,6 @@ node_listener(rmw_context_t * context)
     subscriptions.subscribers = subscriptions_buffer;
     guard_conditions.guard_condition_count = 1;
     guard_conditions.guard_conditions = guard_conditions_buffer;
-    // number of conditions of a subscription is 2
-    rmw_wait_set_t * wait_set = rmw_fastrtps_shared_cpp::__rmw_create_wait_set(
-      context->implementation_identifier, context, 2);
-    if (nullptr == wait_set) {
-      TERMINATE_THREAD("failed to create wait set");
-    }
     if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_wait(
         &subscriptions,
         &guard_conditions,
@@ -145,33 +638,123 @@ node_listener(rmw_context_t * context)
       TERMINATE_THREAD("rmw_wait failed");
     }
     if (subscriptions_buffer[0]) {
-      rmw_dds_common::msg::ParticipantEntitiesInfo msg;
-      bool taken;
-      if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_take(
-          context->implementation_identifier,
-          common_context->sub,
-          static_cast<void *>(&msg),
-          &taken,
-          nullptr))
-      {
+      if (!__drain_graph_subscription(context)) {
         TERMINATE_THREAD("__rmw_take failed");
       }
-      if (taken) {
-        if (std::memcmp(
-            reinterpret_cast<char *>(common_context->gid.data),
-            reinterpret_cast<char *>(&msg.gid.data),
-            RMW_GID_STORAGE_SIZE) == 0)
-        {
-          // ignore local messages
-          continue;
-        }
-        common_context->graph_cache.update_participant_entities(msg);
+    }
+  }
+  if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_destroy_wait_set(
+      context->implementation_identifier, wait_set))
+  {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(
+      RCUTILS_STRINGIFY(__FILE__) ":" RCUTILS_STRINGIFY(__function__) ":"
+      RCUTILS_STRINGIFY(__LINE__) "failed to destroy wait set"
+      ": ros discovery info listener thread will shutdown ...\n");
+  }
+}
+
+void
+shared_node_listener(rmw_context_t * creator)
+{
+  assert(nullptr != creator);
+  auto & state = __shared_listener_state();
+  // The creator is only guaranteed alive until its own deregistration; the
+  // identifier points at the implementation's static string and is kept for
+  // the calls made after the creator may be gone.
+  const char * identifier = creator->implementation_identifier;
+  // The wait set carries no reference to its creating context after this
+  // call, so it may outlive the creator as contexts come and go.
+  rmw_wait_set_t * wait_set = rmw_fastrtps_shared_cpp::__rmw_create_wait_set(
+    identifier, creator, 8);
+  if (nullptr == wait_set) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(
+      RCUTILS_STRINGIFY(__FILE__) ":" RCUTILS_STRINGIFY(__function__) ":"
+      RCUTILS_STRINGIFY(__LINE__) "failed to create wait set"
+      ": shared discovery listener thread will shutdown ...\n");
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.running = false;
+    state.acked_generation = state.generation;
+    state.cv.notify_all();
+    return;
+  }
+
+  std::vector<rmw_context_t *> contexts;
+  std::vector<void *> subscriptions_buffer;
+  bool failed = false;
+  while (!failed) {
+    uint64_t observed;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (!state.running) {
+        break;
+      }
+      contexts = state.contexts;
+      observed = state.generation;
+      // Acknowledged at the snapshot, not after the wait: from here on the
+      // thread only touches snapshot members, so a deregistered context is
+      // free to go as soon as a snapshot excludes it.
+      state.acked_generation = observed;
+    }
+    state.cv.notify_all();
+
+    subscriptions_buffer.clear();
+    for (rmw_context_t * context : contexts) {
+      auto participant_info =
+        static_cast<CustomParticipantInfo *>(context->impl->participant_info);
+      if (participant_info && participant_info->listener) {
+        participant_info->listener->process_queued_discovery();
       }
+      auto common_context = static_cast<rmw_dds_common::Context *>(context->impl->common);
+      subscriptions_buffer.push_back(common_context->sub->data);
     }
-    if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_destroy_wait_set(
-        context->implementation_identifier, wait_set))
+    void * guard_conditions_buffer[] = {state.gc->data};
+    rmw_subscriptions_t subscriptions;
+    rmw_guard_conditions_t guard_conditions;
+    subscriptions.subscriber_count = subscriptions_buffer.size();
+    subscriptions.subscribers = subscriptions_buffer.data();
+    guard_conditions.guard_condition_count = 1;
+    guard_conditions.guard_conditions = guard_conditions_buffer;
+    if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_wait(
+        &subscriptions,
+        &guard_conditions,
+        nullptr,
+        nullptr,
+        nullptr,
+        wait_set,
+        nullptr))
     {
-      TERMINATE_THREAD("failed to destroy wait set");
+      RCUTILS_SAFE_FWRITE_TO_STDERR(
+        RCUTILS_STRINGIFY(__FILE__) ":" RCUTILS_STRINGIFY(__function__) ":"
+        RCUTILS_STRINGIFY(__LINE__) "rmw_wait failed"
+        ": shared discovery listener thread will shutdown ...\n");
+      failed = true;
+      break;
     }
+    for (size_t i = 0; i < contexts.size(); ++i) {
+      if (subscriptions_buffer[i] && !__drain_graph_subscription(contexts[i])) {
+        RCUTILS_SAFE_FWRITE_TO_STDERR(
+          RCUTILS_STRINGIFY(__FILE__) ":" RCUTILS_STRINGIFY(__function__) ":"
+          RCUTILS_STRINGIFY(__LINE__) "__rmw_take failed"
+          ": shared discovery listener thread will shutdown ...\n");
+        failed = true;
+        break;
+      }
+    }
+  }
+  if (RMW_RET_OK != rmw_fastrtps_shared_cpp::__rmw_destroy_wait_set(
+      identifier, wait_set))
+  {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(
+      RCUTILS_STRINGIFY(__FILE__) ":" RCUTILS_STRINGIFY(__function__) ":"
+      RCUTILS_STRINGIFY(__LINE__) "failed to destroy wait set"
+      ": shared discovery listener thread will shutdown ...\n");
+  }
+  if (failed) {
+    // Release deregistering contexts that would otherwise wait for an
+    // acknowledgement this thread can no longer provide.
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.running = false;
+    state.acked_generation = state.generation;
+    state.cv.notify_all();
   }
 }
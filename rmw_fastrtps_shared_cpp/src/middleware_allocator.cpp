@@ -0,0 +1,46 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/middleware_allocator.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+rcutils_allocator_t &
+_allocator_storage()
+{
+  static rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  return allocator;
+}
+
+}  // namespace
+
+void
+set_middleware_allocator(const rcutils_allocator_t & allocator)
+{
+  // Plain assignment on purpose: the contract is install-before-use, so
+  // there is nothing to synchronize against and readers stay free.
+  _allocator_storage() = allocator;
+}
+
+const rcutils_allocator_t &
+middleware_allocator()
+{
+  return _allocator_storage();
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -27,11 +27,51 @@ const std::vector<std::string> _ros_prefixes =
 {ros_topic_prefix, ros_service_requester_prefix, ros_service_response_prefix};
 }  // extern "C"
 
+namespace
+{
+
+// Every ROS prefix is exactly two characters.
+constexpr size_t kRosPrefixLength = 2u;
+
+/// Match `name` against the fixed ROS prefix set with a character dispatch.
+/**
+ * All prefixes are two characters starting with 'r' and must be followed by
+ * '/', so deciding membership is three character comparisons on the name
+ * itself — no per-prefix loop and no temporary strings. These functions run
+ * for every entry of every graph query, so the matcher stays allocation-free.
+ *
+ * \return the matched prefix constant, or nullptr if `name` has none.
+ */
+const char *
+_match_ros_prefix(const std::string & name)
+{
+  if (name.length() <= kRosPrefixLength ||
+    name[0] != 'r' || name[kRosPrefixLength] != '/')
+  {
+    return nullptr;
+  }
+  switch (name[1]) {
+    case 't':
+      return ros_topic_prefix;
+    case 'q':
+      return ros_service_requester_prefix;
+    case 'r':
+      return ros_service_response_prefix;
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
 /// Returns `name` stripped of `prefix`.
 std::string
 _resolve_prefix(const std::string & name, const std::string & prefix)
 {
-  if (name.rfind(prefix, 0) == 0 && name.at(prefix.length()) == '/') {
+  if (name.length() > prefix.length() &&
+    name.compare(0, prefix.length(), prefix) == 0 &&
+    name[prefix.length()] == '/')
+  {
     return name.substr(prefix.length());
   }
   return "";
@@ -41,10 +81,9 @@ _resolve_prefix(const std::string & name, const std::string & prefix)
 std::string
 _get_ros_prefix_if_exists(const std::string & topic_name)
 {
-  for (const auto & prefix : _ros_prefixes) {
-    if (topic_name.rfind(prefix, 0) == 0 && topic_name.at(prefix.length()) == '/') {
-      return prefix;
-    }
+  const char * prefix = _match_ros_prefix(topic_name);
+  if (nullptr != prefix) {
+    return prefix;
   }
   return "";
 }
@@ -53,10 +92,8 @@ _get_ros_prefix_if_exists(const std::string & topic_name)
 std::string
 _strip_ros_prefix_if_exists(const std::string & topic_name)
 {
-  for (const auto & prefix : _ros_prefixes) {
-    if (topic_name.rfind(prefix, 0) == 0 && topic_name.at(prefix.length()) == '/') {
-      return topic_name.substr(prefix.length());
-    }
+  if (nullptr != _match_ros_prefix(topic_name)) {
+    return topic_name.substr(kRosPrefixLength);
   }
   return topic_name;
 }
@@ -14,7 +14,13 @@
 // limitations under the License.
 
 #include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
 
 #include "fastrtps/config.h"
 #include "fastrtps/Domain.h"
@@ -33,6 +39,12 @@
 #include "fastrtps/subscriber/Subscriber.h"
 #include "fastrtps/subscriber/SubscriberListener.h"
 #include "fastrtps/subscriber/SampleInfo.h"
+#include "fastrtps/xmlparser/XMLProfileManager.h"
+
+#if FASTRTPS_VERSION_MAJOR >= 2
+#include "fastdds/rtps/transport/UDPv4TransportDescriptor.h"
+#include "fastdds/rtps/transport/shared_mem/SharedMemTransportDescriptor.h"
+#endif
 
 #include "rcutils/filesystem.h"
 #include "rcutils/get_env.h"
@@ -40,10 +52,12 @@
 #include "rmw/allocators.h"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/init_arena.hpp"
 #include "rmw_fastrtps_shared_cpp/participant.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 using Domain = eprosima::fastrtps::Domain;
+using InitArena = rmw_fastrtps_shared_cpp::InitArena;
 using IPLocator = eprosima::fastrtps::rtps::IPLocator;
 using Locator_t = eprosima::fastrtps::rtps::Locator_t;
 using Participant = eprosima::fastrtps::Participant;
@@ -54,7 +68,8 @@ using StatefulReader = eprosima::fastrtps::rtps::StatefulReader;
 static
 bool
 get_security_file_paths(
-  std::array<std::string, 6> & security_files_paths, const char * secure_root)
+  std::array<const char *, 6> & security_files_paths, const char * secure_root,
+  InitArena & arena)
 {
   // here assume only 6 files for security
   const char * file_names[6] = {
@@ -63,7 +78,7 @@ get_security_file_paths(
   };
   size_t num_files = sizeof(file_names) / sizeof(char *);
 
-  std::string file_prefix("file://");
+  const char * file_prefix = "file://";
 
   for (size_t i = 0; i < num_files; i++) {
     rcutils_allocator_t allocator = rcutils_get_default_allocator();
@@ -73,19 +88,539 @@ get_security_file_paths(
       return false;
     }
 
-    if (rcutils_is_readable(file_path)) {
-      security_files_paths[i] = file_prefix + std::string(file_path);
-    } else {
+    if (!rcutils_is_readable(file_path)) {
       allocator.deallocate(file_path, allocator.state);
       return false;
     }
 
+    const size_t prefixed_length = strlen(file_prefix) + strlen(file_path) + 1u;
+    char * prefixed = static_cast<char *>(arena.allocate(prefixed_length));
+    if (nullptr != prefixed) {
+      snprintf(prefixed, prefixed_length, "%s%s", file_prefix, file_path);
+    }
     allocator.deallocate(file_path, allocator.state);
+    if (nullptr == prefixed) {
+      return false;
+    }
+    security_files_paths[i] = prefixed;
+  }
+
+  return true;
+}
+#endif
+
+// Registry of participants shared between contexts of one process when
+// RMW_FASTRTPS_SHARE_PARTICIPANT=1. The key covers everything that changes
+// the participant configuration, so only contexts that would have produced
+// an identical participant reuse an existing one.
+using SharedParticipantKey = std::tuple<size_t, bool, std::string>;
+struct SharedParticipantEntry
+{
+  CustomParticipantInfo * participant_info;
+  size_t use_count;
+};
+static std::mutex __shared_participants_mutex;
+static std::map<SharedParticipantKey, SharedParticipantEntry> __shared_participants;
+
+static
+bool
+__participant_sharing_enabled()
+{
+  const char * env_value;
+  const char * error_str;
+  error_str = rcutils_get_env("RMW_FASTRTPS_SHARE_PARTICIPANT", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  return env_value != nullptr && strcmp(env_value, "1") == 0;
+}
+
+// One participant funnels all RTPS reception and discovery through a small
+// set of internal threads, which big gateway processes saturate.
+// RMW_FASTRTPS_PARTICIPANT_SHARDS=N (N > 1) makes every context own N
+// participants configured identically; topic endpoints are spread over them
+// by topic-name hash (see CustomParticipantInfo::participant_for_topic), so
+// RTPS processing scales across cores. Each shard also brings its own
+// transport reception threads — the only way to multiply reception capacity
+// on this Fast-RTPS version — which RMW_FASTRTPS_RECEPTION_CPUSET can pin
+// to dedicated cores (see pin_reception_thread). Unset, empty, 0 or 1 keeps
+// the single participant. Each shard is a full DDS participant with its own discovery
+// footprint, so the cap below guards against typos inflating the process.
+static
+size_t
+__requested_shard_count()
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_PARTICIPANT_SHARDS", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return 1u;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return 1u;
+  }
+  char * end = nullptr;
+  unsigned long shards = strtoul(env_value, &end, 10);  // NOLINT(runtime/int)
+  if (end == env_value || *end != '\0' || shards > 64) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_PARTICIPANT_SHARDS is not a number between 0 and 64, ignoring it");
+    return 1u;
+  }
+  return shards > 1u ? static_cast<size_t>(shards) : 1u;
+}
+
+// Parse one "address" or "address:port" entry into an IPv4 locator.
+static
+bool
+__parse_locator_entry(
+  const char * entry, uint32_t default_port, Locator_t & locator,
+  const char * env_name, InitArena & arena)
+{
+  locator.kind = 1;
+  locator.port = default_port;
+  const char * address = entry;
+  const char * colon = strchr(entry, ':');
+  if (nullptr != colon) {
+    address = arena.copy_string(entry, static_cast<size_t>(colon - entry));
+    if (nullptr == address) {
+      RMW_SET_ERROR_MSG("failed to allocate locator scratch");
+      return false;
+    }
+    char * end = nullptr;
+    unsigned long port = strtoul(colon + 1, &end, 10);  // NOLINT(runtime/int)
+    if (end == colon + 1 || *end != '\0' || port > 65535) {
+      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("%s contains an invalid port", env_name);
+      return false;
+    }
+    locator.port = static_cast<uint32_t>(port);
+  }
+  if (!IPLocator::setIPv4(locator, address)) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("%s contains an invalid IPv4 address", env_name);
+    return false;
+  }
+  return true;
+}
+
+// Fixed topologies don't need to pay full multicast discovery on every boot.
+// RMW_FASTRTPS_STATIC_PEERS is a semicolon separated list of IPv4 addresses,
+// each optionally suffixed with ":port"; the listed peers are contacted
+// directly as initial PDP peers, so the graph converges as fast as the peers
+// answer instead of waiting on multicast announcement periods.
+// RMW_FASTRTPS_STATIC_EDP_XML points at a Fast-RTPS static endpoint
+// description file and replaces simple EDP with the pre-declared endpoints
+// entirely, which also removes the EDP builtin readers and writers.
+static
+bool
+__apply_static_discovery_configuration(
+  ParticipantAttributes & participantAttrs, InitArena & arena)
+{
+  const char * env_value;
+  const char * error_str;
+
+  error_str = rcutils_get_env("RMW_FASTRTPS_STATIC_PEERS", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (env_value != nullptr && env_value[0] != '\0') {
+    const char * cursor = env_value;
+    while (nullptr != cursor) {
+      const char * separator = strchr(cursor, ';');
+      const size_t length =
+        separator ? static_cast<size_t>(separator - cursor) : strlen(cursor);
+      if (length > 0u) {
+        char * peer = arena.copy_string(cursor, length);
+        if (nullptr == peer) {
+          RMW_SET_ERROR_MSG("failed to allocate peer list scratch");
+          return false;
+        }
+        Locator_t peer_locator;
+        if (!__parse_locator_entry(
+            peer, 0, peer_locator, "RMW_FASTRTPS_STATIC_PEERS", arena))
+        {
+          return false;
+        }
+        participantAttrs.rtps.builtin.initialPeersList.push_back(peer_locator);
+      }
+      cursor = separator ? separator + 1 : nullptr;
+    }
+  }
+
+  error_str = rcutils_get_env("RMW_FASTRTPS_STATIC_EDP_XML", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (env_value != nullptr && env_value[0] != '\0') {
+    if (!rcutils_is_readable(env_value)) {
+      RMW_SET_ERROR_MSG("RMW_FASTRTPS_STATIC_EDP_XML file is not readable");
+      return false;
+    }
+    participantAttrs.rtps.builtin.discovery_config.use_SIMPLE_EndpointDiscoveryProtocol = false;
+    participantAttrs.rtps.builtin.discovery_config.use_STATIC_EndpointDiscoveryProtocol = true;
+    participantAttrs.rtps.builtin.discovery_config.setStaticEndpointXMLFilename(env_value);
+  }
+
+  return true;
+}
+
+// Large sites replace peer-to-peer multicast discovery with discovery
+// servers. ROS_DISCOVERY_SERVER is a semicolon separated list of server
+// addresses ("address" or "address:port", default port 11811); the position
+// of an entry in the list is the server id, so an empty entry skips an id
+// while keeping the ids of the following servers stable. When at least one
+// server is configured the participant runs as a discovery client; listing
+// several servers gives redundancy, and the client transparently keeps
+// pinging servers that are not reachable yet or went away.
+#if FASTRTPS_VERSION_MAJOR >= 2
+static
+bool
+__add_discovery_server(
+  ParticipantAttributes & participantAttrs,
+  const char * entry,
+  size_t server_id,
+  InitArena & arena)
+{
+  if (server_id > 255) {
+    RMW_SET_ERROR_MSG("ROS_DISCOVERY_SERVER lists too many servers");
+    return false;
+  }
+  Locator_t server_locator;
+  if (!__parse_locator_entry(entry, 11811, server_locator, "ROS_DISCOVERY_SERVER", arena)) {
+    return false;
+  }
+  eprosima::fastrtps::rtps::RemoteServerAttributes server_attrs;
+  // Same well-known prefix scheme the Fast-RTPS discovery server tooling
+  // uses, with the server id as the third octet.
+  char guid_prefix[48];
+  snprintf(
+    guid_prefix, sizeof(guid_prefix),
+    "44.53.%02x.5f.45.50.52.4f.53.49.4d.41", static_cast<unsigned int>(server_id));
+  if (!server_attrs.ReadguidPrefix(guid_prefix)) {
+    RMW_SET_ERROR_MSG("failed to set discovery server guid prefix");
+    return false;
+  }
+  server_attrs.metatrafficUnicastLocatorList.push_back(server_locator);
+  participantAttrs.rtps.builtin.discovery_config.m_DiscoveryServers.push_back(server_attrs);
+  return true;
+}
+#endif
+
+static
+bool
+__apply_discovery_server_configuration(
+  ParticipantAttributes & participantAttrs, InitArena & arena)
+{
+  const char * env_value;
+  const char * error_str;
+  error_str = rcutils_get_env("ROS_DISCOVERY_SERVER", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (env_value == nullptr || env_value[0] == '\0') {
+    return true;
+  }
+#if FASTRTPS_VERSION_MAJOR >= 2
+  size_t server_id = 0;
+  const char * cursor = env_value;
+  while (nullptr != cursor) {
+    const char * separator = strchr(cursor, ';');
+    const size_t length =
+      separator ? static_cast<size_t>(separator - cursor) : strlen(cursor);
+    if (length > 0u) {
+      char * entry = arena.copy_string(cursor, length);
+      if (nullptr == entry) {
+        RMW_SET_ERROR_MSG("failed to allocate server list scratch");
+        return false;
+      }
+      if (!__add_discovery_server(participantAttrs, entry, server_id, arena)) {
+        return false;
+      }
+    }
+    ++server_id;
+    cursor = separator ? separator + 1 : nullptr;
+  }
+  if (!participantAttrs.rtps.builtin.discovery_config.m_DiscoveryServers.empty()) {
+    participantAttrs.rtps.builtin.discovery_config.discoveryProtocol =
+      eprosima::fastrtps::rtps::DiscoveryProtocol_t::CLIENT;
+  }
+  return true;
+#else
+  RMW_SET_ERROR_MSG("ROS_DISCOVERY_SERVER requires Fast-RTPS 2.0 or later");
+  return false;
+#endif
+}
+
+// Publisher/subscription pairs living in the same process don't need to
+// round-trip through the transport stack at all.
+// RMW_FASTRTPS_INTRAPROCESS_DELIVERY=1 turns on Fast-RTPS intra-process
+// delivery: samples between same-process endpoints are handed over through
+// the shared payload in history, skipping the wire entirely, while remote
+// matches keep receiving the sample through the transports. This is a
+// process-wide engine setting, so it is applied once before the first
+// participant is created.
+static
+bool
+__apply_intraprocess_delivery_configuration()
+{
+  const char * env_value;
+  const char * error_str;
+  error_str = rcutils_get_env("RMW_FASTRTPS_INTRAPROCESS_DELIVERY", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (env_value != nullptr && strcmp(env_value, "1") == 0) {
+    eprosima::fastrtps::LibrarySettingsAttributes library_settings;
+    library_settings.intraprocess_delivery = eprosima::fastrtps::INTRAPROCESS_FULL;
+    eprosima::fastrtps::xmlparser::XMLProfileManager::library_settings(library_settings);
+  }
+  return true;
+}
+
+// High-bandwidth same-host links shouldn't traverse loopback UDP.
+// RMW_FASTRTPS_USE_SHM=1 adds the shared memory transport next to UDPv4;
+// Fast-RTPS then prefers shared memory whenever both endpoints are on the
+// same host and falls back to UDP for everything else. The optional
+// RMW_FASTRTPS_SHM_SEGMENT_SIZE (bytes) sizes the shared segment, which
+// bounds the largest message that can go through shared memory.
+static
+bool
+__apply_shared_memory_configuration(ParticipantAttributes & participantAttrs)
+{
+  const char * env_value;
+  const char * error_str;
+  error_str = rcutils_get_env("RMW_FASTRTPS_USE_SHM", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (env_value == nullptr || strcmp(env_value, "1") != 0) {
+    return true;
   }
+#if FASTRTPS_VERSION_MAJOR >= 2
+  auto shm_transport =
+    std::make_shared<eprosima::fastdds::rtps::SharedMemTransportDescriptor>();
+  error_str = rcutils_get_env("RMW_FASTRTPS_SHM_SEGMENT_SIZE", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (env_value != nullptr && env_value[0] != '\0') {
+    char * end = nullptr;
+    unsigned long segment_size = strtoul(env_value, &end, 10);  // NOLINT(runtime/int)
+    if (end == env_value || *end != '\0' || 0 == segment_size || segment_size > UINT32_MAX) {
+      RMW_SET_ERROR_MSG("RMW_FASTRTPS_SHM_SEGMENT_SIZE is not a valid size in bytes");
+      return false;
+    }
+    shm_transport->segment_size(static_cast<uint32_t>(segment_size));
+  }
+  // Adding user transports disables the builtin ones, so UDPv4 has to be
+  // re-added explicitly to keep off-host peers working.
+  auto udp_transport =
+    std::make_shared<eprosima::fastdds::rtps::UDPv4TransportDescriptor>();
+  participantAttrs.rtps.useBuiltinTransports = false;
+  participantAttrs.rtps.userTransports.push_back(shm_transport);
+  participantAttrs.rtps.userTransports.push_back(udp_transport);
+  return true;
+#else
+  RMW_SET_ERROR_MSG("RMW_FASTRTPS_USE_SHM requires Fast-RTPS 2.0 or later");
+  return false;
+#endif
+}
 
+// Socket-layer tuning for bursty high-bandwidth topics, without templating
+// a global XML per process. RMW_FASTRTPS_SEND_BUFFER_SIZE and
+// RMW_FASTRTPS_RECV_BUFFER_SIZE (bytes) size the UDP send and receive
+// socket buffers; undersized receive buffers drop fragment bursts at the
+// kernel and turn into reliable-QoS retransmits that cost far more than
+// the memory. RMW_FASTRTPS_NONBLOCKING_SEND=1 makes sends drop instead of
+// blocking the writer when the send buffer is full, and
+// RMW_FASTRTPS_INTERFACE_WHITELIST (semicolon separated IPv4 addresses)
+// restricts the transport to the listed interfaces. The latter two need a
+// user UDP transport descriptor; buffer sizes alone apply to the builtin
+// transports directly.
+static
+bool
+__parse_buffer_size_env(const char * env_name, uint32_t & size)
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env(env_name, &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return true;
+  }
+  char * end = nullptr;
+  unsigned long parsed = strtoul(env_value, &end, 10);  // NOLINT(runtime/int)
+  if (end == env_value || *end != '\0' || 0 == parsed || parsed > UINT32_MAX) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("%s is not a valid size in bytes", env_name);
+    return false;
+  }
+  size = static_cast<uint32_t>(parsed);
   return true;
 }
+
+static
+bool
+__apply_transport_tuning_configuration(
+  ParticipantAttributes & participantAttrs, InitArena & arena)
+{
+  uint32_t send_buffer_size = 0;
+  uint32_t recv_buffer_size = 0;
+  if (!__parse_buffer_size_env("RMW_FASTRTPS_SEND_BUFFER_SIZE", send_buffer_size) ||
+    !__parse_buffer_size_env("RMW_FASTRTPS_RECV_BUFFER_SIZE", recv_buffer_size))
+  {
+    return false;
+  }
+  if (send_buffer_size > 0) {
+    participantAttrs.rtps.sendSocketBufferSize = send_buffer_size;
+  }
+  if (recv_buffer_size > 0) {
+    participantAttrs.rtps.listenSocketBufferSize = recv_buffer_size;
+  }
+
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_NONBLOCKING_SEND", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  const bool non_blocking_send = env_value != nullptr && strcmp(env_value, "1") == 0;
+
+  const char * whitelist_value;
+  error_str = rcutils_get_env("RMW_FASTRTPS_INTERFACE_WHITELIST", &whitelist_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return false;
+  }
+  const bool has_whitelist = whitelist_value != nullptr && whitelist_value[0] != '\0';
+
+  if (!non_blocking_send && !has_whitelist) {
+    return true;
+  }
+#if FASTRTPS_VERSION_MAJOR >= 2
+  // Reuse the UDP descriptor the shared memory configuration may already
+  // have added; otherwise adding a user transport disables the builtin
+  // ones, so UDPv4 is re-added explicitly, as in the shared memory path.
+  std::shared_ptr<eprosima::fastdds::rtps::UDPv4TransportDescriptor> udp_transport;
+  for (auto & transport : participantAttrs.rtps.userTransports) {
+    udp_transport =
+      std::dynamic_pointer_cast<eprosima::fastdds::rtps::UDPv4TransportDescriptor>(transport);
+    if (udp_transport) {
+      break;
+    }
+  }
+  if (!udp_transport) {
+    udp_transport = std::make_shared<eprosima::fastdds::rtps::UDPv4TransportDescriptor>();
+    participantAttrs.rtps.useBuiltinTransports = false;
+    participantAttrs.rtps.userTransports.push_back(udp_transport);
+  }
+  if (send_buffer_size > 0) {
+    udp_transport->sendBufferSize = send_buffer_size;
+  }
+  if (recv_buffer_size > 0) {
+    udp_transport->receiveBufferSize = recv_buffer_size;
+  }
+  udp_transport->non_blocking_send = non_blocking_send;
+  if (has_whitelist) {
+    const char * cursor = whitelist_value;
+    while (nullptr != cursor) {
+      const char * separator = strchr(cursor, ';');
+      const size_t length =
+        separator ? static_cast<size_t>(separator - cursor) : strlen(cursor);
+      if (length > 0u) {
+        char * address = arena.copy_string(cursor, length);
+        if (nullptr == address) {
+          RMW_SET_ERROR_MSG("failed to allocate whitelist scratch");
+          return false;
+        }
+        udp_transport->interfaceWhiteList.push_back(address);
+      }
+      cursor = separator ? separator + 1 : nullptr;
+    }
+  }
+  return true;
+#else
+  RMW_SET_ERROR_MSG(
+    "RMW_FASTRTPS_NONBLOCKING_SEND and RMW_FASTRTPS_INTERFACE_WHITELIST "
+    "require Fast-RTPS 2.0 or later");
+  return false;
+#endif
+}
+
+// Localhost-only contexts never talk off the machine, so the standard
+// multicast discovery stack is pure overhead for them. Every peer is
+// reachable through the loopback initial peer, which lets multicast
+// discovery be dropped entirely; on Fast-RTPS 2.0 the shared memory
+// transport is added so same-host data skips loopback UDP, with the UDP
+// descriptor whitelisted to loopback as the fallback for payloads that
+// exceed the shared segment. Discovery timings are tightened too: loopback
+// does not lose announcements, so the conservative WAN-ready defaults only
+// slow convergence of the thousands of short-lived contexts CI farms run.
+// Applied after the transport configurations above so it can reuse any
+// descriptors they added instead of stacking duplicates.
+static
+bool
+__apply_localhost_only_configuration(ParticipantAttributes & participantAttrs)
+{
+  Locator_t local_network_interface_locator;
+  static const std::string local_ip_name("127.0.0.1");
+  local_network_interface_locator.kind = 1;
+  local_network_interface_locator.port = 0;
+  IPLocator::setIPv4(local_network_interface_locator, local_ip_name);
+  participantAttrs.rtps.builtin.metatrafficUnicastLocatorList.push_back(
+    local_network_interface_locator);
+  participantAttrs.rtps.builtin.initialPeersList.push_back(local_network_interface_locator);
+  participantAttrs.rtps.builtin.metatrafficMulticastLocatorList.clear();
+
+  // A loopback answer arrives in microseconds; announce eagerly at startup,
+  // then settle on a period that still renews the shortened lease in time.
+  participantAttrs.rtps.builtin.discovery_config.initial_announcements.count = 5;
+  participantAttrs.rtps.builtin.discovery_config.initial_announcements.period =
+    eprosima::fastrtps::Duration_t(0, 10 * 1000 * 1000);
+  participantAttrs.rtps.builtin.discovery_config.leaseDuration_announcementperiod =
+    eprosima::fastrtps::Duration_t(1, 0);
+  participantAttrs.rtps.builtin.discovery_config.leaseDuration =
+    eprosima::fastrtps::Duration_t(5, 0);
+
+#if FASTRTPS_VERSION_MAJOR >= 2
+  bool has_shm_transport = false;
+  for (auto & transport : participantAttrs.rtps.userTransports) {
+    if (std::dynamic_pointer_cast<eprosima::fastdds::rtps::SharedMemTransportDescriptor>(
+        transport))
+    {
+      has_shm_transport = true;
+      break;
+    }
+  }
+  if (!has_shm_transport) {
+    participantAttrs.rtps.userTransports.push_back(
+      std::make_shared<eprosima::fastdds::rtps::SharedMemTransportDescriptor>());
+  }
+  // Find-or-create the UDP descriptor, as in the transport tuning above.
+  std::shared_ptr<eprosima::fastdds::rtps::UDPv4TransportDescriptor> udp_transport;
+  for (auto & transport : participantAttrs.rtps.userTransports) {
+    udp_transport =
+      std::dynamic_pointer_cast<eprosima::fastdds::rtps::UDPv4TransportDescriptor>(transport);
+    if (udp_transport) {
+      break;
+    }
+  }
+  if (!udp_transport) {
+    udp_transport = std::make_shared<eprosima::fastdds::rtps::UDPv4TransportDescriptor>();
+    participantAttrs.rtps.userTransports.push_back(udp_transport);
+  }
+  participantAttrs.rtps.useBuiltinTransports = false;
+  udp_transport->interfaceWhiteList.push_back(local_ip_name);
 #endif
+  return true;
+}
 
 static
 CustomParticipantInfo *
@@ -93,7 +628,8 @@ __create_participant(
   const char * identifier,
   ParticipantAttributes participantAttrs,
   bool leave_middleware_default_qos,
-  rmw_dds_common::Context * common_context)
+  rmw_dds_common::Context * common_context,
+  size_t shard_count)
 {
   // Declare everything before beginning to create things.
   ::ParticipantListener * listener = nullptr;
@@ -125,8 +661,26 @@ __create_participant(
   participant_info->participant = participant;
   participant_info->listener = listener;
 
+  // Shard participants are configured like the primary but carry no
+  // listener: the primary's listener already does the graph bookkeeping for
+  // the whole process, and every participant discovers the same peers.
+  for (size_t i = 1; i < shard_count; ++i) {
+    Participant * shard = Domain::createParticipant(participantAttrs, nullptr);
+    if (!shard) {
+      RMW_SET_ERROR_MSG("create_node() could not create shard participant");
+      goto fail;
+    }
+    participant_info->shard_participants.push_back(shard);
+  }
+
   return participant_info;
 fail:
+  if (participant_info) {
+    for (Participant * shard : participant_info->shard_participants) {
+      Domain::removeParticipant(shard);
+    }
+    delete participant_info;
+  }
   rmw_free(listener);
   if (participant) {
     Domain::removeParticipant(participant);
@@ -147,20 +701,63 @@ rmw_fastrtps_shared_cpp::create_participant(
     RMW_SET_ERROR_MSG("security_options is null");
     return nullptr;
   }
+
+  // Opt-in participant sharing: reuse an already created participant when a
+  // second context in this process would configure an identical one. Secure
+  // participants are never shared, as credentials are per context. The lock
+  // is held across creation so two contexts racing on the same key cannot
+  // both create a participant.
+  const bool share_participant = __participant_sharing_enabled() &&
+    !security_options->security_root_path;
+  std::unique_lock<std::mutex> sharing_lock(__shared_participants_mutex, std::defer_lock);
+  SharedParticipantKey sharing_key;
+  if (share_participant) {
+    sharing_lock.lock();
+    sharing_key = SharedParticipantKey(domain_id, localhost_only, enclave);
+    auto it = __shared_participants.find(sharing_key);
+    if (it != __shared_participants.end()) {
+      ++it->second.use_count;
+      it->second.participant_info->listener->add_context(common_context);
+      return it->second.participant_info;
+    }
+  }
+
+  // Init-phase scratch - peer list tokens, security file paths - comes out
+  // of a monotonic arena released in bulk when this function returns, so
+  // the startup churn never interleaves short-lived blocks with the
+  // long-lived allocations made while the participant comes up.
+  InitArena init_arena;
+
   ParticipantAttributes participantAttrs;
 
   // Load default XML profile.
   Domain::getDefaultParticipantAttributes(participantAttrs);
 
-  if (localhost_only) {
-    Locator_t local_network_interface_locator;
-    static const std::string local_ip_name("127.0.0.1");
-    local_network_interface_locator.kind = 1;
-    local_network_interface_locator.port = 0;
-    IPLocator::setIPv4(local_network_interface_locator, local_ip_name);
-    participantAttrs.rtps.builtin.metatrafficUnicastLocatorList.push_back(
-      local_network_interface_locator);
-    participantAttrs.rtps.builtin.initialPeersList.push_back(local_network_interface_locator);
+  if (!__apply_static_discovery_configuration(participantAttrs, init_arena)) {
+    return nullptr;
+  }
+
+  if (!__apply_discovery_server_configuration(participantAttrs, init_arena)) {
+    return nullptr;
+  }
+
+  if (!__apply_shared_memory_configuration(participantAttrs)) {
+    return nullptr;
+  }
+
+  // After the shared memory configuration, so it can tune the UDP
+  // descriptor that configuration may have added.
+  if (!__apply_transport_tuning_configuration(participantAttrs, init_arena)) {
+    return nullptr;
+  }
+
+  // Last of the transport configurations, so it reuses their descriptors.
+  if (localhost_only && !__apply_localhost_only_configuration(participantAttrs)) {
+    return nullptr;
+  }
+
+  if (!__apply_intraprocess_delivery_configuration()) {
+    return nullptr;
   }
 
 #if FASTRTPS_VERSION_MAJOR < 2
@@ -201,8 +798,10 @@ rmw_fastrtps_shared_cpp::create_participant(
   if (security_options->security_root_path) {
     // if security_root_path provided, try to find the key and certificate files
 #if HAVE_SECURITY
-    std::array<std::string, 6> security_files_paths;
-    if (get_security_file_paths(security_files_paths, security_options->security_root_path)) {
+    std::array<const char *, 6> security_files_paths;
+    if (get_security_file_paths(
+        security_files_paths, security_options->security_root_path, init_arena))
+    {
       eprosima::fastrtps::rtps::PropertyPolicy property_policy;
       using Property = eprosima::fastrtps::rtps::Property;
       property_policy.properties().emplace_back(
@@ -244,21 +843,49 @@ rmw_fastrtps_shared_cpp::create_participant(
     return nullptr;
 #endif
   }
-  return __create_participant(
+  CustomParticipantInfo * participant_info = __create_participant(
     identifier,
     participantAttrs,
     leave_middleware_default_qos,
-    common_context);
+    common_context,
+    __requested_shard_count());
+  if (share_participant && participant_info) {
+    __shared_participants.emplace(sharing_key, SharedParticipantEntry{participant_info, 1u});
+  }
+  return participant_info;
 }
 
 rmw_ret_t
-rmw_fastrtps_shared_cpp::destroy_participant(CustomParticipantInfo * participant_info)
+rmw_fastrtps_shared_cpp::destroy_participant(
+  CustomParticipantInfo * participant_info,
+  rmw_dds_common::Context * common_context)
 {
   rmw_ret_t result_ret = RMW_RET_OK;
   if (!participant_info) {
     RMW_SET_ERROR_MSG("participant_info is null");
     return RMW_RET_ERROR;
   }
+  {
+    std::lock_guard<std::mutex> guard(__shared_participants_mutex);
+    auto it = __shared_participants.begin();
+    for (; it != __shared_participants.end(); ++it) {
+      if (it->second.participant_info == participant_info) {
+        break;
+      }
+    }
+    if (it != __shared_participants.end()) {
+      participant_info->listener->remove_context(common_context);
+      if (0u != --it->second.use_count) {
+        // Other contexts still use this participant; the real teardown
+        // happens when the last of them goes away.
+        return result_ret;
+      }
+      __shared_participants.erase(it);
+    }
+  }
+  for (Participant * shard : participant_info->shard_participants) {
+    Domain::removeParticipant(shard);
+  }
   Domain::removeParticipant(participant_info->participant);
   delete participant_info->listener;
   participant_info->listener = nullptr;
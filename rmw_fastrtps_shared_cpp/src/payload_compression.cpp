@@ -0,0 +1,153 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/payload_compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+// 0xF5 never starts the CDR serialization of a common primitive (bools,
+// small enums, lengths, pointers into small address spaces), which keeps
+// plain-payload collisions with the frame unlikely beyond the 1/2^32 the
+// doc comment already concedes.
+static const uint8_t kCompressionMagic[4] = {0xF5, 'R', 'L', 'E'};
+
+// PackBits control bytes: 0..127 announce that many + 1 literal bytes,
+// 129..255 announce (257 - control) repeats of the next byte, 128 is
+// reserved (a no-op on decode). The encoder only takes runs of three or
+// longer (two is break-even against riding in a literal); literals pay
+// 1 byte per 128, so the worst case grows the stream by 1/128, which the
+// strictly-smaller gate below turns into a plain send.
+
+bool
+payload_is_compressed(const uint8_t * data, uint32_t length)
+{
+  return length > kCompressionFrameSize &&
+         0 == memcmp(data, kCompressionMagic, sizeof(kCompressionMagic));
+}
+
+uint32_t
+compressed_payload_original_length(const uint8_t * data, uint32_t length)
+{
+  if (length < kCompressionFrameSize) {
+    return 0u;
+  }
+  return static_cast<uint32_t>(data[4]) |
+         static_cast<uint32_t>(data[5]) << 8 |
+         static_cast<uint32_t>(data[6]) << 16 |
+         static_cast<uint32_t>(data[7]) << 24;
+}
+
+uint32_t
+compress_payload(
+  const uint8_t * input,
+  uint32_t length,
+  uint8_t * output,
+  uint32_t output_capacity)
+{
+  if (0u == length || output_capacity <= kCompressionFrameSize) {
+    return 0u;
+  }
+  // Anything reaching this bound is already not worth sending compressed,
+  // so the encoder can give up instead of spilling past either limit.
+  const uint32_t bound = (std::min)(length, output_capacity);
+  uint32_t in = 0u;
+  uint32_t out = kCompressionFrameSize;
+  while (in < length) {
+    uint32_t run = 1u;
+    while (in + run < length && input[in + run] == input[in] && run < 128u) {
+      ++run;
+    }
+    if (run >= 3u) {
+      if (out + 2u > bound) {
+        return 0u;
+      }
+      output[out++] = static_cast<uint8_t>(257u - run);
+      output[out++] = input[in];
+      in += run;
+    } else {
+      // Extend the literal until the next run worth encoding, so short
+      // repeats ride inside one literal instead of fragmenting it.
+      uint32_t literal = run;
+      while (in + literal < length && literal < 128u) {
+        if (in + literal + 2u < length &&
+          input[in + literal] == input[in + literal + 1u] &&
+          input[in + literal] == input[in + literal + 2u])
+        {
+          break;
+        }
+        ++literal;
+      }
+      if (out + 1u + literal > bound) {
+        return 0u;
+      }
+      output[out++] = static_cast<uint8_t>(literal - 1u);
+      memcpy(output + out, input + in, literal);
+      out += literal;
+      in += literal;
+    }
+  }
+  if (out >= length) {
+    return 0u;
+  }
+  memcpy(output, kCompressionMagic, sizeof(kCompressionMagic));
+  output[4] = static_cast<uint8_t>(length);
+  output[5] = static_cast<uint8_t>(length >> 8);
+  output[6] = static_cast<uint8_t>(length >> 16);
+  output[7] = static_cast<uint8_t>(length >> 24);
+  return out;
+}
+
+bool
+decompress_payload(
+  const uint8_t * input,
+  uint32_t length,
+  uint8_t * output,
+  uint32_t output_capacity)
+{
+  if (!payload_is_compressed(input, length)) {
+    return false;
+  }
+  const uint32_t original = compressed_payload_original_length(input, length);
+  if (original > output_capacity) {
+    return false;
+  }
+  uint32_t in = kCompressionFrameSize;
+  uint32_t out = 0u;
+  while (in < length) {
+    const uint8_t control = input[in++];
+    if (control < 128u) {
+      const uint32_t count = static_cast<uint32_t>(control) + 1u;
+      if (in + count > length || out + count > original) {
+        return false;
+      }
+      memcpy(output + out, input + in, count);
+      in += count;
+      out += count;
+    } else if (control > 128u) {
+      const uint32_t count = 257u - static_cast<uint32_t>(control);
+      if (in >= length || out + count > original) {
+        return false;
+      }
+      memset(output + out, input[in++], count);
+      out += count;
+    }
+  }
+  return out == original;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
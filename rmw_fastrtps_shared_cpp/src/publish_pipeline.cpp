@@ -0,0 +1,172 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/publish_pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "fastcdr/Cdr.h"
+#include "fastcdr/FastBuffer.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+PublishPipeline::PublishPipeline(CustomPublisherInfo * info, uint32_t depth)
+: info_(info),
+  slots_(std::max<uint32_t>(depth, 2u))
+{
+  sender_ = std::thread(&PublishPipeline::run, this);
+}
+
+PublishPipeline::~PublishPipeline()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  // The sender drains whatever is still queued before honoring the stop, so
+  // destruction never drops a sample that publish() already accepted.
+  slot_ready_.notify_one();
+  sender_.join();
+}
+
+rmw_ret_t
+PublishPipeline::publish(const void * ros_message)
+{
+  if (failed_.exchange(false, std::memory_order_relaxed)) {
+    RMW_SET_ERROR_MSG("an earlier pipelined publish failed in the sender");
+    return RMW_RET_ERROR;
+  }
+
+  const bool timed = info_->sample_clock_now();
+  std::chrono::steady_clock::time_point start;
+  if (timed) {
+    start = std::chrono::steady_clock::now();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Every slot in flight means the writer is the bottleneck; blocking here
+  // is the pipeline's back-pressure.
+  slot_free_.wait(lock, [this] {return queued_count_ < slots_.size();});
+
+  Slot & slot = slots_[(head_ + queued_count_) % slots_.size()];
+  size_t data_length = info_->type_support_->getEstimatedSerializedSize(
+    ros_message, info_->type_support_impl_);
+  if (slot.buffer.size() < data_length) {
+    slot.buffer.resize(data_length);
+  }
+
+  eprosima::fastcdr::FastBuffer buffer(slot.buffer.data(), data_length);
+  eprosima::fastcdr::Cdr ser(
+    buffer, kSerializationEndianness, eprosima::fastcdr::Cdr::DDS_CDR);
+  if (!info_->type_support_->serializeROSmessage(ros_message, ser, info_->type_support_impl_)) {
+    RMW_SET_ERROR_MSG("cannot serialize data");
+    return RMW_RET_ERROR;
+  }
+  const uint32_t length = static_cast<uint32_t>(ser.getSerializedDataLength());
+  slot.length = length;
+  ++queued_count_;
+  lock.unlock();
+  slot_ready_.notify_one();
+
+  // Only the serialization is timed; the send runs on the sender thread and
+  // its cost shows up as back-pressure, not here.
+  if (timed) {
+    info_->statistics_.record(
+      length,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  } else {
+    info_->statistics_.record_untimed(length);
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+PublishPipeline::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  slot_free_.wait(lock, [this] {return 0 == queued_count_;});
+  if (failed_.exchange(false, std::memory_order_relaxed)) {
+    RMW_SET_ERROR_MSG("a pipelined publish failed in the sender");
+    return RMW_RET_ERROR;
+  }
+  return RMW_RET_OK;
+}
+
+void
+PublishPipeline::prewarm(size_t payload_size)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The sender drops the mutex while it writes the slot at head_, so only
+  // the free part of the ring may be touched; queued slots keep their
+  // bytes. Called before first traffic there is nothing queued anyway.
+  for (size_t i = queued_count_; i < slots_.size(); ++i) {
+    Slot & slot = slots_[(head_ + i) % slots_.size()];
+    if (slot.buffer.size() < payload_size) {
+      slot.buffer.resize(payload_size);
+    }
+    // Touch every page; growing the vector alone leaves them unmapped.
+    memset(slot.buffer.data(), 0, slot.buffer.size());
+  }
+}
+
+void
+PublishPipeline::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    slot_ready_.wait(lock, [this] {return queued_count_ > 0 || stop_;});
+    if (0 == queued_count_) {
+      // stop_ is set and the ring drained.
+      return;
+    }
+    Slot & slot = slots_[head_];
+    lock.unlock();
+
+    // The slot stays counted as queued while the write runs, so no publish
+    // touches it; only this thread advances head_.
+    eprosima::fastcdr::FastBuffer buffer(slot.buffer.data(), slot.length);
+    eprosima::fastcdr::Cdr ser(
+      buffer, kSerializationEndianness, eprosima::fastcdr::Cdr::DDS_CDR);
+    bool written = ser.jump(slot.length);
+    if (written) {
+      SerializedData data;
+      data.type = SerializedData::CDR_BUFFER;
+      data.data = &ser;
+      data.impl = nullptr;    // not used when type is CDR_BUFFER
+      data.compress = info_->compress_payloads_;
+      written = info_->publisher_->write(&data);
+    }
+
+    lock.lock();
+    if (!written) {
+      info_->backpressure_count_.fetch_add(1, std::memory_order_relaxed);
+      failed_.store(true, std::memory_order_relaxed);
+    }
+    head_ = (head_ + 1) % slots_.size();
+    --queued_count_;
+    // notify_all: flush() and several blocked publishers may all be waiting.
+    slot_free_.notify_all();
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
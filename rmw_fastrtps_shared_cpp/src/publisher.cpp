@@ -21,7 +21,9 @@
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/publisher.hpp"
+#include "rmw_fastrtps_shared_cpp/topic_mux.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 using Domain = eprosima::fastrtps::Domain;
@@ -49,20 +51,30 @@ destroy_publisher(
   }
 
   auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  // A multiplexed publisher shares its channel endpoint with other logical
+  // publishers; only the last rider tears the DDS entities down (see
+  // topic_mux.hpp).
+  if (info != nullptr && !mux_release_endpoint(publisher, info)) {
+    info = nullptr;
+  }
   if (info != nullptr) {
+    // Drain and stop the pipeline's sender before its DDS writer goes away.
+    info->publish_pipeline_.reset();
     if (info->publisher_ != nullptr) {
       Domain::removePublisher(info->publisher_);
     }
     delete info->listener_;
     if (info->type_support_ != nullptr) {
-      Participant * participant = participant_info->participant;
+      // With sharding the endpoint may live on a shard participant.
+      Participant * participant =
+        info->participant_ ? info->participant_ : participant_info->participant;
       _unregister_type(participant, info->type_support_);
     }
     delete info;
   }
-  rmw_free(const_cast<char *>(publisher->topic_name));
+  handle_pool_release(const_cast<char *>(publisher->topic_name));
   publisher->topic_name = nullptr;
-  rmw_publisher_free(publisher);
+  handle_pool_release(publisher);
 
   return RMW_RET_OK;
 }
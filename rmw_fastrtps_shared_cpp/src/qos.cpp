@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 
@@ -142,19 +145,153 @@ bool fill_entity_qos_from_profile(
   return true;
 }
 
+namespace
+{
+
+// Every field fill_entity_qos_from_profile reads from the profile; two
+// profiles with equal keys convert to identical attribute changes.
+using ProfileKey = std::tuple<
+  int, size_t, int, int,
+  uint64_t, uint64_t, uint64_t, uint64_t,
+  int, uint64_t, uint64_t>;
+
+ProfileKey
+_make_profile_key(const rmw_qos_profile_t & q)
+{
+  return ProfileKey(
+    static_cast<int>(q.history), q.depth,
+    static_cast<int>(q.durability), static_cast<int>(q.reliability),
+    q.lifespan.sec, q.lifespan.nsec,
+    q.deadline.sec, q.deadline.nsec,
+    static_cast<int>(q.liveliness),
+    q.liveliness_lease_duration.sec, q.liveliness_lease_duration.nsec);
+}
+
+// A profile converted once against default-constructed policies. Only the
+// members whose profile field is not SYSTEM_DEFAULT (or a zero time) are
+// copied out on a hit, so pass-through of caller-provided defaults (e.g.
+// from Fast-RTPS XML profiles) behaves exactly like the field-by-field
+// conversion.
+struct ConvertedProfile
+{
+  bool valid;
+  eprosima::fastrtps::HistoryQosPolicy history;
+  eprosima::fastrtps::DurabilityQosPolicy durability;
+  eprosima::fastrtps::ReliabilityQosPolicy reliability;
+  eprosima::fastrtps::LifespanQosPolicy lifespan;
+  eprosima::fastrtps::DeadlineQosPolicy deadline;
+  eprosima::fastrtps::LivelinessQosPolicy liveliness;
+};
+
+template<typename DDSEntityQos>
+void
+_apply_converted_profile(
+  const rmw_qos_profile_t & qos_policies,
+  const ConvertedProfile & converted,
+  DDSEntityQos & entity_qos,
+  eprosima::fastrtps::HistoryQosPolicy & history_qos)
+{
+  if (RMW_QOS_POLICY_HISTORY_SYSTEM_DEFAULT != qos_policies.history) {
+    history_qos.kind = converted.history.kind;
+  }
+  if (RMW_QOS_POLICY_DEPTH_SYSTEM_DEFAULT != qos_policies.depth) {
+    history_qos.depth = converted.history.depth;
+  }
+  if (RMW_QOS_POLICY_DURABILITY_SYSTEM_DEFAULT != qos_policies.durability) {
+    entity_qos.m_durability.kind = converted.durability.kind;
+  }
+  if (RMW_QOS_POLICY_RELIABILITY_SYSTEM_DEFAULT != qos_policies.reliability) {
+    entity_qos.m_reliability.kind = converted.reliability.kind;
+  }
+  if (!is_time_default(qos_policies.lifespan)) {
+    entity_qos.m_lifespan.duration = converted.lifespan.duration;
+  }
+  if (!is_time_default(qos_policies.deadline)) {
+    entity_qos.m_deadline.period = converted.deadline.period;
+  }
+  if (RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT != qos_policies.liveliness) {
+    entity_qos.m_liveliness.kind = converted.liveliness.kind;
+  }
+  if (!is_time_default(qos_policies.liveliness_lease_duration)) {
+    entity_qos.m_liveliness.lease_duration = converted.liveliness.lease_duration;
+    entity_qos.m_liveliness.announcement_period = converted.liveliness.announcement_period;
+  }
+}
+
+template<typename DDSEntityQos>
+bool
+_get_entity_qos_cached(
+  const rmw_qos_profile_t & qos_policies,
+  DDSEntityQos & entity_qos,
+  eprosima::fastrtps::HistoryQosPolicy & history_qos)
+{
+  static std::mutex cache_mutex;
+  static std::map<ProfileKey, ConvertedProfile> cache;
+
+  ProfileKey key = _make_profile_key(qos_policies);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    // Convert once against default-constructed policies; the handful of
+    // profiles a process uses (sensor data, services default, default)
+    // then resolve without re-running the validation switches.
+    ConvertedProfile converted;
+    eprosima::fastrtps::PublisherQos scratch;
+    eprosima::fastrtps::HistoryQosPolicy scratch_history;
+    converted.valid = fill_entity_qos_from_profile(qos_policies, scratch, scratch_history);
+    if (converted.valid) {
+      converted.history = scratch_history;
+      converted.durability = scratch.m_durability;
+      converted.reliability = scratch.m_reliability;
+      converted.lifespan = scratch.m_lifespan;
+      converted.deadline = scratch.m_deadline;
+      converted.liveliness = scratch.m_liveliness;
+    }
+    it = cache.emplace(key, converted).first;
+  }
+  if (!it->second.valid) {
+    // Re-run the conversion so the specific error message is set.
+    return fill_entity_qos_from_profile(qos_policies, entity_qos, history_qos);
+  }
+  _apply_converted_profile(qos_policies, it->second, entity_qos, history_qos);
+  return true;
+}
+
+}  // namespace
+
 bool
 get_datareader_qos(
   const rmw_qos_profile_t & qos_policies,
   eprosima::fastrtps::SubscriberAttributes & sattr)
 {
-  return fill_entity_qos_from_profile(qos_policies, sattr.qos, sattr.topic.historyQos);
+  return _get_entity_qos_cached(qos_policies, sattr.qos, sattr.topic.historyQos);
 }
 
 bool
 get_datawriter_qos(
   const rmw_qos_profile_t & qos_policies, eprosima::fastrtps::PublisherAttributes & pattr)
 {
-  return fill_entity_qos_from_profile(qos_policies, pattr.qos, pattr.topic.historyQos);
+  if (!_get_entity_qos_cached(qos_policies, pattr.qos, pattr.topic.historyQos)) {
+    return false;
+  }
+  // A transient-local KEEP_LAST writer retains exactly its depth for
+  // late-joiner replay, so allocate those history slots up front: when many
+  // readers reconnect at once the replay then runs out of preexisting
+  // payloads instead of growing the history mid-storm. Explicit limits in
+  // the endpoint options override this afterwards.
+  if (eprosima::fastrtps::TRANSIENT_LOCAL_DURABILITY_QOS == pattr.qos.m_durability.kind &&
+    eprosima::fastrtps::KEEP_LAST_HISTORY_QOS == pattr.topic.historyQos.kind &&
+    pattr.topic.historyQos.depth > 0)
+  {
+    eprosima::fastrtps::ResourceLimitsQosPolicy & limits = pattr.topic.resourceLimitsQos;
+    if (limits.allocated_samples < pattr.topic.historyQos.depth) {
+      limits.allocated_samples = pattr.topic.historyQos.depth;
+    }
+    if (limits.max_samples < limits.allocated_samples) {
+      limits.max_samples = limits.allocated_samples;
+    }
+  }
+  return true;
 }
 
 bool
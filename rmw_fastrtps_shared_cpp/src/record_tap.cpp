@@ -0,0 +1,217 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/record_tap.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+// Layout shared with the external recorder. The file starts with the ring
+// header; the record data region of `capacity` bytes follows immediately.
+// write_pos counts bytes ever written and only grows; a record's offset in
+// the data region is its position modulo capacity (capacity is a power of
+// two). A reader snapshots write_pos before and after copying a record out
+// and discards the copy when the two snapshots show the writer lapped it.
+constexpr uint64_t kRingMagic = 0x52544150'31574d52ull;  // "RMW1PATR", layout v1
+
+struct RingHeader
+{
+  uint64_t magic;
+  uint64_t capacity;
+  std::atomic<uint64_t> write_pos;
+};
+
+struct RecordHeader
+{
+  uint32_t payload_length;
+  uint8_t incoming;
+  uint8_t pad[3];
+  uint64_t timestamp_ns;
+  uint64_t type_hash;
+};
+
+struct RecordRing
+{
+  RingHeader * header = nullptr;
+  char * data = nullptr;
+  uint64_t capacity = 0;
+};
+
+uint64_t
+_ring_capacity()
+{
+  constexpr uint64_t kDefaultCapacity = 64ull * 1024 * 1024;
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_RECORD_TAP_SIZE", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return kDefaultCapacity;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return kDefaultCapacity;
+  }
+  char * end = nullptr;
+  unsigned long long requested = strtoull(env_value, &end, 10);  // NOLINT(runtime/int)
+  if (end == env_value || *end != '\0' || 0 == requested) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_RECORD_TAP_SIZE is not a valid size in bytes, using the default");
+    return kDefaultCapacity;
+  }
+  // Power of two, so offsets wrap with a mask instead of a division.
+  uint64_t capacity = 4096;
+  while (capacity < requested) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+#ifndef _WIN32
+const RecordRing *
+_open_ring()
+{
+  static RecordRing ring;
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_RECORD_TAP_FILE", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return nullptr;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return nullptr;
+  }
+
+  const uint64_t capacity = _ring_capacity();
+  int fd = open(env_value, O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "could not open RMW_FASTRTPS_RECORD_TAP_FILE '%s', record tap disabled", env_value);
+    return nullptr;
+  }
+  const size_t total = sizeof(RingHeader) + capacity;
+  if (0 != ftruncate(fd, static_cast<off_t>(total))) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "could not size RMW_FASTRTPS_RECORD_TAP_FILE '%s', record tap disabled", env_value);
+    close(fd);
+    return nullptr;
+  }
+  void * base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  // The mapping outlives the descriptor.
+  close(fd);
+  if (MAP_FAILED == base) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "could not map RMW_FASTRTPS_RECORD_TAP_FILE '%s', record tap disabled", env_value);
+    return nullptr;
+  }
+
+  ring.header = static_cast<RingHeader *>(base);
+  ring.data = static_cast<char *>(base) + sizeof(RingHeader);
+  ring.capacity = capacity;
+  ring.header->capacity = capacity;
+  ring.header->write_pos.store(0, std::memory_order_relaxed);
+  // Magic last: the recorder treats the ring as live once it appears.
+  ring.header->magic = kRingMagic;
+  return &ring;
+}
+#else
+const RecordRing *
+_open_ring()
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_RECORD_TAP_FILE", &env_value);
+  if (error_str == NULL && env_value != nullptr && env_value[0] != '\0') {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_RECORD_TAP_FILE is not supported on this platform");
+  }
+  return nullptr;
+}
+#endif  // _WIN32
+
+// Copy into the data region at a logical position, splitting at the wrap.
+void
+_ring_write(const RecordRing * ring, uint64_t position, const void * bytes, size_t length)
+{
+  const uint64_t offset = position & (ring->capacity - 1u);
+  const size_t until_wrap = static_cast<size_t>(ring->capacity - offset);
+  if (length <= until_wrap) {
+    memcpy(ring->data + offset, bytes, length);
+  } else {
+    memcpy(ring->data + offset, bytes, until_wrap);
+    memcpy(ring->data, static_cast<const char *>(bytes) + until_wrap, length - until_wrap);
+  }
+}
+
+uint64_t
+_hash_type_name(const char * type_name)
+{
+  // FNV-1a; the recorder maps hashes back to names from its own type list.
+  uint64_t hash = 14695981039346656037ull;
+  for (const char * c = type_name; *c != '\0'; ++c) {
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+void
+record_tap_capture(
+  const char * type_name, const void * payload, uint32_t length, bool incoming)
+{
+  static const RecordRing * ring = _open_ring();
+  if (nullptr == ring) {
+    return;
+  }
+  const uint64_t padded = (sizeof(RecordHeader) + length + 7u) & ~7ull;
+  if (padded > ring->capacity) {
+    // A payload larger than the whole ring would overwrite itself.
+    return;
+  }
+  RecordHeader record;
+  record.payload_length = length;
+  record.incoming = incoming ? 1u : 0u;
+  memset(record.pad, 0, sizeof(record.pad));
+  record.timestamp_ns = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+  record.type_hash = _hash_type_name(type_name);
+  // One fetch_add reserves a disjoint range per writer; the copies below
+  // then need no further coordination with other writers.
+  const uint64_t start = ring->header->write_pos.fetch_add(padded, std::memory_order_relaxed);
+  _ring_write(ring, start, &record, sizeof(record));
+  _ring_write(ring, start + sizeof(record), payload, length);
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -12,21 +12,30 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "rcutils/logging_macros.h"
 
 #include "rmw/allocators.h"
+#include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/client_endpoint_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "waitset_attachment.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -51,7 +60,9 @@ __rmw_destroy_client(
 
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   auto info = static_cast<CustomClientInfo *>(client->data);
-  {
+  // Once shutdown armed fast teardown, the participant disposal retracts
+  // every entity at once; skip the per-entity snapshot broadcast.
+  if (!node->context->impl->fast_teardown.load(std::memory_order_relaxed)) {
     // Update graph
     std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
     rmw_gid_t gid = rmw_fastrtps_shared_cpp::create_rmw_gid(
@@ -66,16 +77,21 @@ __rmw_destroy_client(
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.dissociate_reader(
       gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      identifier,
-      common_context->pub,
-      static_cast<void *>(&msg),
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       return rmw_ret;
     }
   }
 
+  if (info != nullptr) {
+    waitset_forget_entity(info);
+    if (client_endpoint_pool_park(common_context, client->service_name, info)) {
+      // The endpoints stay alive and matched, parked for the next client of
+      // this service; the pool tears them down at context shutdown if unused.
+      info = nullptr;
+    }
+  }
   if (info != nullptr) {
     if (info->response_subscriber_ != nullptr) {
       Domain::removeSubscriber(info->response_subscriber_);
@@ -98,11 +114,87 @@ __rmw_destroy_client(
     delete info;
   }
   if (client->service_name != nullptr) {
-    rmw_free(const_cast<char *>(client->service_name));
+    handle_pool_release(const_cast<char *>(client->service_name));
     client->service_name = nullptr;
   }
-  rmw_client_free(client);
+  handle_pool_release(client);
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_client_set_response_dispatch(
+  const char * identifier,
+  const rmw_client_t * client,
+  ClientResponseDispatch dispatch)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom client info is null", return RMW_RET_ERROR);
+
+  if (!dispatch.borrow_response && !dispatch.return_response && !dispatch.on_response) {
+    // Disable the gate first so receptions stop taking the fast path, then
+    // drop the callbacks; a reception that already loaded them holds its own
+    // reference and finishes safely.
+    info->listener_->setResponseDispatchEnabled(false);
+    std::shared_ptr<const ClientResponseDispatch> empty;
+    std::atomic_store(&info->response_dispatch_, empty);
+    return RMW_RET_OK;
+  }
+  if (!dispatch.borrow_response || !dispatch.return_response || !dispatch.on_response) {
+    RMW_SET_ERROR_MSG(
+      "response dispatch needs borrow_response, return_response and on_response");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto new_dispatch =
+    std::make_shared<const ClientResponseDispatch>(std::move(dispatch));
+  // Publish the callbacks before raising the gate the reception path checks.
+  std::atomic_store(&info->response_dispatch_, new_dispatch);
+  info->listener_->setResponseDispatchEnabled(true);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_client_has_response(
+  const char * identifier,
+  const rmw_client_t * client,
+  bool * has_response)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(has_response, RMW_RET_INVALID_ARGUMENT);
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom client info is null", return RMW_RET_ERROR);
+
+  *has_response = info->listener_->hasData();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_client_trim(
+  const char * identifier,
+  const rmw_client_t * client)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom client info is null", return RMW_RET_ERROR);
 
+  info->listener_->trimNodeCache();
   return RMW_RET_OK;
 }
 }  // namespace rmw_fastrtps_shared_cpp
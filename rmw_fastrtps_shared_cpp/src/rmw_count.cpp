@@ -27,7 +27,9 @@
 #include "rmw_dds_common/context.hpp"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -49,10 +51,23 @@ __rmw_count_publishers(
     RMW_SET_ERROR_MSG("node handle not from this implementation");
     return RMW_RET_INVALID_ARGUMENT;
   }
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   const std::string mangled_topic_name =
     _mangle_topic_name(ros_topic_prefix, topic_name).to_string();
-  return common_context->graph_cache.get_writer_count(mangled_topic_name, count);
+  // QoS-compatibility checks and watchdogs poll these counts at high
+  // frequency against a mostly unchanged graph; serve them from the
+  // generation-stamped cache instead of walking the graph every call.
+  return cached_count_query(
+    common_context,
+    ("writers:" + mangled_topic_name).c_str(),
+    count,
+    [&](size_t * out) {
+      return common_context->graph_cache.get_writer_count(mangled_topic_name, out);
+    });
 }
 
 rmw_ret_t
@@ -70,9 +85,19 @@ __rmw_count_subscribers(
     RMW_SET_ERROR_MSG("node handle not from this implementation");
     return RMW_RET_INVALID_ARGUMENT;
   }
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   const std::string mangled_topic_name =
     _mangle_topic_name(ros_topic_prefix, topic_name).to_string();
-  return common_context->graph_cache.get_reader_count(mangled_topic_name, count);
+  return cached_count_query(
+    common_context,
+    ("readers:" + mangled_topic_name).c_str(),
+    count,
+    [&](size_t * out) {
+      return common_context->graph_cache.get_reader_count(mangled_topic_name, out);
+    });
 }
 }  // namespace rmw_fastrtps_shared_cpp
@@ -16,6 +16,7 @@
 
 #include "rmw/impl/cpp/macros.hpp"
 
+#include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "types/event_types.hpp"
 
@@ -23,7 +24,8 @@ static const std::unordered_set<rmw_event_type_t> g_rmw_event_type_set{
   RMW_EVENT_LIVELINESS_CHANGED,
   RMW_EVENT_REQUESTED_DEADLINE_MISSED,
   RMW_EVENT_LIVELINESS_LOST,
-  RMW_EVENT_OFFERED_DEADLINE_MISSED
+  RMW_EVENT_OFFERED_DEADLINE_MISSED,
+  rmw_fastrtps_shared_cpp::RMW_FASTRTPS_EVENT_BACKLOG
 };
 
 namespace rmw_fastrtps_shared_cpp
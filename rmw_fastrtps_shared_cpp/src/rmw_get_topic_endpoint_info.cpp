@@ -24,7 +24,9 @@
 #include "rmw/topic_endpoint_info.h"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -96,6 +98,10 @@ __rmw_get_publishers_info_by_topic(
   if (ret != RMW_RET_OK) {
     return ret;
   }
+  ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   std::string mangled_topic_name = topic_name;
   DemangleFunction demangle_type = _identity_demangle;
@@ -104,11 +110,22 @@ __rmw_get_publishers_info_by_topic(
     demangle_type = _demangle_if_ros_type;
   }
 
-  return common_context->graph_cache.get_writers_info_by_topic(
-    mangled_topic_name,
-    demangle_type,
+  // Tooling tends to poll these queries while the graph is quiet; serve
+  // repeats from the snapshot so only the first call after a graph change
+  // walks the graph cache. The mangling mode is part of the query id since
+  // it changes the reported type names.
+  return cached_topic_endpoint_info_query(
+    common_context,
+    ((no_mangle ? "pub_info_raw:" : "pub_info:") + mangled_topic_name).c_str(),
     allocator,
-    publishers_info);
+    publishers_info,
+    [&](rmw_topic_endpoint_info_array_t * out) {
+      return common_context->graph_cache.get_writers_info_by_topic(
+        mangled_topic_name,
+        demangle_type,
+        allocator,
+        out);
+    });
 }
 
 rmw_ret_t
@@ -129,6 +146,10 @@ __rmw_get_subscriptions_info_by_topic(
   if (ret != RMW_RET_OK) {
     return ret;
   }
+  ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   std::string mangled_topic_name = topic_name;
   DemangleFunction demangle_type = _identity_demangle;
@@ -137,10 +158,17 @@ __rmw_get_subscriptions_info_by_topic(
     demangle_type = _demangle_if_ros_type;
   }
 
-  return common_context->graph_cache.get_readers_info_by_topic(
-    mangled_topic_name,
-    demangle_type,
+  return cached_topic_endpoint_info_query(
+    common_context,
+    ((no_mangle ? "sub_info_raw:" : "sub_info:") + mangled_topic_name).c_str(),
     allocator,
-    subscriptions_info);
+    subscriptions_info,
+    [&](rmw_topic_endpoint_info_array_t * out) {
+      return common_context->graph_cache.get_readers_info_by_topic(
+        mangled_topic_name,
+        demangle_type,
+        allocator,
+        out);
+    });
 }
 }  // namespace rmw_fastrtps_shared_cpp
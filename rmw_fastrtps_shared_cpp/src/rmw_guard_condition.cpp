@@ -12,6 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdlib>
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
@@ -19,8 +24,48 @@
 
 #include "types/guard_condition.hpp"
 
+#include "waitset_attachment.hpp"
+
 namespace rmw_fastrtps_shared_cpp
 {
+// RMW_FASTRTPS_GRAPH_QUIET_US=N delivers graph guard triggers at most once
+// per N microseconds; unset or 0 keeps one delivery per trigger.
+static
+int64_t
+__graph_guard_quiet_ns()
+{
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_GRAPH_QUIET_US", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED("rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    return 0;
+  }
+  if (nullptr == env_value || '\0' == env_value[0]) {
+    return 0;
+  }
+  char * end = nullptr;
+  unsigned long quiet_us = strtoul(env_value, &end, 10);  // NOLINT(runtime/int)
+  if (end == env_value || *end != '\0') {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_fastrtps_shared_cpp",
+      "RMW_FASTRTPS_GRAPH_QUIET_US is not a number, ignoring it");
+    return 0;
+  }
+  return static_cast<int64_t>(quiet_us) * 1000;
+}
+
+void
+apply_graph_guard_coalescing(rmw_guard_condition_t * guard_condition)
+{
+  if (nullptr == guard_condition || nullptr == guard_condition->data) {
+    return;
+  }
+  const int64_t quiet_ns = __graph_guard_quiet_ns();
+  if (quiet_ns > 0) {
+    static_cast<GuardCondition *>(guard_condition->data)->setTriggerCoalescing(quiet_ns);
+  }
+}
+
 rmw_guard_condition_t *
 __rmw_create_guard_condition(const char * identifier)
 {
@@ -34,6 +79,7 @@ rmw_ret_t
 __rmw_destroy_guard_condition(rmw_guard_condition_t * guard_condition)
 {
   if (guard_condition) {
+    waitset_forget_entity(guard_condition->data);
     delete static_cast<GuardCondition *>(guard_condition->data);
     delete guard_condition;
     return RMW_RET_OK;
@@ -15,6 +15,10 @@
 
 #include "rmw_fastrtps_shared_cpp/rmw_init.hpp"
 
+#include <cstring>
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
 #include "rcutils/strdup.h"
 #include "rcutils/types.h"
 
@@ -22,9 +26,32 @@
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/init_options.h"
 
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
+
 namespace rmw_fastrtps_shared_cpp
 {
 
+/// Whether RMW_FASTRTPS_FAST_TEARDOWN=1 asked for bulk teardown after shutdown.
+static
+bool
+__fast_teardown_enabled()
+{
+  static const bool enabled = []() {
+      const char * env_value;
+      const char * error_str;
+      error_str = rcutils_get_env("RMW_FASTRTPS_FAST_TEARDOWN", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return false;
+      }
+      return env_value != nullptr && strcmp(env_value, "1") == 0;
+    }();
+  return enabled;
+}
+
 rmw_ret_t
 rmw_init_options_init(
   const char * identifier, rmw_init_options_t * init_options, rcutils_allocator_t allocator)
@@ -97,4 +124,36 @@ rmw_init_options_fini(const char * identifier, rmw_init_options_t * init_options
   return RMW_RET_OK;
 }
 
+rmw_ret_t
+__rmw_context_trim_memory(
+  const char * identifier,
+  rmw_context_t * context,
+  size_t * bytes_released)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(context, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(bytes_released, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    context,
+    context->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  // The buffer pool is process wide, so every context's trim works on the
+  // same pool; the decaying high-water mark keeps concurrent housekeeping
+  // tasks from fighting over what to release.
+  *bytes_released = FastBufferPool::trim();
+  return RMW_RET_OK;
+}
+
+void
+mark_context_shutdown(rmw_context_t * context)
+{
+  if (nullptr == context || nullptr == context->impl) {
+    return;
+  }
+  if (__fast_teardown_enabled()) {
+    context->impl->fast_teardown.store(true, std::memory_order_relaxed);
+  }
+}
+
 }  // namespace rmw_fastrtps_shared_cpp
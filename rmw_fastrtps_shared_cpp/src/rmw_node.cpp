@@ -29,6 +29,8 @@
 #include "rmw_dds_common/context.hpp"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -91,12 +93,7 @@ __rmw_create_node(
     std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
     rmw_dds_common::msg::ParticipantEntitiesInfo participant_msg =
       graph_cache.add_node(common_context->gid, name, namespace_);
-    if (RMW_RET_OK != __rmw_publish(
-        identifier,
-        common_context->pub,
-        static_cast<void *>(&participant_msg),
-        nullptr))
-    {
+    if (RMW_RET_OK != graph_announce(identifier, common_context, &participant_msg)) {
       goto fail;
     }
   }
@@ -130,15 +127,13 @@ __rmw_destroy_node(
 
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   rmw_dds_common::GraphCache & graph_cache = common_context->graph_cache;
-  {
+  // Once shutdown armed fast teardown, the participant disposal retracts
+  // this node with all its entities; skip the per-node broadcast.
+  if (!node->context->impl->fast_teardown.load(std::memory_order_relaxed)) {
     std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
     rmw_dds_common::msg::ParticipantEntitiesInfo participant_msg =
       graph_cache.remove_node(common_context->gid, node->name, node->namespace_);
-    result_ret = __rmw_publish(
-      identifier,
-      common_context->pub,
-      static_cast<void *>(&participant_msg),
-      nullptr);
+    result_ret = graph_announce(identifier, common_context, &participant_msg);
     if (RMW_RET_OK != result_ret) {
       return result_ret;
     }
@@ -171,6 +166,11 @@ __rmw_node_get_graph_guard_condition(const rmw_node_t * node)
     RMW_SET_ERROR_MSG("common_context is nullptr");
     return nullptr;
   }
+  // Whoever takes this condition intends to wait on graph changes, which
+  // only the listener thread produces; start it now if it was deferred.
+  if (RMW_RET_OK != ensure_listener_thread(node->context)) {
+    return nullptr;
+  }
   return common_context->graph_guard_condition;
 }
 }  // namespace rmw_fastrtps_shared_cpp
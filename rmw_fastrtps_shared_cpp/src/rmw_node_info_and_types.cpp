@@ -15,6 +15,7 @@
 
 #include <functional>
 #include <map>
+#include <new>
 #include <set>
 #include <string>
 #include <utility>
@@ -37,8 +38,11 @@
 
 #include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
+#include "rmw_fastrtps_shared_cpp/middleware_allocator.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -119,6 +123,10 @@ __rmw_get_topic_names_and_types_by_node(
   if (valid_input != RMW_RET_OK) {
     return valid_input;
   }
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
 
   if (no_demangle) {
@@ -264,4 +272,226 @@ __rmw_get_client_names_and_types_by_node(
     service_names_and_types);
 }
 
+struct NodeQueryHandle
+{
+  rmw_dds_common::Context * common_context;
+  std::string node_name;
+  std::string node_namespace;
+  // Pre-composed query-cache keys, one per query flavor, so the per-poll
+  // path neither rebuilds strings nor re-validates the node coordinates.
+  std::string sub_query_id;
+  std::string sub_raw_query_id;
+  std::string pub_query_id;
+  std::string pub_raw_query_id;
+  std::string srv_query_id;
+  std::string cli_query_id;
+};
+
+rmw_ret_t
+__rmw_node_query_handle_create(
+  const char * identifier,
+  const rmw_node_t * node,
+  const char * node_name,
+  const char * node_namespace,
+  NodeQueryHandle ** handle)
+{
+  if (!node) {
+    RMW_SET_ERROR_MSG("null node handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!node_name) {
+    RMW_SET_ERROR_MSG("null node name");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!node_namespace) {
+    RMW_SET_ERROR_MSG("null node namespace");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!handle) {
+    RMW_SET_ERROR_MSG("null handle output");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (node->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("node handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  rmw_ret_t thread_ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != thread_ret) {
+    return thread_ret;
+  }
+
+  auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
+
+  // The one-time resolution: probe the graph cache so a handle is only
+  // handed out for a node that exists right now.
+  // Internal transient query, so it is backed by the middleware allocator
+  // rather than any caller-facing one.
+  rcutils_allocator_t probe_allocator = middleware_allocator();
+  rmw_names_and_types_t probe = rmw_get_zero_initialized_names_and_types();
+  rmw_ret_t ret = common_context->graph_cache.get_reader_names_and_types_by_node(
+    node_name,
+    node_namespace,
+    _identity_demangle,
+    _identity_demangle,
+    &probe_allocator,
+    &probe);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+  ret = rmw_names_and_types_fini(&probe);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  auto resolved = new (std::nothrow) NodeQueryHandle();
+  if (!resolved) {
+    RMW_SET_ERROR_MSG("failed to allocate NodeQueryHandle");
+    return RMW_RET_BAD_ALLOC;
+  }
+  resolved->common_context = common_context;
+  resolved->node_name = node_name;
+  resolved->node_namespace = node_namespace;
+  const std::string node_key = std::string(node_namespace) + "/" + node_name;
+  resolved->sub_query_id = "node_subs/" + node_key;
+  resolved->sub_raw_query_id = "node_subs_raw/" + node_key;
+  resolved->pub_query_id = "node_pubs/" + node_key;
+  resolved->pub_raw_query_id = "node_pubs_raw/" + node_key;
+  resolved->srv_query_id = "node_srvs/" + node_key;
+  resolved->cli_query_id = "node_clis/" + node_key;
+  *handle = resolved;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_node_query_handle_destroy(NodeQueryHandle * handle)
+{
+  if (!handle) {
+    RMW_SET_ERROR_MSG("null node query handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  delete handle;
+  return RMW_RET_OK;
+}
+
+static rmw_ret_t
+__query_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  const std::string & query_id,
+  DemangleFunction demangle_topic,
+  DemangleFunction demangle_type,
+  GetNamesAndTypesByNodeFunction get_names_and_types_by_node,
+  rmw_names_and_types_t * topic_names_and_types)
+{
+  if (!allocator) {
+    RMW_SET_ERROR_MSG("allocator is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  rmw_ret_t ret = rmw_names_and_types_check_zero(topic_names_and_types);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  // While the graph is unchanged this is served from the generation-stamped
+  // snapshot; a node that vanished invalidates the snapshot through the
+  // graph change callback, so the fresh query reports it gone.
+  return cached_names_and_types_query(
+    handle->common_context,
+    query_id.c_str(),
+    allocator,
+    topic_names_and_types,
+    [&](rmw_names_and_types_t * out) {
+      return get_names_and_types_by_node(
+        handle->common_context,
+        handle->node_name,
+        handle->node_namespace,
+        demangle_topic,
+        demangle_type,
+        allocator,
+        out);
+    });
+}
+
+rmw_ret_t
+__rmw_get_subscriber_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  bool no_demangle,
+  rmw_names_and_types_t * topic_names_and_types)
+{
+  if (!handle) {
+    RMW_SET_ERROR_MSG("null node query handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return __query_by_handle(
+    handle,
+    allocator,
+    no_demangle ? handle->sub_raw_query_id : handle->sub_query_id,
+    no_demangle ? _identity_demangle : _demangle_ros_topic_from_topic,
+    no_demangle ? _identity_demangle : _demangle_if_ros_type,
+    __get_reader_names_and_types_by_node,
+    topic_names_and_types);
+}
+
+rmw_ret_t
+__rmw_get_publisher_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  bool no_demangle,
+  rmw_names_and_types_t * topic_names_and_types)
+{
+  if (!handle) {
+    RMW_SET_ERROR_MSG("null node query handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return __query_by_handle(
+    handle,
+    allocator,
+    no_demangle ? handle->pub_raw_query_id : handle->pub_query_id,
+    no_demangle ? _identity_demangle : _demangle_ros_topic_from_topic,
+    no_demangle ? _identity_demangle : _demangle_if_ros_type,
+    __get_writer_names_and_types_by_node,
+    topic_names_and_types);
+}
+
+rmw_ret_t
+__rmw_get_service_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * service_names_and_types)
+{
+  if (!handle) {
+    RMW_SET_ERROR_MSG("null node query handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return __query_by_handle(
+    handle,
+    allocator,
+    handle->srv_query_id,
+    _demangle_service_request_from_topic,
+    _demangle_service_type_only,
+    __get_reader_names_and_types_by_node,
+    service_names_and_types);
+}
+
+rmw_ret_t
+__rmw_get_client_names_and_types_by_handle(
+  NodeQueryHandle * handle,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * service_names_and_types)
+{
+  if (!handle) {
+    RMW_SET_ERROR_MSG("null node query handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return __query_by_handle(
+    handle,
+    allocator,
+    handle->cli_query_id,
+    _demangle_service_reply_from_topic,
+    _demangle_service_type_only,
+    __get_reader_names_and_types_by_node,
+    service_names_and_types);
+}
+
 }  // namespace rmw_fastrtps_shared_cpp
@@ -30,6 +30,7 @@
 #include "rmw_dds_common/context.hpp"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -59,6 +60,11 @@ __rmw_get_node_names(
     return RMW_RET_ERROR;
   }
 
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   rcutils_allocator_t allocator = rcutils_get_default_allocator();
   return common_context->graph_cache.get_node_names(
@@ -94,6 +100,11 @@ __rmw_get_node_names_with_enclaves(
     return RMW_RET_ERROR;
   }
 
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   rcutils_allocator_t allocator = rcutils_get_default_allocator();
   return common_context->graph_cache.get_node_names(
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <vector>
+
 #include "fastcdr/Cdr.h"
 #include "fastcdr/FastBuffer.h"
 
@@ -21,10 +24,110 @@
 
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/hot_path_checks.hpp"
+#include "rmw_fastrtps_shared_cpp/publisher_allocation.hpp"
+#include "rmw_fastrtps_shared_cpp/tracing.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 namespace rmw_fastrtps_shared_cpp
 {
+static rmw_ret_t
+_publish_with_allocation(
+  CustomPublisherInfo * info,
+  const void * ros_message,
+  PublisherAllocation * pub_allocation)
+{
+  // Sampled timing: at high publish rates the two clock reads per sample
+  // are themselves a measurable cost, so a strided publisher only times a
+  // subset (see EndpointOptions::clock_sample_stride).
+  const bool timed = info->sample_clock_now();
+  std::chrono::steady_clock::time_point start;
+  if (timed) {
+    start = std::chrono::steady_clock::now();
+  }
+
+  size_t data_length = info->type_support_->getEstimatedSerializedSize(
+    ros_message, info->type_support_impl_);
+  if (pub_allocation->buffer.size() < data_length) {
+    pub_allocation->buffer.resize(data_length);
+  }
+
+  eprosima::fastcdr::FastBuffer buffer(pub_allocation->buffer.data(), data_length);
+  eprosima::fastcdr::Cdr ser(
+    buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN, eprosima::fastcdr::Cdr::DDS_CDR);
+  if (!info->type_support_->serializeROSmessage(ros_message, ser, info->type_support_impl_)) {
+    RMW_SET_ERROR_MSG("cannot serialize data");
+    return RMW_RET_ERROR;
+  }
+
+  rmw_fastrtps_shared_cpp::SerializedData data;
+  data.type = rmw_fastrtps_shared_cpp::SerializedData::CDR_BUFFER;
+  data.data = &ser;
+  data.impl = nullptr;    // not used when type is CDR_BUFFER
+  data.compress = info->compress_payloads_;
+  if (!info->publisher_->write(&data)) {
+    // With a bounded max blocking time a failed write on a reliable writer
+    // means the history stayed full past the cap - backpressure from a slow
+    // reader, not a malformed sample; count it so the caller can tell.
+    info->backpressure_count_.fetch_add(1, std::memory_order_relaxed);
+    RMW_SET_ERROR_MSG("cannot publish data");
+    return RMW_RET_ERROR;
+  }
+
+  if (timed) {
+    info->statistics_.record(
+      ser.getSerializedDataLength(),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  } else {
+    info->statistics_.record_untimed(ser.getSerializedDataLength());
+  }
+  RMW_FASTRTPS_TRACEPOINT2(
+    rmw_publish_exit, &info->publisher_->getGuid(), ser.getSerializedDataLength());
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_init_publisher_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    allocation, "allocation pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  auto pub_allocation = new (std::nothrow) PublisherAllocation();
+  if (!pub_allocation) {
+    RMW_SET_ERROR_MSG("failed to allocate PublisherAllocation");
+    return RMW_RET_BAD_ALLOC;
+  }
+  // For bounded types this makes every subsequent publish allocation free;
+  // unbounded types start empty and keep the largest buffer seen so far.
+  pub_allocation->buffer.reserve(max_serialized_size);
+
+  allocation->implementation_identifier = identifier;
+  allocation->data = pub_allocation;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_fini_publisher_allocation(
+  const char * identifier,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    allocation, "allocation pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  if (allocation->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("allocation handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  delete static_cast<PublisherAllocation *>(allocation->data);
+  allocation->data = nullptr;
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 __rmw_publish(
   const char * identifier,
@@ -32,28 +135,164 @@ __rmw_publish(
   const void * ros_message,
   rmw_publisher_allocation_t * allocation)
 {
-  (void) allocation;
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(publisher, "publisher pointer is null", return RMW_RET_ERROR);
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
-    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != publisher, "publisher pointer is null", RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != ros_message, "ros_message pointer is null", RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    publisher->implementation_identifier == identifier,
+    "publisher handle not from this implementation", RMW_RET_ERROR);
 
-  if (publisher->implementation_identifier != identifier) {
-    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
-    return RMW_RET_ERROR;
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != info, "publisher info pointer is null", RMW_RET_ERROR);
+
+  RMW_FASTRTPS_TRACEPOINT1(rmw_publish_entry, &info->publisher_->getGuid());
+
+  if (info->skip_unmatched_ && 0u == info->listener_->subscriptionCount()) {
+    // Nothing is matched, and for this writer (best effort, volatile;
+    // checked at creation) nothing repairs or replays a sample later, so
+    // serializing and writing it is pure waste. A reader matching
+    // concurrently may miss this sample, which best effort already allows.
+    RMW_FASTRTPS_TRACEPOINT2(rmw_publish_exit, &info->publisher_->getGuid(), 0u);
+    return RMW_RET_OK;
   }
 
-  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher info pointer is null", return RMW_RET_ERROR);
+  if (info->publish_pipeline_) {
+    // Serialization happens in the pipeline's slot, overlapping the send of
+    // earlier samples on its sender thread; any allocation scratch is
+    // superseded by the slots.
+    return info->publish_pipeline_->publish(ros_message);
+  }
+
+  if (allocation) {
+    if (allocation->implementation_identifier != identifier) {
+      RMW_SET_ERROR_MSG("allocation handle not from this implementation");
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+    }
+    auto pub_allocation = static_cast<PublisherAllocation *>(allocation->data);
+    if (pub_allocation) {
+      // Serialize into the caller provided scratch buffer, so the exact
+      // serialized size is known when the history payload is allocated.
+      return _publish_with_allocation(info, ros_message, pub_allocation);
+    }
+  }
+
+  // Same sampled-timing policy as the allocation path above.
+  const bool timed = info->sample_clock_now();
+  std::chrono::steady_clock::time_point start;
+  if (timed) {
+    start = std::chrono::steady_clock::now();
+  }
 
   rmw_fastrtps_shared_cpp::SerializedData data;
-  data.is_cdr_buffer = false;
+  data.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
   data.data = const_cast<void *>(ros_message);
   data.impl = info->type_support_impl_;
+  data.compress = info->compress_payloads_;
   if (!info->publisher_->write(&data)) {
+    info->backpressure_count_.fetch_add(1, std::memory_order_relaxed);
     RMW_SET_ERROR_MSG("cannot publish data");
     return RMW_RET_ERROR;
   }
 
+  // Serialization happened inside write(), so the payload size is not at
+  // hand here; 0 marks it as unknown.
+  if (timed) {
+    info->statistics_.record(
+      0u,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  } else {
+    info->statistics_.record_untimed(0u);
+  }
+  RMW_FASTRTPS_TRACEPOINT2(rmw_publish_exit, &info->publisher_->getGuid(), 0u);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_publish_batch(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const void * const * ros_messages,
+  size_t count,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    publisher, "publisher pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_messages, "ros_messages pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher info pointer is null", return RMW_RET_ERROR);
+
+  if (0u == count) {
+    return RMW_RET_OK;
+  }
+
+  // Same unmatched fast path as __rmw_publish; a whole skipped batch also
+  // saves the arena sizing pass below.
+  if (info->skip_unmatched_ && 0u == info->listener_->subscriptionCount()) {
+    return RMW_RET_OK;
+  }
+
+  // Size the whole batch up front so a single contiguous arena covers it.
+  std::vector<size_t> offsets(count + 1);
+  offsets[0] = 0u;
+  for (size_t i = 0; i < count; ++i) {
+    RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+      ros_messages[i], "ros_message pointer in batch is null", return RMW_RET_INVALID_ARGUMENT);
+    offsets[i + 1] = offsets[i] + info->type_support_->getEstimatedSerializedSize(
+      ros_messages[i], info->type_support_impl_);
+  }
+
+  // Reuse the publisher allocation scratch when one is provided.
+  rmw_fastrtps_shared_cpp::SerializationScratchBuffer local_arena;
+  rmw_fastrtps_shared_cpp::SerializationScratchBuffer * arena = &local_arena;
+  if (allocation) {
+    if (allocation->implementation_identifier != identifier) {
+      RMW_SET_ERROR_MSG("allocation handle not from this implementation");
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+    }
+    auto pub_allocation = static_cast<PublisherAllocation *>(allocation->data);
+    if (pub_allocation) {
+      arena = &pub_allocation->buffer;
+    }
+  }
+  if (arena->size() < offsets[count]) {
+    arena->resize(offsets[count]);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    eprosima::fastcdr::FastBuffer buffer(
+      arena->data() + offsets[i], offsets[i + 1] - offsets[i]);
+    eprosima::fastcdr::Cdr ser(
+      buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    if (!info->type_support_->serializeROSmessage(
+        ros_messages[i], ser, info->type_support_impl_))
+    {
+      RMW_SET_ERROR_MSG("cannot serialize data");
+      return RMW_RET_ERROR;
+    }
+
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::CDR_BUFFER;
+    data.data = &ser;
+    data.impl = nullptr;    // not used when type is CDR_BUFFER
+    data.compress = info->compress_payloads_;
+    if (!info->publisher_->write(&data)) {
+      info->backpressure_count_.fetch_add(1, std::memory_order_relaxed);
+      RMW_SET_ERROR_MSG("cannot publish data");
+      return RMW_RET_ERROR;
+    }
+  }
+
   return RMW_RET_OK;
 }
 
@@ -86,15 +325,92 @@ __rmw_publish_serialized_message(
     return RMW_RET_ERROR;
   }
 
+  // The write below copies the caller's buffer exactly once, into the payload
+  // owned by the writer's history (TypeSupport::serialize). The Publisher API
+  // used here has no way to lend or adopt a caller buffer as a history
+  // payload, so that single copy is the floor for this implementation; see
+  // also the loaned-message stubs below.
   rmw_fastrtps_shared_cpp::SerializedData data;
-  data.is_cdr_buffer = true;
+  data.type = rmw_fastrtps_shared_cpp::SerializedData::CDR_BUFFER;
   data.data = &ser;
-  data.impl = nullptr;    // not used when is_cdr_buffer is true
+  data.impl = nullptr;    // not used when type is CDR_BUFFER
+  data.compress = info->compress_payloads_;
   if (!info->publisher_->write(&data)) {
+    info->backpressure_count_.fetch_add(1, std::memory_order_relaxed);
     RMW_SET_ERROR_MSG("cannot publish data");
     return RMW_RET_ERROR;
   }
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_publish_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const void * ros_message,
+  rmw_publisher_allocation_t * allocation)
+{
+  (void) allocation;
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    publisher, "publisher pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  // Loans are never handed out by this implementation (see __rmw_borrow_loaned_message),
+  // so there is no valid loaned message that could be published here.
+  RMW_SET_ERROR_MSG("rmw_fastrtps does not support publishing loaned messages");
+  return RMW_RET_UNSUPPORTED;
+}
+
+rmw_ret_t
+__rmw_borrow_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const rosidl_message_type_support_t * type_support,
+  void ** ros_message)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    publisher, "publisher pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    type_support, "type support pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  // Zero-copy loans would have to be backed by the writer history memory, but the
+  // Fast-RTPS publisher API used here has no way to lend history payloads, and the
+  // type support callbacks cannot construct a ROS message in borrowed memory.
+  RMW_SET_ERROR_MSG("rmw_fastrtps does not support loaned messages");
+  return RMW_RET_UNSUPPORTED;
+}
+
+rmw_ret_t
+__rmw_return_loaned_message_from_publisher(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * loaned_message)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    publisher, "publisher pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    loaned_message, "loaned_message pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  RMW_SET_ERROR_MSG("rmw_fastrtps does not support loaned messages");
+  return RMW_RET_UNSUPPORTED;
+}
 }  // namespace rmw_fastrtps_shared_cpp
@@ -22,6 +22,8 @@
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/publisher.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
@@ -58,17 +60,16 @@ __rmw_destroy_publisher(
 
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   auto info = static_cast<const CustomPublisherInfo *>(publisher->data);
-  {
+  // Once shutdown armed fast teardown, the participant disposal retracts
+  // every entity at once; skip the per-entity snapshot broadcast.
+  if (!node->context->impl->fast_teardown.load(std::memory_order_relaxed)) {
     // Update graph
     std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.dissociate_writer(
       info->publisher_gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      identifier,
-      common_context->pub,
-      &msg,
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       return rmw_ret;
     }
@@ -98,6 +99,51 @@ __rmw_publisher_count_matched_subscriptions(
   return RMW_RET_OK;
 }
 
+rmw_ret_t
+__rmw_publisher_get_backpressure_count(
+  const rmw_publisher_t * publisher,
+  uint64_t * backpressure_count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(backpressure_count, RMW_RET_INVALID_ARGUMENT);
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher internal data is invalid", return RMW_RET_ERROR);
+
+  *backpressure_count = info->backpressure_count_.load(std::memory_order_relaxed);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_publisher_prewarm(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  size_t payload_size,
+  size_t buffer_count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher internal data is invalid", return RMW_RET_ERROR);
+
+  if (0u == payload_size) {
+    payload_size = info->type_support_->m_typeSize;
+  }
+  if (info->publish_pipeline_) {
+    info->publish_pipeline_->prewarm(payload_size);
+  }
+  if (buffer_count > 0u && !FastBufferPool::prewarm(buffer_count, payload_size)) {
+    RMW_SET_ERROR_MSG("failed to grow a pooled buffer while prewarming");
+    return RMW_RET_BAD_ALLOC;
+  }
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 __rmw_publisher_assert_liveliness(
   const char * identifier,
@@ -120,6 +166,40 @@ __rmw_publisher_assert_liveliness(
   return RMW_RET_OK;
 }
 
+rmw_ret_t
+__rmw_publisher_wait_for_acknowledgments(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  const rmw_time_t * wait_timeout)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  if (nullptr == info) {
+    RMW_SET_ERROR_MSG("publisher internal data is invalid");
+    return RMW_RET_ERROR;
+  }
+
+  eprosima::fastrtps::Duration_t max_wait = eprosima::fastrtps::c_TimeInfinite;
+  if (wait_timeout) {
+    max_wait = eprosima::fastrtps::Duration_t(
+      static_cast<int32_t>(wait_timeout->sec),
+      static_cast<uint32_t>(wait_timeout->nsec));
+  }
+
+  // Best-effort writers keep no acknowledgment state; everything counts as
+  // acked, which lets callers treat all publishers uniformly.
+  if (info->publisher_->wait_for_all_acked(max_wait)) {
+    return RMW_RET_OK;
+  }
+  return RMW_RET_TIMEOUT;
+}
+
 rmw_ret_t
 __rmw_publisher_get_actual_qos(
   const rmw_publisher_t * publisher,
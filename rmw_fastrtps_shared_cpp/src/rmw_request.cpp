@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <cassert>
+#include <chrono>
+#include <vector>
 
 #include "fastcdr/Cdr.h"
 #include "fastcdr/FastBuffer.h"
@@ -25,7 +27,9 @@
 
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/guid_utils.hpp"
+#include "rmw_fastrtps_shared_cpp/hugepage_allocator.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
@@ -53,10 +57,11 @@ __rmw_send_request(
   assert(info);
 
   eprosima::fastrtps::rtps::WriteParams wparams;
-  rmw_fastrtps_shared_cpp::SerializedData data;
-  data.is_cdr_buffer = false;
+  rmw_fastrtps_shared_cpp::SerializedData data = info->request_data_template_;
   data.data = const_cast<void *>(ros_request);
-  data.impl = info->request_type_support_impl_;
+  // The sequence number has to come back out of the write: the RTPS writer
+  // assigns it under its own lock, and a client-side counter could disagree
+  // with the order concurrent sends actually reach the history in.
   if (info->request_publisher_->write(&data, wparams)) {
     returnedValue = RMW_RET_OK;
     *sequence_id = ((int64_t)wparams.sample_identity().sequence_number().high) << 32 |
@@ -68,6 +73,79 @@ __rmw_send_request(
   return returnedValue;
 }
 
+rmw_ret_t
+__rmw_send_request_batch(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * const * ros_requests,
+  size_t count,
+  int64_t * sequence_ids)
+{
+  assert(client);
+  assert(ros_requests);
+  assert(sequence_ids);
+
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+  if (0 == count) {
+    RMW_SET_ERROR_MSG("requested count is zero");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  assert(info);
+
+  // Size the whole burst up front so one contiguous arena covers it, the
+  // same shape as __rmw_publish_batch.
+  std::vector<size_t> offsets(count + 1);
+  offsets[0] = 0u;
+  for (size_t i = 0; i < count; ++i) {
+    if (nullptr == ros_requests[i]) {
+      RMW_SET_ERROR_MSG("ros_request pointer in batch is null");
+      return RMW_RET_INVALID_ARGUMENT;
+    }
+    offsets[i + 1] = offsets[i] + info->request_type_support_->getEstimatedSerializedSize(
+      ros_requests[i], info->request_type_support_impl_);
+  }
+  rmw_fastrtps_shared_cpp::SerializationScratchBuffer arena(offsets[count]);
+
+  // Serializing the burst before the first write keeps the per-request
+  // critical section down to the payload copy and the history insertion,
+  // and the back-to-back writes give the RTPS layer consecutive sequence
+  // numbers to cover with shared heartbeat bookkeeping.
+  for (size_t i = 0; i < count; ++i) {
+    eprosima::fastcdr::FastBuffer buffer(
+      arena.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    eprosima::fastcdr::Cdr ser(
+      buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    if (!info->request_type_support_->serializeROSmessage(
+        ros_requests[i], ser, info->request_type_support_impl_))
+    {
+      RMW_SET_ERROR_MSG("cannot serialize request");
+      return RMW_RET_ERROR;
+    }
+
+    eprosima::fastrtps::rtps::WriteParams wparams;
+    rmw_fastrtps_shared_cpp::SerializedData data = info->request_data_template_;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::CDR_BUFFER;
+    data.data = &ser;
+    data.impl = nullptr;    // not used when type is CDR_BUFFER
+    if (!info->request_publisher_->write(&data, wparams)) {
+      // Requests before this one are on the wire with their ids filled; the
+      // caller can await those responses and retry the rest.
+      RMW_SET_ERROR_MSG("cannot publish data");
+      return RMW_RET_ERROR;
+    }
+    sequence_ids[i] = ((int64_t)wparams.sample_identity().sequence_number().high) << 32 |
+      wparams.sample_identity().sequence_number().low;
+  }
+
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 __rmw_take_request(
   const char * identifier,
@@ -94,6 +172,13 @@ __rmw_take_request(
   CustomServiceRequest request = info->listener_->getRequest();
 
   if (request.buffer_ != nullptr) {
+    // Queue residency: how long the request sat between the listener
+    // enqueueing it and this take. The overload backlog shows up here.
+    const auto take_time = std::chrono::steady_clock::now();
+    info->statistics_.record_queue(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        take_time - request.enqueue_time_).count());
+
     eprosima::fastcdr::Cdr deser(*request.buffer_, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
       eprosima::fastcdr::Cdr::DDS_CDR);
     info->request_type_support_->deserializeROSmessage(
@@ -107,11 +192,81 @@ __rmw_take_request(
       ((int64_t)request.sample_identity_.sequence_number().high) <<
       32 | request.sample_identity_.sequence_number().low;
 
-    delete request.buffer_;
+    // Cached so sending the reply reuses this identity instead of rebuilding
+    // it from the header bytes.
+    info->remember_pending_reply(
+      request.sample_identity_, request_header->request_id, take_time);
+
+    FastBufferPool::release(request.buffer_);
 
     *taken = true;
   }
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_take_request_batch(
+  const char * identifier,
+  const rmw_service_t * service,
+  rmw_service_info_t * request_headers,
+  void ** ros_requests,
+  size_t count,
+  size_t * taken)
+{
+  assert(service);
+  assert(request_headers);
+  assert(ros_requests);
+  assert(taken);
+
+  *taken = 0;
+
+  if (service->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+  if (0 == count) {
+    RMW_SET_ERROR_MSG("requested count is zero");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto info = static_cast<CustomServiceInfo *>(service->data);
+  assert(info);
+
+  // Dequeue and deserialize until the queue runs dry or the caller's arrays
+  // are full, so one wakeup of a busy server thread handles a whole burst.
+  while (*taken < count) {
+    CustomServiceRequest request = info->listener_->getRequest();
+    if (nullptr == request.buffer_) {
+      break;
+    }
+
+    const auto take_time = std::chrono::steady_clock::now();
+    info->statistics_.record_queue(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        take_time - request.enqueue_time_).count());
+
+    rmw_service_info_t * request_header = &request_headers[*taken];
+    eprosima::fastcdr::Cdr deser(*request.buffer_, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    info->request_type_support_->deserializeROSmessage(
+      deser, ros_requests[*taken], info->request_type_support_impl_);
+
+    rmw_fastrtps_shared_cpp::copy_from_fastrtps_guid_to_byte_array(
+      request.sample_identity_.writer_guid(),
+      request_header->request_id.writer_guid);
+    request_header->request_id.sequence_number =
+      ((int64_t)request.sample_identity_.sequence_number().high) <<
+      32 | request.sample_identity_.sequence_number().low;
+
+    info->remember_pending_reply(
+      request.sample_identity_, request_header->request_id, take_time);
+
+    FastBufferPool::release(request.buffer_);
+
+    ++(*taken);
+  }
+
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 #include "fastcdr/Cdr.h"
+#include "fastcdr/FastBuffer.h"
 
 #include "fastrtps/subscriber/Subscriber.h"
 
@@ -23,10 +28,13 @@
 
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/guid_utils.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "waitset_attachment.hpp"
+
 namespace rmw_fastrtps_shared_cpp
 {
 rmw_ret_t
@@ -54,6 +62,10 @@ __rmw_take_response(
 
   CustomClientResponse response;
 
+  // Responses are delivered in arrival order; the listener already filtered
+  // them to this client's writer GUID, and pairing a response with its
+  // outstanding request is done by the caller via the returned sequence
+  // number. No per-take search happens here.
   if (info->listener_->getResponse(response)) {
     eprosima::fastcdr::Cdr deser(
       *response.buffer_,
@@ -74,6 +86,164 @@ __rmw_take_response(
   return RMW_RET_OK;
 }
 
+rmw_ret_t
+__rmw_take_response_batch(
+  const char * identifier,
+  const rmw_client_t * client,
+  rmw_service_info_t * response_headers,
+  void ** ros_responses,
+  size_t count,
+  size_t * taken)
+{
+  assert(client);
+  assert(response_headers);
+  assert(ros_responses);
+  assert(taken);
+
+  *taken = 0;
+
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+  if (0 == count) {
+    RMW_SET_ERROR_MSG("requested count is zero");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  assert(info);
+
+  // Drain completed responses until the queue runs dry or the caller's
+  // arrays are full; a client with many requests in flight collects a whole
+  // burst of replies per call. Pairing each response with its outstanding
+  // request stays with the caller, through the returned sequence numbers.
+  CustomClientResponse response;
+  while (*taken < count && info->listener_->getResponse(response)) {
+    rmw_service_info_t * response_header = &response_headers[*taken];
+    eprosima::fastcdr::Cdr deser(
+      *response.buffer_,
+      eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    info->response_type_support_->deserializeROSmessage(
+      deser, ros_responses[*taken], info->response_type_support_impl_);
+
+    response_header->source_timestamp = response.sample_info_.sourceTimestamp.to_ns();
+    response_header->received_timestamp = response.sample_info_.receptionTimestamp.to_ns();
+    response_header->request_id.sequence_number =
+      ((int64_t)response.sample_identity_.sequence_number().high) <<
+      32 | response.sample_identity_.sequence_number().low;
+
+    ++(*taken);
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_client_call(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * ros_request,
+  rmw_service_info_t * response_header,
+  void * ros_response,
+  const rmw_time_t * wait_timeout,
+  bool * taken)
+{
+  assert(client);
+  assert(ros_request);
+  assert(response_header);
+  assert(ros_response);
+  assert(taken);
+
+  *taken = false;
+
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  assert(info);
+
+  int64_t sequence_number = 0;
+  rmw_ret_t ret = __rmw_send_request(identifier, client, ros_request, &sequence_number);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  std::chrono::steady_clock::time_point deadline;
+  if (wait_timeout) {
+    deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds(wait_timeout->sec) + std::chrono::nanoseconds(wait_timeout->nsec);
+  }
+
+  // Park directly on the listener with a stack-held condition: the same
+  // handshake a wait set performs, minus attaching and detaching every other
+  // entity and the cross-thread handoff through the wait-set flag. A wait set
+  // may still cache this client from an earlier generic wait, so evict that
+  // attachment first; its next wait re-attaches.
+  std::mutex condition_mutex;
+  std::condition_variable condition_variable;
+  std::atomic_bool condition_ready(false);
+  waitset_forget_entity(info);
+  info->listener_->attachCondition(&condition_mutex, &condition_variable, &condition_ready);
+
+  CustomClientResponse response;
+  bool matched = false;
+  while (!matched && RMW_RET_OK == ret) {
+    while (info->listener_->getResponse(response)) {
+      const int64_t response_sequence =
+        (static_cast<int64_t>(response.sample_identity_.sequence_number().high) << 32) |
+        response.sample_identity_.sequence_number().low;
+      if (response_sequence == sequence_number) {
+        matched = true;
+        break;
+      }
+      // A response to an earlier request nobody awaits any more, e.g. one
+      // whose fused call timed out; dropping it returns the pooled buffer.
+    }
+    if (matched) {
+      break;
+    }
+    std::unique_lock<std::mutex> lock(condition_mutex);
+    // Clear the flag before the recheck: a response pushed earlier is found
+    // by the recheck, one pushed later raises the flag under the mutex.
+    condition_ready.store(false);
+    if (info->listener_->hasData()) {
+      continue;
+    }
+    auto predicate = [&condition_ready]() {
+        return condition_ready.load();
+      };
+    if (wait_timeout) {
+      if (!condition_variable.wait_until(lock, deadline, predicate)) {
+        ret = RMW_RET_TIMEOUT;
+      }
+    } else {
+      condition_variable.wait(lock, predicate);
+    }
+  }
+  info->listener_->detachCondition();
+
+  if (matched) {
+    eprosima::fastcdr::Cdr deser(
+      *response.buffer_,
+      eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    info->response_type_support_->deserializeROSmessage(
+      deser, ros_response, info->response_type_support_impl_);
+
+    response_header->source_timestamp = response.sample_info_.sourceTimestamp.to_ns();
+    response_header->received_timestamp = response.sample_info_.receptionTimestamp.to_ns();
+    response_header->request_id.sequence_number = sequence_number;
+
+    *taken = true;
+  }
+
+  return ret;
+}
+
 rmw_ret_t
 __rmw_send_response(
   const char * identifier,
@@ -96,16 +266,67 @@ __rmw_send_response(
   assert(info);
 
   eprosima::fastrtps::rtps::WriteParams wparams;
-  rmw_fastrtps_shared_cpp::copy_from_byte_array_to_fastrtps_guid(
-    request_header->writer_guid,
-    &wparams.related_sample_identity().writer_guid());
-  wparams.related_sample_identity().sequence_number().high =
-    (int32_t)((request_header->sequence_number & 0xFFFFFFFF00000000) >> 32);
-  wparams.related_sample_identity().sequence_number().low =
-    (int32_t)(request_header->sequence_number & 0xFFFFFFFF);
+  // The identity was cached when the request was taken; only replies to
+  // requests this process never took, or old enough to have been evicted
+  // from the cache, rebuild it from the header bytes.
+  std::chrono::steady_clock::time_point take_time;
+  if (!info->take_pending_reply(
+      *request_header, &wparams.related_sample_identity(), &take_time))
+  {
+    rmw_fastrtps_shared_cpp::copy_from_byte_array_to_fastrtps_guid(
+      request_header->writer_guid,
+      &wparams.related_sample_identity().writer_guid());
+    wparams.related_sample_identity().sequence_number().high =
+      (int32_t)((request_header->sequence_number & 0xFFFFFFFF00000000) >> 32);
+    wparams.related_sample_identity().sequence_number().low =
+      (int32_t)(request_header->sequence_number & 0xFFFFFFFF);
+  } else {
+    // Handler duration: take to response. Replies whose identity was
+    // evicted from the cache are sent untimed rather than guessed at.
+    info->statistics_.record_handler(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - take_time).count());
+  }
+
+  // Multi-threaded servers serialize the response here, outside the
+  // writer's internal lock, so workers only contend on the payload memcpy
+  // and the history insertion instead of on the whole serialization. The
+  // single-threaded path keeps serializing straight into the history
+  // payload, with no extra copy.
+  if (info->sending_concurrently()) {
+    rmw_fastrtps_shared_cpp::PooledFastBufferPtr scratch(
+      rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+    const size_t data_length = info->response_type_support_->getEstimatedSerializedSize(
+      ros_response, info->response_type_support_impl_);
+    if (scratch->getBufferSize() < data_length) {
+      if (!scratch->reserve(data_length) && !scratch->resize(data_length)) {
+        RMW_SET_ERROR_MSG("cannot grow buffer for response serialization");
+        return RMW_RET_ERROR;
+      }
+    }
+    eprosima::fastcdr::FastBuffer buffer(scratch->getBuffer(), data_length);
+    eprosima::fastcdr::Cdr ser(
+      buffer, rmw_fastrtps_shared_cpp::kSerializationEndianness,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    if (!info->response_type_support_->serializeROSmessage(
+        ros_response, ser, info->response_type_support_impl_))
+    {
+      RMW_SET_ERROR_MSG("cannot serialize response");
+      return RMW_RET_ERROR;
+    }
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::CDR_BUFFER;
+    data.data = &ser;
+    data.impl = nullptr;    // not used when type is CDR_BUFFER
+    if (info->response_publisher_->write(&data, wparams)) {
+      return RMW_RET_OK;
+    }
+    RMW_SET_ERROR_MSG("cannot publish data");
+    return RMW_RET_ERROR;
+  }
 
   rmw_fastrtps_shared_cpp::SerializedData data;
-  data.is_cdr_buffer = false;
+  data.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
   data.data = const_cast<void *>(ros_response);
   data.impl = info->response_type_support_impl_;
   if (info->response_publisher_->write(&data, wparams)) {
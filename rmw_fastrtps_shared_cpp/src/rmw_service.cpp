@@ -28,17 +28,23 @@
 #include "rcutils/logging_macros.h"
 
 #include "rmw/allocators.h"
+#include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
 #include "rmw_fastrtps_shared_cpp/create_rmw_gid.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "waitset_attachment.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -65,7 +71,9 @@ __rmw_destroy_service(
   }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   auto info = static_cast<CustomServiceInfo *>(service->data);
-  {
+  // Once shutdown armed fast teardown, the participant disposal retracts
+  // every entity at once; skip the per-entity snapshot broadcast.
+  if (!node->context->impl->fast_teardown.load(std::memory_order_relaxed)) {
     // Update graph
     std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
     rmw_gid_t gid = rmw_fastrtps_shared_cpp::create_rmw_gid(
@@ -80,17 +88,15 @@ __rmw_destroy_service(
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.dissociate_writer(
       gid, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      identifier,
-      common_context->pub,
-      &msg,
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       return rmw_ret;
     }
   }
 
   if (info != nullptr) {
+    waitset_forget_entity(info);
     if (info->request_subscriber_ != nullptr) {
       Domain::removeSubscriber(info->request_subscriber_);
     }
@@ -110,11 +116,93 @@ __rmw_destroy_service(
     delete info;
   }
   if (service->service_name != nullptr) {
-    rmw_free(const_cast<char *>(service->service_name));
+    handle_pool_release(const_cast<char *>(service->service_name));
     service->service_name = nullptr;
   }
-  rmw_service_free(service);
+  handle_pool_release(service);
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_service_has_request(
+  const char * identifier,
+  const rmw_service_t * service,
+  bool * has_request)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(has_request, RMW_RET_INVALID_ARGUMENT);
+  if (service->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomServiceInfo *>(service->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom service info is null", return RMW_RET_ERROR);
+
+  *has_request = info->listener_->hasData();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_service_set_admission_control(
+  const char * identifier,
+  const rmw_service_t * service,
+  size_t max_queue_depth,
+  int64_t max_request_age_ns)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
+  if (service->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+  if (max_request_age_ns < 0) {
+    RMW_SET_ERROR_MSG("max_request_age_ns must not be negative");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto info = static_cast<CustomServiceInfo *>(service->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom service info is null", return RMW_RET_ERROR);
+
+  info->listener_->setAdmissionControl(max_queue_depth, max_request_age_ns);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_service_get_shed_count(
+  const char * identifier,
+  const rmw_service_t * service,
+  uint64_t * shed_count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(shed_count, RMW_RET_INVALID_ARGUMENT);
+  if (service->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomServiceInfo *>(service->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom service info is null", return RMW_RET_ERROR);
+
+  *shed_count = info->listener_->shedCount();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_service_trim(
+  const char * identifier,
+  const rmw_service_t * service)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
+  if (service->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("service handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomServiceInfo *>(service->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom service info is null", return RMW_RET_ERROR);
 
+  info->listener_->trimNodeCache();
   return RMW_RET_OK;
 }
 }  // namespace rmw_fastrtps_shared_cpp
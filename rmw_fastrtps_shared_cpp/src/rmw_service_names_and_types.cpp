@@ -25,6 +25,8 @@
 
 #include "rmw_dds_common/context.hpp"
 
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -57,12 +59,24 @@ __rmw_get_service_names_and_types(
     return RMW_RET_ERROR;
   }
 
+  ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
 
-  return common_context->graph_cache.get_names_and_types(
-    _demangle_service_from_topic,
-    _demangle_service_type_only,
+  return cached_names_and_types_query(
+    common_context,
+    "services",
     allocator,
-    service_names_and_types);
+    service_names_and_types,
+    [&](rmw_names_and_types_t * out) {
+      return common_context->graph_cache.get_names_and_types(
+        _demangle_service_from_topic,
+        _demangle_service_type_only,
+        allocator,
+        out);
+    });
 }
 }  // namespace rmw_fastrtps_shared_cpp
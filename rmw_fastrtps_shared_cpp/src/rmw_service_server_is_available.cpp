@@ -13,6 +13,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <mutex>
 #include <string>
 
 #include "fastrtps/subscriber/Subscriber.h"
@@ -29,6 +31,7 @@
 
 #include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
@@ -67,13 +70,31 @@ __rmw_service_server_is_available(
     return RMW_RET_ERROR;
   }
 
+  *is_available = false;
+
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  // The matched counts are maintained by the client's listeners, so checking
+  // them first keeps the common polling case (server not up yet) free of any
+  // graph cache locking.
+  if (0 == client_info->request_publisher_matched_count_.load()) {
+    // not ready
+    return RMW_RET_OK;
+  }
+  if (0 == client_info->response_subscriber_matched_count_.load()) {
+    // not ready
+    return RMW_RET_OK;
+  }
+
   auto pub_topic_name =
     client_info->request_publisher_->getAttributes().topic.getTopicName().to_string();
 
   auto sub_topic_name =
     client_info->response_subscriber_->getAttributes().topic.getTopicName().to_string();
 
-  *is_available = false;
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
 
   size_t number_of_request_subscribers = 0;
@@ -100,17 +121,62 @@ __rmw_service_server_is_available(
     return RMW_RET_OK;
   }
 
-  if (0 == client_info->request_publisher_matched_count_.load()) {
-    // not ready
-    return RMW_RET_OK;
-  }
-  if (0 == client_info->response_subscriber_matched_count_.load()) {
-    // not ready
-    return RMW_RET_OK;
-  }
-
   // all conditions met, there is a service server available
   *is_available = true;
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_client_wait_for_service_server(
+  const char * identifier,
+  const rmw_node_t * node,
+  const rmw_client_t * client,
+  const rmw_time_t * wait_timeout,
+  bool * is_available)
+{
+  rmw_ret_t ret = __rmw_service_server_is_available(identifier, node, client, is_available);
+  if (RMW_RET_OK != ret || *is_available) {
+    return ret;
+  }
+
+  auto client_info = static_cast<CustomClientInfo *>(client->data);
+
+  std::chrono::steady_clock::time_point deadline;
+  if (wait_timeout) {
+    deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds(wait_timeout->sec) + std::chrono::nanoseconds(wait_timeout->nsec);
+  }
+
+  // Block on the matching notification instead of having the caller poll.
+  // Each wakeup re-runs the full availability check, since the graph cache
+  // may briefly lag the listener counts; while it does, retry on a short
+  // bounded wait rather than spinning.
+  auto matched = [client_info]() {
+      return 0 != client_info->request_publisher_matched_count_.load() &&
+             0 != client_info->response_subscriber_matched_count_.load();
+    };
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(client_info->matched_mutex_);
+      if (!matched()) {
+        if (wait_timeout) {
+          if (!client_info->matched_cv_.wait_until(lock, deadline, matched)) {
+            return RMW_RET_TIMEOUT;
+          }
+        } else {
+          client_info->matched_cv_.wait(lock, matched);
+        }
+      } else {
+        client_info->matched_cv_.wait_for(lock, std::chrono::milliseconds(10));
+      }
+    }
+    ret = __rmw_service_server_is_available(identifier, node, client, is_available);
+    if (RMW_RET_OK != ret || *is_available) {
+      return ret;
+    }
+    if (wait_timeout && std::chrono::steady_clock::now() >= deadline) {
+      return RMW_RET_TIMEOUT;
+    }
+  }
+}
 }  // namespace rmw_fastrtps_shared_cpp
@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <utility>
 #include <string>
 
@@ -24,6 +25,8 @@
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
+#include "rmw_fastrtps_shared_cpp/graph_announce.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
@@ -60,17 +63,16 @@ __rmw_destroy_subscription(
 
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
   auto info = static_cast<const CustomSubscriberInfo *>(subscription->data);
-  {
+  // Once shutdown armed fast teardown, the participant disposal retracts
+  // every entity at once; skip the per-entity snapshot broadcast.
+  if (!node->context->impl->fast_teardown.load(std::memory_order_relaxed)) {
     // Update graph
     std::lock_guard<std::mutex> guard(common_context->node_update_mutex);
     rmw_dds_common::msg::ParticipantEntitiesInfo msg =
       common_context->graph_cache.dissociate_reader(
       info->subscription_gid_, common_context->gid, node->name, node->namespace_);
-    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::__rmw_publish(
-      identifier,
-      common_context->pub,
-      static_cast<void *>(&msg),
-      nullptr);
+    rmw_ret_t rmw_ret = rmw_fastrtps_shared_cpp::graph_announce(
+      identifier, common_context, &msg);
     if (RMW_RET_OK != rmw_ret) {
       return rmw_ret;
     }
@@ -99,6 +101,244 @@ __rmw_subscription_count_matched_publishers(
   return RMW_RET_OK;
 }
 
+rmw_ret_t
+__rmw_subscription_has_data(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  bool * has_data)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(has_data, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  // The listener predicate already folds in the spill queue, so samples the
+  // history extension or arrival prefetch moved out of the reader history
+  // still count as data.
+  *has_data = info->listener_->hasData();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_prewarm(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t payload_size,
+  size_t buffer_count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  if (0u == payload_size) {
+    payload_size = info->type_support_->m_typeSize;
+  }
+  if (buffer_count > 0u && !FastBufferPool::prewarm(buffer_count, payload_size)) {
+    RMW_SET_ERROR_MSG("failed to grow a pooled buffer while prewarming");
+    return RMW_RET_BAD_ALLOC;
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_trim(
+  const char * identifier,
+  const rmw_subscription_t * subscription)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  info->trim_spilled();
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_loan_pool(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * const * ros_messages,
+  size_t count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (count > 0 && !ros_messages) {
+    RMW_SET_ERROR_MSG("ros_messages array is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  info->set_loanable_messages(ros_messages, count);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_content_filter(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  SerializedDataFilter filter)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  std::shared_ptr<const SerializedDataFilter> new_filter;
+  if (filter) {
+    new_filter = std::make_shared<const SerializedDataFilter>(std::move(filter));
+  }
+  // Takes in flight hold their own reference, so swapping never invalidates
+  // a filter that is currently running.
+  std::atomic_store(&info->content_filter_, new_filter);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_take_newest(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  bool take_newest)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  info->take_newest_.store(take_newest, std::memory_order_relaxed);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_arrival_prefetch(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  bool prefetch)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  // Disabling leaves samples already extracted in the overflow; takes drain
+  // them normally, so no sample is lost across a toggle.
+  info->arrival_prefetch_.store(prefetch, std::memory_order_relaxed);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_backlog_watermark(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  uint64_t high_watermark)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  info->listener_->set_backlog_watermark(high_watermark);
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_history_extension(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t extra_capacity)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  info->spill_capacity_.store(extra_capacity, std::memory_order_relaxed);
+  if (0 == extra_capacity) {
+    // Lowering only gates new spills, but zero means off; release the
+    // samples held so their buffers return to the pool.
+    info->clear_spilled();
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_subscription_set_direct_dispatch(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  SubscriptionDirectDispatch dispatch)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  if (!dispatch.borrow_message && !dispatch.return_message && !dispatch.on_message) {
+    // Disable the gate first so receptions stop taking the fast path, then
+    // drop the callbacks; a reception that already loaded them holds its own
+    // reference and finishes safely.
+    info->listener_->set_direct_dispatch_enabled(false);
+    std::shared_ptr<const SubscriptionDirectDispatch> empty;
+    std::atomic_store(&info->direct_dispatch_, empty);
+    return RMW_RET_OK;
+  }
+  if (!dispatch.borrow_message || !dispatch.return_message || !dispatch.on_message) {
+    RMW_SET_ERROR_MSG(
+      "direct dispatch needs borrow_message, return_message and on_message");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  dispatch.implementation_identifier = identifier;
+  auto new_dispatch =
+    std::make_shared<const SubscriptionDirectDispatch>(std::move(dispatch));
+  // Publish the callbacks before raising the gate the reception path checks.
+  std::atomic_store(&info->direct_dispatch_, new_dispatch);
+  info->listener_->set_direct_dispatch_enabled(true);
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 __rmw_subscription_get_actual_qos(
   const rmw_subscription_t * subscription,
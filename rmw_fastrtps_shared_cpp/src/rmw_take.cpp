@@ -12,6 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/serialized_message.h"
@@ -25,12 +37,39 @@
 #include "fastcdr/FastBuffer.h"
 
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/fastbuffer_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/guid_utils.hpp"
+#include "rmw_fastrtps_shared_cpp/hot_path_checks.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/subscription_allocation.hpp"
+#include "rmw_fastrtps_shared_cpp/tracing.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "waitset_attachment.hpp"
+
 namespace rmw_fastrtps_shared_cpp
 {
+static
+void
+_assign_writer_gid(
+  const char * identifier,
+  rmw_gid_t * sender_gid,
+  const eprosima::fastrtps::rtps::GUID_t & writer_guid)
+{
+  sender_gid->implementation_identifier = identifier;
+
+  rmw_fastrtps_shared_cpp::copy_from_fastrtps_guid_to_byte_array(
+    writer_guid,
+    sender_gid->data);
+  // The copy above fills the first 16 bytes (guid prefix plus entity id);
+  // only the tail of the storage needs zeroing.
+  constexpr size_t guid_size =
+    sizeof(eprosima::fastrtps::rtps::GuidPrefix_t::value) +
+    eprosima::fastrtps::rtps::EntityId_t::size;
+  static_assert(guid_size <= RMW_GID_STORAGE_SIZE, "rmw gid storage too small for a DDS guid");
+  memset(sender_gid->data + guid_size, 0, RMW_GID_STORAGE_SIZE - guid_size);
+}
+
 void
 _assign_message_info(
   const char * identifier,
@@ -39,13 +78,83 @@ _assign_message_info(
 {
   message_info->source_timestamp = sinfo->sourceTimestamp.to_ns();
   message_info->received_timestamp = sinfo->receptionTimestamp.to_ns();
-  rmw_gid_t * sender_gid = &message_info->publisher_gid;
-  sender_gid->implementation_identifier = identifier;
-  memset(sender_gid->data, 0, RMW_GID_STORAGE_SIZE);
+  _assign_writer_gid(
+    identifier, &message_info->publisher_gid, sinfo->sample_identity.writer_guid());
+}
 
-  rmw_fastrtps_shared_cpp::copy_from_fastrtps_guid_to_byte_array(
-    sinfo->sample_identity.writer_guid(),
-    sender_gid->data);
+/// Whether takes deserialize outside the reader history mutex.
+/**
+ * Fast-RTPS runs TypeSupport::deserialize() while it still holds the reader
+ * history mutex, so concurrent takes on one subscription serialize on the
+ * deserialization of large messages. With
+ * RMW_FASTRTPS_PARALLEL_DESERIALIZE=1 a take instead copies the raw CDR
+ * payload into a pooled buffer under the mutex (a memcpy) and deserializes
+ * after releasing it, so the caller's executor threads deserialize a backlog
+ * in parallel and the reception thread is never blocked behind a decode.
+ * Subscriptions with a content filter keep the in-history path, where the
+ * filter drops samples before they are decoded.
+ */
+static
+bool
+_parallel_deserialize_enabled()
+{
+  static const bool enabled = []() {
+      const char * env_value;
+      const char * error_str;
+      error_str = rcutils_get_env("RMW_FASTRTPS_PARALLEL_DESERIALIZE", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return false;
+      }
+      return env_value != nullptr && strcmp(env_value, "1") == 0;
+    }();
+  return enabled;
+}
+
+rmw_ret_t
+__rmw_init_subscription_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_subscription_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    allocation, "allocation pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  auto sub_allocation = new (std::nothrow) SubscriptionAllocation();
+  if (!sub_allocation) {
+    RMW_SET_ERROR_MSG("failed to allocate SubscriptionAllocation");
+    return RMW_RET_BAD_ALLOC;
+  }
+  // For bounded types this makes every subsequent take allocation free;
+  // unbounded types start empty and keep the largest buffer seen so far.
+  if (max_serialized_size > 0 && !sub_allocation->buffer.reserve(max_serialized_size)) {
+    delete sub_allocation;
+    RMW_SET_ERROR_MSG("failed to reserve subscription allocation buffer");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  allocation->implementation_identifier = identifier;
+  allocation->data = sub_allocation;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_fini_subscription_allocation(
+  const char * identifier,
+  rmw_subscription_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    allocation, "allocation pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  if (allocation->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("allocation handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+
+  delete static_cast<SubscriptionAllocation *>(allocation->data);
+  allocation->data = nullptr;
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
@@ -57,34 +166,186 @@ _take(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation)
 {
-  (void) allocation;
   *taken = false;
 
-  if (subscription->implementation_identifier != identifier) {
-    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
-    return RMW_RET_ERROR;
+  SubscriptionAllocation * sub_allocation = nullptr;
+  if (allocation) {
+    if (allocation->implementation_identifier != identifier) {
+      RMW_SET_ERROR_MSG("allocation handle not from this implementation");
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+    }
+    sub_allocation = static_cast<SubscriptionAllocation *>(allocation->data);
   }
 
+  RMW_FASTRTPS_CHECK_HANDLE(
+    subscription->implementation_identifier == identifier,
+    "subscription handle not from this implementation", RMW_RET_ERROR);
+
   CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != info, "custom subscriber info is null", RMW_RET_ERROR);
+
+  RMW_FASTRTPS_TRACEPOINT1(rmw_take_entry, &info->subscriber_->getGuid());
+
+  auto start = std::chrono::steady_clock::now();
 
   eprosima::fastrtps::SampleInfo_t sinfo;
 
-  rmw_fastrtps_shared_cpp::SerializedData data;
-  data.is_cdr_buffer = false;
-  data.data = ros_message;
-  data.impl = info->type_support_impl_;
-  if (info->subscriber_->takeNextData(&data, &sinfo)) {
-    info->listener_->data_taken(info->subscriber_);
+  auto content_filter = std::atomic_load(&info->content_filter_);
 
-    if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+  if (info->take_newest_.load(std::memory_order_relaxed)) {
+    // Spilled samples are the oldest of all; in take-newest mode they are
+    // exactly the stale backlog the caller wants skipped.
+    if (info->spill_size_.load(std::memory_order_relaxed) > 0) {
+      info->clear_spilled();
+    }
+    // Consume everything but the newest unread sample through the discard
+    // path; each iteration marks a stale sample read without copying or
+    // decoding it. Samples arriving concurrently only shorten the skip.
+    auto unread_count = info->subscriber_->get_unread_count();
+    uint64_t discarded = 0;
+    while (unread_count-- > 1) {
+      rmw_fastrtps_shared_cpp::SerializedData discard;
+      discard.type = rmw_fastrtps_shared_cpp::SerializedData::DISCARD;
+      discard.data = nullptr;
+      discard.impl = nullptr;
+      if (!info->subscriber_->takeNextData(&discard, &sinfo)) {
+        break;
+      }
+      info->listener_->pop_arrival_stamp();
+      ++discarded;
+    }
+    if (discarded > 0) {
+      info->listener_->data_taken(info->subscriber_, discarded);
+    }
+  }
+
+  // Samples rescued from a full history by the history extension predate
+  // everything still in the history; drain them first to preserve ordering.
+  if (info->spill_size_.load(std::memory_order_relaxed) > 0) {
+    rmw_fastrtps_shared_cpp::SpilledSample spilled;
+    while (!*taken && info->take_spilled(&spilled)) {
+      if (content_filter && *content_filter &&
+        !(*content_filter)(
+          reinterpret_cast<const uint8_t *>(spilled.buffer->getBuffer()),
+          spilled.length))
+      {
+        continue;
+      }
+      eprosima::fastcdr::Cdr deser(
+        *spilled.buffer,
+        eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+        eprosima::fastcdr::Cdr::DDS_CDR);
+      if (!info->type_support_->deserializeROSmessage(
+          deser, ros_message, info->type_support_impl_))
+      {
+        RMW_SET_ERROR_MSG("failed to deserialize spilled sample");
+        return RMW_RET_ERROR;
+      }
       if (message_info) {
-        _assign_message_info(identifier, message_info, &sinfo);
+        _assign_message_info(identifier, message_info, &spilled.sample_info);
+        if (0 != spilled.arrival_timestamp) {
+          message_info->received_timestamp = spilled.arrival_timestamp;
+        }
       }
       *taken = true;
     }
+    if (*taken) {
+      info->statistics_.record(
+        0u,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start).count());
+      RMW_FASTRTPS_TRACEPOINT2(rmw_take_exit, &info->subscriber_->getGuid(), *taken);
+      return RMW_RET_OK;
+    }
+  }
+
+  if (!content_filter && (nullptr != sub_allocation || _parallel_deserialize_enabled())) {
+    // A caller-provided allocation supplies the scratch buffer; otherwise it
+    // comes from the shared pool. Takes with an allocation always go through
+    // this path: the scratch is preallocated exactly so the take touches
+    // neither the pool nor the allocator.
+    rmw_fastrtps_shared_cpp::PooledFastBufferPtr pooled;
+    eprosima::fastcdr::FastBuffer * buffer;
+    if (sub_allocation) {
+      buffer = &sub_allocation->buffer;
+    } else {
+      pooled.reset(rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+      buffer = pooled.get();
+    }
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
+    data.data = buffer;
+    data.impl = nullptr;    // not used when type is FAST_BUFFER
+    if (info->subscriber_->takeNextData(&data, &sinfo)) {
+      info->listener_->data_taken(info->subscriber_);
+      const int64_t arrival = info->listener_->pop_arrival_stamp();
+
+      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+        // Only the payload copy above ran under the history mutex; from here
+        // on other threads take and decode this subscription concurrently.
+        eprosima::fastcdr::Cdr deser(
+          *buffer,
+          eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+          eprosima::fastcdr::Cdr::DDS_CDR);
+        if (!info->type_support_->deserializeROSmessage(
+            deser, ros_message, info->type_support_impl_))
+        {
+          RMW_SET_ERROR_MSG("failed to deserialize taken sample");
+          return RMW_RET_ERROR;
+        }
+        if (message_info) {
+          _assign_message_info(identifier, message_info, &sinfo);
+          if (0 != arrival) {
+            message_info->received_timestamp = arrival;
+          }
+        }
+        *taken = true;
+      }
+    } else {
+      // An empty take while the shadow count claimed data: resync it so the
+      // wait set stops waking for samples that are not there.
+      info->listener_->sync_unread_count(info->subscriber_);
+    }
+  } else {
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
+    data.data = ros_message;
+    data.impl = info->type_support_impl_;
+    data.filter = content_filter.get();
+    if (info->subscriber_->takeNextData(&data, &sinfo)) {
+      info->listener_->data_taken(info->subscriber_);
+      const int64_t arrival = info->listener_->pop_arrival_stamp();
+
+      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+        if (message_info) {
+          _assign_message_info(identifier, message_info, &sinfo);
+          if (0 != arrival) {
+            message_info->received_timestamp = arrival;
+          }
+        }
+        *taken = true;
+      }
+    } else if (data.filter) {
+      // takeNextData also comes back false when the content filter dropped
+      // the sample, which still consumed it from the history.
+      info->listener_->data_taken(info->subscriber_);
+      info->listener_->pop_arrival_stamp();
+    } else {
+      // An empty take while the shadow count claimed data: resync it so the
+      // wait set stops waking for samples that are not there.
+      info->listener_->sync_unread_count(info->subscriber_);
+    }
   }
 
+  if (*taken) {
+    // Deserialization happens in place, so only the time is observable here.
+    info->statistics_.record(
+      0u,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  }
+  RMW_FASTRTPS_TRACEPOINT2(rmw_take_exit, &info->subscriber_->getGuid(), *taken);
   return RMW_RET_OK;
 }
 
@@ -98,9 +359,8 @@ _take_sequence(
   size_t * taken,
   rmw_subscription_allocation_t * allocation)
 {
+  (void) allocation;
   *taken = 0;
-  bool taken_flag = false;
-  rmw_ret_t ret = RMW_RET_OK;
 
   if (subscription->implementation_identifier != identifier) {
     RMW_SET_ERROR_MSG("publisher handle not from this implementation");
@@ -110,33 +370,144 @@ _take_sequence(
   CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
 
-  // Limit the upper bound of reads to the number unread at the beginning.
-  // This prevents any samples that are added after the beginning of the
-  // _take_sequence call from being read.
+  auto content_filter = std::atomic_load(&info->content_filter_);
+
+  // Samples rescued from a full history by the history extension predate
+  // everything still in the history; drain them into the sequence first to
+  // preserve ordering.
+  if (info->spill_size_.load(std::memory_order_relaxed) > 0) {
+    rmw_fastrtps_shared_cpp::SpilledSample spilled;
+    while (*taken < count && info->take_spilled(&spilled)) {
+      if (content_filter && *content_filter &&
+        !(*content_filter)(
+          reinterpret_cast<const uint8_t *>(spilled.buffer->getBuffer()),
+          spilled.length))
+      {
+        continue;
+      }
+      eprosima::fastcdr::Cdr deser(
+        *spilled.buffer,
+        eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+        eprosima::fastcdr::Cdr::DDS_CDR);
+      if (!info->type_support_->deserializeROSmessage(
+          deser, message_sequence->data[*taken], info->type_support_impl_))
+      {
+        // Same recovery as the backlog loop below: the sample is already out
+        // of the overflow, so skip it rather than hand back a broken entry.
+        continue;
+      }
+      _assign_message_info(
+        identifier, &message_info_sequence->data[*taken], &spilled.sample_info);
+      if (0 != spilled.arrival_timestamp) {
+        message_info_sequence->data[*taken].received_timestamp = spilled.arrival_timestamp;
+      }
+      (*taken)++;
+    }
+  }
+
+  // The spill consumed part of the caller's budget; limit the remaining
+  // reads to the number unread at this point. This prevents any samples that
+  // are added after the beginning of the _take_sequence call from being read.
+  count -= *taken;
   auto unread_count = info->subscriber_->get_unread_count();
   if (unread_count < count) {
     count = unread_count;
   }
 
-  for (size_t ii = 0; ii < count; ++ii) {
-    taken_flag = false;
-    ret = _take(
-      identifier, subscription, message_sequence->data[*taken],
-      &taken_flag, &message_info_sequence->data[*taken], allocation);
-
-    if (ret != RMW_RET_OK) {
-      break;
+  // Drain the history in one pass; the listener shadow count is adjusted
+  // once at the end by the number of samples consumed instead of once per
+  // sample.
+  size_t consumed = 0;
+  eprosima::fastrtps::SampleInfo_t sinfo;
+  if (!content_filter && _parallel_deserialize_enabled()) {
+    // Copy the whole backlog out of the history first; each iteration only
+    // memcpys a payload, so the history mutex is released quickly and the
+    // reception thread can keep inserting while the decode loop below runs.
+    std::vector<std::pair<rmw_fastrtps_shared_cpp::PooledFastBufferPtr,
+      eprosima::fastrtps::SampleInfo_t>> backlog;
+    backlog.reserve(count);
+    // Arrival stamps of the backlog entries, aligned by index.
+    std::vector<int64_t> arrival_stamps;
+    arrival_stamps.reserve(count);
+    for (size_t ii = 0; ii < count; ++ii) {
+      rmw_fastrtps_shared_cpp::PooledFastBufferPtr buffer(
+        rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+      rmw_fastrtps_shared_cpp::SerializedData data;
+      data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
+      data.data = buffer.get();
+      data.impl = nullptr;    // not used when type is FAST_BUFFER
+      if (!info->subscriber_->takeNextData(&data, &sinfo)) {
+        break;
+      }
+      ++consumed;
+      const int64_t arrival = info->listener_->pop_arrival_stamp();
+      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+        backlog.emplace_back(std::move(buffer), sinfo);
+        arrival_stamps.push_back(arrival);
+      }
     }
-
-    if (taken_flag) {
+    for (size_t ii = 0; ii < backlog.size(); ++ii) {
+      auto & sample = backlog[ii];
+      eprosima::fastcdr::Cdr deser(
+        *sample.first,
+        eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+        eprosima::fastcdr::Cdr::DDS_CDR);
+      if (!info->type_support_->deserializeROSmessage(
+          deser, message_sequence->data[*taken], info->type_support_impl_))
+      {
+        // The sample is already out of the history; skipping it keeps the
+        // sequence consistent instead of handing back a half-decoded entry.
+        continue;
+      }
+      _assign_message_info(identifier, &message_info_sequence->data[*taken], &sample.second);
+      if (0 != arrival_stamps[ii]) {
+        message_info_sequence->data[*taken].received_timestamp = arrival_stamps[ii];
+      }
       (*taken)++;
     }
+  } else {
+    for (size_t ii = 0; ii < count; ++ii) {
+      rmw_fastrtps_shared_cpp::SerializedData data;
+      data.type = rmw_fastrtps_shared_cpp::SerializedData::ROS_MESSAGE;
+      data.data = message_sequence->data[*taken];
+      data.impl = info->type_support_impl_;
+      data.filter = content_filter.get();
+      if (!info->subscriber_->takeNextData(&data, &sinfo)) {
+        if (data.filter) {
+          // A rejected sample was still consumed from the history; keep
+          // draining the remaining budget.
+          info->listener_->pop_arrival_stamp();
+          ++consumed;
+          continue;
+        }
+        break;
+      }
+      ++consumed;
+      const int64_t arrival = info->listener_->pop_arrival_stamp();
+
+      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+        _assign_message_info(identifier, &message_info_sequence->data[*taken], &sinfo);
+        if (0 != arrival) {
+          message_info_sequence->data[*taken].received_timestamp = arrival;
+        }
+        (*taken)++;
+      }
+    }
+  }
+
+  if (consumed > 0u) {
+    info->listener_->data_taken(info->subscriber_, consumed);
+  }
+  if (consumed < count) {
+    // The history ran out before the budget did; the shadow count was
+    // overstated, resync it.
+    info->listener_->sync_unread_count(info->subscriber_);
   }
 
   message_sequence->size = *taken;
   message_info_sequence->size = *taken;
 
-  return ret;
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
@@ -167,6 +538,28 @@ __rmw_take_event(
   return RMW_RET_ERROR;
 }
 
+rmw_ret_t
+__rmw_take_all_events(
+  const char * identifier,
+  const rmw_event_t * event_handle,
+  TakenEventStatuses * statuses,
+  uint32_t * taken_mask)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(event_handle, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(statuses, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken_mask, RMW_RET_INVALID_ARGUMENT);
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    event handle,
+    event_handle->implementation_identifier,
+    identifier,
+    return RMW_RET_ERROR);
+
+  auto event = static_cast<CustomEventInfo *>(event_handle->data);
+  *taken_mask = event->getListener()->takeAllEvents(statuses);
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 __rmw_take(
   const char * identifier,
@@ -175,11 +568,12 @@ __rmw_take(
   bool * taken,
   rmw_subscription_allocation_t * allocation)
 {
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
-    subscription, "subscription pointer is null", return RMW_RET_ERROR);
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
-    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
-  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "boolean flag for taken is null", return RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != subscription, "subscription pointer is null", RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != ros_message, "ros_message pointer is null", RMW_RET_ERROR);
+  RMW_FASTRTPS_CHECK_HANDLE(
+    nullptr != taken, "boolean flag for taken is null", RMW_RET_ERROR);
 
   return _take(identifier, subscription, ros_message, taken, nullptr, allocation);
 }
@@ -239,6 +633,39 @@ __rmw_take_with_info(
   return _take(identifier, subscription, ros_message, taken, message_info, allocation);
 }
 
+rmw_ret_t
+__rmw_take_multi(
+  const char * identifier,
+  TakeMultiEntry * entries,
+  size_t count,
+  size_t * taken_count)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    entries, "entries pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    taken_count, "taken_count pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  *taken_count = 0;
+  for (size_t i = 0; i < count; ++i) {
+    TakeMultiEntry & entry = entries[i];
+    entry.taken = false;
+    RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+      entry.subscription, "subscription pointer is null", return RMW_RET_INVALID_ARGUMENT);
+    RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+      entry.ros_message, "ros_message pointer is null", return RMW_RET_INVALID_ARGUMENT);
+    rmw_ret_t ret = _take(
+      identifier, entry.subscription, entry.ros_message, &entry.taken,
+      entry.message_info, entry.allocation);
+    if (RMW_RET_OK != ret) {
+      return ret;
+    }
+    if (entry.taken) {
+      ++(*taken_count);
+    }
+  }
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 _take_serialized_message(
   const char * identifier,
@@ -259,32 +686,54 @@ _take_serialized_message(
   CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
 
-  eprosima::fastcdr::FastBuffer buffer;
   eprosima::fastrtps::SampleInfo_t sinfo;
 
+  // Samples rescued from a full history by the history extension predate
+  // everything still in the history; hand those bytes out first.
+  if (info->spill_size_.load(std::memory_order_relaxed) > 0) {
+    rmw_fastrtps_shared_cpp::SpilledSample spilled;
+    if (info->take_spilled(&spilled)) {
+      rmw_ret_t ret = rmw_serialized_message_resize(serialized_message, spilled.length);
+      if (RMW_RET_OK != ret) {
+        return ret;
+      }
+      memcpy(serialized_message->buffer, spilled.buffer->getBuffer(), spilled.length);
+      serialized_message->buffer_length = spilled.length;
+      if (message_info) {
+        _assign_message_info(identifier, message_info, &spilled.sample_info);
+        if (0 != spilled.arrival_timestamp) {
+          message_info->received_timestamp = spilled.arrival_timestamp;
+        }
+      }
+      *taken = true;
+      return RMW_RET_OK;
+    }
+  }
+
+  // The payload is resized into and copied straight into the caller's
+  // serialized message inside TypeSupport::deserialize, skipping the
+  // intermediate FastBuffer this function used to stage the bytes in.
   rmw_fastrtps_shared_cpp::SerializedData data;
-  data.is_cdr_buffer = true;
-  data.data = &buffer;
-  data.impl = nullptr;    // not used when is_cdr_buffer is true
+  data.type = rmw_fastrtps_shared_cpp::SerializedData::SERIALIZED_MESSAGE;
+  data.data = serialized_message;
+  data.impl = nullptr;    // not used when type is SERIALIZED_MESSAGE
   if (info->subscriber_->takeNextData(&data, &sinfo)) {
     info->listener_->data_taken(info->subscriber_);
+    const int64_t arrival = info->listener_->pop_arrival_stamp();
 
     if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-      auto buffer_size = static_cast<size_t>(buffer.getBufferSize());
-      if (serialized_message->buffer_capacity < buffer_size) {
-        auto ret = rmw_serialized_message_resize(serialized_message, buffer_size);
-        if (ret != RMW_RET_OK) {
-          return ret;  // Error message already set
-        }
-      }
-      serialized_message->buffer_length = buffer_size;
-      memcpy(serialized_message->buffer, buffer.getBuffer(), serialized_message->buffer_length);
-
       if (message_info) {
         _assign_message_info(identifier, message_info, &sinfo);
+        if (0 != arrival) {
+          message_info->received_timestamp = arrival;
+        }
       }
       *taken = true;
     }
+  } else {
+    // An empty take while the shadow count claimed data: resync it so the
+    // wait set stops waking for samples that are not there.
+    info->listener_->sync_unread_count(info->subscriber_);
   }
 
   return RMW_RET_OK;
@@ -328,4 +777,255 @@ __rmw_take_serialized_message_with_info(
   return _take_serialized_message(
     identifier, subscription, serialized_message, taken, message_info, allocation);
 }
+
+rmw_ret_t
+__rmw_take_loaned_serialized_sample(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  LoanedSerializedSample * sample,
+  bool * taken)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(sample, "sample pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "boolean flag for taken is null", return RMW_RET_ERROR);
+
+  *taken = false;
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  rmw_fastrtps_shared_cpp::PooledFastBufferPtr buffer;
+  eprosima::fastrtps::SampleInfo_t sinfo;
+  uint32_t length = 0;
+  int64_t arrival = 0;
+
+  // Samples rescued from a full history by the history extension predate
+  // everything still in the history; lend those bytes out first. They
+  // already sit in a pooled buffer, so the loan costs nothing extra.
+  rmw_fastrtps_shared_cpp::SpilledSample spilled;
+  if (info->spill_size_.load(std::memory_order_relaxed) > 0 && info->take_spilled(&spilled)) {
+    buffer = std::move(spilled.buffer);
+    sinfo = spilled.sample_info;
+    length = spilled.length;
+    arrival = spilled.arrival_timestamp;
+  } else {
+    buffer.reset(rmw_fastrtps_shared_cpp::FastBufferPool::acquire());
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.type = rmw_fastrtps_shared_cpp::SerializedData::FAST_BUFFER;
+    data.data = buffer.get();
+    data.impl = nullptr;    // not used when type is FAST_BUFFER
+    if (!info->subscriber_->takeNextData(&data, &sinfo)) {
+      // An empty take while the shadow count claimed data: resync it so the
+      // wait set stops waking for samples that are not there.
+      info->listener_->sync_unread_count(info->subscriber_);
+      return RMW_RET_OK;
+    }
+    info->listener_->data_taken(info->subscriber_);
+    arrival = info->listener_->pop_arrival_stamp();
+    if (eprosima::fastrtps::rtps::ALIVE != sinfo.sampleKind) {
+      return RMW_RET_OK;
+    }
+    length = data.taken_length;
+  }
+
+  sample->buffer = reinterpret_cast<const uint8_t *>(buffer->getBuffer());
+  sample->length = length;
+  _assign_writer_gid(identifier, &sample->writer_gid, sinfo.sample_identity.writer_guid());
+  sample->sequence_number = sinfo.sample_identity.sequence_number().to64long();
+  sample->source_timestamp = sinfo.sourceTimestamp.to_ns();
+  sample->received_timestamp = 0 != arrival ? arrival : sinfo.receptionTimestamp.to_ns();
+  // The buffer leaves the pool for the duration of the loan; the return
+  // call recycles it.
+  sample->impl = buffer.release();
+  *taken = true;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_return_loaned_serialized_sample(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  LoanedSerializedSample * sample)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(sample, "sample pointer is null", return RMW_RET_ERROR);
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  if (nullptr != sample->impl) {
+    rmw_fastrtps_shared_cpp::FastBufferPool::release(
+      static_cast<eprosima::fastcdr::FastBuffer *>(sample->impl));
+    sample->impl = nullptr;
+  }
+  sample->buffer = nullptr;
+  sample->length = 0;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_take_with_deadline(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * ros_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  const rmw_time_t * wait_timeout)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "boolean flag for taken is null", return RMW_RET_ERROR);
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  // The fast path never touches any wait machinery: with a sample already
+  // queued, the whole call is one _take.
+  rmw_ret_t ret = _take(identifier, subscription, ros_message, taken, message_info, nullptr);
+  if (RMW_RET_OK != ret || *taken) {
+    return ret;
+  }
+  if (wait_timeout && 0 == wait_timeout->sec && 0 == wait_timeout->nsec) {
+    return RMW_RET_TIMEOUT;
+  }
+
+  CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  const bool indefinite = (nullptr == wait_timeout);
+  std::chrono::steady_clock::time_point deadline;
+  if (!indefinite) {
+    auto n = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::seconds(wait_timeout->sec));
+    n += std::chrono::nanoseconds(wait_timeout->nsec);
+    deadline = std::chrono::steady_clock::now() + n;
+  }
+
+  // Per-call condition on the caller's stack, attached directly to the
+  // subscription's listener: the notify handshake is the same one the wait
+  // set path uses, without the wait set's attach caches or ready scans.
+  // This occupies the listener's single condition slot, so a subscription
+  // consumed through the fused call must not concurrently sit in a wait
+  // set; the dedicated consumer thread this call targets never does. A wait
+  // set may still cache this subscription from an earlier generic wait, so
+  // evict that attachment first; its next wait re-attaches.
+  std::mutex condition_mutex;
+  std::condition_variable condition;
+  std::atomic_bool ready{false};
+  waitset_forget_entity(info);
+  info->listener_->attachCondition(&condition_mutex, &condition, &ready);
+
+  auto predicate = [info, &ready]() {
+      // Clear before checking, exactly like __rmw_wait: a notification
+      // raised after the check re-arms the flag and re-runs the predicate.
+      ready.exchange(false);
+      return info->listener_->hasData();
+    };
+
+  for (;;) {
+    bool has_data = false;
+    {
+      std::unique_lock<std::mutex> lock(condition_mutex);
+      if (indefinite) {
+        condition.wait(lock, predicate);
+        has_data = true;
+      } else {
+        has_data = condition.wait_until(lock, deadline, predicate);
+      }
+    }
+    if (!has_data) {
+      ret = RMW_RET_TIMEOUT;
+      break;
+    }
+    // The shadow count can run ahead of the history, so an empty take here
+    // is not a bug; the loop re-arms against the remaining budget.
+    ret = _take(identifier, subscription, ros_message, taken, message_info, nullptr);
+    if (RMW_RET_OK != ret || *taken) {
+      break;
+    }
+  }
+
+  info->listener_->detachCondition();
+  return ret;
+}
+
+rmw_ret_t
+__rmw_take_loaned_ros_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** ros_message,
+  bool * taken,
+  rmw_message_info_t * message_info)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "boolean flag for taken is null", return RMW_RET_ERROR);
+
+  *taken = false;
+  *ros_message = nullptr;
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  void * message = nullptr;
+  if (!info->borrow_loanable_message(&message)) {
+    RMW_SET_ERROR_MSG(
+      "no loanable message available; install a pool with "
+      "__rmw_subscription_set_loan_pool or return outstanding loans");
+    return RMW_RET_ERROR;
+  }
+
+  rmw_ret_t ret = _take(identifier, subscription, message, taken, message_info, nullptr);
+  if (RMW_RET_OK != ret || !*taken) {
+    // Nothing was deserialized; the object goes straight back into rotation
+    // with whatever capacity it already carries.
+    info->return_loanable_message(message);
+    return ret;
+  }
+  *ros_message = message;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_return_loaned_ros_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * ros_message)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  info->return_loanable_message(ros_message);
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
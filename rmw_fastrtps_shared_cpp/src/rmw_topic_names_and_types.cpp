@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <string>
 
 #include "rcutils/allocator.h"
@@ -26,8 +27,11 @@
 
 #include "rmw_dds_common/context.hpp"
 
+#include "rmw_fastrtps_shared_cpp/graph_query_cache.hpp"
+#include "rmw_fastrtps_shared_cpp/listener_thread.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
+#include "rmw_fastrtps_shared_cpp/topic_mux.hpp"
 
 #include "demangle.hpp"
 
@@ -66,12 +70,166 @@ __rmw_get_topic_names_and_types(
     demangle_topic = _identity_demangle;
     demangle_type = _identity_demangle;
   }
+  ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+  auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
+
+  // Periodic introspection polls mostly see an unchanged graph; serve those
+  // from a generation-stamped snapshot instead of re-walking the cache.
+  return cached_names_and_types_query(
+    common_context,
+    no_demangle ? "topics_raw" : "topics",
+    allocator,
+    topic_names_and_types,
+    [&](rmw_names_and_types_t * out) {
+      rmw_ret_t query_ret = common_context->graph_cache.get_names_and_types(
+        demangle_topic,
+        demangle_type,
+        allocator,
+        out);
+      if (RMW_RET_OK != query_ret || no_demangle) {
+        // The raw view reports the DDS reality, where only channels exist.
+        return query_ret;
+      }
+      // Logical topics carried over mux channels stay visible to tooling.
+      return mux_expand_names_and_types(allocator, out);
+    });
+}
+
+rmw_ret_t
+__rmw_visit_topic_names_and_types(
+  const char * identifier,
+  const rmw_node_t * node,
+  bool no_demangle,
+  const NamesAndTypesVisitor & visitor)
+{
+  if (!node) {
+    RMW_SET_ERROR_MSG("null node handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!visitor) {
+    RMW_SET_ERROR_MSG("visitor is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (node->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("node handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  DemangleFunction demangle_topic = _demangle_ros_topic_from_topic;
+  DemangleFunction demangle_type = _demangle_if_ros_type;
+
+  if (no_demangle) {
+    demangle_topic = _identity_demangle;
+    demangle_type = _identity_demangle;
+  }
+  rmw_ret_t ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+  auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
+
+  // The query ids match __rmw_get_topic_names_and_types, so both entry
+  // points refresh and reuse the same snapshot; steady-state visits walk it
+  // in place and allocate nothing.
+  return visit_cached_names_and_types(
+    common_context,
+    no_demangle ? "topics_raw" : "topics",
+    [&](rcutils_allocator_t * allocator, rmw_names_and_types_t * out) {
+      rmw_ret_t query_ret = common_context->graph_cache.get_names_and_types(
+        demangle_topic,
+        demangle_type,
+        allocator,
+        out);
+      if (RMW_RET_OK != query_ret || no_demangle) {
+        // The raw view reports the DDS reality, where only channels exist.
+        return query_ret;
+      }
+      // Logical topics carried over mux channels stay visible to tooling.
+      return mux_expand_names_and_types(allocator, out);
+    },
+    visitor);
+}
+
+rmw_ret_t
+__rmw_get_topic_names_and_types_chunk(
+  const char * identifier,
+  const rmw_node_t * node,
+  rcutils_allocator_t * allocator,
+  bool no_demangle,
+  size_t offset,
+  size_t max_entries,
+  uint64_t * continuation,
+  bool * more,
+  rmw_names_and_types_t * topic_names_and_types)
+{
+  if (!allocator) {
+    RMW_SET_ERROR_MSG("allocator is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!node) {
+    RMW_SET_ERROR_MSG("null node handle");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (0u == max_entries) {
+    RMW_SET_ERROR_MSG("max_entries is zero");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!continuation) {
+    RMW_SET_ERROR_MSG("continuation is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (!more) {
+    RMW_SET_ERROR_MSG("more is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  rmw_ret_t ret = rmw_names_and_types_check_zero(topic_names_and_types);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  if (node->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("node handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  DemangleFunction demangle_topic = _demangle_ros_topic_from_topic;
+  DemangleFunction demangle_type = _demangle_if_ros_type;
+
+  if (no_demangle) {
+    demangle_topic = _identity_demangle;
+    demangle_type = _identity_demangle;
+  }
+  ret = ensure_listener_thread(node->context);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
   auto common_context = static_cast<rmw_dds_common::Context *>(node->context->impl->common);
 
-  return common_context->graph_cache.get_names_and_types(
-    demangle_topic,
-    demangle_type,
+  // Same query ids as the unchunked entry points, so a pull reuses any
+  // snapshot a full query or visit already published, and vice versa.
+  return cached_names_and_types_query_chunk(
+    common_context,
+    no_demangle ? "topics_raw" : "topics",
     allocator,
-    topic_names_and_types);
+    offset,
+    max_entries,
+    continuation,
+    topic_names_and_types,
+    more,
+    [&](rcutils_allocator_t * scratch_allocator, rmw_names_and_types_t * out) {
+      rmw_ret_t query_ret = common_context->graph_cache.get_names_and_types(
+        demangle_topic,
+        demangle_type,
+        scratch_allocator,
+        out);
+      if (RMW_RET_OK != query_ret || no_demangle) {
+        // The raw view reports the DDS reality, where only channels exist.
+        return query_ret;
+      }
+      // Logical topics carried over mux channels stay visible to tooling.
+      return mux_expand_names_and_types(scratch_allocator, out);
+    });
 }
 }  // namespace rmw_fastrtps_shared_cpp
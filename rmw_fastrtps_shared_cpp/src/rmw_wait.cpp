@@ -12,6 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "fastrtps/subscriber/Subscriber.h"
 
 #include "rmw/error_handling.h"
@@ -20,9 +26,423 @@
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_slot.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/tracing.hpp"
 #include "types/custom_wait_set_info.hpp"
 #include "types/guard_condition.hpp"
+#include "waitset_attachment.hpp"
+
+namespace
+{
+
+// Protects the attachment caches of every wait set and the registry below.
+// Only taken when the composition of a wait set changes or an entity or wait
+// set is destroyed; waits over an unchanged composition take it once without
+// doing any per-entity work.
+std::mutex g_attachment_mutex;
+
+// Which wait set each entity is currently attached to, so entities can be
+// removed from the right cache when they are destroyed or move to another
+// wait set.
+std::unordered_map<void *, CustomWaitsetInfo *> g_attachment_registry;
+
+// Dispatch priorities assigned through __rmw_wait_set_entity_priority, keyed
+// by the entity data pointer the ready list reports. Entities without an
+// entry rank at priority zero. The count mirror lets every wait skip the
+// sorting (and its lock) entirely while no priorities are registered.
+std::mutex g_priority_mutex;
+std::unordered_map<void *, int32_t> g_entity_priorities;
+std::atomic<size_t> g_priority_count{0};
+
+// Requires g_priority_mutex.
+int32_t
+_entity_priority_locked(void * entity)
+{
+  auto it = g_entity_priorities.find(entity);
+  return it == g_entity_priorities.end() ? 0 : it->second;
+}
+
+// Orders the collected ready list so higher-priority entities come first;
+// ties keep their scan order, so equal-priority dispatch stays fair.
+void
+_sort_ready_by_priority(std::vector<void *> & ready)
+{
+  if (ready.size() < 2u ||
+    0u == g_priority_count.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_priority_mutex);
+  std::stable_sort(
+    ready.begin(), ready.end(),
+    [](void * lhs, void * rhs) {
+      return _entity_priority_locked(lhs) > _entity_priority_locked(rhs);
+    });
+}
+
+void
+_remove_from_cache(std::vector<void *> & cache, void * entity)
+{
+  cache.erase(std::remove(cache.begin(), cache.end(), entity), cache.end());
+}
+
+// Hands the shared condition variable to the next parked waiter, waking
+// exactly that thread. Requires the wait set's condition_mutex.
+void
+_promote_next_waiter_locked(CustomWaitsetInfo * wait_set_info)
+{
+  if (wait_set_info->parked_waiters.empty()) {
+    return;
+  }
+  ParkedWaiter * next = wait_set_info->parked_waiters.front();
+  wait_set_info->parked_waiters.pop_front();
+  next->promoted = true;
+  next->condition.notify_one();
+}
+
+void
+_set_ready_slot(const ReadyEntity & entity, const rmw_fastrtps_shared_cpp::ReadySlot & slot)
+{
+  switch (entity.kind) {
+    case ReadyEntity::Kind::Subscription:
+      static_cast<CustomSubscriberInfo *>(entity.data)->listener_->setReadySlot(slot);
+      break;
+    case ReadyEntity::Kind::Client:
+      static_cast<CustomClientInfo *>(entity.data)->listener_->setReadySlot(slot);
+      break;
+    case ReadyEntity::Kind::Service:
+      static_cast<CustomServiceInfo *>(entity.data)->listener_->setReadySlot(slot);
+      break;
+    case ReadyEntity::Kind::GuardCondition:
+      static_cast<GuardCondition *>(entity.data)->setReadySlot(slot);
+      break;
+  }
+}
+
+bool
+_entity_has_data(const ReadyEntity & entity)
+{
+  switch (entity.kind) {
+    case ReadyEntity::Kind::Subscription:
+      return static_cast<CustomSubscriberInfo *>(entity.data)->listener_->hasData();
+    case ReadyEntity::Kind::Client:
+      return static_cast<CustomClientInfo *>(entity.data)->listener_->hasData();
+    case ReadyEntity::Kind::Service:
+      return static_cast<CustomServiceInfo *>(entity.data)->listener_->hasData();
+    case ReadyEntity::Kind::GuardCondition:
+      return static_cast<GuardCondition *>(entity.data)->hasTriggered();
+  }
+  return false;
+}
+
+void
+_drop_ready_index_locked(CustomWaitsetInfo * wait_set_info)
+{
+  for (const ReadyEntity & entity : wait_set_info->indexed_entities) {
+    _set_ready_slot(entity, rmw_fastrtps_shared_cpp::ReadySlot());
+  }
+  wait_set_info->indexed_entities.clear();
+  wait_set_info->ready_word_count = 0u;
+  wait_set_info->ready_summary.store(0u, std::memory_order_relaxed);
+}
+
+void
+_forget_entity_locked(CustomWaitsetInfo * wait_set_info, void * entity)
+{
+  _remove_from_cache(wait_set_info->attached_subscriptions, entity);
+  _remove_from_cache(wait_set_info->attached_clients, entity);
+  _remove_from_cache(wait_set_info->attached_services, entity);
+  _remove_from_cache(wait_set_info->attached_guard_conditions, entity);
+  // Also drop it from the readiness index: take back its slot while the
+  // listener is still alive (a rebuild frees the words the slot points at)
+  // and forget the entity so the index teardown never touches it once it is
+  // destroyed. The bit layout is stale afterwards, but the shrunken caches
+  // force a full rebuild before the next scan anyway.
+  auto & indexed = wait_set_info->indexed_entities;
+  indexed.erase(
+    std::remove_if(
+      indexed.begin(), indexed.end(),
+      [entity](const ReadyEntity & e) {
+        if (e.data == entity) {
+          _set_ready_slot(e, rmw_fastrtps_shared_cpp::ReadySlot());
+          return true;
+        }
+        return false;
+      }),
+    indexed.end());
+}
+
+void
+_record_attachment_locked(
+  CustomWaitsetInfo * wait_set_info, std::vector<void *> & cache, void * entity)
+{
+  auto it = g_attachment_registry.find(entity);
+  if (it != g_attachment_registry.end() && it->second != wait_set_info) {
+    // attachCondition below overwrites the listener's condition pointers, so
+    // only the previous wait set's cache needs to be updated.
+    _forget_entity_locked(it->second, entity);
+  }
+  g_attachment_registry[entity] = wait_set_info;
+  cache.push_back(entity);
+}
+
+void
+_detach_entities_locked(CustomWaitsetInfo * wait_set_info)
+{
+  _drop_ready_index_locked(wait_set_info);
+  for (void * data : wait_set_info->attached_subscriptions) {
+    static_cast<CustomSubscriberInfo *>(data)->listener_->detachCondition();
+    g_attachment_registry.erase(data);
+  }
+  for (void * data : wait_set_info->attached_clients) {
+    static_cast<CustomClientInfo *>(data)->listener_->detachCondition();
+    g_attachment_registry.erase(data);
+  }
+  for (void * data : wait_set_info->attached_services) {
+    static_cast<CustomServiceInfo *>(data)->listener_->detachCondition();
+    g_attachment_registry.erase(data);
+  }
+  for (void * data : wait_set_info->attached_guard_conditions) {
+    static_cast<GuardCondition *>(data)->detachCondition();
+    g_attachment_registry.erase(data);
+  }
+  wait_set_info->attached_subscriptions.clear();
+  wait_set_info->attached_clients.clear();
+  wait_set_info->attached_services.clear();
+  wait_set_info->attached_guard_conditions.clear();
+}
+
+bool
+_composition_matches(const std::vector<void *> & cache, void * const * entities, size_t count)
+{
+  if (cache.size() != count) {
+    return false;
+  }
+  return std::equal(cache.begin(), cache.end(), entities);
+}
+
+// Builds the readiness index for a freshly attached composition: sizes the
+// words, hands every entity its slot and starts with every bit set, so the
+// first scan rechecks everything once and stale bits clear themselves.
+void
+_build_ready_index_locked(CustomWaitsetInfo * wait_set_info)
+{
+  const size_t total = wait_set_info->indexed_entities.size();
+  if (0u == total || total > kReadyWordBits * kReadyWordBits) {
+    // Nothing to index, or more entities than one summary word can cover;
+    // ready_word_count stays zero and the waits use the linear scan.
+    return;
+  }
+  const size_t word_count = (total + kReadyWordBits - 1u) / kReadyWordBits;
+  if (word_count > wait_set_info->ready_word_capacity) {
+    wait_set_info->ready_words.reset(new std::atomic<uint64_t>[word_count]);
+    wait_set_info->ready_word_capacity = word_count;
+  }
+  wait_set_info->ready_word_count = word_count;
+  for (size_t w = 0; w < word_count; ++w) {
+    const size_t in_word = std::min(kReadyWordBits, total - w * kReadyWordBits);
+    const uint64_t all_set =
+      in_word == kReadyWordBits ? ~static_cast<uint64_t>(0u) : ((1ull << in_word) - 1u);
+    wait_set_info->ready_words[w].store(all_set, std::memory_order_relaxed);
+  }
+  wait_set_info->ready_summary.store(
+    word_count == kReadyWordBits ? ~static_cast<uint64_t>(0u) : ((1ull << word_count) - 1u),
+    std::memory_order_relaxed);
+
+  for (size_t slot = 0; slot < total; ++slot) {
+    rmw_fastrtps_shared_cpp::ReadySlot ready_slot;
+    ready_slot.word = &wait_set_info->ready_words[slot / kReadyWordBits];
+    ready_slot.word_bit = 1ull << (slot % kReadyWordBits);
+    ready_slot.summary = &wait_set_info->ready_summary;
+    ready_slot.summary_bit = 1ull << (slot / kReadyWordBits);
+    _set_ready_slot(wait_set_info->indexed_entities[slot], ready_slot);
+  }
+}
+
+// Walks only the set bits of the readiness index, rechecking each marked
+// entity. A stale bit (the entity is not ready after all) is consumed by the
+// walk; a confirmed bit is restored so the next wait still sees it.
+bool
+_scan_ready_index(CustomWaitsetInfo * wait_set_info)
+{
+  bool any_confirmed = false;
+  uint64_t summary = wait_set_info->ready_summary.exchange(0u, std::memory_order_relaxed);
+  for (size_t w = 0; summary != 0u; ++w, summary >>= 1) {
+    if (0u == (summary & 1u)) {
+      continue;
+    }
+    uint64_t bits = wait_set_info->ready_words[w].exchange(0u, std::memory_order_relaxed);
+    uint64_t confirmed = 0u;
+    for (size_t b = 0; bits != 0u; ++b, bits >>= 1) {
+      if (0u == (bits & 1u)) {
+        continue;
+      }
+      if (_entity_has_data(wait_set_info->indexed_entities[w * kReadyWordBits + b])) {
+        confirmed |= 1ull << b;
+      }
+    }
+    if (confirmed != 0u) {
+      // fetch_or instead of store: a listener marking concurrently between
+      // the exchange above and here must not be overwritten.
+      wait_set_info->ready_words[w].fetch_or(confirmed, std::memory_order_relaxed);
+      wait_set_info->ready_summary.fetch_or(1ull << w, std::memory_order_relaxed);
+      any_confirmed = true;
+    }
+  }
+  return any_confirmed;
+}
+
+// Scrub pass over an indexed composition: null every array entry with a
+// plain pointer sweep, then walk only the set bits restoring the entities
+// confirmed ready. The per-entity readiness checks, the expensive part on
+// large wait sets, run O(ready) times instead of O(attached).
+void
+_scrub_with_ready_index(
+  CustomWaitsetInfo * wait_set_info,
+  rmw_subscriptions_t * subscriptions,
+  rmw_clients_t * clients,
+  rmw_services_t * services,
+  rmw_guard_conditions_t * guard_conditions)
+{
+  if (subscriptions) {
+    std::fill_n(
+      subscriptions->subscribers, subscriptions->subscriber_count,
+      static_cast<void *>(nullptr));
+  }
+  if (clients) {
+    std::fill_n(
+      clients->clients, clients->client_count, static_cast<void *>(nullptr));
+  }
+  if (services) {
+    std::fill_n(
+      services->services, services->service_count, static_cast<void *>(nullptr));
+  }
+  if (guard_conditions) {
+    std::fill_n(
+      guard_conditions->guard_conditions, guard_conditions->guard_condition_count,
+      static_cast<void *>(nullptr));
+  }
+
+  uint64_t ready_subscriptions = 0u;
+  uint64_t ready_clients = 0u;
+  uint64_t ready_services = 0u;
+  uint64_t ready_guard_conditions = 0u;
+
+  uint64_t summary = wait_set_info->ready_summary.exchange(0u, std::memory_order_relaxed);
+  for (size_t w = 0; summary != 0u; ++w, summary >>= 1) {
+    if (0u == (summary & 1u)) {
+      continue;
+    }
+    uint64_t bits = wait_set_info->ready_words[w].exchange(0u, std::memory_order_relaxed);
+    uint64_t keep = 0u;
+    for (size_t b = 0; bits != 0u; ++b, bits >>= 1) {
+      if (0u == (bits & 1u)) {
+        continue;
+      }
+      const ReadyEntity & entity = wait_set_info->indexed_entities[w * kReadyWordBits + b];
+      bool still_ready = false;
+      switch (entity.kind) {
+        case ReadyEntity::Kind::Subscription:
+          still_ready = static_cast<CustomSubscriberInfo *>(entity.data)->listener_->hasData();
+          if (still_ready) {
+            subscriptions->subscribers[entity.array_index] = entity.data;
+            ++ready_subscriptions;
+          }
+          break;
+        case ReadyEntity::Kind::Client:
+          still_ready = static_cast<CustomClientInfo *>(entity.data)->listener_->hasData();
+          if (still_ready) {
+            clients->clients[entity.array_index] = entity.data;
+            ++ready_clients;
+          }
+          break;
+        case ReadyEntity::Kind::Service:
+          still_ready = static_cast<CustomServiceInfo *>(entity.data)->listener_->hasData();
+          if (still_ready) {
+            services->services[entity.array_index] = entity.data;
+            ++ready_services;
+          }
+          break;
+        case ReadyEntity::Kind::GuardCondition:
+          // The take consumes the trigger, so a reported guard condition
+          // does not keep its bit; it comes back when triggered again.
+          if (static_cast<GuardCondition *>(entity.data)->getHasTriggered()) {
+            guard_conditions->guard_conditions[entity.array_index] = entity.data;
+            wait_set_info->last_ready_entities.push_back(entity.data);
+            ++ready_guard_conditions;
+          }
+          break;
+      }
+      if (still_ready) {
+        // Reported but still holding data: keep the bit, so the next wait's
+        // scan revisits this entity without needing a new notification.
+        keep |= 1ull << b;
+        wait_set_info->last_ready_entities.push_back(entity.data);
+      }
+    }
+    if (keep != 0u) {
+      wait_set_info->ready_words[w].fetch_or(keep, std::memory_order_relaxed);
+      wait_set_info->ready_summary.fetch_or(1ull << w, std::memory_order_relaxed);
+    }
+  }
+
+  wait_set_info->statistics.add_ready(
+    ready_subscriptions, ready_clients, ready_services, ready_guard_conditions);
+}
+
+}  // namespace
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+void
+waitset_forget_entity(void * entity)
+{
+  {
+    std::lock_guard<std::mutex> lock(g_attachment_mutex);
+    auto it = g_attachment_registry.find(entity);
+    if (it != g_attachment_registry.end()) {
+      _forget_entity_locked(it->second, entity);
+      g_attachment_registry.erase(it);
+    }
+  }
+  std::lock_guard<std::mutex> lock(g_priority_mutex);
+  if (g_entity_priorities.erase(entity) > 0) {
+    g_priority_count.store(g_entity_priorities.size(), std::memory_order_relaxed);
+  }
+}
+
+void
+waitset_detach_entities(CustomWaitsetInfo * wait_set_info)
+{
+  std::lock_guard<std::mutex> lock(g_attachment_mutex);
+  _detach_entities_locked(wait_set_info);
+}
+
+void
+waitset_set_event_fd(CustomWaitsetInfo * wait_set_info, int event_fd)
+{
+  // Entities already attached when the fd is created have skipped the
+  // attach-time hand-off, so push it to them here; later attachments pick
+  // it up from the wait set directly.
+  std::lock_guard<std::mutex> lock(g_attachment_mutex);
+  wait_set_info->event_fd = event_fd;
+  for (void * data : wait_set_info->attached_subscriptions) {
+    static_cast<CustomSubscriberInfo *>(data)->listener_->setEventFd(event_fd);
+  }
+  for (void * data : wait_set_info->attached_clients) {
+    static_cast<CustomClientInfo *>(data)->listener_->setEventFd(event_fd);
+  }
+  for (void * data : wait_set_info->attached_services) {
+    static_cast<CustomServiceInfo *>(data)->listener_->setEventFd(event_fd);
+  }
+  for (void * data : wait_set_info->attached_guard_conditions) {
+    static_cast<GuardCondition *>(data)->setEventFd(event_fd);
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
 
 // helper function for wait
 bool
@@ -88,15 +508,117 @@ check_wait_set_for_data(
 
 namespace rmw_fastrtps_shared_cpp
 {
+
+// Read-only readiness poll backing the zero-timeout wait. Nothing is
+// attached or detached and the condition mutex is never taken: each entity
+// costs one readiness load, consumed directly from the caller's arrays, so
+// any cached attachment and the ready index are simply left alone — bits
+// listeners set meanwhile are validated by the next blocking wait. Only the
+// scrub mutex is taken, once, to publish the ready list for
+// __rmw_wait_set_get_last_ready.
+static
 rmw_ret_t
-__rmw_wait(
+_poll(
+  rmw_subscriptions_t * subscriptions,
+  rmw_guard_conditions_t * guard_conditions,
+  rmw_services_t * services,
+  rmw_clients_t * clients,
+  rmw_events_t * events,
+  CustomWaitsetInfo * wait_set_info)
+{
+  bool any_ready = false;
+
+  std::lock_guard<std::mutex> scrub_lock(wait_set_info->scrub_mutex);
+  wait_set_info->last_ready_entities.clear();
+
+  if (subscriptions) {
+    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
+      void * data = subscriptions->subscribers[i];
+      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
+      if (!custom_subscriber_info || !custom_subscriber_info->listener_->hasData()) {
+        subscriptions->subscribers[i] = 0;
+      } else {
+        wait_set_info->last_ready_entities.push_back(data);
+        any_ready = true;
+      }
+    }
+  }
+
+  if (clients) {
+    for (size_t i = 0; i < clients->client_count; ++i) {
+      void * data = clients->clients[i];
+      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
+      if (!custom_client_info || !custom_client_info->listener_->hasData()) {
+        clients->clients[i] = 0;
+      } else {
+        wait_set_info->last_ready_entities.push_back(data);
+        any_ready = true;
+      }
+    }
+  }
+
+  if (services) {
+    for (size_t i = 0; i < services->service_count; ++i) {
+      void * data = services->services[i];
+      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
+      if (!custom_service_info || !custom_service_info->listener_->hasData()) {
+        services->services[i] = 0;
+      } else {
+        wait_set_info->last_ready_entities.push_back(data);
+        any_ready = true;
+      }
+    }
+  }
+
+  if (guard_conditions) {
+    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+      void * data = guard_conditions->guard_conditions[i];
+      auto guard_condition = static_cast<GuardCondition *>(data);
+      // Consuming read, like the blocking path's scrub; a ready-index bit
+      // this leaves behind is scrubbed as not-ready by the next wait.
+      if (!guard_condition || !guard_condition->getHasTriggered()) {
+        guard_conditions->guard_conditions[i] = 0;
+      } else {
+        wait_set_info->last_ready_entities.push_back(data);
+        any_ready = true;
+      }
+    }
+  }
+
+  if (events) {
+    for (size_t i = 0; i < events->event_count; ++i) {
+      auto event = static_cast<rmw_event_t *>(events->events[i]);
+      auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
+      if (!custom_event_info->getListener()->hasEvent(event->event_type)) {
+        events->events[i] = nullptr;
+      } else {
+        wait_set_info->last_ready_entities.push_back(event);
+        any_ready = true;
+      }
+    }
+  }
+
+  _sort_ready_by_priority(wait_set_info->last_ready_entities);
+
+  RMW_FASTRTPS_TRACEPOINT2(rmw_wait_exit, wait_set_info, !any_ready);
+  return any_ready ? RMW_RET_OK : RMW_RET_TIMEOUT;
+}
+
+// Common wait implementation. The bound is either the relative wait_timeout
+// or, when has_deadline is set, the absolute abs_deadline; with neither the
+// wait blocks until something is ready.
+static
+rmw_ret_t
+_wait(
   rmw_subscriptions_t * subscriptions,
   rmw_guard_conditions_t * guard_conditions,
   rmw_services_t * services,
   rmw_clients_t * clients,
   rmw_events_t * events,
   rmw_wait_set_t * wait_set,
-  const rmw_time_t * wait_timeout)
+  const rmw_time_t * wait_timeout,
+  bool has_deadline,
+  std::chrono::steady_clock::time_point abs_deadline)
 {
   if (!wait_set) {
     RMW_SET_ERROR_MSG("wait set handle is null");
@@ -107,6 +629,21 @@ __rmw_wait(
     RMW_SET_ERROR_MSG("Waitset info struct is null");
     return RMW_RET_ERROR;
   }
+  RMW_FASTRTPS_TRACEPOINT3(
+    rmw_wait_entry, wait_set_info,
+    subscriptions ? subscriptions->subscriber_count : 0u,
+    guard_conditions ? guard_conditions->guard_condition_count : 0u);
+
+  // A zero timeout never blocks, so nothing needs to be attached or locked
+  // to begin with; spin_some-style pollers go straight to the scan.
+  if (!has_deadline && wait_timeout && 0 == wait_timeout->sec && 0 == wait_timeout->nsec) {
+    return _poll(subscriptions, guard_conditions, services, clients, events, wait_set_info);
+  }
+
+  // Everything past this point may block, so the statistics cover it; the
+  // poll above never does and stays out of the wakeup accounting.
+  const auto wait_entry_time = std::chrono::steady_clock::now();
+
   std::mutex * conditionMutex = &wait_set_info->condition_mutex;
   std::condition_variable * conditionVariable = &wait_set_info->condition;
   if (!conditionMutex) {
@@ -118,43 +655,124 @@ __rmw_wait(
     return RMW_RET_ERROR;
   }
 
-  if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      custom_subscriber_info->listener_->attachCondition(conditionMutex, conditionVariable);
+  // Resolve the bound to one absolute deadline on the monotonic clock up
+  // front; the spin and the block below both compare against it, so the
+  // caller's budget is consumed exactly once instead of being re-derived
+  // from additional clock reads after every partial wait.
+  bool indefinite = false;
+  std::chrono::steady_clock::time_point deadline;
+  if (has_deadline) {
+    deadline = abs_deadline;
+  } else if (!wait_timeout) {
+    indefinite = true;
+  } else if (wait_timeout->sec > 0 || wait_timeout->nsec > 0) {
+    if (wait_timeout->sec != wait_set_info->cached_timeout.sec ||
+      wait_timeout->nsec != wait_set_info->cached_timeout.nsec)
+    {
+      auto n = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::seconds(wait_timeout->sec));
+      n += std::chrono::nanoseconds(wait_timeout->nsec);
+      wait_set_info->cached_timeout = *wait_timeout;
+      wait_set_info->cached_timeout_ns = n;
     }
+    deadline = std::chrono::steady_clock::now() + wait_set_info->cached_timeout_ns;
   }
+  // The zero-timeout case went through _poll above; a deadline left at the
+  // clock's epoch (only reachable through __rmw_wait_until) is always in the
+  // past and degenerates to a poll through the blocking machinery.
 
-  if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      custom_client_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
-  }
+  {
+    // Entities stay attached between waits; only a composition change pays
+    // for the attach/detach loops and their per-entity mutex acquisitions.
+    std::lock_guard<std::mutex> attachment_lock(g_attachment_mutex);
 
-  if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
-      custom_service_info->listener_->attachCondition(conditionMutex, conditionVariable);
+    bool same_composition =
+      _composition_matches(
+      wait_set_info->attached_subscriptions,
+      subscriptions ? subscriptions->subscribers : nullptr,
+      subscriptions ? subscriptions->subscriber_count : 0u) &&
+      _composition_matches(
+      wait_set_info->attached_clients,
+      clients ? clients->clients : nullptr,
+      clients ? clients->client_count : 0u) &&
+      _composition_matches(
+      wait_set_info->attached_services,
+      services ? services->services : nullptr,
+      services ? services->service_count : 0u) &&
+      _composition_matches(
+      wait_set_info->attached_guard_conditions,
+      guard_conditions ? guard_conditions->guard_conditions : nullptr,
+      guard_conditions ? guard_conditions->guard_condition_count : 0u);
+
+    if (!same_composition) {
+      _detach_entities_locked(wait_set_info);
+
+      if (subscriptions) {
+        for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
+          void * data = subscriptions->subscribers[i];
+          auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
+          custom_subscriber_info->listener_->attachCondition(
+            conditionMutex, conditionVariable, &wait_set_info->any_ready);
+          custom_subscriber_info->listener_->setEventFd(wait_set_info->event_fd);
+          _record_attachment_locked(wait_set_info, wait_set_info->attached_subscriptions, data);
+          wait_set_info->indexed_entities.push_back(
+            ReadyEntity{data, ReadyEntity::Kind::Subscription, i});
+        }
+      }
+
+      if (clients) {
+        for (size_t i = 0; i < clients->client_count; ++i) {
+          void * data = clients->clients[i];
+          CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
+          custom_client_info->listener_->attachCondition(
+            conditionMutex, conditionVariable, &wait_set_info->any_ready);
+          custom_client_info->listener_->setEventFd(wait_set_info->event_fd);
+          _record_attachment_locked(wait_set_info, wait_set_info->attached_clients, data);
+          wait_set_info->indexed_entities.push_back(
+            ReadyEntity{data, ReadyEntity::Kind::Client, i});
+        }
+      }
+
+      if (services) {
+        for (size_t i = 0; i < services->service_count; ++i) {
+          void * data = services->services[i];
+          auto custom_service_info = static_cast<CustomServiceInfo *>(data);
+          custom_service_info->listener_->attachCondition(
+            conditionMutex, conditionVariable, &wait_set_info->any_ready);
+          custom_service_info->listener_->setEventFd(wait_set_info->event_fd);
+          _record_attachment_locked(wait_set_info, wait_set_info->attached_services, data);
+          wait_set_info->indexed_entities.push_back(
+            ReadyEntity{data, ReadyEntity::Kind::Service, i});
+        }
+      }
+
+      if (guard_conditions) {
+        for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+          void * data = guard_conditions->guard_conditions[i];
+          auto guard_condition = static_cast<GuardCondition *>(data);
+          guard_condition->attachCondition(
+            conditionMutex, conditionVariable, &wait_set_info->any_ready);
+          guard_condition->setEventFd(wait_set_info->event_fd);
+          _record_attachment_locked(
+            wait_set_info, wait_set_info->attached_guard_conditions, data);
+          wait_set_info->indexed_entities.push_back(
+            ReadyEntity{data, ReadyEntity::Kind::GuardCondition, i});
+        }
+      }
+
+      _build_ready_index_locked(wait_set_info);
     }
   }
 
+  // Events have no destruction hook in the rmw API, so their attachment
+  // cannot be cached safely; they keep the per-call attach/detach cycle.
   if (events) {
     for (size_t i = 0; i < events->event_count; ++i) {
       auto event = static_cast<rmw_event_t *>(events->events[i]);
       auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      custom_event_info->getListener()->attachCondition(conditionMutex, conditionVariable);
-    }
-  }
-
-  if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
-      auto guard_condition = static_cast<GuardCondition *>(data);
-      guard_condition->attachCondition(conditionMutex, conditionVariable);
+      custom_event_info->getListener()->attachCondition(
+        conditionMutex, conditionVariable, &wait_set_info->any_ready);
+      custom_event_info->getListener()->setEventFd(wait_set_info->event_fd);
     }
   }
 
@@ -164,23 +782,97 @@ __rmw_wait(
   // otherwise the decision to wait might be incorrect
   std::unique_lock<std::mutex> lock(*conditionMutex);
 
-  bool hasData = check_wait_set_for_data(
-    subscriptions, guard_conditions, services, clients, events);
-  auto predicate = [subscriptions, guard_conditions, services, clients, events]() {
-      return check_wait_set_for_data(subscriptions, guard_conditions, services, clients, events);
+  // Clear the ready flag before the scan: anything that became ready earlier
+  // is picked up by the scan, anything that becomes ready later raises the
+  // flag again under the condition mutex.
+  wait_set_info->any_ready.store(false);
+
+  bool hasData;
+  if (wait_set_info->ready_word_count > 0u) {
+    // Two-level index: only the set bits are visited, so the readiness
+    // check is O(ready) regardless of how many entities are attached.
+    // Events attach per call and stay outside the index.
+    hasData = _scan_ready_index(wait_set_info) ||
+      check_wait_set_for_data(nullptr, nullptr, nullptr, nullptr, events);
+  } else {
+    hasData = check_wait_set_for_data(
+      subscriptions, guard_conditions, services, clients, events);
+  }
+  // Wakeups are validated in O(1) through the wait-set level flag instead of
+  // rescanning every attached entity on each spurious wakeup. Every false
+  // evaluation is counted; the pre-sleep check contributes one per park, the
+  // rest are absorbed wakeups (see WaitsetStatisticsSnapshot).
+  auto predicate = [wait_set_info]() {
+      const bool ready = wait_set_info->any_ready.load();
+      if (!ready) {
+        wait_set_info->statistics.count_spurious_check();
+      }
+      return ready;
     };
 
   bool timeout = false;
-  if (!hasData) {
-    if (!wait_timeout) {
-      conditionVariable->wait(lock, predicate);
-    } else if (wait_timeout->sec > 0 || wait_timeout->nsec > 0) {
-      auto n = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::seconds(wait_timeout->sec));
-      n += std::chrono::nanoseconds(wait_timeout->nsec);
-      timeout = !conditionVariable->wait_for(lock, n, predicate);
+  if (!hasData && wait_set_info->spin_before_block.count() > 0 &&
+    (indefinite || deadline > std::chrono::steady_clock::now()))
+  {
+    // Hybrid wait: poll the ready flag for the configured budget before
+    // parking on the condition variable, skipping the scheduler wakeup
+    // latency when data arrives within the budget. The mutex is released
+    // while spinning so notifying listeners never contend with the spin.
+    lock.unlock();
+    auto spin_deadline = std::chrono::steady_clock::now() + wait_set_info->spin_before_block;
+    if (!indefinite && deadline < spin_deadline) {
+      spin_deadline = deadline;
+    }
+    while (!wait_set_info->any_ready.load(std::memory_order_relaxed) &&
+      std::chrono::steady_clock::now() < spin_deadline)
+    {
+    }
+    lock.lock();
+    hasData = wait_set_info->any_ready.load();
+  }
+  while (!hasData && !timeout) {
+    if (!wait_set_info->leader_active) {
+      // Leader: the one thread parked on the shared condition variable the
+      // listeners notify, so their notify_one wakes exactly this thread.
+      wait_set_info->leader_active = true;
+      if (indefinite) {
+        conditionVariable->wait(lock, predicate);
+      } else {
+        // wait_until with an already-passed deadline evaluates the predicate
+        // once and comes straight back, covering the zero-timeout poll too.
+        timeout = !conditionVariable->wait_until(lock, deadline, predicate);
+      }
+      wait_set_info->leader_active = false;
+      // Hand the shared condition variable on: after a wakeup so a further
+      // ready entity gets its own waiter, after a timeout so the listeners
+      // are not notifying into a void while followers are still parked.
+      _promote_next_waiter_locked(wait_set_info);
+      hasData = wait_set_info->any_ready.load();
+      break;
+    }
+    // Follower: park on a private condition in FIFO order. Only the
+    // promotion above wakes it, so entity activity re-runs no predicate of
+    // the parked majority — the thundering herd a shared condition causes.
+    ParkedWaiter self;
+    wait_set_info->parked_waiters.push_back(&self);
+    bool promoted = true;
+    if (indefinite) {
+      self.condition.wait(lock, [&self] {return self.promoted;});
     } else {
+      promoted = self.condition.wait_until(lock, deadline, [&self] {return self.promoted;});
+    }
+    if (!promoted) {
+      auto & parked = wait_set_info->parked_waiters;
+      parked.erase(std::find(parked.begin(), parked.end(), &self));
       timeout = true;
+      break;
+    }
+    // Promoted: the outgoing leader consumed its wakeup. With readiness
+    // left over this waiter takes it (and keeps the chain going, one
+    // wakeup per ready entity); otherwise the loop makes it the leader.
+    hasData = wait_set_info->any_ready.load();
+    if (hasData) {
+      _promote_next_waiter_locked(wait_set_info);
     }
   }
 
@@ -191,61 +883,201 @@ __rmw_wait(
   // after we check, it will be caught on the next call to this function).
   lock.unlock();
 
-  if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      custom_subscriber_info->listener_->detachCondition();
-      if (!custom_subscriber_info->listener_->hasData()) {
-        subscriptions->subscribers[i] = 0;
+  // Subscriptions, clients, services and guard conditions stay attached for
+  // the next wait; only the ready scrubbing of the arrays happens here. The
+  // same pass collects the compact ready list, so finding what fired costs
+  // one scan total instead of one here and another in the caller.
+  // Concurrent waiters returning together scrub one at a time; the index's
+  // bit consumption has already split the ready entities between them.
+  std::lock_guard<std::mutex> scrub_lock(wait_set_info->scrub_mutex);
+  wait_set_info->last_ready_entities.clear();
+  if (wait_set_info->ready_word_count > 0u) {
+    _scrub_with_ready_index(
+      wait_set_info, subscriptions, clients, services, guard_conditions);
+  } else {
+    // Cause counters ride the scrub loops the wait already pays for; the
+    // indexed path counts inside _scrub_with_ready_index the same way.
+    uint64_t ready_subscriptions = 0u;
+    uint64_t ready_clients = 0u;
+    uint64_t ready_services = 0u;
+    uint64_t ready_guard_conditions = 0u;
+
+    if (subscriptions) {
+      for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
+        void * data = subscriptions->subscribers[i];
+        auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
+        if (!custom_subscriber_info->listener_->hasData()) {
+          subscriptions->subscribers[i] = 0;
+        } else {
+          wait_set_info->last_ready_entities.push_back(data);
+          ++ready_subscriptions;
+        }
       }
     }
-  }
 
-  if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      custom_client_info->listener_->detachCondition();
-      if (!custom_client_info->listener_->hasData()) {
-        clients->clients[i] = 0;
+    if (clients) {
+      for (size_t i = 0; i < clients->client_count; ++i) {
+        void * data = clients->clients[i];
+        CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
+        if (!custom_client_info->listener_->hasData()) {
+          clients->clients[i] = 0;
+        } else {
+          wait_set_info->last_ready_entities.push_back(data);
+          ++ready_clients;
+        }
       }
     }
-  }
 
-  if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
-      custom_service_info->listener_->detachCondition();
-      if (!custom_service_info->listener_->hasData()) {
-        services->services[i] = 0;
+    if (services) {
+      for (size_t i = 0; i < services->service_count; ++i) {
+        void * data = services->services[i];
+        auto custom_service_info = static_cast<CustomServiceInfo *>(data);
+        if (!custom_service_info->listener_->hasData()) {
+          services->services[i] = 0;
+        } else {
+          wait_set_info->last_ready_entities.push_back(data);
+          ++ready_services;
+        }
       }
     }
+
+    if (guard_conditions) {
+      for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+        void * data = guard_conditions->guard_conditions[i];
+        auto guard_condition = static_cast<GuardCondition *>(data);
+        if (!guard_condition->getHasTriggered()) {
+          guard_conditions->guard_conditions[i] = 0;
+        } else {
+          wait_set_info->last_ready_entities.push_back(data);
+          ++ready_guard_conditions;
+        }
+      }
+    }
+
+    wait_set_info->statistics.add_ready(
+      ready_subscriptions, ready_clients, ready_services, ready_guard_conditions);
   }
 
   if (events) {
+    uint64_t ready_events = 0u;
     for (size_t i = 0; i < events->event_count; ++i) {
       auto event = static_cast<rmw_event_t *>(events->events[i]);
       auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
       custom_event_info->getListener()->detachCondition();
+      // The event listener is shared with the endpoint it reports on, so the
+      // detach above also undid any cached attachment of that endpoint; make
+      // sure the next wait reattaches it.
+      waitset_forget_entity(event->data);
       if (!custom_event_info->getListener()->hasEvent(event->event_type)) {
         events->events[i] = nullptr;
+      } else {
+        wait_set_info->last_ready_entities.push_back(event);
+        ++ready_events;
       }
     }
+    wait_set_info->statistics.add_ready_events(ready_events);
   }
 
-  if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
-      auto guard_condition = static_cast<GuardCondition *>(data);
-      guard_condition->detachCondition();
-      if (!guard_condition->getHasTriggered()) {
-        guard_conditions->guard_conditions[i] = 0;
-      }
-    }
-  }
+  // With priorities registered, critical entities lead the ready list so a
+  // consumer dispatching in list order services them first. The positional
+  // output arrays stay untouched: their layout mirrors the caller's arrays.
+  _sort_ready_by_priority(wait_set_info->last_ready_entities);
 
+  wait_set_info->statistics.record_wait(
+    static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wait_entry_time).count()),
+    timeout);
+
+  RMW_FASTRTPS_TRACEPOINT2(rmw_wait_exit, wait_set_info, timeout);
   return timeout ? RMW_RET_TIMEOUT : RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_wait(
+  rmw_subscriptions_t * subscriptions,
+  rmw_guard_conditions_t * guard_conditions,
+  rmw_services_t * services,
+  rmw_clients_t * clients,
+  rmw_events_t * events,
+  rmw_wait_set_t * wait_set,
+  const rmw_time_t * wait_timeout)
+{
+  return _wait(
+    subscriptions, guard_conditions, services, clients, events, wait_set,
+    wait_timeout, false, std::chrono::steady_clock::time_point());
+}
+
+rmw_ret_t
+__rmw_wait_until(
+  rmw_subscriptions_t * subscriptions,
+  rmw_guard_conditions_t * guard_conditions,
+  rmw_services_t * services,
+  rmw_clients_t * clients,
+  rmw_events_t * events,
+  rmw_wait_set_t * wait_set,
+  int64_t deadline_ns)
+{
+  if (deadline_ns < 0) {
+    return _wait(
+      subscriptions, guard_conditions, services, clients, events, wait_set,
+      nullptr, false, std::chrono::steady_clock::time_point());
+  }
+  return _wait(
+    subscriptions, guard_conditions, services, clients, events, wait_set,
+    nullptr, true,
+    std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline_ns)));
+}
+
+rmw_ret_t
+__rmw_wait_set_get_last_ready(
+  const char * identifier,
+  const rmw_wait_set_t * wait_set,
+  void ** entities,
+  size_t capacity,
+  size_t * count)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    wait_set, "wait set handle is null", return RMW_RET_INVALID_ARGUMENT);
+  if (wait_set->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("wait set handle not from this implementation");
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION;
+  }
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    count, "count pointer is null", return RMW_RET_INVALID_ARGUMENT);
+  if (capacity > 0 && !entities) {
+    RMW_SET_ERROR_MSG("entities array is null");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto wait_set_info = static_cast<CustomWaitsetInfo *>(wait_set->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    wait_set_info, "wait set info is null", return RMW_RET_ERROR);
+
+  const std::vector<void *> & ready = wait_set_info->last_ready_entities;
+  *count = ready.size();
+  size_t to_copy = std::min(capacity, ready.size());
+  for (size_t i = 0; i < to_copy; ++i) {
+    entities[i] = ready[i];
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_wait_set_entity_priority(void * entity, int32_t priority)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    entity, "entity pointer is null", return RMW_RET_INVALID_ARGUMENT);
+
+  std::lock_guard<std::mutex> lock(g_priority_mutex);
+  if (0 == priority) {
+    // Zero is the implicit default; dropping the entry keeps the registry
+    // (and the per-wait sorting trigger) limited to prioritized entities.
+    g_entity_priorities.erase(entity);
+  } else {
+    g_entity_priorities[entity] = priority;
+  }
+  g_priority_count.store(g_entity_priorities.size(), std::memory_order_relaxed);
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
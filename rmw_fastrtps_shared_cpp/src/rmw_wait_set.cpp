@@ -12,6 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdlib.h>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
@@ -20,6 +31,7 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 #include "types/custom_wait_set_info.hpp"
+#include "waitset_attachment.hpp"
 
 namespace rmw_fastrtps_shared_cpp
 {
@@ -34,7 +46,6 @@ __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t m
     // TODO(wjwwood): replace this with RMW_RET_INCORRECT_RMW_IMPLEMENTATION when refactored
     return nullptr);
 
-  (void)max_conditions;
   rmw_wait_set_t * wait_set = rmw_wait_set_allocate();
   CustomWaitsetInfo * wait_set_info = nullptr;
 
@@ -54,6 +65,44 @@ __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t m
     goto fail;
   }
 
+  if (max_conditions > 0) {
+    // The hint bounds how many entities the caller will attach; sizing the
+    // attachment caches, the readiness index and the ready list to it now
+    // keeps wait-set operation allocation-free after creation, as long as
+    // the composition stays within the hint.
+    wait_set_info->attached_subscriptions.reserve(max_conditions);
+    wait_set_info->attached_clients.reserve(max_conditions);
+    wait_set_info->attached_services.reserve(max_conditions);
+    wait_set_info->attached_guard_conditions.reserve(max_conditions);
+    wait_set_info->indexed_entities.reserve(max_conditions);
+    wait_set_info->last_ready_entities.reserve(max_conditions);
+    const size_t word_count = (max_conditions + kReadyWordBits - 1u) / kReadyWordBits;
+    wait_set_info->ready_words.reset(new std::atomic<uint64_t>[word_count]);
+    wait_set_info->ready_word_capacity = word_count;
+  }
+
+  {
+    // Latency-critical waiters on dedicated cores can trade spun CPU for
+    // take-to-wake latency; see CustomWaitsetInfo::spin_before_block.
+    const char * env_value;
+    const char * error_str;
+    error_str = rcutils_get_env("RMW_FASTRTPS_WAIT_SPIN_US", &env_value);
+    if (error_str != NULL) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+    } else if (env_value != nullptr && env_value[0] != '\0') {
+      char * end = nullptr;
+      unsigned long spin_us = strtoul(env_value, &end, 10);  // NOLINT(runtime/int)
+      if (end == env_value || *end != '\0') {
+        RCUTILS_LOG_WARN_NAMED(
+          "rmw_fastrtps_shared_cpp",
+          "RMW_FASTRTPS_WAIT_SPIN_US is not a number of microseconds, ignoring it");
+      } else {
+        wait_set_info->spin_before_block = std::chrono::microseconds(spin_us);
+      }
+    }
+  }
+
   return wait_set;
 
 fail:
@@ -68,6 +117,45 @@ fail:
   return nullptr;
 }
 
+rmw_ret_t
+__rmw_wait_set_get_file_descriptor(
+  const char * identifier, rmw_wait_set_t * wait_set, int * fd)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(wait_set, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(fd, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    wait set handle,
+    wait_set->implementation_identifier, identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION)
+
+  auto wait_set_info = static_cast<CustomWaitsetInfo *>(wait_set->data);
+  if (!wait_set_info) {
+    RMW_SET_ERROR_MSG("wait set info is null");
+    return RMW_RET_ERROR;
+  }
+
+#ifdef __linux__
+  if (wait_set_info->event_fd < 0) {
+    // Non-blocking so listener signals never stall on a saturated counter;
+    // cloexec like every other descriptor this layer owns.
+    int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd < 0) {
+      RMW_SET_ERROR_MSG("failed to create eventfd for wait set");
+      return RMW_RET_ERROR;
+    }
+    // Hands the fd to the currently attached listeners too, so the export
+    // takes effect without waiting for the composition to change.
+    waitset_set_event_fd(wait_set_info, event_fd);
+  }
+  *fd = wait_set_info->event_fd;
+  return RMW_RET_OK;
+#else
+  (void)wait_set_info;
+  RMW_SET_ERROR_MSG("wait set file descriptors are only supported on Linux");
+  return RMW_RET_UNSUPPORTED;
+#endif
+}
+
 rmw_ret_t
 __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set)
 {
@@ -92,6 +180,19 @@ __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set)
     return RMW_RET_ERROR;
   }
 
+  // Entities may still be attached from the last __rmw_wait; drop them before
+  // the condition variable and mutex they point to go away.
+  waitset_detach_entities(wait_set_info);
+
+#ifdef __linux__
+  // detach cleared the listeners' copies of the fd, so nothing signals it
+  // any more and it is safe to close.
+  if (wait_set_info->event_fd >= 0) {
+    close(wait_set_info->event_fd);
+    wait_set_info->event_fd = -1;
+  }
+#endif
+
   if (wait_set->data) {
     if (wait_set_info) {
       RMW_TRY_DESTRUCTOR(
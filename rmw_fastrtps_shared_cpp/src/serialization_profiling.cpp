@@ -0,0 +1,167 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/serialization_profiling.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+constexpr size_t kBuckets = 64;
+
+// One log2 histogram per direction and type, owned by one thread. The
+// owning thread increments without synchronization; the dump reads the
+// counters concurrently and tolerates torn totals.
+struct ThreadProfile
+{
+  std::unordered_map<std::string, std::array<uint64_t, kBuckets>> serialize_hist;
+  std::unordered_map<std::string, std::array<uint64_t, kBuckets>> deserialize_hist;
+};
+
+std::mutex g_profiles_mutex;
+// shared_ptr keeps a profile alive for dumping after its thread exited.
+std::vector<std::shared_ptr<ThreadProfile>> & g_profiles()
+{
+  static std::vector<std::shared_ptr<ThreadProfile>> profiles;
+  return profiles;
+}
+
+ThreadProfile &
+_this_thread_profile()
+{
+  thread_local std::shared_ptr<ThreadProfile> profile = []() {
+      auto p = std::make_shared<ThreadProfile>();
+      std::lock_guard<std::mutex> lock(g_profiles_mutex);
+      g_profiles().push_back(p);
+      return p;
+    }();
+  return *profile;
+}
+
+size_t
+_bucket(uint64_t cycles)
+{
+  size_t bucket = 0;
+  while (cycles > 1 && bucket < kBuckets - 1) {
+    cycles >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+uint64_t
+serialization_profile_now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void
+serialization_profile_record(const char * type_name, bool deserialize, uint64_t cycles)
+{
+  ThreadProfile & profile = _this_thread_profile();
+  auto & hist = deserialize ?
+    profile.deserialize_hist[type_name] : profile.serialize_hist[type_name];
+  ++hist[_bucket(cycles)];
+}
+
+void
+serialization_profile_dump()
+{
+  // Aggregate across threads per direction and type; ordered output keeps
+  // two dumps diffable.
+  std::map<std::string, std::array<uint64_t, kBuckets>> aggregated;
+  {
+    std::lock_guard<std::mutex> lock(g_profiles_mutex);
+    for (const auto & profile : g_profiles()) {
+      for (const auto & entry : profile->serialize_hist) {
+        auto & hist = aggregated["serialize " + entry.first];
+        for (size_t i = 0; i < kBuckets; ++i) {
+          hist[i] += entry.second[i];
+        }
+      }
+      for (const auto & entry : profile->deserialize_hist) {
+        auto & hist = aggregated["deserialize " + entry.first];
+        for (size_t i = 0; i < kBuckets; ++i) {
+          hist[i] += entry.second[i];
+        }
+      }
+    }
+  }
+
+  FILE * out = stderr;
+  const char * env_value;
+  const char * error_str = rcutils_get_env("RMW_FASTRTPS_SERIALIZATION_PROFILE_FILE", &env_value);
+  if (error_str != NULL) {
+    RCUTILS_LOG_DEBUG_NAMED(
+      "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+  } else if (env_value != nullptr && env_value[0] != '\0') {
+    out = fopen(env_value, "a");
+    if (nullptr == out) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "could not open serialization profile file '%s', dumping to stderr", env_value);
+      out = stderr;
+    }
+  }
+
+  for (const auto & entry : aggregated) {
+    uint64_t count = 0;
+    for (uint64_t bucket_count : entry.second) {
+      count += bucket_count;
+    }
+    if (0 == count) {
+      continue;
+    }
+    fprintf(out, "%s: %llu samples\n", entry.first.c_str(),
+      static_cast<unsigned long long>(count));
+    for (size_t i = 0; i < kBuckets; ++i) {
+      if (entry.second[i] > 0) {
+        fprintf(out, "  <2^%zu cycles: %llu\n", i + 1,
+          static_cast<unsigned long long>(entry.second[i]));
+      }
+    }
+  }
+  if (out != stderr) {
+    fclose(out);
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -26,12 +26,16 @@
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/handle_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/subscription.hpp"
+#include "rmw_fastrtps_shared_cpp/topic_mux.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "waitset_attachment.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -59,19 +63,25 @@ destroy_subscription(
 
   auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
   if (info != nullptr) {
+    // Drops the logical-topic registration of a multiplexed subscription;
+    // readers are never shared, so teardown always proceeds.
+    mux_release_endpoint(subscription, info);
+    waitset_forget_entity(info);
     if (info->subscriber_ != nullptr) {
       Domain::removeSubscriber(info->subscriber_);
     }
     delete info->listener_;
     if (info->type_support_ != nullptr) {
-      Participant * participant = participant_info->participant;
+      // With sharding the endpoint may live on a shard participant.
+      Participant * participant =
+        info->participant_ ? info->participant_ : participant_info->participant;
       _unregister_type(participant, info->type_support_);
     }
     delete info;
   }
-  rmw_free(const_cast<char *>(subscription->topic_name));
+  handle_pool_release(const_cast<char *>(subscription->topic_name));
   subscription->topic_name = nullptr;
-  rmw_subscription_free(subscription);
+  handle_pool_release(subscription);
 
   return RMW_RET_OK;
 }
@@ -0,0 +1,200 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "rcutils/strdup.h"
+#include "rcutils/types/string_array.h"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_fastrtps_shared_cpp/topic_mux.hpp"
+
+#include "demangle.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+struct SharedChannel
+{
+  const eprosima::fastrtps::Participant * participant;
+  std::string dds_topic_name;
+  std::string type_name;
+  CustomPublisherInfo * info;
+  size_t references;
+};
+
+struct LogicalTopic
+{
+  std::string ros_topic_name;
+  std::string dds_type_name;
+};
+
+// One mutex for all mux state: endpoint creation and destruction are the
+// only writers and graph queries the only other readers, none of them hot.
+std::mutex g_mux_mutex;
+std::vector<SharedChannel> g_shared_channels;
+// Logical-topic registrations keyed by the rmw endpoint handle. Several
+// handles may ride the same channel, so the handle — not the shared info —
+// identifies the registration.
+std::map<const void *, LogicalTopic> g_logical_topics;
+
+}  // namespace
+
+CustomPublisherInfo *
+mux_acquire_shared_publisher(
+  const eprosima::fastrtps::Participant * participant,
+  const std::string & dds_topic_name,
+  const std::string & type_name)
+{
+  std::lock_guard<std::mutex> lock(g_mux_mutex);
+  for (SharedChannel & channel : g_shared_channels) {
+    if (channel.participant == participant && channel.dds_topic_name == dds_topic_name &&
+      channel.type_name == type_name)
+    {
+      ++channel.references;
+      return channel.info;
+    }
+  }
+  return nullptr;
+}
+
+void
+mux_register_shared_publisher(
+  const eprosima::fastrtps::Participant * participant,
+  const std::string & dds_topic_name,
+  const std::string & type_name,
+  CustomPublisherInfo * info)
+{
+  std::lock_guard<std::mutex> lock(g_mux_mutex);
+  g_shared_channels.push_back({participant, dds_topic_name, type_name, info, 1u});
+}
+
+void
+mux_register_logical_topic(
+  const void * endpoint_handle,
+  const std::string & ros_topic_name,
+  const std::string & dds_type_name)
+{
+  std::lock_guard<std::mutex> lock(g_mux_mutex);
+  g_logical_topics[endpoint_handle] = {ros_topic_name, dds_type_name};
+}
+
+bool
+mux_release_endpoint(const void * endpoint_handle, const void * endpoint_info)
+{
+  std::lock_guard<std::mutex> lock(g_mux_mutex);
+  g_logical_topics.erase(endpoint_handle);
+  for (auto it = g_shared_channels.begin(); it != g_shared_channels.end(); ++it) {
+    if (it->info == endpoint_info) {
+      if (--it->references > 0) {
+        return false;
+      }
+      g_shared_channels.erase(it);
+      return true;
+    }
+  }
+  return true;
+}
+
+rmw_ret_t
+mux_expand_names_and_types(
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * names_and_types)
+{
+  // Logical topics registered more than once (one publisher, several
+  // subscriptions) collapse into one entry with the union of their types.
+  std::map<std::string, std::set<std::string>> additions;
+  {
+    std::lock_guard<std::mutex> lock(g_mux_mutex);
+    for (const auto & entry : g_logical_topics) {
+      additions[entry.second.ros_topic_name].insert(
+        _demangle_if_ros_type(entry.second.dds_type_name));
+    }
+  }
+  for (size_t i = 0; additions.size() > 0 && i < names_and_types->names.size; ++i) {
+    additions.erase(names_and_types->names.data[i]);
+  }
+  if (additions.empty()) {
+    return RMW_RET_OK;
+  }
+
+  // The rcutils arrays do not grow in place; rebuild the result with the
+  // additions appended.
+  rmw_names_and_types_t merged = rmw_get_zero_initialized_names_and_types();
+  rmw_ret_t ret = rmw_names_and_types_init(
+    &merged, names_and_types->names.size + additions.size(), allocator);
+  if (RMW_RET_OK != ret) {
+    return ret;
+  }
+
+  size_t index = 0;
+  auto assign_entry = [&](const char * name, const std::vector<std::string> & types) {
+      merged.names.data[index] = rcutils_strdup(name, *allocator);
+      if (!merged.names.data[index]) {
+        return false;
+      }
+      if (RCUTILS_RET_OK != rcutils_string_array_init(
+          &merged.types[index], types.size(), allocator))
+      {
+        return false;
+      }
+      for (size_t j = 0; j < types.size(); ++j) {
+        merged.types[index].data[j] = rcutils_strdup(types[j].c_str(), *allocator);
+        if (!merged.types[index].data[j]) {
+          return false;
+        }
+      }
+      ++index;
+      return true;
+    };
+
+  bool ok = true;
+  for (size_t i = 0; ok && i < names_and_types->names.size; ++i) {
+    std::vector<std::string> types(
+      names_and_types->types[i].data,
+      names_and_types->types[i].data + names_and_types->types[i].size);
+    ok = assign_entry(names_and_types->names.data[i], types);
+  }
+  for (auto it = additions.begin(); ok && it != additions.end(); ++it) {
+    ok = assign_entry(
+      it->first.c_str(), std::vector<std::string>(it->second.begin(), it->second.end()));
+  }
+  if (!ok) {
+    RMW_SET_ERROR_MSG("failed to allocate expanded names and types");
+    if (RMW_RET_OK != rmw_names_and_types_fini(&merged)) {
+      RMW_SET_ERROR_MSG("failed to cleanup expanded names and types");
+    }
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  if (RMW_RET_OK != rmw_names_and_types_fini(names_and_types)) {
+    RMW_SET_ERROR_MSG("failed to cleanup names and types before expansion");
+    if (RMW_RET_OK != rmw_names_and_types_fini(&merged)) {
+      RMW_SET_ERROR_MSG("failed to cleanup expanded names and types");
+    }
+    return RMW_RET_ERROR;
+  }
+  *names_and_types = merged;
+  return RMW_RET_OK;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -0,0 +1,123 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_shared_cpp/type_name_compaction.hpp"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "rcutils/get_env.h"
+#include "rcutils/logging_macros.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+
+constexpr char kCompactPrefix[] = "rthc_";
+constexpr size_t kCompactPrefixLength = sizeof(kCompactPrefix) - 1;
+// prefix + 16 hex digits + trailing underscore.
+constexpr size_t kCompactNameLength = kCompactPrefixLength + 16 + 1;
+
+std::mutex g_registry_mutex;
+// Keyed by hash; values are never erased, so their storage is stable and
+// resolve_type_name can hand out pointers into it.
+std::unordered_map<uint64_t, std::string> g_full_names;
+
+uint64_t
+_fnv1a(const std::string & text)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : text) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+bool
+compact_type_names_enabled()
+{
+  static const bool enabled = []() {
+      const char * env_value;
+      const char * error_str = rcutils_get_env("RMW_FASTRTPS_COMPACT_TYPE_NAMES", &env_value);
+      if (error_str != NULL) {
+        RCUTILS_LOG_DEBUG_NAMED(
+          "rmw_fastrtps_shared_cpp", "Error getting env var: %s\n", error_str);
+        return false;
+      }
+      return env_value != nullptr && strcmp(env_value, "1") == 0;
+    }();
+  return enabled;
+}
+
+std::string
+compact_type_name(const std::string & type_name)
+{
+  if (!compact_type_names_enabled() || type_name.empty()) {
+    return type_name;
+  }
+  const uint64_t hash = _fnv1a(type_name);
+  {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    std::string & entry = g_full_names[hash];
+    if (entry.empty()) {
+      entry = type_name;
+    } else if (entry != type_name) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "type name hash collision between '%s' and '%s'; announcing the full name",
+        entry.c_str(), type_name.c_str());
+      return type_name;
+    }
+  }
+  char compact[kCompactNameLength + 1];
+  snprintf(compact, sizeof(compact), "%s%016" PRIx64 "_", kCompactPrefix, hash);
+  return std::string(compact);
+}
+
+const char *
+resolve_type_name(const char * discovered_name)
+{
+  if (nullptr == discovered_name ||
+    0 != strncmp(discovered_name, kCompactPrefix, kCompactPrefixLength) ||
+    kCompactNameLength != strlen(discovered_name))
+  {
+    return discovered_name;
+  }
+  char * end = nullptr;
+  const uint64_t hash =
+    strtoull(discovered_name + kCompactPrefixLength, &end, 16);  // NOLINT(runtime/int)
+  if (end != discovered_name + kCompactPrefixLength + 16 || '_' != *end) {
+    return discovered_name;
+  }
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  auto it = g_full_names.find(hash);
+  if (it == g_full_names.end()) {
+    return discovered_name;
+  }
+  return it->second.c_str();
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -15,13 +15,129 @@
 #ifndef TYPES__CUSTOM_WAIT_SET_INFO_HPP_
 #define TYPES__CUSTOM_WAIT_SET_INFO_HPP_
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/entity_statistics.hpp"
+
+/// Bits per word of the readiness index; one summary word covers this many
+/// entity words, so compositions beyond kReadyWordBits * kReadyWordBits
+/// entities fall back to the linear scan.
+constexpr size_t kReadyWordBits = 64u;
+
+/// What an index slot of the readiness index refers to.
+struct ReadyEntity
+{
+  enum class Kind
+  {
+    Subscription,
+    Client,
+    Service,
+    GuardCondition,
+  };
+
+  void * data;
+  Kind kind;
+  // Position in the caller's array for this kind, so a ready entity found
+  // through the index can be restored into the right scrubbed entry.
+  size_t array_index;
+};
+
+/// One thread parked on a wait set while another holds the shared condition.
+struct ParkedWaiter
+{
+  std::condition_variable condition;
+  // Set by the promoting leader; guarded by the wait set's condition_mutex.
+  bool promoted{false};
+};
 
 typedef struct CustomWaitsetInfo
 {
   std::condition_variable condition;
   std::mutex condition_mutex;
+
+  // Raised by attached listeners together with every notification, so a
+  // wakeup can be validated without rescanning all attached entities.
+  std::atomic_bool any_ready{false};
+
+  // Concurrent waiters: exactly one thread at a time, the leader, parks on
+  // the shared condition the listeners notify; the rest queue here in FIFO
+  // order, each on its own condition. An outgoing leader promotes the front
+  // waiter, so every notification wakes one thread and entity activity
+  // never re-runs the predicates of the parked majority. Both guarded by
+  // condition_mutex.
+  std::deque<ParkedWaiter *> parked_waiters;
+  bool leader_active{false};
+
+  // Serializes the post-wait scrub of the caller arrays and the ready list
+  // when several waiters return together; the readiness index's bit
+  // consumption already partitions the ready entities between them.
+  std::mutex scrub_mutex;
+
+  // Bounded busy-spin on the ready flag before parking on the condition
+  // variable, for latency-critical waiters on dedicated cores. Zero keeps
+  // the pure blocking behavior. Initialized from RMW_FASTRTPS_WAIT_SPIN_US
+  // when the wait set is created.
+  std::chrono::nanoseconds spin_before_block{0};
+
+  // Last relative timeout and its converted value, so an executor waiting in
+  // a fixed-rate loop pays for the duration arithmetic once instead of on
+  // every wait. Only touched by the waiting thread.
+  rmw_time_t cached_timeout{0, 0};
+  std::chrono::nanoseconds cached_timeout_ns{0};
+
+  // Entities found ready by the last __rmw_wait on this wait set, collected
+  // during the pass that scrubs the caller's arrays, so consumers can walk
+  // just the ready entities instead of rescanning every array entry. Holds
+  // the same pointers the arrays keep non-null (entity data pointers, and
+  // the rmw_event_t pointer for events). Only valid between two waits on the
+  // same thread; not synchronized against a concurrent wait.
+  std::vector<void *> last_ready_entities;
+
+  // Entities stay attached to this wait set across calls to __rmw_wait.
+  // These caches record what is currently attached, so a wait over an
+  // unchanged composition skips the attach/detach loops entirely.
+  // Guarded by the process-wide attachment mutex in rmw_wait.cpp.
+  std::vector<void *> attached_subscriptions;
+  std::vector<void *> attached_clients;
+  std::vector<void *> attached_services;
+  std::vector<void *> attached_guard_conditions;
+
+  // Two-level readiness index over the attached entities: one bit per
+  // entity, grouped into 64 bit words, plus one summary word with a bit per
+  // group. Listeners mark their slot when they become ready, so checking for
+  // data walks only the set bits instead of every attached entity. Rebuilt
+  // whenever the composition changes; a composition with more entities than
+  // the single summary word can cover leaves ready_word_count at zero and
+  // falls back to the linear scan. Event attachments are per call and stay
+  // outside the index.
+  std::atomic<uint64_t> ready_summary{0};
+  std::unique_ptr<std::atomic<uint64_t>[]> ready_words;
+  size_t ready_word_count{0};
+  // Words allocated behind ready_words. Seeded from the creator's
+  // max_conditions hint and grown on demand, so index rebuilds within the
+  // hinted size reuse the allocation instead of reallocating per rebuild.
+  size_t ready_word_capacity{0};
+  // Slot number (word * 64 + bit) to entity; parallel to the bit layout.
+  std::vector<ReadyEntity> indexed_entities;
+
+  // Eventfd exported by __rmw_wait_set_get_file_descriptor, or -1. Created
+  // lazily, handed to the attached listeners so they signal it alongside
+  // every condition notification, closed when the wait set is destroyed.
+  // Guarded by the process-wide attachment mutex in rmw_wait.cpp.
+  int event_fd{-1};
+
+  // Wakeup counters for __rmw_wait_set_get_statistics; written with relaxed
+  // atomics from the wait path, readable at any time.
+  rmw_fastrtps_shared_cpp::WaitsetStatistics statistics;
 } CustomWaitsetInfo;
 
 #endif  // TYPES__CUSTOM_WAIT_SET_INFO_HPP_
@@ -18,43 +18,97 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <utility>
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw_fastrtps_shared_cpp/ready_slot.hpp"
+#include "rmw_fastrtps_shared_cpp/waitset_event_fd.hpp"
+
 class GuardCondition
 {
 public:
   GuardCondition()
   : hasTriggered_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+    conditionMutex_(nullptr), conditionVariable_(nullptr), conditionReady_(nullptr) {}
+
+  /// Coalesce triggers: at most one delivery per quiet window (0 disables).
+  /**
+   * For conditions triggered in storms, like the graph guard condition
+   * during a site restart. Triggers inside the window fold into one
+   * pending delivery, released by the first trigger past the window or by
+   * the next readiness scan after it — waiters polling or waiting with a
+   * timeout see the trailing trigger then. A waiter parked without timeout
+   * can only be woken by a delivery, so pick a window well below the
+   * shortest wait timeout that watches this condition. Triggers are never
+   * lost, only deferred.
+   */
+  void
+  setTriggerCoalescing(int64_t quiet_window_ns)
+  {
+    coalesce_window_ns_.store(quiet_window_ns, std::memory_order_relaxed);
+  }
 
   void
   trigger()
   {
+    const int64_t window = coalesce_window_ns_.load(std::memory_order_relaxed);
+    if (window > 0) {
+      const int64_t now = _now_ns();
+      int64_t last = last_delivery_ns_.load(std::memory_order_relaxed);
+      if (now - last < window ||
+        !last_delivery_ns_.compare_exchange_strong(last, now, std::memory_order_relaxed))
+      {
+        // Inside the quiet window, or a concurrent trigger opened the next
+        // one: fold into a single pending delivery.
+        pending_coalesced_.store(true, std::memory_order_relaxed);
+        return;
+      }
+      // This delivery also covers everything folded so far.
+      pending_coalesced_.store(false, std::memory_order_relaxed);
+    }
+
+    // Stored before any signaling, so a waiter that scans for data observes
+    // the trigger no matter how it was woken up.
+    hasTriggered_ = true;
+
     std::lock_guard<std::mutex> lock(internalMutex_);
 
     if (conditionMutex_ != nullptr) {
-      std::unique_lock<std::mutex> clock(*conditionMutex_);
-      // the change to hasTriggered_ needs to be mutually exclusive with
-      // rmw_wait() which checks hasTriggered() and decides if wait() needs to
-      // be called
-      hasTriggered_ = true;
-      clock.unlock();
+      // Bit before flag: a waiter woken through the flag finds it set.
+      ready_slot_.mark();
+      // Before the suppression below: fd consumers never clear the flag.
+      rmw_fastrtps_shared_cpp::waitset_eventfd_signal(event_fd_);
+      if (nullptr != conditionReady_ && conditionReady_->exchange(true)) {
+        // A wakeup is already pending and has not been consumed; the waiter
+        // clears the flag before scanning and will observe hasTriggered_, so
+        // repeated triggers stay wait-free.
+        return;
+      }
+      // The empty critical section pairs with the waiter's predicate check:
+      // the waiter is either before the check, and sees the flags set above,
+      // or already waiting, and receives the notification.
+      {
+        std::lock_guard<std::mutex> clock(*conditionMutex_);
+      }
       conditionVariable_->notify_one();
-    } else {
-      hasTriggered_ = true;
     }
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    std::atomic_bool * conditionReady)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    conditionReady_ = conditionReady;
   }
 
   void
@@ -63,25 +117,89 @@ public:
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    conditionReady_ = nullptr;
+    event_fd_ = -1;
+  }
+
+  void
+  setEventFd(int event_fd)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    event_fd_ = event_fd;
+  }
+
+  void
+  setReadySlot(const rmw_fastrtps_shared_cpp::ReadySlot & slot)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    ready_slot_ = slot;
   }
 
   bool
   hasTriggered()
   {
+    _flush_coalesced();
     return hasTriggered_;
   }
 
   bool
   getHasTriggered()
   {
+    _flush_coalesced();
     return hasTriggered_.exchange(false);
   }
 
 private:
+  static int64_t
+  _now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /// Deliver a pending coalesced trigger once its quiet window has passed.
+  void
+  _flush_coalesced()
+  {
+    if (!pending_coalesced_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const int64_t window = coalesce_window_ns_.load(std::memory_order_relaxed);
+    const int64_t now = _now_ns();
+    if (now - last_delivery_ns_.load(std::memory_order_relaxed) < window) {
+      return;
+    }
+    if (!pending_coalesced_.exchange(false, std::memory_order_relaxed)) {
+      return;
+    }
+    last_delivery_ns_.store(now, std::memory_order_relaxed);
+    hasTriggered_ = true;
+    // Mark the readiness index too, so index-driven scrubs agree with the
+    // flag; no notification, the scanning waiter running this is awake.
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    if (conditionMutex_ != nullptr) {
+      ready_slot_.mark();
+      if (nullptr != conditionReady_) {
+        conditionReady_->exchange(true);
+      }
+    }
+  }
+
   std::mutex internalMutex_;
   std::atomic_bool hasTriggered_;
+  // Trigger coalescing (setTriggerCoalescing): quiet window length, the
+  // steady-clock stamp of the last delivery, and whether suppressed
+  // triggers await one. All relaxed; a racily stretched or shortened
+  // window only shifts a wakeup, never loses the trigger.
+  std::atomic<int64_t> coalesce_window_ns_{0};
+  std::atomic<int64_t> last_delivery_ns_{0};
+  std::atomic_bool pending_coalesced_{false};
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  std::atomic_bool * conditionReady_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadySlot ready_slot_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Wait-set eventfd, part of the attachment like the pointers above.
+  int event_fd_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_) {-1};
 };
 
 #endif  // TYPES__GUARD_CONDITION_HPP_
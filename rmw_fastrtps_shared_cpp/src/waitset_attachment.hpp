@@ -0,0 +1,44 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WAITSET_ATTACHMENT_HPP_
+#define WAITSET_ATTACHMENT_HPP_
+
+#include "types/custom_wait_set_info.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Remove an entity that is about to be destroyed from the attachment cache
+/// of whichever wait set it is still attached to, if any.
+/// The entity pointer is the one stored in the rmw wait arrays
+/// (CustomSubscriberInfo, CustomClientInfo, CustomServiceInfo or
+/// GuardCondition).
+void
+waitset_forget_entity(void * entity);
+
+/// Detach every entity still attached to the given wait set and clear its
+/// attachment caches. Must be called before the wait set is destroyed.
+void
+waitset_detach_entities(CustomWaitsetInfo * wait_set_info);
+
+/// Store the wait set's exported eventfd and hand it to every entity
+/// currently attached; entities attaching later receive it with their
+/// attachment. Used by __rmw_wait_set_get_file_descriptor.
+void
+waitset_set_event_fd(CustomWaitsetInfo * wait_set_info, int event_fd);
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // WAITSET_ATTACHMENT_HPP_
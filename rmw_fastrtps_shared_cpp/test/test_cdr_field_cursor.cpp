@@ -0,0 +1,119 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "fastcdr/Cdr.h"
+#include "fastcdr/FastBuffer.h"
+
+#include "rmw_fastrtps_shared_cpp/cdr_field_cursor.hpp"
+
+using rmw_fastrtps_shared_cpp::CdrFieldCursor;
+
+// Serialize fields the way a taken payload looks: encapsulation header
+// first, then the fields in declaration order.
+class CdrFieldCursorTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    buffer_.resize(512);
+    fastbuffer_ = eprosima::fastcdr::FastBuffer(buffer_.data(), buffer_.size());
+    ser_ = std::make_unique<eprosima::fastcdr::Cdr>(
+      fastbuffer_, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR);
+    ser_->serialize_encapsulation();
+  }
+
+  size_t serialized_length() const
+  {
+    return ser_->getSerializedDataLength();
+  }
+
+  std::vector<char> buffer_;
+  eprosima::fastcdr::FastBuffer fastbuffer_;
+  std::unique_ptr<eprosima::fastcdr::Cdr> ser_;
+};
+
+
+TEST_F(CdrFieldCursorTest, test_reads_header_like_prefix) {
+  // std_msgs/Header: int32 sec, uint32 nanosec, string frame_id.
+  *ser_ << static_cast<int32_t>(-5) << static_cast<uint32_t>(42u) << std::string("base_link");
+  *ser_ << static_cast<double>(2.5);
+
+  CdrFieldCursor cursor(buffer_.data(), serialized_length());
+  int32_t sec = 0;
+  uint32_t nanosec = 0;
+  std::string frame_id;
+  double trailing = 0.0;
+  EXPECT_TRUE(cursor.read_int32(&sec));
+  EXPECT_TRUE(cursor.read_uint32(&nanosec));
+  EXPECT_TRUE(cursor.read_string(&frame_id));
+  EXPECT_TRUE(cursor.read_float64(&trailing));
+  EXPECT_TRUE(cursor.valid());
+  EXPECT_EQ(sec, -5);
+  EXPECT_EQ(nanosec, 42u);
+  EXPECT_EQ(frame_id, "base_link");
+  EXPECT_EQ(trailing, 2.5);
+}
+
+TEST_F(CdrFieldCursorTest, test_skip_string) {
+  *ser_ << std::string("frame") << static_cast<uint32_t>(7u);
+
+  CdrFieldCursor cursor(buffer_.data(), serialized_length());
+  uint32_t after = 0;
+  EXPECT_TRUE(cursor.skip_string());
+  EXPECT_TRUE(cursor.read_uint32(&after));
+  EXPECT_EQ(after, 7u);
+}
+
+TEST_F(CdrFieldCursorTest, test_sequence_length) {
+  *ser_ << static_cast<uint32_t>(3u);
+  for (uint8_t i = 0; i < 3; ++i) {
+    *ser_ << i;
+  }
+
+  CdrFieldCursor cursor(buffer_.data(), serialized_length());
+  uint32_t length = 0;
+  EXPECT_TRUE(cursor.read_sequence_length(&length));
+  EXPECT_EQ(length, 3u);
+  uint8_t element = 0;
+  EXPECT_TRUE(cursor.read_uint8(&element));
+  EXPECT_EQ(element, 0u);
+  EXPECT_TRUE(cursor.skip_bytes(2u));
+  EXPECT_TRUE(cursor.valid());
+}
+
+TEST_F(CdrFieldCursorTest, test_read_past_end_fails_sticky) {
+  *ser_ << static_cast<uint32_t>(1u);
+
+  CdrFieldCursor cursor(buffer_.data(), serialized_length());
+  uint32_t value = 0;
+  EXPECT_TRUE(cursor.read_uint32(&value));
+  EXPECT_FALSE(cursor.read_uint32(&value));
+  EXPECT_FALSE(cursor.valid());
+  // Once failed, everything fails; no read resurrects the cursor.
+  EXPECT_FALSE(cursor.read_uint8(reinterpret_cast<uint8_t *>(&value)));
+}
+
+TEST_F(CdrFieldCursorTest, test_truncated_encapsulation_is_invalid) {
+  CdrFieldCursor cursor(buffer_.data(), 2u);
+  EXPECT_FALSE(cursor.valid());
+  uint32_t value = 0;
+  EXPECT_FALSE(cursor.read_uint32(&value));
+}